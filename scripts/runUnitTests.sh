@@ -6,4 +6,4 @@ set -eux
 
 rm -f UnitTestResults.xml
 
-./cmake-build-debug/UnitTests ~[integration] -r junit -o UnitTestResults.xml
+./cmake-build-debug/UnitTests "~[integration]~[benchmark]~[xdp]" -r junit -o UnitTestResults.xml
@@ -0,0 +1,93 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef FILENAMEVALIDATOR_HPP
+#define FILENAMEVALIDATOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// Equivalent to std::regex_match(filename, std::regex("[a-zA-Z0-9\\.\\-_]+")) without building a regex.
+namespace FilenameValidator
+{
+  namespace detail
+  {
+    constexpr std::array<bool, 256> buildAllowedCharacterTable()
+    {
+      std::array<bool, 256> table{};
+      for (auto c = 'a'; c <= 'z'; ++c)
+      {
+        table[static_cast<std::uint8_t>(c)] = true;
+      }
+      for (auto c = 'A'; c <= 'Z'; ++c)
+      {
+        table[static_cast<std::uint8_t>(c)] = true;
+      }
+      for (auto c = '0'; c <= '9'; ++c)
+      {
+        table[static_cast<std::uint8_t>(c)] = true;
+      }
+      table[static_cast<std::uint8_t>('.')] = true;
+      table[static_cast<std::uint8_t>('-')] = true;
+      table[static_cast<std::uint8_t>('_')] = true;
+      return table;
+    }
+
+    inline constexpr std::array<bool, 256> allowedCharacters = buildAllowedCharacterTable();
+  }
+
+  constexpr bool isAllowedCharacter(char c)
+  {
+    return detail::allowedCharacters[static_cast<std::uint8_t>(c)];
+  }
+
+  constexpr bool isValid(std::string_view filename)
+  {
+    if (filename.empty())
+    {
+      return false;
+    }
+    for (const auto c : filename)
+    {
+      if (!isAllowedCharacter(c))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Longest filename, not counting its folders, that the client sends and the server accepts by default.
+  constexpr std::size_t maxFilenameLength = 65;
+  constexpr std::size_t maxPathDepth = 32;
+  constexpr std::size_t maxRelativePathLength = 1024;
+
+  // A directory path relative to the output folder, such as "docs/2021": valid filenames separated by single
+  // slashes, none of them . or .., so a received path can never climb out of the folder it is written to.
+  constexpr bool isValidRelativePath(std::string_view path)
+  {
+    if (path.size() > maxRelativePathLength)
+    {
+      return false;
+    }
+    std::size_t depth = 0;
+    for (std::size_t begin = 0;;)
+    {
+      const auto end = std::min(path.find('/', begin), path.size());
+      const auto component = path.substr(begin, end - begin);
+      if (!isValid(component) || component == "." || component == ".." || ++depth > maxPathDepth)
+      {
+        return false;
+      }
+      if (end == path.size())
+      {
+        return true;
+      }
+      begin = end + 1;
+    }
+  }
+}
+
+#endif //FILENAMEVALIDATOR_HPP
@@ -0,0 +1,76 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef FRAMECOMPRESSION_HPP
+#define FRAMECOMPRESSION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <lz4.h>
+#include "BytesBuffer.hpp"
+
+// Payload of a frame in a compressed session: the decompressed length as a little endian uint32, then one LZ4 block.
+// Every frame is an independent block, so each decodes on its own whatever happens to the frames around it.
+namespace FrameCompression
+{
+  constexpr std::size_t lengthSizeInBytes = 4;
+  constexpr std::size_t maxDecompressedSizeInBytes = 64 * 1024;
+
+  struct CompressedFrame
+  {
+    std::size_t inputBytesUsed;
+    std::size_t frameLength;
+  };
+
+  // Compresses as much of the input, up to maxDecompressedSizeInBytes, as fits in frameCapacity bytes.
+  inline CompressedFrame compressFrame(const char* input, std::size_t inputSize, char* frame, std::size_t frameCapacity)
+  {
+    if (frameCapacity <= lengthSizeInBytes)
+    {
+      throw std::runtime_error("Frame too small for compression");
+    }
+    auto inputBytesUsed = static_cast<int>(std::min(inputSize, maxDecompressedSizeInBytes));
+    const auto compressedLength = LZ4_compress_destSize(
+      input, frame + lengthSizeInBytes, &inputBytesUsed, static_cast<int>(frameCapacity - lengthSizeInBytes));
+    if (compressedLength <= 0 || (inputBytesUsed == 0 && inputSize > 0))
+    {
+      throw std::runtime_error("Unable to compress frame");
+    }
+    const auto decompressedLength = static_cast<std::uint32_t>(inputBytesUsed);
+    for (std::size_t i = 0; i < lengthSizeInBytes; ++i)
+    {
+      frame[i] = static_cast<char>(decompressedLength >> (8 * i));
+    }
+    return {static_cast<std::size_t>(inputBytesUsed), lengthSizeInBytes + static_cast<std::size_t>(compressedLength)};
+  }
+
+  // Replaces the contents of output with the decoded frame. Throws std::runtime_error if the frame is corrupt.
+  inline void decompressFrame(const BytesBuffer& frame, BytesBuffer& output)
+  {
+    if (frame.size() < lengthSizeInBytes)
+    {
+      throw std::runtime_error("Compressed frame too short");
+    }
+    std::uint32_t decompressedLength = 0;
+    for (std::size_t i = 0; i < lengthSizeInBytes; ++i)
+    {
+      decompressedLength |= static_cast<std::uint32_t>(frame[i]) << (8 * i);
+    }
+    if (decompressedLength == 0 || decompressedLength > maxDecompressedSizeInBytes)
+    {
+      throw std::runtime_error("Invalid compressed frame length");
+    }
+    output.resize(decompressedLength);
+    const auto result = LZ4_decompress_safe(
+      reinterpret_cast<const char*>(frame.data() + lengthSizeInBytes), reinterpret_cast<char*>(output.data()),
+      static_cast<int>(frame.size() - lengthSizeInBytes), static_cast<int>(decompressedLength));
+    if (result < 0 || static_cast<std::uint32_t>(result) != decompressedLength)
+    {
+      throw std::runtime_error("Corrupt compressed frame");
+    }
+  }
+}
+
+#endif //FRAMECOMPRESSION_HPP
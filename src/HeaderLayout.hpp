@@ -0,0 +1,70 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef HEADERLAYOUT_HPP
+#define HEADERLAYOUT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <boost/endian/conversion.hpp>
+
+// Compile time description of a fixed size header. Each field is read in place with a single unaligned load,
+// so a header can be viewed straight out of a receive buffer without copying it.
+namespace HeaderLayout
+{
+  template <typename T, std::size_t Offset>
+  struct Field
+  {
+    static_assert(std::is_trivially_copyable_v<T>, "Header fields must be plain bytes");
+
+    using Type = T;
+    static constexpr std::size_t offset = Offset;
+    static constexpr std::size_t size = sizeof(T);
+    static constexpr std::size_t end = Offset + sizeof(T);
+
+    static T read(const std::uint8_t* header) noexcept
+    {
+      T value;
+      std::memcpy(&value, header + Offset, sizeof(T));
+      return value;
+    }
+  };
+
+  // A wider load covering the consecutive fields First to Last, used to check several fields at once.
+  template <typename T, typename First, typename Last>
+  struct Span : Field<T, First::offset>
+  {
+    static_assert(First::offset + sizeof(T) == Last::end, "Span must cover exactly the fields from First to Last");
+  };
+
+  // True if the fields are in order, with no gaps or overlaps, and fill exactly headerSize bytes.
+  template <std::size_t headerSize, typename... Fields>
+  constexpr bool tiles()
+  {
+    std::size_t offset = 0;
+    bool contiguous = true;
+    ((contiguous = contiguous && Fields::offset == offset, offset = Fields::end), ...);
+    return contiguous && offset == headerSize;
+  }
+
+  // The value a native load of the big endian encoding of bigEndianValue produces, for comparing fields in place.
+  template <typename T>
+  constexpr T fromWire(T bigEndianValue) noexcept
+  {
+    static_assert(std::is_unsigned_v<T>, "Only unsigned integers have a wire encoding");
+    if constexpr (boost::endian::order::native == boost::endian::order::big)
+    {
+      return bigEndianValue;
+    }
+    T swapped = 0;
+    for (std::size_t byte = 0; byte < sizeof(T); ++byte)
+    {
+      swapped = static_cast<T>(swapped | (((bigEndianValue >> (8 * byte)) & 0xFF) << (8 * (sizeof(T) - 1 - byte))));
+    }
+    return swapped;
+  }
+}
+
+#endif //HEADERLAYOUT_HPP
@@ -0,0 +1,84 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef PACKFORMAT_HPP
+#define PACKFORMAT_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include "FilenameValidator.hpp"
+
+// Payload of a packed session, which carries many small files in one stream: for each file an entry header, then
+// its name relative to the output folder, as in photos/2021/a.jpg, then its content. The entry headers are the
+// index, so the server can split the files back out as the stream arrives.
+namespace PackFormat
+{
+  // Magic, then the name length as a little endian uint16 and the content size as a little endian uint64.
+  constexpr std::size_t entryHeaderSizeInBytes = 14;
+  constexpr std::array<char, 4> entryMagic{'E', 'D', 'P', 'K'};
+  constexpr std::size_t maxNameLength =
+    FilenameValidator::maxRelativePathLength + 1 + FilenameValidator::maxFilenameLength;
+
+  struct EntryHeader
+  {
+    std::uint16_t nameLength;
+    std::uint64_t contentSize;
+  };
+
+  namespace detail
+  {
+    template<typename Integer>
+    void writeLittleEndian(Integer value, char* output)
+    {
+      for (std::size_t i = 0; i < sizeof(Integer); ++i)
+      {
+        output[i] = static_cast<char>(value >> (8 * i));
+      }
+    }
+
+    template<typename Integer>
+    Integer readLittleEndian(const char* input)
+    {
+      Integer value = 0;
+      for (std::size_t i = 0; i < sizeof(Integer); ++i)
+      {
+        value = static_cast<Integer>(value | static_cast<Integer>(static_cast<std::uint8_t>(input[i])) << (8 * i));
+      }
+      return value;
+    }
+  }
+
+  inline std::array<char, entryHeaderSizeInBytes> writeEntryHeader(const EntryHeader& entry)
+  {
+    std::array<char, entryHeaderSizeInBytes> header{};
+    std::copy(entryMagic.begin(), entryMagic.end(), header.begin());
+    detail::writeLittleEndian(entry.nameLength, header.data() + 4);
+    detail::writeLittleEndian(entry.contentSize, header.data() + 6);
+    return header;
+  }
+
+  // Empty if the header does not start with the magic, which means the stream is corrupt.
+  inline std::optional<EntryHeader> readEntryHeader(const char* header)
+  {
+    if (!std::equal(entryMagic.begin(), entryMagic.end(), header))
+    {
+      return std::nullopt;
+    }
+    return EntryHeader{
+      detail::readLittleEndian<std::uint16_t>(header + 4), detail::readLittleEndian<std::uint64_t>(header + 6)};
+  }
+
+  // A name the server may create: a valid filename, optionally after a relative path the server may create.
+  constexpr bool isValidName(std::string_view name)
+  {
+    const auto slash = name.rfind('/');
+    const auto filename = slash == std::string_view::npos ? name : name.substr(slash + 1);
+    return FilenameValidator::isValid(filename) && filename.size() <= FilenameValidator::maxFilenameLength &&
+           (slash == std::string_view::npos || FilenameValidator::isValidRelativePath(name.substr(0, slash)));
+  }
+}
+
+#endif //PACKFORMAT_HPP
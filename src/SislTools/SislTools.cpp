@@ -4,31 +4,70 @@
 #include "SislTools.hpp"
 #include "library/BoostSpiritSislParser.hpp"
 #include "library/RapidJsonSislConverter.hpp"
+#include "library/SislStreamParser.hpp"
 #include <stdexcept>
 
 namespace SislTools
 {
   std::string toSisl(const std::string& json)
+  {
+    std::string output;
+    toSisl(json, output);
+    return output;
+  }
+
+  std::string toJson(const std::string& sisl)
+  {
+    std::string output;
+    toJson(sisl, output);
+    return output;
+  }
+
+  void toSisl(std::string_view json, std::string& output)
   {
     try
     {
-      return SislToolsInternal::parseJsonToSisl(json);
+      SislToolsInternal::parseJsonToSisl(json, output);
     }
     catch (const std::runtime_error& e)
     {
       throw UnableToParseJsonException();
     }
   }
-  std::string toJson(const std::string& sisl)
+
+  void toJson(std::string_view sisl, std::string& output)
   {
     try
     {
-      return SislToolsInternal::parseSislToJson(sisl);
+      SislToolsInternal::parseSislToJson(sisl, output);
     }
     catch (const std::runtime_error& e)
     {
       throw UnableToParseSislException();
     }
+  }
+
+  void toSisl(std::istream& json, std::ostream& sisl)
+  {
+    try
+    {
+      SislToolsInternal::streamJsonToSisl(json, sisl);
+    }
+    catch (const std::runtime_error& e)
+    {
+      throw UnableToParseJsonException();
+    }
+  }
 
+  void toJson(std::istream& sisl, std::ostream& json)
+  {
+    try
+    {
+      SislToolsInternal::streamSislToJson(sisl, json);
+    }
+    catch (const std::runtime_error& e)
+    {
+      throw UnableToParseSislException();
+    }
   }
 }
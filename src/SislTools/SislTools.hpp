@@ -3,7 +3,10 @@
 
 #ifndef ED_SISLTOOLS_HPP
 #define ED_SISLTOOLS_HPP
+#include <istream>
+#include <ostream>
 #include <string>
+#include <string_view>
 
 struct UnableToParseJsonException : public std::exception
 {
@@ -25,6 +28,16 @@ namespace SislTools
 {
   std::string toSisl(const std::string& json);
   std::string toJson(const std::string& sisl);
+
+  // Streaming variants. The converted document replaces the contents of output, so a caller that
+  // keeps the same output string across calls does not reallocate once it has grown to size.
+  void toSisl(std::string_view json, std::string& output);
+  void toJson(std::string_view sisl, std::string& output);
+
+  // Bounded memory variants for large documents: the input is read and the output written in fixed size chunks.
+  // Output is written as the input is parsed, so after an exception it holds a partial document.
+  void toSisl(std::istream& json, std::ostream& sisl);
+  void toJson(std::istream& sisl, std::ostream& json);
 }
 
 #endif //ED_SISLTOOLS_HPP
@@ -0,0 +1,68 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "SislTools.hpp"
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <test/catch.hpp>
+#include "spdlog/spdlog.h"
+
+// Hidden from the default run; use: UnitTests "[benchmark]"
+namespace
+{
+  // A per-file manifest of roughly the given size: a list of files each carrying a list of chunk digests.
+  std::string makeManifestJson(std::size_t approximateSizeInBytes)
+  {
+    std::string json = R"({"transfer":"benchmark","files":[)";
+    for (auto file = 0u; json.size() < approximateSizeInBytes; ++file)
+    {
+      if (file > 0)
+      {
+        json += ',';
+      }
+      json += R"({"name":"file)" + std::to_string(file) + R"(.bin","size":)" + std::to_string(file * 4096) +
+              R"(,"complete":true,"digests":[)";
+      for (auto chunk = 0; chunk < 16; ++chunk)
+      {
+        json += chunk > 0 ? "," : "";
+        json += R"("0123456789abcdef0123456789abcdef)" + std::to_string(chunk) + R"(")";
+      }
+      json += "]}";
+    }
+    json += "]}";
+    return json;
+  }
+
+  template <typename Convert>
+  void logThroughput(const char* name, std::size_t bytes, Convert&& convert)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    convert();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    spdlog::info("{}: {} bytes in {:.3f}s, {:.1f} MB/s", name, bytes, elapsed.count(),
+                 static_cast<double>(bytes) / elapsed.count() / 1e6);
+  }
+}
+
+TEST_CASE("SislTools benchmark. Multi megabyte manifest throughput", "[.][benchmark]")
+{
+  const auto json = makeManifestJson(16 * 1024 * 1024);
+
+  std::string sisl;
+  logThroughput("Json to sisl, string", json.size(), [&]() { SislTools::toSisl(json, sisl); });
+
+  std::string roundTrip;
+  logThroughput("Sisl to json, string", sisl.size(), [&]() { SislTools::toJson(sisl, roundTrip); });
+  REQUIRE(roundTrip == json);
+
+  std::istringstream jsonInput(json);
+  std::ostringstream sislOutput;
+  logThroughput("Json to sisl, stream", json.size(), [&]() { SislTools::toSisl(jsonInput, sislOutput); });
+  REQUIRE(sislOutput.str() == sisl);
+
+  std::istringstream sislInput(sisl);
+  std::ostringstream jsonOutput;
+  logThroughput("Sisl to json, stream", sisl.size(), [&]() { SislTools::toJson(sislInput, jsonOutput); });
+  REQUIRE(jsonOutput.str() == json);
+}
@@ -2,6 +2,7 @@
 // MIT License. For licence terms see LICENCE.md file.
 
 #include "SislTools.hpp"
+#include <sstream>
 #include <test/catch.hpp>
 
 TEST_CASE("RapidJsonSislConverterInterface Strings Json to Sisl")
@@ -35,3 +36,57 @@ TEST_CASE("RapidJsonSislConverterInterface Errors Empty Json")
 {
   REQUIRE_THROWS_AS(SislTools::toSisl(""), UnableToParseJsonException);
 }
+
+TEST_CASE("RapidJsonSislConverterInterface Streaming conversion replaces the output buffer contents")
+{
+  std::string output = "previous contents";
+  SislTools::toJson("{name: !str \"donald\"}", output);
+  REQUIRE(output == "{\"name\":\"donald\"}");
+
+  SislTools::toSisl("{\"name\": \"donald\"}", output);
+  REQUIRE(output == "{name: !str \"donald\"}");
+}
+
+TEST_CASE("RapidJsonSislConverterInterface Streaming conversion reuses the output buffer capacity")
+{
+  std::string output;
+  output.reserve(1024);
+  const auto* const buffer = output.data();
+
+  for (int i = 0; i < 10; ++i)
+  {
+    SislTools::toJson("{name: !str \"donald\", size: !uint \"123\"}", output);
+    REQUIRE(output == "{\"name\":\"donald\",\"size\":123}");
+    SislTools::toSisl("{\"name\": \"donald\", \"size\": 123}", output);
+    REQUIRE(output == "{name: !str \"donald\",size: !uint \"123\"}");
+  }
+  REQUIRE(output.data() == buffer);
+}
+
+TEST_CASE("RapidJsonSislConverterInterface Streaming conversion errors")
+{
+  std::string output;
+  REQUIRE_THROWS_AS(SislTools::toJson("{", output), UnableToParseSislException);
+  REQUIRE_THROWS_AS(SislTools::toSisl("{", output), UnableToParseJsonException);
+}
+
+TEST_CASE("RapidJsonSislConverterInterface Stream conversion round trips arrays")
+{
+  const std::string json = R"({"files":[{"name":"a.txt","digests":["ab","cd"]},{"name":"b.txt","digests":[]}]})";
+  std::istringstream jsonInput(json);
+  std::stringstream sisl;
+  SislTools::toSisl(jsonInput, sisl);
+
+  std::ostringstream jsonOutput;
+  SislTools::toJson(sisl, jsonOutput);
+  REQUIRE(jsonOutput.str() == json);
+}
+
+TEST_CASE("RapidJsonSislConverterInterface Stream conversion errors")
+{
+  std::istringstream json("{");
+  std::istringstream sisl("{");
+  std::ostringstream output;
+  REQUIRE_THROWS_AS(SislTools::toSisl(json, output), UnableToParseJsonException);
+  REQUIRE_THROWS_AS(SislTools::toJson(sisl, output), UnableToParseSislException);
+}
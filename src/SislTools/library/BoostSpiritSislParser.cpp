@@ -3,23 +3,48 @@
 
 #include <boost/spirit/home/x3.hpp>
 #include "rapidjson/writer.h"
-#include "rapidjson/stringbuffer.h"
 
+#include <charconv>
+#include <cstdlib>
 #include <functional>
 #include <map>
+#include <vector>
 #include "spdlog/spdlog.h"
 
 #include "BoostSpiritSislParser.hpp"
+#include "SislTypes.hpp"
+
+// Lets the rapidjson writer append straight into the caller's output string.
+struct StringOutputStream
+{
+  typedef char Ch;
+
+  explicit StringOutputStream(std::string& output):
+    output(output) {}
+
+  void Put(char c) { output.push_back(c); }
+  void Flush() {}
+
+  std::string& output;
+};
 
 struct Storage
 {
-  Storage():
+  explicit Storage(std::string& output):
+    s(output),
     writer(s) {}
 
-  rapidjson::StringBuffer s;
-  rapidjson::Writer<rapidjson::StringBuffer> writer;
+  StringOutputStream s;
+  rapidjson::Writer<StringOutputStream> writer;
 
-  std::string rType;
+  SislToolsInternal::SislType rType = SislToolsInternal::SislType::null;
+
+  struct Container
+  {
+    bool isList;
+    std::uint64_t memberCount;
+  };
+  std::vector<Container> containers;
 };
 
 namespace actions
@@ -30,61 +55,48 @@ namespace actions
   {
   };
 
+  using SislValue = boost::iterator_range<std::string_view::const_iterator>;
+
+  static std::string_view toStringView(const SislValue& value)
+  {
+    return {value.begin(), value.size()};
+  }
+
   //actions
   auto keyAction = [](auto& ctx) {
-    boost::spirit::x3::get<state_tag>(ctx).get().writer.Key(_attr(ctx).c_str());
+    auto& storage = boost::spirit::x3::get<state_tag>(ctx).get();
+    const auto key = toStringView(_attr(ctx));
+    auto& container = storage.containers.back();
+    if (container.isList)
+    {
+      if (!SislToolsInternal::isListElementName(key, container.memberCount++))
+      {
+        throw std::runtime_error("Invalid sisl, list elements must be named _0, _1, ...");
+      }
+      return;
+    }
+    storage.writer.Key(key.data(), static_cast<rapidjson::SizeType>(key.size()));
   };
 
   auto typeAction = [](auto& ctx) { boost::spirit::x3::get<state_tag>(ctx).get().rType = _attr(ctx); };
 
   auto valueAction = [](auto& ctx) {
-    if (boost::spirit::x3::get<state_tag>(ctx).get().rType == "str")
-    {
-      boost::spirit::x3::get<state_tag>(ctx).get().writer.String(_attr(ctx).c_str());
-    }
-
-    if (boost::spirit::x3::get<state_tag>(ctx).get().rType == "bool")
-    {
-      boost::spirit::x3::get<state_tag>(ctx).get().writer.Bool(std::string(_attr(ctx).c_str()) == std::string("true"));
-    }
-
-    if (boost::spirit::x3::get<state_tag>(ctx).get().rType == "uint")
-    {
-      boost::spirit::x3::get<state_tag>(ctx).get().writer.Uint(static_cast<unsigned int>(std::stoul(_attr(ctx).c_str())));
-    }
-
-    if (boost::spirit::x3::get<state_tag>(ctx).get().rType == "int")
-    {
-      boost::spirit::x3::get<state_tag>(ctx).get().writer.Int(static_cast<int>(std::stoul(_attr(ctx).c_str())));
-    }
-
-    if (boost::spirit::x3::get<state_tag>(ctx).get().rType == "uint64_t")
-    {
-      boost::spirit::x3::get<state_tag>(ctx).get().writer.Uint64(static_cast<uint64_t>(std::stoull(_attr(ctx).c_str())));
-    }
-
-    if (boost::spirit::x3::get<state_tag>(ctx).get().rType == "int64_t")
-    {
-      boost::spirit::x3::get<state_tag>(ctx).get().writer.Int64(static_cast<int64_t>(std::stoull(_attr(ctx).c_str())));
-    }
-
-    if (boost::spirit::x3::get<state_tag>(ctx).get().rType == "double")
-    {
-      boost::spirit::x3::get<state_tag>(ctx).get().writer.Double(static_cast<double>(std::stod(_attr(ctx).c_str())));
-    }
-
-    if (boost::spirit::x3::get<state_tag>(ctx).get().rType == "null")
-    {
-      boost::spirit::x3::get<state_tag>(ctx).get().writer.Null();
-    }
+    auto& storage = boost::spirit::x3::get<state_tag>(ctx).get();
+    SislToolsInternal::writeSislValue(storage.writer, storage.rType, toStringView(_attr(ctx)));
   };
 
   auto startObjectAction = [](auto& ctx) {
-    boost::spirit::x3::get<state_tag>(ctx).get().writer.StartObject();
+    auto& storage = boost::spirit::x3::get<state_tag>(ctx).get();
+    const bool isList = !storage.containers.empty() && storage.rType == SislToolsInternal::SislType::list;
+    storage.containers.push_back({isList, 0});
+    isList ? storage.writer.StartArray() : storage.writer.StartObject();
   };
 
   auto endObjectAction = [](auto& ctx) {
-    boost::spirit::x3::get<state_tag>(ctx).get().writer.EndObject();
+    auto& storage = boost::spirit::x3::get<state_tag>(ctx).get();
+    const bool isList = storage.containers.back().isList;
+    storage.containers.pop_back();
+    isList ? storage.writer.EndArray() : storage.writer.EndObject();
   };
 }
 
@@ -93,11 +105,26 @@ namespace parser
   using boost::spirit::x3::char_;
   using boost::spirit::x3::lexeme;
   using boost::spirit::x3::lit;
+  using boost::spirit::x3::raw;
+
+  static boost::spirit::x3::symbols<SislToolsInternal::SislType> makeSislTypes()
+  {
+    boost::spirit::x3::symbols<SislToolsInternal::SislType> types;
+    for (const auto& [name, type] : SislToolsInternal::sislTypeNames)
+    {
+      types.add(std::string(name), type);
+    }
+    return types;
+  }
+
+  const auto sislTypes = makeSislTypes();
 
   //element syntax
-  auto const name = lexeme[+(char_ - ':' - ',') >> ':'][actions::keyAction];
-  auto const type = lexeme['!' >> +(char_ - ' ') >> ' '][actions::typeAction];
-  auto const quoted_string = lexeme['"' >> *(char_ - '"') >> '"'][actions::valueAction];
+  // A name cannot start with '}', otherwise a member that fails to parse after its name has been written leaves a
+  // dangling key in the json writer when the parser backtracks to close the object.
+  auto const name = lexeme[raw[(char_ - ':' - ',' - '}') >> *(char_ - ':' - ',')] >> ':'][actions::keyAction];
+  auto const type = lexeme['!' >> sislTypes >> ' '][actions::typeAction];
+  auto const quoted_string = lexeme['"' >> raw[*(char_ - '"')] >> '"'][actions::valueAction];
 
   //rules
   boost::spirit::x3::rule<class sisl> sisl = "sisl";
@@ -110,20 +137,27 @@ namespace parser
   BOOST_SPIRIT_DEFINE(sisl_value, sisl)
 }
 
-std::string SislToolsInternal::parseSislToJson(std::string input)
+std::string SislToolsInternal::parseSislToJson(std::string_view input)
+{
+  std::string output;
+  parseSislToJson(input, output);
+  return output;
+}
+
+void SislToolsInternal::parseSislToJson(std::string_view input, std::string& output)
 {
-  if(input[0] != 0x7B)
+  output.clear();
+  if(input.empty() || input.front() != 0x7B)
   {
     spdlog::info("Invalid sisl, first character is not {");
     throw std::runtime_error("Invalid sisl, first character is not {");
   }
-  Storage storage;
+  Storage storage(output);
   auto parser = boost::spirit::x3::with<actions::state_tag>(std::ref(storage))[parser::sisl] >> boost::spirit::x3::eoi;
 
   using boost::spirit::x3::ascii::space;
-  if (phrase_parse(input.begin(), input.end(), parser, space))
+  if (!phrase_parse(input.begin(), input.end(), parser, space))
   {
-    return storage.s.GetString();
+    throw std::runtime_error("unable to convert to json");
   }
-  throw std::runtime_error("unable to convert to json");
 }
@@ -5,9 +5,11 @@
 #define ED_BOOSTSPIRIT_HPP
 
 #include <string>
+#include <string_view>
 
 namespace SislToolsInternal
 {
-std::string parseSislToJson(std::string input);
+std::string parseSislToJson(std::string_view input);
+void parseSislToJson(std::string_view input, std::string& output);
 }
 #endif //ED_BOOSTSPIRIT_HPP
@@ -80,3 +80,62 @@ TEST_CASE("SISL parsing. Can parse numerical types")
   REQUIRE(SislToolsInternal::parseSislToJson("{value: !uint64_t \"4294967296\"}") == "{\"value\":4294967296}");
   REQUIRE(SislToolsInternal::parseSislToJson("{value: !int64_t \"-2147483649\"}") =="{\"value\":-2147483649}");
 }
+
+TEST_CASE("SISL parsing. Unknown types are rejected")
+{
+  REQUIRE_THROWS_AS(SislToolsInternal::parseSislToJson(R"({value: !float "1.0"})"), std::runtime_error);
+  REQUIRE_THROWS_AS(SislToolsInternal::parseSislToJson(R"({value: !strx "1"})"), std::runtime_error);
+}
+
+TEST_CASE("SISL parsing. Obj type must hold an object")
+{
+  REQUIRE_THROWS_AS(SislToolsInternal::parseSislToJson(R"({value: !obj "1"})"), std::runtime_error);
+}
+
+TEST_CASE("SISL parsing. Invalid numbers are rejected")
+{
+  REQUIRE_THROWS_AS(SislToolsInternal::parseSislToJson(R"({value: !uint "abc"})"), std::runtime_error);
+  REQUIRE_THROWS_AS(SislToolsInternal::parseSislToJson(R"({value: !uint "-1"})"), std::runtime_error);
+  REQUIRE_THROWS_AS(SislToolsInternal::parseSislToJson(R"({value: !uint "4294967296"})"), std::runtime_error);
+  REQUIRE_THROWS_AS(SislToolsInternal::parseSislToJson(R"({value: !int "12a"})"), std::runtime_error);
+  REQUIRE_THROWS_AS(SislToolsInternal::parseSislToJson(R"({value: !double "x"})"), std::runtime_error);
+  REQUIRE_THROWS_AS(SislToolsInternal::parseSislToJson(R"({value: !double "1.5x"})"), std::runtime_error);
+  REQUIRE_THROWS_AS(SislToolsInternal::parseSislToJson(R"({value: !double "2.0 "})"), std::runtime_error);
+}
+
+TEST_CASE("SISL parsing. Numerical limits")
+{
+  REQUIRE(SislToolsInternal::parseSislToJson("{value: !uint \"4294967295\"}") == "{\"value\":4294967295}");
+  REQUIRE(SislToolsInternal::parseSislToJson("{value: !int \"-2147483648\"}") == "{\"value\":-2147483648}");
+  REQUIRE(SislToolsInternal::parseSislToJson("{value: !uint64_t \"18446744073709551615\"}") ==
+          "{\"value\":18446744073709551615}");
+  REQUIRE(SislToolsInternal::parseSislToJson("{value: !int64_t \"-9223372036854775808\"}") ==
+          "{\"value\":-9223372036854775808}");
+}
+
+TEST_CASE("SISL parsing. Lists become arrays")
+{
+  REQUIRE(
+    SislToolsInternal::parseSislToJson(R"({a: !list {_0: !uint "1",_1: !str "x",_2: !null ""},b: !bool "true"})") ==
+    R"({"a":[1,"x",null],"b":true})");
+  REQUIRE(SislToolsInternal::parseSislToJson(R"({empty: !list {}})") == R"({"empty":[]})");
+  REQUIRE(
+    SislToolsInternal::parseSislToJson(R"({m: !list {_0: !list {_0: !uint "1"},_1: !obj {k: !list {}}}})") ==
+    R"({"m":[[1],{"k":[]}]})");
+}
+
+TEST_CASE("SISL parsing. List elements must be named by position")
+{
+  REQUIRE_THROWS_AS(SislToolsInternal::parseSislToJson(R"({a: !list {_1: !uint "1"}})"), std::runtime_error);
+  REQUIRE_THROWS_AS(
+    SislToolsInternal::parseSislToJson(R"({a: !list {_0: !uint "1",_0: !uint "2"}})"), std::runtime_error);
+  REQUIRE_THROWS_AS(SislToolsInternal::parseSislToJson(R"({a: !list {_00: !uint "1"}})"), std::runtime_error);
+  REQUIRE_THROWS_AS(SislToolsInternal::parseSislToJson(R"({a: !list {x: !uint "1"}})"), std::runtime_error);
+  REQUIRE_THROWS_AS(SislToolsInternal::parseSislToJson(R"({a: !list "1"})"), std::runtime_error);
+}
+
+TEST_CASE("SISL parsing. Names cannot start with }")
+{
+  REQUIRE_THROWS_AS(SislToolsInternal::parseSislToJson(R"({o: !obj {a: !str "x"} b: !str x})"), std::runtime_error);
+  REQUIRE_THROWS_AS(SislToolsInternal::parseSislToJson(R"({}a: !str "x"})"), std::runtime_error);
+}
@@ -0,0 +1,134 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef ED_BUFFEREDSTREAMS_HPP
+#define ED_BUFFEREDSTREAMS_HPP
+
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include "rapidjson/rapidjson.h"
+
+namespace SislToolsInternal
+{
+  constexpr std::size_t streamChunkSizeInBytes = 64 * 1024;
+
+  // rapidjson input stream reading a std::istream one fixed size chunk at a time.
+  class BufferedInputStream
+  {
+  public:
+    typedef char Ch;
+
+    explicit BufferedInputStream(std::istream& input):
+      input(input),
+      buffer(streamChunkSizeInBytes)
+    {
+    }
+
+    bool atEnd()
+    {
+      return current == end && !refill();
+    }
+
+    Ch Peek()
+    {
+      return atEnd() ? '\0' : *current;
+    }
+
+    Ch Take()
+    {
+      return atEnd() ? '\0' : *current++;
+    }
+
+    size_t Tell() const
+    {
+      return bytesBeforeBuffer + static_cast<size_t>(current - buffer.data());
+    }
+
+    // Only used by insitu parsing, which a std::istream cannot support.
+    Ch* PutBegin() { RAPIDJSON_ASSERT(false); return nullptr; }
+    void Put(Ch) { RAPIDJSON_ASSERT(false); }
+    void Flush() { RAPIDJSON_ASSERT(false); }
+    size_t PutEnd(Ch*) { RAPIDJSON_ASSERT(false); return 0; }
+
+  private:
+    bool refill()
+    {
+      bytesBeforeBuffer += static_cast<size_t>(end - buffer.data());
+      input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      current = buffer.data();
+      end = current + input.gcount();
+      return current != end;
+    }
+
+    std::istream& input;
+    std::vector<char> buffer;
+    const char* current = buffer.data();
+    const char* end = buffer.data();
+    size_t bytesBeforeBuffer = 0;
+  };
+
+  // rapidjson output stream writing to a std::ostream one fixed size chunk at a time.
+  class BufferedOutputStream
+  {
+  public:
+    typedef char Ch;
+
+    explicit BufferedOutputStream(std::ostream& output):
+      output(output),
+      buffer(streamChunkSizeInBytes)
+    {
+    }
+
+    void Put(Ch c)
+    {
+      if (used == buffer.size())
+      {
+        Flush();
+      }
+      buffer[used++] = c;
+    }
+
+    void push_back(Ch c)
+    {
+      Put(c);
+    }
+
+    BufferedOutputStream& append(const Ch* data, size_t length)
+    {
+      while (length > 0)
+      {
+        if (used == buffer.size())
+        {
+          Flush();
+        }
+        const auto chunk = std::min(length, buffer.size() - used);
+        std::memcpy(buffer.data() + used, data, chunk);
+        used += chunk;
+        data += chunk;
+        length -= chunk;
+      }
+      return *this;
+    }
+
+    BufferedOutputStream& append(const Ch* data)
+    {
+      return append(data, std::strlen(data));
+    }
+
+    void Flush()
+    {
+      output.write(buffer.data(), static_cast<std::streamsize>(used));
+      used = 0;
+    }
+
+  private:
+    std::ostream& output;
+    std::vector<char> buffer;
+    size_t used = 0;
+  };
+}
+
+#endif //ED_BUFFEREDSTREAMS_HPP
@@ -2,50 +2,135 @@
 // MIT License. For licence terms see LICENCE.md file.
 
 #include "rapidjson/reader.h"
-#include <sstream>
-#include <iostream>
+#include "rapidjson/memorystream.h"
+#include <charconv>
+#include <cstdio>
+#include <vector>
+#include "BufferedStreams.hpp"
 #include "RapidJsonSislConverter.hpp"
 
 using namespace rapidjson;
 using namespace std;
 
-struct MyHandler : public BaseReaderHandler<UTF8<>, MyHandler> {
-
-  explicit MyHandler(std::stringstream& stream):
-    stream(stream), nesting_depth(0) {}
-
-  std::stringstream& stream;
-  std::uint64_t nesting_depth;
-
-  bool Null() { stream << "!null \"\","; return true; }
-  bool Bool(bool b) { stream << "!bool \"" << boolalpha << b << "\","; return true; }
-  bool Int(int i) { stream << "!int \"" << i << "\","; return true; }
-  bool Uint(unsigned u) { stream << "!uint \"" << u << "\","; return true; }
-  bool Int64(int64_t i) { stream << "!int64_t \"" << i << "\","; return true; }
-  bool Uint64(uint64_t u) { stream << "!uint64_t \"" << u << "\","; return true; }
-  bool Double(double d) { stream << "!double \"" << d << "\","; return true; }
-  bool String(const char* str, SizeType, bool) { stream << "!str \"" << str << "\"," ; return true;}
-  bool StartObject() { if (nesting_depth++ == 0) {stream << '{';} else {stream << "!obj {";} return true; }
-  bool Key(const char* str, SizeType, bool) { stream << str << ": "; return true;}
-  bool EndObject(SizeType memberCount) {
-    if (memberCount > 0) stream.seekp(-1, std::ios_base::end);
-    stream << "}";
-    nesting_depth--;
-    if (nesting_depth > 0) {
-      stream << ",";
+template <typename Output>
+struct MyHandler : public BaseReaderHandler<UTF8<>, MyHandler<Output>> {
+
+  explicit MyHandler(Output& output):
+    output(output) {}
+
+  Output& output;
+
+  bool Null() { if (!startValue()) return false; output.append("!null \"\""); return true; }
+  bool Bool(bool b) { if (!startValue()) return false; output.append(b ? "!bool \"true\"" : "!bool \"false\""); return true; }
+  bool Int(int i) { return startValue() && appendInteger("!int \"", i); }
+  bool Uint(unsigned u) { return startValue() && appendInteger("!uint \"", u); }
+  bool Int64(int64_t i) { return startValue() && appendInteger("!int64_t \"", i); }
+  bool Uint64(uint64_t u) { return startValue() && appendInteger("!uint64_t \"", u); }
+  bool Double(double d)
+  {
+    if (!startValue()) return false;
+    // Same digits as the default std::ostream formatting; GCC 9 has no floating point std::to_chars.
+    char digits[32];
+    const auto length = std::snprintf(digits, sizeof(digits), "%g", d);
+    output.append("!double \"").append(digits, static_cast<size_t>(length)).append("\"");
+    return true;
+  }
+  bool String(const char* str, SizeType, bool)
+  {
+    if (!startValue()) return false;
+    output.append("!str \"").append(str).append("\"");
+    return true;
+  }
+  bool StartObject()
+  {
+    if (!containers.empty())
+    {
+      if (!startValue()) return false;
+      output.append("!obj ");
     }
+    output.push_back('{');
+    containers.push_back({false, 0});
     return true;
   }
-  bool StartArray() { return false; }
-  bool EndArray(SizeType elementCount) { cout << "EndArray(" << elementCount << ")" << endl; return true; }
+  bool Key(const char* str, SizeType, bool) { separateMember(); output.append(str).append(": "); return true;}
+  bool EndObject(SizeType) { containers.pop_back(); output.push_back('}'); return true; }
+  bool StartArray()
+  {
+    if (!startValue()) return false;
+    output.append("!list {");
+    containers.push_back({true, 0});
+    return true;
+  }
+  bool EndArray(SizeType) { containers.pop_back(); output.push_back('}'); return true; }
+
+private:
+  struct Container
+  {
+    bool isArray;
+    std::uint64_t memberCount;
+  };
+
+  void separateMember()
+  {
+    if (containers.back().memberCount++ > 0) output.push_back(',');
+  }
+
+  // SISL documents are objects, so a value is only valid inside one. Array elements are named _0, _1, ...
+  bool startValue()
+  {
+    if (containers.empty()) return false;
+    if (containers.back().isArray)
+    {
+      separateMember();
+      output.push_back('_');
+      appendDigits(containers.back().memberCount - 1);
+      output.append(": ");
+    }
+    return true;
+  }
+
+  template <typename Integer>
+  void appendDigits(Integer value)
+  {
+    char digits[24];
+    const auto result = std::to_chars(std::begin(digits), std::end(digits), value);
+    output.append(digits, static_cast<size_t>(result.ptr - digits));
+  }
+
+  template <typename Integer>
+  bool appendInteger(const char* typePrefix, Integer value)
+  {
+    output.append(typePrefix);
+    appendDigits(value);
+    output.append("\"");
+    return true;
+  }
+
+  std::vector<Container> containers;
 };
 
-std::string SislToolsInternal::parseJsonToSisl(std::string json)
+std::string SislToolsInternal::parseJsonToSisl(std::string_view json)
+{
+  std::string output;
+  parseJsonToSisl(json, output);
+  return output;
+}
+
+void SislToolsInternal::parseJsonToSisl(std::string_view json, std::string& output)
+{
+  output.clear();
+  MyHandler<std::string> handler(output);
+  Reader reader;
+  MemoryStream ms(json.data(), json.size());
+  if (!reader.Parse(ms, handler)) throw std::runtime_error("unable to parse");
+}
+
+void SislToolsInternal::streamJsonToSisl(std::istream& json, std::ostream& sisl)
 {
-  std::stringstream output;
-  MyHandler handler(output);
+  BufferedInputStream input(json);
+  BufferedOutputStream output(sisl);
+  MyHandler<BufferedOutputStream> handler(output);
   Reader reader;
-  StringStream ss(json.data());
-  if (!reader.Parse(ss, handler)) throw std::runtime_error("unable to parse");
-  return output.str();
+  if (!reader.Parse(input, handler)) throw std::runtime_error("unable to parse");
+  output.Flush();
 }
@@ -4,10 +4,15 @@
 #ifndef ED_RAPIDJSONSISLCONVERTER_HPP
 #define ED_RAPIDJSONSISLCONVERTER_HPP
 
+#include <istream>
+#include <ostream>
 #include <string>
+#include <string_view>
 
 namespace SislToolsInternal
 {
-std::string parseJsonToSisl(std::string json);
+std::string parseJsonToSisl(std::string_view json);
+void parseJsonToSisl(std::string_view json, std::string& output);
+void streamJsonToSisl(std::istream& json, std::ostream& sisl);
 }
 #endif //ED_RAPIDJSONSISLCONVERTER_HPP
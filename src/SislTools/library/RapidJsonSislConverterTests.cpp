@@ -2,11 +2,31 @@
 // MIT License. For licence terms see LICENCE.md file.
 
 #include "RapidJsonSislConverter.hpp"
+#include <sstream>
 #include <test/catch.hpp>
 
-TEST_CASE("Json parsing. Arrays not supported")
+TEST_CASE("Json parsing. Arrays become lists of elements named by position")
 {
-  REQUIRE_THROWS_AS(SislToolsInternal::parseJsonToSisl("{ \"hello\" : [1,2,3]}"), std::runtime_error);
+  REQUIRE(
+    SislToolsInternal::parseJsonToSisl("{ \"hello\" : [1,2,3]}") ==
+    "{hello: !list {_0: !uint \"1\",_1: !uint \"2\",_2: !uint \"3\"}}");
+  REQUIRE(
+    SislToolsInternal::parseJsonToSisl("{ \"a\" : [1, \"x\", null], \"b\" : true}") ==
+    "{a: !list {_0: !uint \"1\",_1: !str \"x\",_2: !null \"\"},b: !bool \"true\"}");
+  REQUIRE(SislToolsInternal::parseJsonToSisl("{ \"empty\" : []}") == "{empty: !list {}}");
+}
+
+TEST_CASE("Json parsing. Nested arrays and objects")
+{
+  REQUIRE(
+    SislToolsInternal::parseJsonToSisl("{\"m\":[[1],{\"k\":[]}]}") ==
+    "{m: !list {_0: !list {_0: !uint \"1\"},_1: !obj {k: !list {}}}}");
+}
+
+TEST_CASE("Json parsing. Document root must be an object")
+{
+  REQUIRE_THROWS_AS(SislToolsInternal::parseJsonToSisl("[1,2,3]"), std::runtime_error);
+  REQUIRE_THROWS_AS(SislToolsInternal::parseJsonToSisl("1"), std::runtime_error);
 }
 
 TEST_CASE("Json parsing. Nested Groups")
@@ -68,3 +88,32 @@ TEST_CASE("Json parsing. Create appropriate sisl type")
               "buildable: !bool \"false\""
               "}");
 }
+
+TEST_CASE("Json parsing. Numerical limits")
+{
+  REQUIRE(SislToolsInternal::parseJsonToSisl("{\"value\" : 4294967295}") == "{value: !uint \"4294967295\"}");
+  REQUIRE(SislToolsInternal::parseJsonToSisl("{\"value\" : -2147483648}") == "{value: !int \"-2147483648\"}");
+  REQUIRE(
+    SislToolsInternal::parseJsonToSisl("{\"value\" : 18446744073709551615}") ==
+    "{value: !uint64_t \"18446744073709551615\"}");
+  REQUIRE(
+    SislToolsInternal::parseJsonToSisl("{\"value\" : -9223372036854775808}") ==
+    "{value: !int64_t \"-9223372036854775808\"}");
+  REQUIRE(SislToolsInternal::parseJsonToSisl("{\"value\" : 1.5e300}") == "{value: !double \"1.5e+300\"}");
+}
+
+TEST_CASE("Json parsing. Streaming conversion matches the in memory conversion")
+{
+  const std::string json = R"({"files":[{"name":"a.txt","size":10},{"name":"b.txt","size":20}],"count":2})";
+  std::istringstream input(json);
+  std::ostringstream output;
+  SislToolsInternal::streamJsonToSisl(input, output);
+  REQUIRE(output.str() == SislToolsInternal::parseJsonToSisl(json));
+}
+
+TEST_CASE("Json parsing. Streaming conversion errors")
+{
+  std::istringstream input("{\"a\":[1,2");
+  std::ostringstream output;
+  REQUIRE_THROWS_AS(SislToolsInternal::streamJsonToSisl(input, output), std::runtime_error);
+}
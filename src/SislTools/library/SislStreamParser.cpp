@@ -0,0 +1,211 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "rapidjson/writer.h"
+#include <cctype>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "BufferedStreams.hpp"
+#include "SislStreamParser.hpp"
+#include "SislTypes.hpp"
+
+namespace
+{
+  // Hand written equivalent of the Spirit grammar in BoostSpiritSislParser.cpp. Nesting is tracked on an explicit
+  // stack rather than by recursion, so deeply nested documents cannot exhaust the call stack.
+  class SislStreamReader
+  {
+  public:
+    SislStreamReader(std::istream& sisl, std::ostream& json):
+      input(sisl),
+      output(json),
+      writer(output)
+    {
+    }
+
+    void parse()
+    {
+      if (input.atEnd() || input.Take() != '{')
+      {
+        throw std::runtime_error("Invalid sisl, first character is not {");
+      }
+      openContainer(false);
+
+      auto memberRequired = false;
+      while (!containers.empty())
+      {
+        skipWhitespace();
+        if (!memberRequired && input.Peek() == '}')
+        {
+          input.Take();
+          closeContainer();
+        }
+        else if (!memberRequired && containers.back().memberCount > 0 && input.Peek() == ',')
+        {
+          input.Take();
+          memberRequired = true;
+        }
+        else
+        {
+          readMember();
+          memberRequired = false;
+        }
+      }
+
+      skipWhitespace();
+      if (!input.atEnd())
+      {
+        throw std::runtime_error("Invalid sisl, unexpected data after the closing }");
+      }
+      output.Flush();
+    }
+
+  private:
+    struct Container
+    {
+      bool isList;
+      std::uint64_t memberCount;
+    };
+
+    void readMember()
+    {
+      readName();
+      auto& container = containers.back();
+      if (container.isList)
+      {
+        if (!SislToolsInternal::isListElementName(token, container.memberCount))
+        {
+          throw std::runtime_error("Invalid sisl, list elements must be named _0, _1, ...");
+        }
+      }
+      else
+      {
+        writer.Key(token.data(), static_cast<rapidjson::SizeType>(token.size()));
+      }
+      ++container.memberCount;
+
+      skipWhitespace();
+      const auto type = readType();
+
+      skipWhitespace();
+      if (input.atEnd())
+      {
+        throw std::runtime_error("Invalid sisl, missing value");
+      }
+      const auto c = input.Take();
+      if (c == '"')
+      {
+        readQuotedValue();
+        SislToolsInternal::writeSislValue(writer, type, token);
+      }
+      else if (c == '{')
+      {
+        openContainer(type == SislToolsInternal::SislType::list);
+      }
+      else
+      {
+        throw std::runtime_error("Invalid sisl, value must be quoted or an object");
+      }
+    }
+
+    void readName()
+    {
+      token.clear();
+      for (;;)
+      {
+        if (input.atEnd())
+        {
+          throw std::runtime_error("Invalid sisl, unterminated name");
+        }
+        const auto c = input.Take();
+        if (c == ':')
+        {
+          break;
+        }
+        if (c == ',')
+        {
+          throw std::runtime_error("Invalid sisl, name contains ,");
+        }
+        token.push_back(c);
+      }
+      if (token.empty())
+      {
+        throw std::runtime_error("Invalid sisl, empty name");
+      }
+    }
+
+    SislToolsInternal::SislType readType()
+    {
+      if (input.atEnd() || input.Take() != '!')
+      {
+        throw std::runtime_error("Invalid sisl, missing type");
+      }
+      token.clear();
+      while (!input.atEnd() && input.Peek() != ' ' && token.size() < maxTypeNameLength)
+      {
+        token.push_back(input.Take());
+      }
+      const auto type = SislToolsInternal::findSislType(token);
+      if (!type || input.atEnd() || input.Take() != ' ')
+      {
+        throw std::runtime_error("Invalid sisl, unknown type");
+      }
+      return *type;
+    }
+
+    void readQuotedValue()
+    {
+      token.clear();
+      for (;;)
+      {
+        if (input.atEnd())
+        {
+          throw std::runtime_error("Invalid sisl, unterminated value");
+        }
+        const auto c = input.Take();
+        if (c == '"')
+        {
+          return;
+        }
+        token.push_back(c);
+      }
+    }
+
+    void openContainer(bool isList)
+    {
+      containers.push_back({isList, 0});
+      isList ? writer.StartArray() : writer.StartObject();
+    }
+
+    void closeContainer()
+    {
+      const auto isList = containers.back().isList;
+      containers.pop_back();
+      isList ? writer.EndArray() : writer.EndObject();
+    }
+
+    void skipWhitespace()
+    {
+      while (!input.atEnd() && std::isspace(static_cast<unsigned char>(input.Peek())))
+      {
+        input.Take();
+      }
+    }
+
+    static constexpr std::size_t maxTypeNameLength = 16;
+
+    SislToolsInternal::BufferedInputStream input;
+    SislToolsInternal::BufferedOutputStream output;
+    rapidjson::Writer<SislToolsInternal::BufferedOutputStream> writer;
+    std::vector<Container> containers;
+    std::string token;
+  };
+}
+
+void SislToolsInternal::streamSislToJson(std::istream& sisl, std::ostream& json)
+{
+  SislStreamReader reader(sisl, json);
+  reader.parse();
+}
@@ -0,0 +1,16 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef ED_SISLSTREAMPARSER_HPP
+#define ED_SISLSTREAMPARSER_HPP
+
+#include <istream>
+#include <ostream>
+
+namespace SislToolsInternal
+{
+// Accepts the same documents as parseSislToJson, reading and writing in fixed size chunks so memory use does not
+// grow with the document. Json is written as it is parsed, so after an error the output holds a partial document.
+void streamSislToJson(std::istream& sisl, std::ostream& json);
+}
+#endif //ED_SISLSTREAMPARSER_HPP
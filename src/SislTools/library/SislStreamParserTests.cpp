@@ -0,0 +1,80 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "BoostSpiritSislParser.hpp"
+#include "SislStreamParser.hpp"
+#include <sstream>
+#include <test/catch.hpp>
+
+namespace
+{
+  std::string streamSislToJson(const std::string& sisl)
+  {
+    std::istringstream input(sisl);
+    std::ostringstream output;
+    SislToolsInternal::streamSislToJson(input, output);
+    return output.str();
+  }
+}
+
+TEST_CASE("SISL stream parsing. Produces the same json as the in memory parser")
+{
+  const auto sisl = GENERATE(
+    std::string("{}"),
+    std::string("{} \n"),
+    std::string(R"({name: !str "donald"})"),
+    std::string(R"({ field: !str "h", field2: !uint "2"})"),
+    std::string(R"({field: !str "h" field2: !uint "2"})"),
+    std::string(R"({value: !double "0.123412", flag: !bool "false", nothing: !null ""})"),
+    std::string(R"({value: !int64_t "-9223372036854775808", other: !uint64_t "18446744073709551615"})"),
+    std::string(R"({name: !obj {another: !obj {key: !str "value", dif: !uint "1"}, friend: !bool "true"}})"),
+    std::string(R"({a: !list {_0: !uint "1",_1: !str "x",_2: !null ""},b: !bool "true"})"),
+    std::string(R"({m: !list {_0: !list {_0: !uint "1"},_1: !obj {k: !list {}}}})"),
+    std::string("{\n  spaced key : !str \"with spaces\",\n\tother: !str \"\"\n}"));
+  REQUIRE(streamSislToJson(sisl) == SislToolsInternal::parseSislToJson(sisl));
+}
+
+TEST_CASE("SISL stream parsing. Rejects the documents the in memory parser rejects")
+{
+  const auto sisl = GENERATE(
+    std::string(""),
+    std::string(" {}"),
+    std::string("{"),
+    std::string("{}}"),
+    std::string("{} x"),
+    std::string(R"({value: !str "x",})"),
+    std::string(R"({, value: !str "x"})"),
+    std::string(R"({value: !str "x"},)"),
+    std::string(R"({value: !float "1.0"})"),
+    std::string(R"({value: !str"x"})"),
+    std::string(R"({value: !obj "1"})"),
+    std::string(R"({value: !uint "abc"})"),
+    std::string(R"({value: !str "unterminated})"),
+    std::string(R"({va,lue: !str "x"})"),
+    std::string(R"({a: !list {_1: !uint "1"}})"),
+    std::string(R"({a: !list "1"})"));
+  REQUIRE_THROWS_AS(SislToolsInternal::parseSislToJson(sisl), std::runtime_error);
+  REQUIRE_THROWS_AS(streamSislToJson(sisl), std::runtime_error);
+}
+
+TEST_CASE("SISL stream parsing. Values spanning the read chunk boundary")
+{
+  const std::string longValue(200000, 'x');
+  const auto sisl = "{first: !str \"" + longValue + "\", second: !list {_0: !str \"" + longValue + "\"}}";
+  REQUIRE(streamSislToJson(sisl) == R"({"first":")" + longValue + R"(","second":[")" + longValue + R"("]})");
+}
+
+TEST_CASE("SISL stream parsing. Deep nesting does not recurse")
+{
+  const auto depth = 100000;
+  std::string sisl = "{";
+  std::string json = "{";
+  for (auto i = 0; i < depth; ++i)
+  {
+    sisl += "a: !obj {";
+    json += "\"a\":{";
+  }
+  sisl += std::string(depth + 1, '}');
+  json += std::string(depth + 1, '}');
+  REQUIRE(streamSislToJson(sisl) == json);
+}
@@ -0,0 +1,133 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef ED_SISLTYPES_HPP
+#define ED_SISLTYPES_HPP
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "rapidjson/rapidjson.h"
+
+namespace SislToolsInternal
+{
+  enum class SislType
+  {
+    str,
+    boolean,
+    uint,
+    int32,
+    uint64,
+    int64,
+    floatingPoint,
+    null,
+    obj,
+    list
+  };
+
+  constexpr std::array<std::pair<std::string_view, SislType>, 10> sislTypeNames{{
+    {"str", SislType::str},
+    {"bool", SislType::boolean},
+    {"uint", SislType::uint},
+    {"int", SislType::int32},
+    {"uint64_t", SislType::uint64},
+    {"int64_t", SislType::int64},
+    {"double", SislType::floatingPoint},
+    {"null", SislType::null},
+    {"obj", SislType::obj},
+    {"list", SislType::list}}};
+
+  inline std::optional<SislType> findSislType(std::string_view name)
+  {
+    for (const auto& [typeName, type] : sislTypeNames)
+    {
+      if (typeName == name)
+      {
+        return type;
+      }
+    }
+    return std::nullopt;
+  }
+
+  // Elements of a !list are named by their position: _0, _1, ...
+  inline bool isListElementName(std::string_view name, std::uint64_t index)
+  {
+    if (name.size() < 2 || name.front() != '_')
+    {
+      return false;
+    }
+    std::uint64_t parsedIndex{};
+    const auto result = std::from_chars(name.data() + 1, name.data() + name.size(), parsedIndex);
+    return result.ec == std::errc() && result.ptr == name.data() + name.size() && parsedIndex == index &&
+           (name.size() == 2 || name.at(1) != '0');
+  }
+
+  template <typename Number>
+  Number parseSislNumber(std::string_view value)
+  {
+    Number number{};
+    const auto result = std::from_chars(value.data(), value.data() + value.size(), number);
+    if (result.ec != std::errc() || result.ptr != value.data() + value.size())
+    {
+      throw std::runtime_error("Invalid sisl number");
+    }
+    return number;
+  }
+
+  // value must be followed in memory by a character that cannot continue a number, such as the closing quote
+  // or a string terminator, as strtod reads up to the first character it cannot convert.
+  inline double parseSislDouble(std::string_view value)
+  {
+    char* end = nullptr;
+    const auto number = std::strtod(value.data(), &end);
+    if (end == value.data() || end != value.data() + value.size())
+    {
+      throw std::runtime_error("Invalid sisl double");
+    }
+    return number;
+  }
+
+  template <typename Writer>
+  void writeSislValue(Writer& writer, SislType type, std::string_view value)
+  {
+    switch (type)
+    {
+      case SislType::str:
+        writer.String(value.data(), static_cast<rapidjson::SizeType>(value.size()));
+        break;
+      case SislType::boolean:
+        writer.Bool(value == "true");
+        break;
+      case SislType::uint:
+        writer.Uint(parseSislNumber<unsigned int>(value));
+        break;
+      case SislType::int32:
+        writer.Int(parseSislNumber<int>(value));
+        break;
+      case SislType::uint64:
+        writer.Uint64(parseSislNumber<std::uint64_t>(value));
+        break;
+      case SislType::int64:
+        writer.Int64(parseSislNumber<std::int64_t>(value));
+        break;
+      case SislType::floatingPoint:
+        writer.Double(parseSislDouble(value));
+        break;
+      case SislType::null:
+        writer.Null();
+        break;
+      case SislType::obj:
+      case SislType::list:
+      default:
+        throw std::runtime_error("Invalid sisl, obj and list types must hold an object");
+    }
+  }
+}
+
+#endif //ED_SISLTYPES_HPP
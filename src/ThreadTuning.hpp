@@ -0,0 +1,175 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef THREADTUNING_HPP
+#define THREADTUNING_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+
+// Placement of the network, reader and writer threads, to keep the scheduler from moving them between cores
+// mid-transfer, which shows up as bursty pacing on the client and drops on the server.
+namespace ThreadTuning
+{
+  struct ThreadSettings
+  {
+    // Cores the thread may run on; empty leaves it to the scheduler.
+    std::vector<unsigned int> cpus;
+    // SCHED_FIFO priority from 1 to 99; 0 keeps the normal scheduling policy.
+    int realtimePriority;
+  };
+
+  // Parses a list of cores in the kernel's cpulist format, e.g. "0-3,8".
+  inline std::vector<unsigned int> parseCpuList(std::string_view list)
+  {
+    const auto parseNumber = [list](std::string_view number) {
+      unsigned int value{};
+      const auto result = std::from_chars(number.data(), number.data() + number.size(), value);
+      if (number.empty() || result.ec != std::errc() || result.ptr != number.data() + number.size() ||
+          value >= CPU_SETSIZE)
+      {
+        throw std::runtime_error("Invalid cpu list: " + std::string(list));
+      }
+      return value;
+    };
+
+    std::vector<unsigned int> cpus;
+    while (!list.empty() && list.back() == '\n')
+    {
+      list.remove_suffix(1);
+    }
+    for (std::size_t begin = 0, end = 0; end < list.size(); begin = end + 1)
+    {
+      end = std::min(list.find(',', begin), list.size());
+      const auto range = list.substr(begin, end - begin);
+      const auto dash = range.find('-');
+      const auto first = parseNumber(range.substr(0, dash));
+      const auto last = dash == std::string_view::npos ? first : parseNumber(range.substr(dash + 1));
+      if (last < first)
+      {
+        throw std::runtime_error("Invalid cpu list: " + std::string(list));
+      }
+      for (auto cpu = first; cpu <= last; ++cpu)
+      {
+        cpus.push_back(cpu);
+      }
+    }
+    return cpus;
+  }
+
+  inline std::vector<unsigned int> numaNodeCpus(unsigned int node)
+  {
+    std::ifstream cpuList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string list;
+    if (!std::getline(cpuList, list))
+    {
+      throw std::runtime_error("Unknown NUMA node " + std::to_string(node));
+    }
+    return parseCpuList(list);
+  }
+
+  // The cores from cpuList if given, otherwise those of numaNode if given, otherwise none.
+  inline ThreadSettings threadSettings(
+    const std::string& cpuList, std::optional<unsigned int> numaNode, int realtimePriority)
+  {
+    if (realtimePriority < 0 || realtimePriority > 99)
+    {
+      throw std::runtime_error("Real-time priority must be between 1 and 99");
+    }
+    if (!cpuList.empty())
+    {
+      return {parseCpuList(cpuList), realtimePriority};
+    }
+    if (numaNode)
+    {
+      return {numaNodeCpus(*numaNode), realtimePriority};
+    }
+    return {{}, realtimePriority};
+  }
+
+  // The cores and scheduling of the process before any thread was tuned. A new thread inherits the placement of the
+  // thread that creates it, so threads started from a tuned one are put back to this rather than sharing its cores
+  // and real-time priority.
+  struct OriginalPlacement
+  {
+    cpu_set_t cpus;
+    int policy;
+    sched_param parameters;
+  };
+
+  // Read on the first call, which applyToCurrentThread makes before it changes anything.
+  inline const OriginalPlacement& originalPlacement()
+  {
+    static const OriginalPlacement placement = []() {
+      OriginalPlacement original{};
+      CPU_ZERO(&original.cpus);
+      pthread_getaffinity_np(pthread_self(), sizeof(original.cpus), &original.cpus);
+      pthread_getschedparam(pthread_self(), &original.policy, &original.parameters);
+      return original;
+    }();
+    return placement;
+  }
+
+  // Settings left empty put the thread back to the process's original placement, rather than leaving it with
+  // whatever it inherited.
+  inline void applyToCurrentThread(const ThreadSettings& settings)
+  {
+    const auto& original = originalPlacement();
+    if (settings.cpus.empty())
+    {
+      if (CPU_COUNT(&original.cpus) != 0)
+      {
+        pthread_setaffinity_np(pthread_self(), sizeof(original.cpus), &original.cpus);
+      }
+    }
+    else
+    {
+      cpu_set_t cpuSet;
+      CPU_ZERO(&cpuSet);
+      for (const auto cpu : settings.cpus)
+      {
+        CPU_SET(cpu, &cpuSet);
+      }
+      if (const auto error = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet); error != 0)
+      {
+        throw std::runtime_error(std::string("Unable to set thread affinity: ") + std::strerror(error));
+      }
+    }
+    if (settings.realtimePriority > 0)
+    {
+      sched_param parameters{};
+      parameters.sched_priority = settings.realtimePriority;
+      if (const auto error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters); error != 0)
+      {
+        throw std::runtime_error(std::string("Unable to set SCHED_FIFO: ") + std::strerror(error));
+      }
+    }
+    else
+    {
+      pthread_setschedparam(pthread_self(), original.policy, &original.parameters);
+    }
+  }
+
+  // Polls the device queue for up to microseconds on a receive instead of waiting for the interrupt. The asio
+  // event loop waits in epoll, which only busy polls if the net.core.busy_poll sysctl is set as well.
+  inline void enableBusyPoll(int socket, int microseconds)
+  {
+    if (microseconds > 0 && setsockopt(socket, SOL_SOCKET, SO_BUSY_POLL, &microseconds, sizeof(microseconds)) != 0)
+    {
+      throw std::runtime_error(std::string("Unable to set SO_BUSY_POLL: ") + std::strerror(errno));
+    }
+  }
+}
+
+#endif //THREADTUNING_HPP
@@ -0,0 +1,111 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "AdaptivePacing.hpp"
+#include <algorithm>
+#include <thread>
+#include "spdlog/spdlog.h"
+
+namespace
+{
+  constexpr double increaseFactor = 1.05;
+  constexpr double decreaseFactor = 0.8;
+  constexpr double steadyRateWeight = 0.05;
+  constexpr auto controlInterval = std::chrono::milliseconds(1);
+  // Sleeping overshoots, so the last part of a wait is spent spinning.
+  constexpr auto spinTime = std::chrono::microseconds(20);
+}
+
+void AdaptiveRate::update(const LocalQueueState& queue, double achievedRateMbps)
+{
+  const auto stalled = queue.sendStalls > lastSendStalls;
+  lastSendStalls = queue.sendStalls;
+  const auto congested = queue.queueCapacity != 0 && queue.queuedBytes * 2 > queue.queueCapacity;
+  const auto draining = queue.queueCapacity == 0 || queue.queuedBytes * 4 < queue.queueCapacity;
+
+  if (stalled || congested)
+  {
+    rate = std::max(minRateMbps, rate * decreaseFactor);
+    ++backoffCount;
+  }
+  else if (draining)
+  {
+    // Never more than twice what was actually sent, so the rate does not run away while the sender cannot keep up.
+    rate = std::min({maxRateMbps, rate * increaseFactor, std::max(initialRateMbps, achievedRateMbps * 2)});
+  }
+
+  steadyRate = measured ? steadyRate + steadyRateWeight * (achievedRateMbps - steadyRate) : achievedRateMbps;
+  measured = true;
+}
+
+double AdaptiveRate::rateMbps() const
+{
+  return rate;
+}
+
+double AdaptiveRate::steadyRateMbps() const
+{
+  return steadyRate;
+}
+
+std::uint64_t AdaptiveRate::backoffs() const
+{
+  return backoffCount;
+}
+
+AdaptiveTimer::AdaptiveTimer(std::shared_ptr<UdpClientInterface> udpClient, std::uint32_t packetSizeBytes):
+  udpClient(std::move(udpClient)),
+  packetSizeBytes(packetSizeBytes)
+{
+}
+
+void AdaptiveTimer::runTimer(std::function<bool()> callback)
+{
+  tickCallback = callback;
+  auto intervalStart = Clock::now();
+  auto nextSend = intervalStart;
+  std::uint64_t packetsSent = 0;
+  while (true)
+  {
+    waitUntil(nextSend);
+    if (!callback())
+    {
+      break;
+    }
+    ++packetsSent;
+
+    const auto now = Clock::now();
+    nextSend = std::max(nextSend + period(), now);
+    if (now - intervalStart >= controlInterval)
+    {
+      const std::chrono::duration<double> elapsed = now - intervalStart;
+      const auto bitsSent = static_cast<double>(packetsSent) * packetSizeBytes * 8;
+      rate.update(udpClient->localQueueState(), bitsSent / elapsed.count() / (1024 * 1024));
+      intervalStart = now;
+      packetsSent = 0;
+    }
+  }
+  spdlog::debug("Adaptive pacing: {:.0f} Mbps steady, {} back offs", rate.steadyRateMbps(), rate.backoffs());
+}
+
+double AdaptiveTimer::steadyRateMbps() const
+{
+  return rate.steadyRateMbps();
+}
+
+AdaptiveTimer::Clock::duration AdaptiveTimer::period() const
+{
+  const std::chrono::duration<double> seconds(packetSizeBytes * 8 / (rate.rateMbps() * 1024 * 1024));
+  return std::chrono::duration_cast<Clock::duration>(seconds);
+}
+
+void AdaptiveTimer::waitUntil(Clock::time_point time)
+{
+  if (time - Clock::now() > spinTime)
+  {
+    std::this_thread::sleep_until(time - spinTime);
+  }
+  while (Clock::now() < time)
+  {
+  }
+}
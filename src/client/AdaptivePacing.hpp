@@ -0,0 +1,60 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef ADAPTIVEPACING_HPP
+#define ADAPTIVEPACING_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include "TimerInterface.hpp"
+#include "UdpClientInterface.hpp"
+
+// Finds the fastest rate the local path to the diode carries without loss. The rate grows while the socket's
+// send queue stays short and is cut back as soon as it fills past half, a send stalls on a full queue or the
+// queueing discipline refuses a datagram.
+class AdaptiveRate
+{
+public:
+  static constexpr double initialRateMbps = 1000;
+  static constexpr double minRateMbps = 1;
+  static constexpr double maxRateMbps = 100000;
+
+  // Called once a control interval with the send queue as it is now and the rate actually sent over the interval.
+  void update(const LocalQueueState& queue, double achievedRateMbps);
+
+  [[nodiscard]] double rateMbps() const;
+  // Average of the rates actually sent, weighted towards the most recent.
+  [[nodiscard]] double steadyRateMbps() const;
+  [[nodiscard]] std::uint64_t backoffs() const;
+
+private:
+  double rate = initialRateMbps;
+  double steadyRate = 0;
+  bool measured = false;
+  std::uint64_t lastSendStalls = 0;
+  std::uint64_t backoffCount = 0;
+};
+
+// Paces the frames of a send at the rate AdaptiveRate finds, checking the client's send queue every millisecond.
+// Used when no data rate is given, so that as fast as possible means as fast as the local path carries.
+class AdaptiveTimer : public TimerInterface
+{
+public:
+  AdaptiveTimer(std::shared_ptr<UdpClientInterface> udpClient, std::uint32_t packetSizeBytes);
+  void runTimer(std::function<bool()> callback) override;
+
+  [[nodiscard]] double steadyRateMbps() const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  [[nodiscard]] Clock::duration period() const;
+  static void waitUntil(Clock::time_point time);
+
+  std::shared_ptr<UdpClientInterface> udpClient;
+  const std::uint32_t packetSizeBytes;
+  AdaptiveRate rate;
+};
+
+#endif //ADAPTIVEPACING_HPP
@@ -0,0 +1,109 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <chrono>
+
+#include "test/catch.hpp"
+#include "test/EnterpriseDiodeTestHelpers.hpp"
+#include "AdaptivePacing.hpp"
+
+namespace
+{
+  constexpr std::uint64_t capacity = 1000;
+
+  class QueueStub : public UdpClientSpy
+  {
+  public:
+    LocalQueueState localQueueState() const override
+    {
+      return state;
+    }
+
+    LocalQueueState state{0, capacity, 0};
+  };
+}
+
+TEST_CASE("Adaptive pacing. The rate follows the local send queue")
+{
+  AdaptiveRate rate;
+  const auto start = AdaptiveRate::initialRateMbps;
+
+  SECTION("The rate grows while the queue stays short")
+  {
+    rate.update({100, capacity, 0}, start);
+    REQUIRE(rate.rateMbps() > start);
+    REQUIRE(rate.backoffs() == 0);
+  }
+
+  SECTION("The rate is held while the queue is between a quarter and half full")
+  {
+    rate.update({400, capacity, 0}, start);
+    REQUIRE(rate.rateMbps() == Approx(start));
+  }
+
+  SECTION("The rate is cut when the queue is over half full")
+  {
+    rate.update({600, capacity, 0}, start);
+    REQUIRE(rate.rateMbps() < start);
+    REQUIRE(rate.backoffs() == 1);
+  }
+
+  SECTION("The rate is cut when a send has stalled since the last update, however short the queue")
+  {
+    rate.update({0, capacity, 3}, start);
+    REQUIRE(rate.rateMbps() < start);
+    const auto cut = rate.rateMbps();
+    rate.update({0, capacity, 3}, start);
+    REQUIRE(rate.rateMbps() > cut);
+  }
+
+  SECTION("The rate stays between the limits and never runs far ahead of what is actually sent")
+  {
+    for (auto interval = 0; interval < 1000; ++interval)
+    {
+      rate.update({0, capacity, static_cast<std::uint64_t>(interval + 1)}, 0);
+    }
+    REQUIRE(rate.rateMbps() == Approx(AdaptiveRate::minRateMbps));
+
+    for (auto interval = 0; interval < 1000; ++interval)
+    {
+      rate.update({0, capacity, 1000}, 3000);
+    }
+    REQUIRE(rate.rateMbps() == Approx(6000));
+  }
+
+  SECTION("A queue that cannot be seen never holds the rate back")
+  {
+    for (auto interval = 0; interval < 1000; ++interval)
+    {
+      rate.update({0, 0, 0}, AdaptiveRate::maxRateMbps);
+    }
+    REQUIRE(rate.rateMbps() == Approx(AdaptiveRate::maxRateMbps));
+  }
+
+  SECTION("The steady rate is the recent average of what was sent")
+  {
+    rate.update({0, capacity, 0}, 800);
+    REQUIRE(rate.steadyRateMbps() == Approx(800));
+    for (auto interval = 0; interval < 500; ++interval)
+    {
+      rate.update({0, capacity, 0}, 400);
+    }
+    REQUIRE(rate.steadyRateMbps() == Approx(400).epsilon(0.01));
+  }
+}
+
+TEST_CASE("Adaptive pacing. The timer sends every frame and slows down when the queue fills")
+{
+  auto queue = std::make_shared<QueueStub>();
+  AdaptiveTimer timer(queue, 1500);
+
+  int ticks = 0;
+  timer.runTimer([&ticks]() { return ++ticks < 10; });
+  REQUIRE(ticks == 10);
+
+  queue->state = {capacity, capacity, 0};
+  const auto start = std::chrono::steady_clock::now();
+  timer.runTimer([&start]() { return std::chrono::steady_clock::now() - start < std::chrono::milliseconds(50); });
+  REQUIRE(timer.steadyRateMbps() < AdaptiveRate::initialRateMbps);
+}
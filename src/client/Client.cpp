@@ -3,25 +3,75 @@
 
 #include "Client.hpp"
 #include <chrono>
+#include <cstring>
+#include <exception>
 #include <istream>
 #include <random>
+#include <utility>
 #include <filesystem>
+#include <limits>
 #include <boost/algorithm/string.hpp>
-#include <regex>
 #include "spdlog/spdlog.h"
+#include "FilenameValidator.hpp"
+
+namespace
+{
+  // Calls a function on every way out of a scope, whether it returns or throws.
+  template <typename Function>
+  class ScopeExit
+  {
+  public:
+    explicit ScopeExit(Function function): function(std::move(function)) {}
+    ~ScopeExit() { function(); }
+
+    ScopeExit(const ScopeExit&) = delete;
+    ScopeExit& operator=(const ScopeExit&) = delete;
+
+  private:
+    Function function;
+  };
+}
 
 Client::Client(
   std::shared_ptr<UdpClientInterface> udpClient,
   std::shared_ptr<TimerInterface> timer,
   std::uint16_t maxPayloadSize,
-  std::string filename):
+  std::string filename,
+  bool compress,
+  ThreadTuning::ThreadSettings readerThread,
+  ResumeOptions resume,
+  std::string relativePath,
+  bool packed,
+  bool timestamps):
     udpClient(udpClient),
     edTimer(timer),
     maxPayloadSize(maxPayloadSize),
     headerBuffer({}),
-    payloadBuffer(maxPayloadSize),
-    filename(std::move(filename))
+    filename(std::move(filename)),
+    relativePath(std::move(relativePath)),
+    timestamps(timestamps),
+    readerThread(std::move(readerThread)),
+    resume(std::move(resume))
 {
+  headerBuffer.at(EnterpriseDiode::CompressedFlagIndex) = compress;
+  headerBuffer.at(EnterpriseDiode::PackedFlagIndex) = packed;
+  if (this->resume.enabled)
+  {
+    if (packed)
+    {
+      throw std::runtime_error("Packed sessions cannot be resumable");
+    }
+    if (compress)
+    {
+      throw std::runtime_error("Resumable sends cannot be compressed");
+    }
+    headerBuffer.at(EnterpriseDiode::ResumableFlagIndex) = 1;
+    *reinterpret_cast<std::uint32_t*>(&headerBuffer.at(EnterpriseDiode::ResumeFrameSizeIndex)) = this->maxPayloadSize;
+  }
+  else if (!this->resume.frames.empty())
+  {
+    throw std::runtime_error("Frame ranges can only be sent in a resumable session");
+  }
 }
 
 void Client::send(std::istream& inputStream)
@@ -32,31 +82,118 @@ void Client::send(std::istream& inputStream)
     throw std::runtime_error("file stream not found");
   }
   parseFilename();
-  setSessionID();
-  edTimer->runTimer([&]() {
+  if (resume.enabled)
+  {
+    startResumableSend(inputStream);
+  }
+  else
+  {
+    startSession();
+    input = std::make_unique<ReadAheadReader>(
+      inputStream, maxPayloadSize, readAheadBlockSizeInBytes, readAheadBlockCount, readerThread);
+  }
+  sendFrames();
+}
+
+void Client::send(std::vector<boost::asio::const_buffer> buffers)
+{
+  if (resume.enabled)
+  {
+    throw std::runtime_error("Sends from memory cannot be resumable");
+  }
+  parseFilename();
+  startSession();
+  input = std::make_unique<MemoryReader>(std::move(buffers), maxPayloadSize);
+  sendFrames();
+}
+
+void Client::sendStream(
+  int inputFileDescriptor, std::chrono::milliseconds flushLatency, std::chrono::milliseconds keepaliveInterval)
+{
+  if (resume.enabled || headerBuffer.at(EnterpriseDiode::CompressedFlagIndex) ||
+      headerBuffer.at(EnterpriseDiode::PackedFlagIndex))
+  {
+    throw std::runtime_error("Streams cannot be resumable, compressed or packed");
+  }
+  parseFilename();
+  startSession();
+  headerBuffer.at(EnterpriseDiode::StreamingFlagIndex) = 1;
+  auto streamReader =
+    std::make_unique<StreamReader>(inputFileDescriptor, maxPayloadSize, flushLatency, keepaliveInterval);
+  streamInput = streamReader.get();
+  input = std::move(streamReader);
+  sendFrames();
+}
+
+// Frames are sent until the EOF frame, or until one fails, which fails the send with the same error.
+// The input reads from the caller's stream, buffers or descriptor, a file on a thread of its own, so it is released
+// as soon as the send is over and on every way out of here, before the caller can destroy them. Only a timer driven
+// by hand, as in the tests, returns while the send is still going.
+void Client::sendFrames()
+{
+  sendInProgress = false;
+  const ScopeExit releaseUnlessSending([this]() {
+    if (!sendInProgress)
+    {
+      releaseInput();
+    }
+  });
+  frameCompressor.reset();
+  if (headerBuffer.at(EnterpriseDiode::CompressedFlagIndex))
+  {
+    frameCompressor = std::make_unique<FrameCompressor>(*input, maxPayloadSize);
+  }
+  sendError = nullptr;
+  sendInProgress = true;
+  edTimer->runTimer([this]() {
     try
     {
-      return sendFrame(inputStream);
+      sendInProgress = sendFrame();
     }
     catch (const std::exception& exception)
     {
       spdlog::error(std::string("exception in send frame ") + exception.what());
-      return false;
+      sendError = std::current_exception();
+      sendInProgress = false;
+    }
+    if (!sendInProgress)
+    {
+      releaseInput();
     }
+    return sendInProgress;
   });
+  if (sendError)
+  {
+    std::rethrow_exception(std::exchange(sendError, nullptr));
+  }
+}
+
+void Client::releaseInput()
+{
+  frameCompressor.reset();
+  input.reset();
+  resumeInput = nullptr;
+  streamInput = nullptr;
 }
 
 void Client::parseFilename()
 {
     const auto filenameFromPath = getFilenameFromPath();
-    std::regex filter("[a-zA-Z0-9\\.\\-_]+");
-    if (!std::regex_match(filenameFromPath, filter))
+    if (!FilenameValidator::isValid(filenameFromPath))
     {
       throw std::runtime_error("Invalid filename provided. Please rename. The filename can only contain alphanumeric characters, dashes(-) and dots(.)");
     }
-    if (filenameFromPath.length() > 65)
+    if (filenameFromPath.length() > FilenameValidator::maxFilenameLength)
+    {
+      throw std::runtime_error("Invalid filename provided. The maximum length of the filename is " + std::to_string(FilenameValidator::maxFilenameLength) + " characters.\n" + filenameFromPath + " is " + std::to_string(filenameFromPath.length()) + " characters.");
+    }
+    if (!relativePath.empty() && !FilenameValidator::isValidRelativePath(relativePath))
+    {
+      throw std::runtime_error("Invalid folder for " + filenameFromPath + ": " + relativePath + ". Folder names can only contain alphanumeric characters, dashes(-) and dots(.), and cannot be . or ..");
+    }
+    if (!relativePath.empty() && filenameFromPath.length() + relativePath.length() + 32 > maxPayloadSize)
     {
-      throw std::runtime_error("Invalid filename provided. The maximum length of the filename is 65 characters.\n" + filenameFromPath + " is " + std::to_string(filenameFromPath.length()) + " characters.");
+      throw std::runtime_error("The folder and name of " + filenameFromPath + " do not fit in one frame at this MTU");
     }
 }
 std::string Client::getFilenameFromPath() const
@@ -64,22 +201,114 @@ std::string Client::getFilenameFromPath() const
   return std::filesystem::path(filename).filename();
 }
 
-bool Client::sendFrame(std::istream& inputStream)
+std::string Client::getPathname() const
 {
-  udpClient->send(generateEDPacket(inputStream, maxPayloadSize));
+  return relativePath.empty() ? getFilenameFromPath() : relativePath + "/" + getFilenameFromPath();
+}
+
+bool Client::sendFrame()
+{
+  const auto packet = generateEDPacket();
+  if (timestamps)
+  {
+    stampSendTime();
+  }
+  udpClient->send(packet);
   return headerBuffer.at(8) != 1;
 }
 
-ConstSocketBuffers Client::generateEDPacket(std::istream& inputStream, std::uint32_t payloadSize)
+void Client::startResumableSend(std::istream& inputStream)
+{
+  const auto contentId = calculateContentId(inputStream, getPathname(), maxPayloadSize);
+  const auto frames = (contentId.size + maxPayloadSize - 1) / maxPayloadSize;
+  if (frames >= std::numeric_limits<std::uint32_t>::max())
+  {
+    throw std::runtime_error("File is too large to send with this MTU");
+  }
+  totalFrames = static_cast<std::uint32_t>(frames);
+  *reinterpret_cast<std::uint32_t*>(&headerBuffer.at(EnterpriseDiode::SessionIDIndex)) = contentId.sessionId;
+  *reinterpret_cast<std::uint32_t*>(&headerBuffer.at(EnterpriseDiode::ResumeEOFFrameIndex)) = totalFrames + 1;
+  headerBuffer.at(EnterpriseDiode::EOFFlagIndex) = 0;
+
+  const auto ranges = resume.frames.empty() ? std::vector<FrameRange>{{1, totalFrames}} : resume.frames;
+  sendPlan.clear();
+  for (auto pass = 0u; pass < std::max(1u, resume.passes); ++pass)
+  {
+    for (const auto& range : ranges)
+    {
+      if (range.first <= std::min(range.last, totalFrames))
+      {
+        sendPlan.push_back({range.first, std::min(range.last, totalFrames)});
+      }
+    }
+  }
+  nextRange = 0;
+  framesLeftInRange = 0;
+  resumeInput = &inputStream;
+  spdlog::info("Resumable session {:08x}: {} frames of {} bytes", contentId.sessionId, totalFrames, maxPayloadSize);
+}
+
+void Client::startFrameRange(const FrameRange& range)
 {
+  input.reset();
+  resumeInput->clear();
+  resumeInput->seekg(static_cast<std::streamoff>(std::uint64_t{range.first - 1} * maxPayloadSize));
+  framesLeftInRange = range.last - range.first + 1;
+  const auto rangeSize = std::uint64_t{framesLeftInRange} * maxPayloadSize;
+  input = std::make_unique<ReadAheadReader>(
+    *resumeInput, maxPayloadSize, std::min<std::uint64_t>(readAheadBlockSizeInBytes, rangeSize),
+    readAheadBlockCount, readerThread);
+  setFrameCount(range.first - 1);
+}
+
+ConstSocketBuffers Client::generateResumableEDPacket()
+{
+  while (framesLeftInRange == 0)
+  {
+    if (nextRange == sendPlan.size())
+    {
+      // The reader may be reading ahead past the last range, so stop it before the input can go away.
+      input.reset();
+      setFrameCount(totalFrames + 1);
+      return addEOFframe();
+    }
+    startFrameRange(sendPlan.at(nextRange++));
+  }
+
   incrementFrameCount();
-  const auto payloadLength = inputStream.read((char*)&*(payloadBuffer.begin()), payloadSize).gcount();
+  --framesLeftInRange;
+  const auto payload = input->nextFrame();
+  if (payload.size() == 0)
+  {
+    throw std::runtime_error("Input is shorter than when the send started");
+  }
+  return {boost::asio::buffer(headerBuffer, EnterpriseDiode::HeaderSizeInBytes), payload};
+}
 
-  if (payloadLength > 0)
+void Client::setFrameCount(std::uint32_t frameCount)
+{
+  *reinterpret_cast<std::uint32_t*>(&headerBuffer.at(EnterpriseDiode::FrameCountIndex)) = frameCount;
+}
+
+ConstSocketBuffers Client::generateEDPacket()
+{
+  if (resume.enabled)
+  {
+    return generateResumableEDPacket();
+  }
+  headerBuffer.at(EnterpriseDiode::KeepaliveFlagIndex) = 0;
+  incrementFrameCount();
+  const auto payload = nextPayload();
+
+  if (payload.size() > 0)
   {
     return {
       boost::asio::buffer(headerBuffer, EnterpriseDiode::HeaderSizeInBytes),
-      boost::asio::buffer(payloadBuffer, (size_t)payloadLength)};
+      payload};
+  }
+  else if (streamInput != nullptr && streamInput->quiet())
+  {
+    return addKeepaliveFrame();
   }
   else
   {
@@ -87,6 +316,11 @@ ConstSocketBuffers Client::generateEDPacket(std::istream& inputStream, std::uint
   }
 }
 
+boost::asio::const_buffer Client::nextPayload()
+{
+  return frameCompressor ? frameCompressor->nextFrame() : input->nextFrame();
+}
+
 void Client::incrementFrameCount()
 {
   ++(*reinterpret_cast<std::uint32_t*>(&headerBuffer.at(4)));
@@ -100,16 +334,47 @@ void Client::setEOF()
 ConstSocketBuffers Client::addEOFframe()
 {
   setEOF();
-  filenameAsSisl = "{name: !str \"" + getFilenameFromPath() + "\"}";
+  filenameAsSisl = "{name: !str \"" + getFilenameFromPath() + "\"" +
+    (relativePath.empty() ? "" : ", path: !str \"" + relativePath + "\"") + "}";
   return {
     boost::asio::buffer(headerBuffer, EnterpriseDiode::HeaderSizeInBytes),
     boost::asio::buffer(filenameAsSisl, filenameAsSisl.length())};
 }
 
+// Not a frame, so it takes back the frame count it was given. The server drops datagrams with no payload, so it
+// carries a byte the server ignores.
+ConstSocketBuffers Client::addKeepaliveFrame()
+{
+  static constexpr char keepalivePayload = 0;
+  setFrameCount(*reinterpret_cast<const std::uint32_t*>(&headerBuffer.at(EnterpriseDiode::FrameCountIndex)) - 1);
+  headerBuffer.at(EnterpriseDiode::KeepaliveFlagIndex) = 1;
+  return {
+    boost::asio::buffer(headerBuffer, EnterpriseDiode::HeaderSizeInBytes),
+    boost::asio::buffer(&keepalivePayload, 1)};
+}
+
+// Each send is a new session, so one client can send many times.
+void Client::startSession()
+{
+  setSessionID();
+  setFrameCount(0);
+  headerBuffer.at(EnterpriseDiode::EOFFlagIndex) = 0;
+  headerBuffer.at(EnterpriseDiode::StreamingFlagIndex) = 0;
+}
+
 void Client::setSessionID()
 {
-  const auto seed = std::chrono::system_clock::now().time_since_epoch().count();
-  *reinterpret_cast<std::uint32_t*>(&headerBuffer.at(0)) = (std::uint32_t)std::default_random_engine(seed)();
+  // Seeded once per thread, so that clients sending on several threads at once do not pick the same ID.
+  thread_local std::mt19937 engine(std::random_device{}());
+  *reinterpret_cast<std::uint32_t*>(&headerBuffer.at(0)) = static_cast<std::uint32_t>(engine());
+}
+
+// Wall clock time rather than a monotonic clock, so that it can be compared with the server's on the other host.
+void Client::stampSendTime()
+{
+  const auto sendTime = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count());
+  std::memcpy(&headerBuffer.at(EnterpriseDiode::SendTimestampIndex), &sendTime, sizeof(sendTime));
 }
 
 boost::posix_time::microseconds calculateTimerPeriod(double dataRateMbps, std::uint32_t mtuSize)
@@ -4,9 +4,16 @@
 #ifndef CLIENT_HPP
 #define CLIENT_HPP
 
+#include <exception>
 #include <istream>
 #include <boost/asio/time_traits.hpp>
 #include <boost/asio/buffer.hpp>
+#include "FrameCompressor.hpp"
+#include "FrameSource.hpp"
+#include "MemoryReader.hpp"
+#include "ReadAheadReader.hpp"
+#include "ResumableTransfer.hpp"
+#include "StreamReader.hpp"
 #include "TimerInterface.hpp"
 #include "UdpClientInterface.hpp"
 #include "diodeheader/EnterpriseDiodeHeader.hpp"
@@ -17,27 +24,68 @@ public:
   Client(std::shared_ptr<UdpClientInterface> udpClient,
     std::shared_ptr<TimerInterface> timer,
     std::uint16_t maxPayloadSize,
-    std::string filename="received");
+    std::string filename="received",
+    bool compress=false,
+    ThreadTuning::ThreadSettings readerThread={},
+    ResumeOptions resume={},
+    std::string relativePath={},
+    bool packed=false,
+    bool timestamps=false);
 
   void send(std::istream& inputStream);
+  // Sends data held in memory, in place where it can. The buffers must stay valid until the send returns.
+  void send(std::vector<boost::asio::const_buffer> buffers);
+  // Sends what is written to inputFileDescriptor, such as stdin or a named pipe, until the writer closes it, each
+  // byte reaching the network within flushLatency of being written. While nothing is written a keepalive is sent
+  // every keepaliveInterval, so the server does not time the stream out.
+  void sendStream(int inputFileDescriptor, std::chrono::milliseconds flushLatency,
+    std::chrono::milliseconds keepaliveInterval = EnterpriseDiode::StreamKeepaliveInterval);
 
 private:
-  bool sendFrame(std::istream& inputStream);
-  ConstSocketBuffers generateEDPacket(std::istream& inputStream, std::uint32_t payloadSize);
+  void sendFrames();
+  bool sendFrame();
+  void releaseInput();
+  boost::asio::const_buffer nextPayload();
+  ConstSocketBuffers generateEDPacket();
+  ConstSocketBuffers generateResumableEDPacket();
+  void startResumableSend(std::istream& inputStream);
+  void startFrameRange(const FrameRange& range);
+  void setFrameCount(std::uint32_t frameCount);
   void incrementFrameCount();
   void setEOF();
+  void startSession();
   void setSessionID();
+  void stampSendTime();
   ConstSocketBuffers addEOFframe();
+  ConstSocketBuffers addKeepaliveFrame();
   void parseFilename();
   std::string getFilenameFromPath() const;
+  std::string getPathname() const;
 
   std::shared_ptr<UdpClientInterface> udpClient;
   std::shared_ptr<TimerInterface> edTimer;
   std::uint32_t maxPayloadSize;
   std::array<char, EnterpriseDiode::HeaderSizeInBytes> headerBuffer;
-  std::vector<char> payloadBuffer;
+  std::unique_ptr<FrameSource> input;
+  // The input while a stream is being sent, which may have nothing to send for a while. Null otherwise.
+  StreamReader* streamInput = nullptr;
+  std::unique_ptr<FrameCompressor> frameCompressor;
+  std::exception_ptr sendError;
+  // True from the first frame of a send until the EOF frame is sent or a frame fails.
+  bool sendInProgress = false;
   const std::string filename;
+  // Folder to recreate the file in on the server, relative to its output folder. Empty to write it there directly.
+  const std::string relativePath;
   std::string filenameAsSisl;
+  // Stamp each frame with the time it is sent, so the server can measure the one way latency.
+  const bool timestamps;
+  const ThreadTuning::ThreadSettings readerThread;
+  const ResumeOptions resume;
+  std::istream* resumeInput = nullptr;
+  std::vector<FrameRange> sendPlan;
+  std::size_t nextRange = 0;
+  std::uint32_t framesLeftInRange = 0;
+  std::uint32_t totalFrames = 0;
 };
 
 boost::posix_time::microseconds calculateTimerPeriod(double dataRateMbps, std::uint32_t packetSizeBytes);
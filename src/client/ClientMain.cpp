@@ -2,12 +2,16 @@
 // MIT License. For licence terms see LICENCE.md file.
 
 #include <chrono>
+#include <cmath>
 #include <filesystem>
 
 #include "clara/clara.hpp"
 #include "spdlog/spdlog.h"
 
 #include "ClientWrapper.hpp"
+#include "DirectoryTree.hpp"
+#include "StripedUdpClient.hpp"
+#include "ThreadTuning.hpp"
 
 struct Params
 {
@@ -17,6 +21,21 @@ struct Params
   double dataRateMbps;
   std::uint16_t mtuSize;
   std::string logLevel;
+  bool compress;
+  std::string networkCpus;
+  std::string readerCpus;
+  int numaNode;
+  int realtimePriority;
+  bool resumable;
+  std::string frames;
+  unsigned int passes;
+  std::string directory;
+  unsigned int parallel;
+  std::uint64_t packLimit;
+  std::vector<StripeLink> links;
+  bool timestamps;
+  bool stream;
+  unsigned int flushLatencyMs;
 };
 
 inline Params parseArgs(int argc, char **argv)
@@ -24,17 +43,47 @@ inline Params parseArgs(int argc, char **argv)
   bool showHelp = false;
   std::string filename;
   std::string clientAddress;
-  std::uint16_t clientPort;
+  std::uint16_t clientPort = 0;
   std::uint16_t mtuSize = 1500;
   double dataRateMbps = 0;
   std::string logLevel = "info";
+  bool compress = false;
+  std::string networkCpus;
+  std::string readerCpus;
+  int numaNode = -1;
+  int realtimePriority = 0;
+  bool resumable = false;
+  std::string frames;
+  unsigned int passes = 1;
+  std::string directory;
+  unsigned int parallel = 4;
+  std::uint64_t packLimit = 0;
+  std::string links;
+  bool timestamps = false;
+  bool stream = false;
+  unsigned int flushLatencyMs = 100;
   const auto cli = clara::Help(showHelp) |
-                   clara::Opt(filename, "filename")["-f"]["--filename"]("name of a file you want to send").required() |
-                   clara::Opt(clientAddress, "client address")["-a"]["--address"]("address send packets to").required() |
-                   clara::Opt(clientPort, "client port")["-c"]["--clientPort"]("port to send packets to").required() |
+                   clara::Opt(filename, "filename")["-f"]["--filename"]("name of a file you want to send") |
+                   clara::Opt(directory, "folder")["-d"]["--directory"]("send this folder and everything in it instead of a single file") |
+                   clara::Opt(parallel, "files")["--parallel"]("folder: number of files to send at once, each with an equal share of the data rate. default 4") |
+                   clara::Opt(packLimit, "bytes")["--pack"]("folder: pack files of up to this size together, many to a session. default off") |
+                   clara::Opt(clientAddress, "client address")["-a"]["--address"]("address send packets to") |
+                   clara::Opt(clientPort, "client port")["-c"]["--clientPort"]("port to send packets to") |
+                   clara::Opt(links, "link list")["--links"]("stripe the send across these address:port[/Mbps] pairs instead of --address and --clientPort") |
                    clara::Opt(mtuSize, "MTU size")["-m"]["--mtu"]("MTU size of the network interface. default 1500") |
-                   clara::Opt(dataRateMbps, "date rate in Megabits per second")["-r"]["--datarate"]("data rate of transfer. default as fast as possible") |
-                   clara::Opt(logLevel, "Log level")["-l"]["--logLevel"]("Logging level for program output - default info");
+                   clara::Opt(dataRateMbps, "date rate in Megabits per second")["-r"]["--datarate"]("data rate of transfer. default as fast as the local path carries without loss") |
+                   clara::Opt(logLevel, "Log level")["-l"]["--logLevel"]("Logging level for program output - default info") |
+                   clara::Opt(compress)["-z"]["--compress"]("Compress the file with LZ4. Not supported through the import diode") |
+                   clara::Opt(networkCpus, "cpu list")["--networkCpus"]("cores to run the sending thread on, e.g. 2-3. default any") |
+                   clara::Opt(readerCpus, "cpu list")["--readerCpus"]("cores to run the file reading thread on. default any") |
+                   clara::Opt(numaNode, "NUMA node")["--numaNode"]("run both threads on the cores of this NUMA node, unless given cores") |
+                   clara::Opt(realtimePriority, "priority")["--realtime"]("run both threads with SCHED_FIFO at this priority (1-99). default off") |
+                   clara::Opt(resumable)["--resumable"]("send so that an interrupted transfer can be completed by a later send") |
+                   clara::Opt(frames, "frame list")["--frames"]("resumable: send only these frames, e.g. 1-100,250,4000-. default all") |
+                   clara::Opt(passes, "passes")["--passes"]("resumable: send the frames this many times. default 1") |
+                   clara::Opt(timestamps)["--timestamps"]("stamp each frame with its send time, for the server to report latency") |
+                   clara::Opt(stream)["--stream"]("send what is written to --filename, such as a named pipe, or to stdin, until it is closed") |
+                   clara::Opt(flushLatencyMs, "milliseconds")["--latency"]("stream: send a part frame once its first byte has waited this long. default 100");
 
   const auto result = cli.parse(clara::Args(argc, argv));
   if (!result)
@@ -51,7 +100,103 @@ inline Params parseArgs(int argc, char **argv)
     exit(1);
   }
 
-  return {clientAddress, clientPort, filename, dataRateMbps, mtuSize, logLevel};
+  if (filename.empty() == directory.empty() && !(stream && directory.empty()))
+  {
+    spdlog::error("Give either a file with --filename or a folder with --directory");
+    exit(1);
+  }
+  if (stream && (!directory.empty() || resumable || !frames.empty() || compress))
+  {
+    spdlog::error("--stream cannot be used with --directory, --resumable, --frames or --compress");
+    exit(1);
+  }
+  if (!directory.empty() && (!frames.empty() || parallel == 0))
+  {
+    spdlog::error("--frames cannot be used with --directory, and --parallel must be at least 1");
+    exit(1);
+  }
+  if (packLimit != 0 && (directory.empty() || resumable))
+  {
+    spdlog::error("--pack can only be used with --directory, and not with --resumable");
+    exit(1);
+  }
+
+  if (links.empty() == (clientAddress.empty() || clientPort == 0))
+  {
+    spdlog::error("Give either --address and --clientPort or --links");
+    exit(1);
+  }
+  std::vector<StripeLink> stripeLinks;
+  try
+  {
+    stripeLinks = links.empty() ? std::vector<StripeLink>{} : parseStripeLinks(links);
+  }
+  catch (const std::runtime_error& exception)
+  {
+    spdlog::error(exception.what());
+    exit(1);
+  }
+  if (!stripeLinks.empty() && stripeLinks.front().dataRateMbps > 0 && dataRateMbps > 0)
+  {
+    spdlog::error("--datarate cannot be used with links that have their own data rates");
+    exit(1);
+  }
+
+  return {clientAddress, clientPort, filename, dataRateMbps, mtuSize, logLevel, compress,
+    networkCpus, readerCpus, numaNode, realtimePriority, resumable || !frames.empty(), frames, passes, directory, parallel, packLimit, stripeLinks, timestamps, stream, flushLatencyMs};
+}
+
+// The overall data rate, which is the sum of the links' own rates if they have them.
+inline double totalDataRate(const Params& params)
+{
+  if (params.links.empty() || !(params.links.front().dataRateMbps > 0))
+  {
+    return params.dataRateMbps;
+  }
+  double total = 0;
+  for (const auto& link : params.links)
+  {
+    total += link.dataRateMbps;
+  }
+  return total;
+}
+
+// A socket to --address, or a socket to each of the --links weighted by their data rates.
+inline std::shared_ptr<UdpClientInterface> createUdpClient(const Params& params)
+{
+  if (params.links.empty())
+  {
+    return std::make_shared<UdpClient>(params.clientAddress, params.clientPort);
+  }
+  std::vector<StripedUdpClient::Link> links;
+  for (const auto& link : params.links)
+  {
+    links.push_back({
+      std::make_shared<UdpClient>(link.address, link.port),
+      static_cast<std::uint32_t>(std::max(1.0, std::round(link.dataRateMbps * 1000)))});
+  }
+  return std::make_shared<StripedUdpClient>(links);
+}
+
+inline std::size_t sendDirectory(const Params& params, std::optional<unsigned int> numaNode)
+{
+  std::vector<DirectoryClient::Link> links;
+  for (auto link = 0u; link < params.parallel; ++link)
+  {
+    const auto udpClient = createUdpClient(params);
+    links.push_back({
+      udpClient, ClientWrapper::selectTimer(params.mtuSize, totalDataRate(params) / params.parallel, udpClient)});
+  }
+  return DirectoryClient(
+    links,
+    calculatePayloadSize(params.mtuSize),
+    params.compress,
+    ThreadTuning::threadSettings(params.networkCpus, numaNode, params.realtimePriority),
+    ThreadTuning::threadSettings(params.readerCpus, numaNode, params.realtimePriority),
+    {params.resumable, {}, params.passes},
+    params.packLimit,
+    params.timestamps
+  ).send(listDirectoryTree(params.directory));
 }
 
 int main(int argc, char **argv)
@@ -62,14 +207,32 @@ int main(int argc, char **argv)
 
   try
   {
-    ClientWrapper(
-      params.clientAddress,
-      params.clientPort,
+    const auto numaNode = params.numaNode < 0 ? std::nullopt : std::optional(static_cast<unsigned int>(params.numaNode));
+    if (!params.directory.empty())
+    {
+      return sendDirectory(params, numaNode) == 0 ? 0 : 2;
+    }
+    ThreadTuning::applyToCurrentThread(
+      ThreadTuning::threadSettings(params.networkCpus, numaNode, params.realtimePriority));
+    ClientWrapper clientWrapper(
+      createUdpClient(params),
       params.mtuSize,
-      params.dataRateMbps,
-      params.filename,
-      params.logLevel
-    ).sendData(params.filename);
+      totalDataRate(params),
+      params.stream && params.filename.empty() ? "stdin" : params.filename,
+      params.logLevel,
+      params.compress,
+      ThreadTuning::threadSettings(params.readerCpus, numaNode, params.realtimePriority),
+      {params.resumable, parseFrameRanges(params.frames), params.passes},
+      params.timestamps);
+    if (params.stream)
+    {
+      clientWrapper.streamData(
+        params.filename.empty() ? "-" : params.filename, std::chrono::milliseconds(params.flushLatencyMs));
+    }
+    else
+    {
+      clientWrapper.sendData(params.filename);
+    }
   }
   catch (const std::exception& exception)
   {
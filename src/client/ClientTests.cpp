@@ -1,18 +1,57 @@
 // Copyright PA Knowledge Ltd 2021
 // MIT License. For licence terms see LICENCE.md file.
 
+#include <atomic>
 #include <cstdint>
+#include <stdexcept>
+#include <streambuf>
 #include <vector>
 #include <string>
+#include <chrono>
 #include <future>
+#include <thread>
+#include <unistd.h>
 
 #include "test/catch.hpp"
 
 #include "test/EnterpriseDiodeTestHelpers.hpp"
 #include "diodeheader/EnterpriseDiodeHeader.hpp"
 #include "Client.hpp"
+#include "ClientWrapper.hpp"
+#include "FrameCompression.hpp"
 #include "Timer.hpp"
 
+namespace
+{
+  class FailingUdpClient : public UdpClientInterface
+  {
+  public:
+    void send(ConstSocketBuffers) override
+    {
+      throw std::runtime_error("send failed");
+    }
+  };
+
+  // An endless input read slowly, which notes any read made after the test has let go of it.
+  class SlowInput : public std::streambuf
+  {
+  public:
+    std::atomic<bool> released{false};
+    std::atomic<bool> readAfterRelease{false};
+
+  protected:
+    int_type underflow() override
+    {
+      readAfterRelease = readAfterRelease || released;
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      setg(chunk.data(), chunk.data(), chunk.data() + chunk.size());
+      return traits_type::to_int_type(chunk.front());
+    }
+
+  private:
+    std::vector<char> chunk = std::vector<char>(64 * 1024, 'x');
+  };
+}
 
 TEST_CASE("Client. Stream data is sent using the ED client")
 {
@@ -271,3 +310,180 @@ TEST_CASE("Client. Packets are sent with a random session ID")
   edClient.send(nextInputStream);
   REQUIRE(lastSessionID != *reinterpret_cast<std::uint32_t*>(&udpClientSpy->latestPacket.at(0)));
 }
+
+TEST_CASE("Client. Compressed sessions flag every frame and compress the payload")
+{
+  auto udpClientSpy = std::make_shared<UdpClientSpy>();
+  Client edClient(udpClientSpy, std::make_shared<Timer>(0), 1000, "testFilename", true);
+
+  std::stringstream ss(std::string(10000, 'a'));
+  edClient.send(ss);
+
+  REQUIRE(udpClientSpy->buffersSent.size() == 2);
+  REQUIRE(udpClientSpy->buffersSent.at(0).at(EnterpriseDiode::CompressedFlagIndex) == 1);
+  REQUIRE(udpClientSpy->buffersSent.at(1).at(EnterpriseDiode::CompressedFlagIndex) == 1);
+  REQUIRE(udpClientSpy->buffersSent.at(1).at(EnterpriseDiode::EOFFlagIndex));
+
+  const BytesBuffer frame(
+    udpClientSpy->buffersSent.at(0).begin() + EnterpriseDiode::HeaderSizeInBytes, udpClientSpy->buffersSent.at(0).end());
+  BytesBuffer decompressed;
+  FrameCompression::decompressFrame(frame, decompressed);
+  REQUIRE(decompressed == BytesBuffer(10000, 'a'));
+}
+
+TEST_CASE("Client. The folder to recreate the file in is sent with its name")
+{
+  auto udpClientSpy = std::make_shared<UdpClientSpy>();
+
+  SECTION("The path goes in the EOF frame SISL")
+  {
+    Client edClient(udpClientSpy, std::make_shared<Timer>(0), 100, "local/dir/file.txt", false, {}, {}, "photos/2021");
+    std::stringstream ss("B");
+    edClient.send(ss);
+
+    const auto& eofFrame = udpClientSpy->buffersSent.at(1);
+    REQUIRE(std::string(eofFrame.begin() + EnterpriseDiode::HeaderSizeInBytes, eofFrame.end()) ==
+            "{name: !str \"file.txt\", path: !str \"photos/2021\"}");
+  }
+
+  SECTION("Paths the server would refuse are not sent")
+  {
+    for (const auto path : {"/etc", "photos/../..", "my photos"})
+    {
+      Client edClient(udpClientSpy, std::make_shared<Timer>(0), 100, "file.txt", false, {}, {}, path);
+      std::stringstream ss("B");
+      REQUIRE_THROWS_AS(edClient.send(ss), std::runtime_error);
+    }
+  }
+}
+
+TEST_CASE("Client. Frames are stamped with their send time only when asked")
+{
+  auto udpClientSpy = std::make_shared<UdpClientSpy>();
+  const auto sendTimestamp = [&udpClientSpy](std::size_t frame) {
+    return EDHeaderView(udpClientSpy->buffersSent.at(frame).data()).sendTimestamp();
+  };
+
+  SECTION("Not stamped by default")
+  {
+    Client edClient(udpClientSpy, std::make_shared<Timer>(0), 1);
+    std::stringstream ss("AB");
+    edClient.send(ss);
+    REQUIRE(sendTimestamp(0) == 0);
+    REQUIRE(sendTimestamp(2) == 0);
+  }
+
+  SECTION("Every frame stamped, the EOF frame included, in wall clock nanoseconds")
+  {
+    const auto nanosecondsNow = []() {
+      return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    };
+    Client edClient(udpClientSpy, std::make_shared<Timer>(0), 1, "testFilename", false, {}, {}, {}, false, true);
+    std::stringstream ss("AB");
+    const auto before = nanosecondsNow();
+    edClient.send(ss);
+    const auto after = nanosecondsNow();
+
+    REQUIRE(udpClientSpy->buffersSent.size() == 3);
+    REQUIRE(sendTimestamp(0) >= before);
+    REQUIRE(sendTimestamp(1) >= sendTimestamp(0));
+    REQUIRE(sendTimestamp(2) >= sendTimestamp(1));
+    REQUIRE(sendTimestamp(2) <= after);
+  }
+}
+
+TEST_CASE("Client. Streamed sessions flag every frame and send what is written as it comes")
+{
+  auto udpClientSpy = std::make_shared<UdpClientSpy>();
+  int ends[2];
+  REQUIRE(pipe(ends) == 0);
+  const std::string data = "line one\nline two\n";
+  REQUIRE(write(ends[1], data.data(), data.size()) == static_cast<ssize_t>(data.size()));
+  close(ends[1]);
+
+  Client edClient(udpClientSpy, std::make_shared<Timer>(0), 10, "feed.log");
+  edClient.sendStream(ends[0], std::chrono::milliseconds(10));
+  close(ends[0]);
+
+  REQUIRE(udpClientSpy->buffersSent.size() == 3);
+  std::string received;
+  for (const auto& frame : udpClientSpy->buffersSent)
+  {
+    REQUIRE(frame.at(EnterpriseDiode::StreamingFlagIndex) == 1);
+  }
+  for (std::size_t frame = 0; frame < 2; ++frame)
+  {
+    received.append(udpClientSpy->buffersSent.at(frame).begin() + EnterpriseDiode::HeaderSizeInBytes,
+      udpClientSpy->buffersSent.at(frame).end());
+  }
+  REQUIRE(received == data);
+  REQUIRE(udpClientSpy->buffersSent.at(2).at(EnterpriseDiode::EOFFlagIndex) == 1);
+
+  Client compressingClient(udpClientSpy, std::make_shared<Timer>(0), 10, "feed.log", true);
+  REQUIRE_THROWS_AS(compressingClient.sendStream(STDIN_FILENO, std::chrono::milliseconds(10)), std::runtime_error);
+}
+
+TEST_CASE("Client. A quiet stream sends keepalives, which are not counted as frames")
+{
+  auto udpClientSpy = std::make_shared<UdpClientSpy>();
+  int ends[2];
+  REQUIRE(pipe(ends) == 0);
+  auto writer = std::async(std::launch::async, [writeEnd = ends[1]]() {
+    const auto first = write(writeEnd, "ab", 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const auto second = write(writeEnd, "cd", 2);
+    close(writeEnd);
+    return first == 2 && second == 2;
+  });
+
+  Client edClient(udpClientSpy, std::make_shared<Timer>(0), 10, "feed.log");
+  edClient.sendStream(ends[0], std::chrono::milliseconds(5), std::chrono::milliseconds(20));
+  REQUIRE(writer.get());
+  close(ends[0]);
+
+  const auto& sent = udpClientSpy->buffersSent;
+  REQUIRE(sent.size() >= 4);
+  REQUIRE(std::string(sent.front().begin() + EnterpriseDiode::HeaderSizeInBytes, sent.front().end()) == "ab");
+  REQUIRE(sent.front().at(EnterpriseDiode::KeepaliveFlagIndex) == 0);
+  for (std::size_t keepalive = 1; keepalive < sent.size() - 2; ++keepalive)
+  {
+    REQUIRE(sent.at(keepalive).at(EnterpriseDiode::KeepaliveFlagIndex) == 1);
+    REQUIRE(sent.at(keepalive).at(EnterpriseDiode::FrameCountIndex) == 1);
+    REQUIRE(sent.at(keepalive).at(EnterpriseDiode::EOFFlagIndex) == 0);
+  }
+  const auto& last = sent.at(sent.size() - 2);
+  REQUIRE(std::string(last.begin() + EnterpriseDiode::HeaderSizeInBytes, last.end()) == "cd");
+  REQUIRE(last.at(EnterpriseDiode::FrameCountIndex) == 2);
+  REQUIRE(last.at(EnterpriseDiode::KeepaliveFlagIndex) == 0);
+  REQUIRE(sent.back().at(EnterpriseDiode::FrameCountIndex) == 3);
+  REQUIRE(sent.back().at(EnterpriseDiode::EOFFlagIndex) == 1);
+}
+
+TEST_CASE("Client. A send whose frame fails stops reading its input before it returns")
+{
+  SlowInput input;
+  std::istream inputStream(&input);
+  Client edClient(std::make_shared<FailingUdpClient>(), std::make_shared<Timer>(0), 1000);
+
+  REQUIRE_THROWS_AS(edClient.send(inputStream), std::runtime_error);
+  input.released = true;
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  REQUIRE_FALSE(input.readAfterRelease);
+}
+
+TEST_CASE("Client. Jumbo and 64KB datagrams carry full size frames")
+{
+  REQUIRE(calculatePayloadSize(1500) == 1360);
+  REQUIRE(calculatePayloadSize(9000) == 8860);
+  REQUIRE(calculatePayloadSize(65535) == 65395);
+
+  auto udpClientSpy = std::make_shared<UdpClientSpy>();
+  Client edClient(udpClientSpy, std::make_shared<Timer>(0), calculatePayloadSize(65535), "big.bin");
+  std::stringstream input(std::string(100000, 'x'));
+  edClient.send(input);
+
+  REQUIRE(udpClientSpy->buffersSent.size() == 3);
+  REQUIRE(udpClientSpy->buffersSent.at(0).size() == EnterpriseDiode::MaxDatagramSizeInBytes);
+  REQUIRE(udpClientSpy->buffersSent.at(1).size() == EnterpriseDiode::HeaderSizeInBytes + 100000 - 65395);
+}
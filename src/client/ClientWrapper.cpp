@@ -2,10 +2,14 @@
 // MIT License. For licence terms see LICENCE.md file.
 
 #include "ClientWrapper.hpp"
-#include "FreeRunningTimer.hpp"
+#include "AdaptivePacing.hpp"
 #include "Timer.hpp"
 #include "spdlog/spdlog.h"
+#include <cerrno>
+#include <cstring>
 #include <utility>
+#include <fcntl.h>
+#include <unistd.h>
 
 ClientWrapper::ClientWrapper(
   const std::string& targetAddress,
@@ -13,22 +17,57 @@ ClientWrapper::ClientWrapper(
   std::uint16_t mtuSize,
   double dataRateMbps,
   std::string filename,
-  const std::string& logLevel) :
-    edClient(
+  const std::string& logLevel,
+  bool compress,
+  ThreadTuning::ThreadSettings readerThread,
+  ResumeOptions resume,
+  bool timestamps) :
+    ClientWrapper(
       std::make_shared<UdpClient>(targetAddress, targetPort),
-      selectTimer(mtuSize, dataRateMbps),
+      mtuSize,
+      dataRateMbps,
+      std::move(filename),
+      logLevel,
+      compress,
+      std::move(readerThread),
+      std::move(resume),
+      timestamps)
+{
+}
+
+ClientWrapper::ClientWrapper(
+  std::shared_ptr<UdpClientInterface> udpClient,
+  std::uint16_t mtuSize,
+  double dataRateMbps,
+  std::string filename,
+  const std::string& logLevel,
+  bool compress,
+  ThreadTuning::ThreadSettings readerThread,
+  ResumeOptions resume,
+  bool timestamps) :
+    timer(selectTimer(mtuSize, dataRateMbps, udpClient)),
+    edClient(
+      std::move(udpClient),
+      timer,
       calculatePayloadSize(mtuSize),
-      std::move(filename))
+      std::move(filename),
+      compress,
+      std::move(readerThread),
+      std::move(resume),
+      {},
+      false,
+      timestamps)
 {
   spdlog::set_level(spdlog::level::from_str(logLevel));
 }
 
-std::shared_ptr<TimerInterface> ClientWrapper::selectTimer(uint16_t mtuSize, double dataRateMbps)
+std::shared_ptr<TimerInterface> ClientWrapper::selectTimer(
+  uint16_t mtuSize, double dataRateMbps, std::shared_ptr<UdpClientInterface> udpClient)
 {
   if (isZero(dataRateMbps))
   {
-    spdlog::debug("Selecting free running timer");
-    return std::make_shared<FreeRunningTimer>();
+    spdlog::debug("Selecting adaptive timer");
+    return std::make_shared<AdaptiveTimer>(std::move(udpClient), mtuSize);
   }
   else
   {
@@ -44,6 +83,11 @@ bool ClientWrapper::isZero(double dataRateMbps)
 void ClientWrapper::sendData(const std::string& filename)
 {
   std::ifstream inputStream(filename, std::ios::binary);
+  sendData(inputStream);
+}
+
+void ClientWrapper::sendData(std::istream& inputStream)
+{
   try
   {
     edClient.send(inputStream);
@@ -54,10 +98,41 @@ void ClientWrapper::sendData(const std::string& filename)
     throw std::runtime_error("sendData failed");
   }
   spdlog::info("Send complete");
+  if (const auto adaptiveTimer = std::dynamic_pointer_cast<AdaptiveTimer>(timer))
+  {
+    spdlog::info("Adaptive pacing settled at {:.0f} Mbps", adaptiveTimer->steadyRateMbps());
+  }
+}
+
+void ClientWrapper::streamData(const std::string& path, std::chrono::milliseconds flushLatency)
+{
+  const auto fileDescriptor = path == "-" ? STDIN_FILENO : open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fileDescriptor < 0)
+  {
+    throw std::runtime_error("Unable to open " + path + ": " + std::strerror(errno));
+  }
+  const auto closeInput = [fileDescriptor]() {
+    if (fileDescriptor != STDIN_FILENO)
+    {
+      close(fileDescriptor);
+    }
+  };
+  try
+  {
+    edClient.sendStream(fileDescriptor, flushLatency);
+  }
+  catch(const std::exception& exc)
+  {
+    closeInput();
+    spdlog::error(std::string("Exception Streaming Data: ") + exc.what());
+    throw std::runtime_error("streamData failed");
+  }
+  closeInput();
+  spdlog::info("Stream complete");
 }
 
 std::uint16_t calculatePayloadSize(std::uint16_t mtuSize)
 {
-  return std::uint16_t(
-    (short) EnterpriseDiode::calculateMaxBufferSize(mtuSize) - (short) EnterpriseDiode::HeaderSizeInBytes);
+  return static_cast<std::uint16_t>(
+    EnterpriseDiode::calculateMaxBufferSize(mtuSize) - EnterpriseDiode::HeaderSizeInBytes);
 }
@@ -4,6 +4,7 @@
 #ifndef CLIENTWRAPPER_HPP
 #define CLIENTWRAPPER_HPP
 
+#include <chrono>
 #include <iostream>
 #include <fstream>
 #include "Client.hpp"
@@ -21,13 +22,34 @@ public:
     std::uint16_t mtuSize,
     double dataRateMbps,
     std::string filename,
-    const std::string& logLevel);
+    const std::string& logLevel,
+    bool compress = false,
+    ThreadTuning::ThreadSettings readerThread = {},
+    ResumeOptions resume = {},
+    bool timestamps = false);
+  ClientWrapper(
+    std::shared_ptr<UdpClientInterface> udpClient,
+    std::uint16_t mtuSize,
+    double dataRateMbps,
+    std::string filename,
+    const std::string& logLevel,
+    bool compress = false,
+    ThreadTuning::ThreadSettings readerThread = {},
+    ResumeOptions resume = {},
+    bool timestamps = false);
   void sendData(const std::string& filename);
+  void sendData(std::istream& inputStream);
+  // Sends what is written to path, which may be a named pipe or "-" for stdin, until the writer closes it.
+  void streamData(const std::string& path, std::chrono::milliseconds flushLatency);
+
+  // Paces to the data rate, or adaptively to what the local path to udpClient carries if it is zero.
+  static std::shared_ptr<TimerInterface> selectTimer(
+    uint16_t mtuSize, double dataRateMbps, std::shared_ptr<UdpClientInterface> udpClient);
 
 private:
+  std::shared_ptr<TimerInterface> timer;
   Client edClient;
 
-  static std::shared_ptr<TimerInterface> selectTimer(uint16_t mtuSize, double dataRateMbps);
   static bool isZero(double dataRateMbps);
 };
 
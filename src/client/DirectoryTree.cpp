@@ -0,0 +1,219 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "DirectoryTree.hpp"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include "spdlog/spdlog.h"
+#include "AdaptivePacing.hpp"
+#include "Client.hpp"
+#include "FilePacker.hpp"
+#include "FilenameValidator.hpp"
+
+namespace
+{
+  std::string rootName(const std::filesystem::path& root)
+  {
+    auto normal = std::filesystem::absolute(root).lexically_normal();
+    if (!normal.has_filename())
+    {
+      normal = normal.parent_path();
+    }
+    const auto name = normal.filename().string();
+    if (!FilenameValidator::isValidRelativePath(name))
+    {
+      throw std::runtime_error("Unable to send the folder " + root.string() + " under the name " + name);
+    }
+    return name;
+  }
+}
+
+std::vector<TreeFile> listDirectoryTree(const std::filesystem::path& root)
+{
+  if (!std::filesystem::is_directory(root))
+  {
+    throw std::runtime_error(root.string() + " is not a folder");
+  }
+  const auto name = rootName(root);
+
+  std::vector<TreeFile> files;
+  for (auto entry = std::filesystem::recursive_directory_iterator(root);
+       entry != std::filesystem::recursive_directory_iterator(); ++entry)
+  {
+    const auto relativeFolder = entry->path().parent_path().lexically_relative(root);
+    const auto relativePath = relativeFolder == "." ? name : name + "/" + relativeFolder.generic_string();
+    const auto filename = entry->path().filename().string();
+
+    if (entry->is_symlink())
+    {
+      spdlog::warn("Skipping symlink {}", entry->path().string());
+    }
+    else if (entry->is_directory())
+    {
+      if (!FilenameValidator::isValidRelativePath(relativePath + "/" + filename))
+      {
+        spdlog::warn("Skipping folder {}: the name or depth cannot be sent", entry->path().string());
+        entry.disable_recursion_pending();
+      }
+    }
+    else if (!entry->is_regular_file())
+    {
+      spdlog::warn("Skipping {}: not a regular file", entry->path().string());
+    }
+    else if (!FilenameValidator::isValid(filename) || filename.length() > FilenameValidator::maxFilenameLength)
+    {
+      spdlog::warn("Skipping {}: the name cannot be sent", entry->path().string());
+    }
+    else
+    {
+      files.push_back({entry->path(), relativePath, entry->file_size()});
+    }
+  }
+
+  std::sort(files.begin(), files.end(), [](const auto& lhs, const auto& rhs) { return lhs.path < rhs.path; });
+  return files;
+}
+
+DirectoryClient::DirectoryClient(
+  std::vector<Link> links,
+  std::uint16_t maxPayloadSize,
+  bool compress,
+  ThreadTuning::ThreadSettings networkThread,
+  ThreadTuning::ThreadSettings readerThread,
+  ResumeOptions resume,
+  std::uint64_t packLimit,
+  bool timestamps):
+    links(std::move(links)),
+    maxPayloadSize(maxPayloadSize),
+    compress(compress),
+    networkThread(std::move(networkThread)),
+    readerThread(std::move(readerThread)),
+    resume(std::move(resume)),
+    packLimit(packLimit),
+    timestamps(timestamps)
+{
+  if (this->links.empty())
+  {
+    throw std::runtime_error("Sending a folder needs at least one link");
+  }
+  if (packLimit != 0 && this->resume.enabled)
+  {
+    throw std::runtime_error("Packed files cannot be sent resumably");
+  }
+}
+
+std::size_t DirectoryClient::send(const std::vector<TreeFile>& files)
+{
+  const auto transfers = planTransfers(files);
+  std::atomic<std::size_t> nextTransfer = 0;
+  std::atomic<std::size_t> failures = 0;
+
+  std::vector<std::thread> workers;
+  for (const auto& link : links)
+  {
+    workers.emplace_back([this, &link, &transfers, &nextTransfer, &failures]() {
+      try
+      {
+        ThreadTuning::applyToCurrentThread(networkThread);
+      }
+      catch (const std::exception& exception)
+      {
+        spdlog::warn("Unable to apply the network thread settings: {}", exception.what());
+      }
+
+      for (auto index = nextTransfer++; index < transfers.size(); index = nextTransfer++)
+      {
+        failures += sendTransfer(link, transfers[index], index);
+      }
+    });
+  }
+  for (auto& worker : workers)
+  {
+    worker.join();
+  }
+
+  spdlog::info("Sent {} of {} files", files.size() - failures, files.size());
+  double steadyRateMbps = 0;
+  for (const auto& link : links)
+  {
+    if (const auto adaptiveTimer = std::dynamic_pointer_cast<AdaptiveTimer>(link.timer))
+    {
+      steadyRateMbps += adaptiveTimer->steadyRateMbps();
+    }
+  }
+  if (steadyRateMbps > 0)
+  {
+    spdlog::info("Adaptive pacing settled at {:.0f} Mbps", steadyRateMbps);
+  }
+  return failures;
+}
+
+std::vector<DirectoryClient::Transfer> DirectoryClient::planTransfers(const std::vector<TreeFile>& files) const
+{
+  std::vector<Transfer> transfers;
+  std::vector<TreeFile> smallFiles;
+  std::uint64_t smallBytes = 0;
+  for (const auto& file : files)
+  {
+    if (file.size <= packLimit && packLimit != 0)
+    {
+      smallFiles.push_back(file);
+      smallBytes += file.size;
+    }
+    else
+    {
+      transfers.push_back({{file}, false});
+    }
+  }
+
+  // Spread the small files over at least as many packs as there are links, so they all have work.
+  const auto packSize = std::clamp<std::uint64_t>(smallBytes / links.size(), 1, maxPackSizeInBytes);
+  std::vector<Transfer> packs;
+  std::uint64_t bytesInPack = 0;
+  for (const auto& file : smallFiles)
+  {
+    if (packs.empty() || bytesInPack >= packSize)
+    {
+      packs.push_back({{}, true});
+      bytesInPack = 0;
+    }
+    packs.back().files.push_back(file);
+    bytesInPack += file.size;
+  }
+  transfers.insert(transfers.begin(), packs.begin(), packs.end());
+  return transfers;
+}
+
+std::size_t DirectoryClient::sendTransfer(const Link& link, const Transfer& transfer, std::size_t index)
+{
+  try
+  {
+    if (!transfer.packed)
+    {
+      const auto& file = transfer.files.front();
+      std::ifstream inputStream(file.path, std::ios::binary);
+      Client(link.udpClient, link.timer, maxPayloadSize, file.path.string(), compress, readerThread, resume,
+        file.relativePath, false, timestamps).send(inputStream);
+      spdlog::debug("Sent {} to {}", file.path.string(), file.relativePath);
+      return 0;
+    }
+
+    FilePacker packer(transfer.files);
+    std::istream inputStream(&packer);
+    Client(link.udpClient, link.timer, maxPayloadSize, "pack" + std::to_string(index) + ".edpack", compress,
+      readerThread, {}, {}, true, timestamps).send(inputStream);
+    spdlog::debug("Sent a pack of {} files", transfer.files.size());
+    return packer.failures();
+  }
+  catch (const std::exception& exception)
+  {
+    spdlog::error("Unable to send {}: {}",
+      transfer.packed ? "a pack of " + std::to_string(transfer.files.size()) + " files"
+                      : transfer.files.front().path.string(),
+      exception.what());
+    return transfer.files.size();
+  }
+}
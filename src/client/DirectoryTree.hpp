@@ -0,0 +1,79 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef DIRECTORYTREE_HPP
+#define DIRECTORYTREE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ResumableTransfer.hpp"
+#include "ThreadTuning.hpp"
+#include "TimerInterface.hpp"
+#include "UdpClientInterface.hpp"
+
+// A file found under the folder being sent, with the folder to recreate it in on the server.
+struct TreeFile
+{
+  std::filesystem::path path;
+  std::string relativePath;
+  std::uint64_t size;
+};
+
+// The regular files under root in path order. Their relative paths start with the name of root itself, so the
+// server recreates root as a folder, as scp -r does. Symlinks, special files and anything named in a way the server
+// would reject are skipped with a warning, as are empty folders.
+std::vector<TreeFile> listDirectoryTree(const std::filesystem::path& root);
+
+// Largest pack of small files sent as one session.
+constexpr std::uint64_t maxPackSizeInBytes = 64 * 1024 * 1024;
+
+// Sends files each as its own session, one at a time on each link, with the links working through the list in
+// parallel so that many small files are not held up behind each other. Files of up to packLimit bytes are instead
+// packed together, many to a session, which saves the frames, session set up and file handling a file of their
+// own would cost on both sides.
+class DirectoryClient
+{
+public:
+  struct Link
+  {
+    std::shared_ptr<UdpClientInterface> udpClient;
+    std::shared_ptr<TimerInterface> timer;
+  };
+
+  DirectoryClient(std::vector<Link> links,
+    std::uint16_t maxPayloadSize,
+    bool compress = false,
+    ThreadTuning::ThreadSettings networkThread = {},
+    ThreadTuning::ThreadSettings readerThread = {},
+    ResumeOptions resume = {},
+    std::uint64_t packLimit = 0,
+    bool timestamps = false);
+
+  // Returns the number of files that could not be sent, which are logged and passed over.
+  std::size_t send(const std::vector<TreeFile>& files);
+
+private:
+  // One session: a file on its own, or a pack of small files.
+  struct Transfer
+  {
+    std::vector<TreeFile> files;
+    bool packed;
+  };
+
+  [[nodiscard]] std::vector<Transfer> planTransfers(const std::vector<TreeFile>& files) const;
+  std::size_t sendTransfer(const Link& link, const Transfer& transfer, std::size_t index);
+
+  const std::vector<Link> links;
+  const std::uint16_t maxPayloadSize;
+  const bool compress;
+  const ThreadTuning::ThreadSettings networkThread;
+  const ThreadTuning::ThreadSettings readerThread;
+  const ResumeOptions resume;
+  const std::uint64_t packLimit;
+  const bool timestamps;
+};
+
+#endif //DIRECTORYTREE_HPP
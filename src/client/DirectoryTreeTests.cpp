@@ -0,0 +1,180 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+
+#include "test/catch.hpp"
+#include "test/EnterpriseDiodeTestHelpers.hpp"
+#include "diodeheader/EnterpriseDiodeHeader.hpp"
+#include "DirectoryTree.hpp"
+#include "FilePacker.hpp"
+#include "PackFormat.hpp"
+#include "Timer.hpp"
+
+namespace
+{
+  void writeFile(const std::filesystem::path& path, const std::string& content)
+  {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream(path, std::ios::binary) << content;
+  }
+
+  struct ReceivedFile
+  {
+    std::string content;
+    std::string eofSisl;
+    bool packed;
+  };
+
+  // Splits the content of a packed session back into its files.
+  std::map<std::string, std::string> unpack(const std::string& content)
+  {
+    std::map<std::string, std::string> files;
+    for (std::size_t offset = 0; offset < content.size();)
+    {
+      const auto header = PackFormat::readEntryHeader(content.data() + offset);
+      REQUIRE(header);
+      offset += PackFormat::entryHeaderSizeInBytes;
+      const auto name = content.substr(offset, header->nameLength);
+      offset += header->nameLength;
+      files[name] = content.substr(offset, header->contentSize);
+      offset += header->contentSize;
+    }
+    return files;
+  }
+
+  // Puts the frames sent on every link back together by session, as the server would.
+  std::map<std::uint32_t, ReceivedFile> receivedFiles(const std::vector<std::shared_ptr<UdpClientSpy>>& spies)
+  {
+    std::map<std::uint32_t, std::map<std::uint32_t, BytesBuffer>> sessions;
+    for (const auto& spy : spies)
+    {
+      for (const auto& packet : spy->buffersSent)
+      {
+        std::uint32_t sessionId;
+        std::uint32_t frameCount;
+        std::memcpy(&sessionId, packet.data() + EnterpriseDiode::SessionIDIndex, sizeof(sessionId));
+        std::memcpy(&frameCount, packet.data() + EnterpriseDiode::FrameCountIndex, sizeof(frameCount));
+        sessions[sessionId][frameCount] = packet;
+      }
+    }
+
+    std::map<std::uint32_t, ReceivedFile> files;
+    for (const auto& [sessionId, frames] : sessions)
+    {
+      auto& file = files[sessionId];
+      for (const auto& [frameCount, packet] : frames)
+      {
+        const std::string payload(packet.begin() + EnterpriseDiode::HeaderSizeInBytes, packet.end());
+        (packet.at(EnterpriseDiode::EOFFlagIndex) ? file.eofSisl : file.content) += payload;
+        file.packed = packet.at(EnterpriseDiode::PackedFlagIndex);
+      }
+    }
+    return files;
+  }
+}
+
+TEST_CASE("DirectoryTree.")
+{
+  const auto base = std::filesystem::temp_directory_path() / ("edtree." + std::to_string(std::random_device()()));
+  const auto root = base / "photos";
+  writeFile(root / "a.txt", "AAAAA");
+  writeFile(root / "2021" / "b.txt", "BB");
+  writeFile(root / "2021" / "q1" / "c.txt", "C");
+  writeFile(root / "2021" / "bad name.txt", "X");
+  writeFile(root / "bad folder" / "d.txt", "X");
+  std::filesystem::create_symlink(root / "a.txt", root / "link.txt");
+  std::filesystem::create_directories(root / "empty");
+
+  SECTION("Regular files with names the server accepts are listed with the folder to recreate them in")
+  {
+    const auto files = listDirectoryTree(root);
+    REQUIRE(files.size() == 3);
+    REQUIRE(files.at(0).path == root / "2021" / "b.txt");
+    REQUIRE(files.at(0).relativePath == "photos/2021");
+    REQUIRE(files.at(1).path == root / "2021" / "q1" / "c.txt");
+    REQUIRE(files.at(1).relativePath == "photos/2021/q1");
+    REQUIRE(files.at(2).path == root / "a.txt");
+    REQUIRE(files.at(2).relativePath == "photos");
+
+    REQUIRE(listDirectoryTree(root.string() + "/").size() == 3);
+    REQUIRE_THROWS_AS(listDirectoryTree(root / "a.txt"), std::runtime_error);
+  }
+
+  SECTION("Each file is sent as its own session with its folder, spread across the links")
+  {
+    std::vector<std::shared_ptr<UdpClientSpy>> spies;
+    std::vector<DirectoryClient::Link> links;
+    for (auto link = 0; link < 3; ++link)
+    {
+      spies.push_back(std::make_shared<UdpClientSpy>());
+      links.push_back({spies.back(), std::make_shared<Timer>(0)});
+    }
+
+    auto files = listDirectoryTree(root);
+    files.push_back({root / "missing.txt", "photos", 1});
+    REQUIRE(DirectoryClient(links, 100).send(files) == 1);
+
+    std::map<std::string, std::string> contentBySisl;
+    for (const auto& [sessionId, file] : receivedFiles(spies))
+    {
+      contentBySisl[file.eofSisl] = file.content;
+    }
+    REQUIRE(contentBySisl == std::map<std::string, std::string>{
+      {"{name: !str \"a.txt\", path: !str \"photos\"}", "AAAAA"},
+      {"{name: !str \"b.txt\", path: !str \"photos/2021\"}", "BB"},
+      {"{name: !str \"c.txt\", path: !str \"photos/2021/q1\"}", "C"}});
+  }
+
+  SECTION("Small files are packed together, spread over packs for every link")
+  {
+    std::vector<std::shared_ptr<UdpClientSpy>> spies;
+    std::vector<DirectoryClient::Link> links;
+    for (auto link = 0; link < 2; ++link)
+    {
+      spies.push_back(std::make_shared<UdpClientSpy>());
+      links.push_back({spies.back(), std::make_shared<Timer>(0)});
+    }
+
+    auto files = listDirectoryTree(root);
+    files.push_back({root / "missing.txt", "photos", 1});
+    REQUIRE(DirectoryClient(links, 100, false, {}, {}, {}, 2).send(files) == 1);
+
+    std::map<std::string, std::string> unpacked;
+    std::size_t packs = 0;
+    std::string unpackedFile;
+    for (const auto& [sessionId, file] : receivedFiles(spies))
+    {
+      if (file.packed)
+      {
+        ++packs;
+        unpacked.merge(unpack(file.content));
+      }
+      else
+      {
+        unpackedFile = file.content;
+      }
+    }
+    REQUIRE(packs == 2);
+    REQUIRE(unpacked == std::map<std::string, std::string>{
+      {"photos/2021/b.txt", "BB"}, {"photos/2021/q1/c.txt", "C"}});
+    REQUIRE(unpackedFile == "AAAAA");
+  }
+
+  SECTION("The packer reads the files as one stream of entries")
+  {
+    FilePacker packer(listDirectoryTree(root));
+    std::istream input(&packer);
+    const std::string content{std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+    REQUIRE(unpack(content) == std::map<std::string, std::string>{
+      {"photos/2021/b.txt", "BB"}, {"photos/2021/q1/c.txt", "C"}, {"photos/a.txt", "AAAAA"}});
+    REQUIRE(packer.failures() == 0);
+  }
+
+  std::filesystem::remove_all(base);
+}
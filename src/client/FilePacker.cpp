@@ -0,0 +1,56 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "FilePacker.hpp"
+#include <fstream>
+#include "spdlog/spdlog.h"
+#include "PackFormat.hpp"
+
+FilePacker::FilePacker(std::vector<TreeFile> files):
+  files(std::move(files))
+{
+}
+
+std::size_t FilePacker::failures() const
+{
+  return failed;
+}
+
+FilePacker::int_type FilePacker::underflow()
+{
+  if (gptr() == egptr() && !loadNextEntry())
+  {
+    return traits_type::eof();
+  }
+  return traits_type::to_int_type(*gptr());
+}
+
+bool FilePacker::loadNextEntry()
+{
+  while (nextFile < files.size())
+  {
+    const auto& file = files[nextFile++];
+    const auto filename = file.path.filename().string();
+    const auto name = file.relativePath.empty() ? filename : file.relativePath + "/" + filename;
+    std::ifstream input(file.path, std::ios::binary);
+    if (!input || !PackFormat::isValidName(name))
+    {
+      spdlog::error("Unable to pack {}", file.path.string());
+      ++failed;
+      continue;
+    }
+
+    const auto contentOffset = PackFormat::entryHeaderSizeInBytes + name.size();
+    entry.resize(contentOffset + file.size);
+    input.read(entry.data() + contentOffset, static_cast<std::streamsize>(file.size));
+    entry.resize(contentOffset + static_cast<std::size_t>(input.gcount()));
+
+    const auto header = PackFormat::writeEntryHeader(
+      {static_cast<std::uint16_t>(name.size()), static_cast<std::uint64_t>(input.gcount())});
+    std::copy(header.begin(), header.end(), entry.begin());
+    std::copy(name.begin(), name.end(), entry.begin() + PackFormat::entryHeaderSizeInBytes);
+    setg(entry.data(), entry.data(), entry.data() + entry.size());
+    return true;
+  }
+  return false;
+}
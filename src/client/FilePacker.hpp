@@ -0,0 +1,32 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef FILEPACKER_HPP
+#define FILEPACKER_HPP
+
+#include <streambuf>
+#include <vector>
+#include "DirectoryTree.hpp"
+
+// Reads a list of small files as the payload stream of a packed session, see PackFormat.hpp, loading one file at a
+// time. A file that cannot be read is logged and left out of the pack.
+class FilePacker : public std::streambuf
+{
+public:
+  explicit FilePacker(std::vector<TreeFile> files);
+
+  [[nodiscard]] std::size_t failures() const;
+
+protected:
+  int_type underflow() override;
+
+private:
+  bool loadNextEntry();
+
+  const std::vector<TreeFile> files;
+  std::size_t nextFile = 0;
+  std::vector<char> entry;
+  std::size_t failed = 0;
+};
+
+#endif //FILEPACKER_HPP
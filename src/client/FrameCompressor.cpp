@@ -0,0 +1,48 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "FrameCompressor.hpp"
+#include <cstring>
+#include "FrameCompression.hpp"
+
+FrameCompressor::FrameCompressor(FrameSource& reader, std::size_t maxPayloadSize):
+  reader(reader),
+  pendingInput(2 * FrameCompression::maxDecompressedSizeInBytes + maxPayloadSize),
+  frame(maxPayloadSize)
+{
+}
+
+boost::asio::const_buffer FrameCompressor::nextFrame()
+{
+  fillPendingInput();
+  if (pendingBegin == pendingEnd)
+  {
+    return {};
+  }
+  const auto compressed = FrameCompression::compressFrame(
+    pendingInput.data() + pendingBegin, pendingEnd - pendingBegin, frame.data(), frame.size());
+  pendingBegin += compressed.inputBytesUsed;
+  return boost::asio::buffer(frame.data(), compressed.frameLength);
+}
+
+// Keeps at least a full compression block pending, unless the input has run out.
+void FrameCompressor::fillPendingInput()
+{
+  while (!inputExhausted && pendingEnd - pendingBegin < FrameCompression::maxDecompressedSizeInBytes)
+  {
+    const auto input = reader.nextFrame();
+    if (input.size() == 0)
+    {
+      inputExhausted = true;
+      return;
+    }
+    if (pendingEnd + input.size() > pendingInput.size())
+    {
+      std::memmove(pendingInput.data(), pendingInput.data() + pendingBegin, pendingEnd - pendingBegin);
+      pendingEnd -= pendingBegin;
+      pendingBegin = 0;
+    }
+    std::memcpy(pendingInput.data() + pendingEnd, input.data(), input.size());
+    pendingEnd += input.size();
+  }
+}
@@ -0,0 +1,33 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef FRAMECOMPRESSOR_HPP
+#define FRAMECOMPRESSOR_HPP
+
+#include <cstddef>
+#include <vector>
+#include <boost/asio/buffer.hpp>
+#include "FrameSource.hpp"
+
+// Packs the input into frames of at most maxPayloadSize bytes, each holding one independently
+// compressed block in the FrameCompression format.
+class FrameCompressor : public FrameSource
+{
+public:
+  FrameCompressor(FrameSource& reader, std::size_t maxPayloadSize);
+
+  // The next compressed frame, empty once the input is exhausted. The frame stays valid until the next call.
+  boost::asio::const_buffer nextFrame() override;
+
+private:
+  void fillPendingInput();
+
+  FrameSource& reader;
+  bool inputExhausted = false;
+  std::vector<char> pendingInput;
+  std::size_t pendingBegin = 0;
+  std::size_t pendingEnd = 0;
+  std::vector<char> frame;
+};
+
+#endif //FRAMECOMPRESSOR_HPP
@@ -0,0 +1,140 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <random>
+#include <sstream>
+#include <string>
+#include "test/catch.hpp"
+#include "FrameCompression.hpp"
+#include "FrameCompressor.hpp"
+#include "ReadAheadReader.hpp"
+
+namespace
+{
+  std::vector<BytesBuffer> compressAll(const std::string& input, std::size_t maxPayloadSize)
+  {
+    std::stringstream inputStream(input);
+    ReadAheadReader reader(inputStream, maxPayloadSize, 4096, 2);
+    FrameCompressor compressor(reader, maxPayloadSize);
+    std::vector<BytesBuffer> frames;
+    for (auto frame = compressor.nextFrame(); frame.size() > 0; frame = compressor.nextFrame())
+    {
+      const auto* data = static_cast<const std::uint8_t*>(frame.data());
+      frames.emplace_back(data, data + frame.size());
+    }
+    return frames;
+  }
+
+  std::string decompressAll(const std::vector<BytesBuffer>& frames)
+  {
+    std::string output;
+    BytesBuffer decompressed;
+    for (const auto& frame : frames)
+    {
+      FrameCompression::decompressFrame(frame, decompressed);
+      output.append(decompressed.begin(), decompressed.end());
+    }
+    return output;
+  }
+
+  std::string logText(std::size_t size)
+  {
+    std::string text;
+    for (std::size_t line = 0; text.size() < size; ++line)
+    {
+      text += "2021-06-01 12:00:00 INFO session " + std::to_string(line % 97) + " frame received\n";
+    }
+    text.resize(size);
+    return text;
+  }
+
+  std::string randomBytes(std::size_t size)
+  {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, 255);
+    std::string bytes(size, '\0');
+    for (auto& byte : bytes)
+    {
+      byte = static_cast<char>(distribution(generator));
+    }
+    return bytes;
+  }
+}
+
+TEST_CASE("Frame compressor. Compressible input round trips in fewer frames than uncompressed")
+{
+  const auto input = logText(300000);
+  const auto frames = compressAll(input, 1400);
+
+  REQUIRE(decompressAll(frames) == input);
+  REQUIRE(frames.size() < input.size() / 1400 / 4);
+  for (const auto& frame : frames)
+  {
+    REQUIRE(frame.size() <= 1400);
+  }
+}
+
+TEST_CASE("Frame compressor. Incompressible input round trips")
+{
+  const auto input = randomBytes(100000);
+  const auto frames = compressAll(input, 1400);
+
+  REQUIRE(decompressAll(frames) == input);
+  for (const auto& frame : frames)
+  {
+    REQUIRE(frame.size() <= 1400);
+  }
+}
+
+TEST_CASE("Frame compressor. Frames decompress independently")
+{
+  const auto input = logText(200000);
+  const auto frames = compressAll(input, 1400);
+  REQUIRE(frames.size() > 2);
+
+  BytesBuffer first;
+  BytesBuffer last;
+  FrameCompression::decompressFrame(frames.back(), last);
+  FrameCompression::decompressFrame(frames.front(), first);
+
+  REQUIRE(std::string(first.begin(), first.end()) == input.substr(0, first.size()));
+  REQUIRE(std::string(last.begin(), last.end()) == input.substr(input.size() - last.size()));
+}
+
+TEST_CASE("Frame compressor. Empty input produces no frames")
+{
+  REQUIRE(compressAll("", 1400).empty());
+}
+
+TEST_CASE("Frame compression. Invalid frames are rejected")
+{
+  const auto frames = compressAll(logText(10000), 1400);
+  BytesBuffer output;
+
+  SECTION("Too short for the length")
+  {
+    REQUIRE_THROWS_AS(FrameCompression::decompressFrame({1, 0, 0}, output), std::runtime_error);
+  }
+  SECTION("Zero length")
+  {
+    REQUIRE_THROWS_AS(FrameCompression::decompressFrame({0, 0, 0, 0, 0}, output), std::runtime_error);
+  }
+  SECTION("Length over the maximum")
+  {
+    auto frame = frames.front();
+    frame[2] = 0x01;
+    REQUIRE_THROWS_AS(FrameCompression::decompressFrame(frame, output), std::runtime_error);
+  }
+  SECTION("Length not matching the block")
+  {
+    auto frame = frames.front();
+    frame[0] = static_cast<std::uint8_t>(frame[0] - 1);
+    REQUIRE_THROWS_AS(FrameCompression::decompressFrame(frame, output), std::runtime_error);
+  }
+  SECTION("Truncated block")
+  {
+    auto frame = frames.front();
+    frame.resize(frame.size() / 2);
+    REQUIRE_THROWS_AS(FrameCompression::decompressFrame(frame, output), std::runtime_error);
+  }
+}
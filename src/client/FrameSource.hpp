@@ -0,0 +1,20 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef FRAMESOURCE_HPP
+#define FRAMESOURCE_HPP
+
+#include <boost/asio/buffer.hpp>
+
+// Where the client takes the payload of each frame from: a file, a stream or memory.
+class FrameSource
+{
+public:
+  virtual ~FrameSource() = default;
+
+  // The next frame, of at most the source's frame size, and empty once the input is exhausted. The frame stays
+  // valid until the next call.
+  virtual boost::asio::const_buffer nextFrame() = 0;
+};
+
+#endif //FRAMESOURCE_HPP
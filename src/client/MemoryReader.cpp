@@ -0,0 +1,59 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "MemoryReader.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+MemoryReader::MemoryReader(std::vector<boost::asio::const_buffer> buffers, std::size_t frameSize):
+  buffers(std::move(buffers)),
+  frameSize(frameSize)
+{
+  if (frameSize == 0)
+  {
+    throw std::runtime_error("Frames must hold at least one byte");
+  }
+  skipEmptyBuffers();
+}
+
+boost::asio::const_buffer MemoryReader::nextFrame()
+{
+  if (currentBuffer == buffers.size())
+  {
+    return {};
+  }
+
+  const auto& buffer = buffers[currentBuffer];
+  const auto* data = static_cast<const char*>(buffer.data());
+  if (buffer.size() - offset >= frameSize || currentBuffer + 1 == buffers.size())
+  {
+    const auto length = std::min(frameSize, buffer.size() - offset);
+    const auto frame = boost::asio::buffer(data + offset, length);
+    offset += length;
+    skipEmptyBuffers();
+    return frame;
+  }
+
+  scratch.resize(frameSize);
+  std::size_t length = 0;
+  while (length < frameSize && currentBuffer < buffers.size())
+  {
+    const auto& next = buffers[currentBuffer];
+    const auto chunk = std::min(frameSize - length, next.size() - offset);
+    std::memcpy(scratch.data() + length, static_cast<const char*>(next.data()) + offset, chunk);
+    length += chunk;
+    offset += chunk;
+    skipEmptyBuffers();
+  }
+  return boost::asio::buffer(scratch.data(), length);
+}
+
+void MemoryReader::skipEmptyBuffers()
+{
+  while (currentBuffer < buffers.size() && offset == buffers[currentBuffer].size())
+  {
+    ++currentBuffer;
+    offset = 0;
+  }
+}
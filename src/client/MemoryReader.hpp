@@ -0,0 +1,32 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef MEMORYREADER_HPP
+#define MEMORYREADER_HPP
+
+#include <cstddef>
+#include <vector>
+#include <boost/asio/buffer.hpp>
+#include "FrameSource.hpp"
+
+// Slices data held in memory, in one or more buffers, into frames of frameSize bytes. A frame that lies within one
+// buffer is sent from it in place, so sending from memory costs no copy; only a frame that spans two buffers is
+// gathered into a scratch frame first. The buffers must stay valid until the send completes.
+class MemoryReader : public FrameSource
+{
+public:
+  MemoryReader(std::vector<boost::asio::const_buffer> buffers, std::size_t frameSize);
+
+  boost::asio::const_buffer nextFrame() override;
+
+private:
+  void skipEmptyBuffers();
+
+  const std::vector<boost::asio::const_buffer> buffers;
+  const std::size_t frameSize;
+  std::size_t currentBuffer = 0;
+  std::size_t offset = 0;
+  std::vector<char> scratch;
+};
+
+#endif //MEMORYREADER_HPP
@@ -0,0 +1,53 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <string>
+#include "test/catch.hpp"
+#include "MemoryReader.hpp"
+
+namespace
+{
+  std::string toString(boost::asio::const_buffer frame)
+  {
+    return {static_cast<const char*>(frame.data()), frame.size()};
+  }
+}
+
+TEST_CASE("Memory reader. Frames within one buffer are sent from it in place")
+{
+  const std::string data = "abcdefghij";
+  MemoryReader reader({boost::asio::buffer(data)}, 4);
+
+  const auto first = reader.nextFrame();
+  REQUIRE(first.data() == data.data());
+  REQUIRE(toString(first) == "abcd");
+  REQUIRE(toString(reader.nextFrame()) == "efgh");
+  REQUIRE(toString(reader.nextFrame()) == "ij");
+  REQUIRE(reader.nextFrame().size() == 0);
+  REQUIRE(reader.nextFrame().size() == 0);
+}
+
+TEST_CASE("Memory reader. Frames that span buffers are gathered, passing over empty buffers")
+{
+  const std::string first = "abc";
+  const std::string empty;
+  const std::string second = "defgh";
+  const std::string third = "ij";
+  MemoryReader reader(
+    {boost::asio::buffer(first), boost::asio::buffer(empty), boost::asio::buffer(second), boost::asio::buffer(third)},
+    4);
+
+  REQUIRE(toString(reader.nextFrame()) == "abcd");
+  const auto inPlace = reader.nextFrame();
+  REQUIRE(toString(inPlace) == "efgh");
+  REQUIRE(inPlace.data() == second.data() + 1);
+  REQUIRE(toString(reader.nextFrame()) == "ij");
+  REQUIRE(reader.nextFrame().size() == 0);
+}
+
+TEST_CASE("Memory reader. No buffers, or only empty ones, is an empty input")
+{
+  const std::string empty;
+  REQUIRE(MemoryReader({}, 4).nextFrame().size() == 0);
+  REQUIRE(MemoryReader({boost::asio::buffer(empty)}, 4).nextFrame().size() == 0);
+}
@@ -0,0 +1,118 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "ReadAheadReader.hpp"
+#include <algorithm>
+#include <new>
+
+ReadAheadReader::ReadAheadReader(
+  std::istream& inputStream,
+  std::size_t frameSize,
+  std::size_t blockSize,
+  std::size_t blockCount,
+  ThreadTuning::ThreadSettings readerThread):
+    inputStream(inputStream),
+    frameSize(frameSize),
+    blockSize(std::max<std::size_t>(1, blockSize / frameSize) * frameSize),
+    blocks(std::max<std::size_t>(2, blockCount))
+{
+  for (auto& block : blocks)
+  {
+    block.data.reset(new (std::align_val_t(readAheadBlockAlignment)) char[this->blockSize]);
+  }
+  reader = std::thread([this, readerThread = std::move(readerThread)]() { readBlocks(readerThread); });
+}
+
+ReadAheadReader::~ReadAheadReader()
+{
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  blockReleased.notify_one();
+  reader.join();
+}
+
+void ReadAheadReader::AlignedDelete::operator()(char* data) const
+{
+  operator delete[](data, std::align_val_t(readAheadBlockAlignment));
+}
+
+boost::asio::const_buffer ReadAheadReader::nextFrame()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  if (holdingBlock && sendingOffset == blocks[sendingBlock].length)
+  {
+    if (blocks[sendingBlock].last)
+    {
+      return {};
+    }
+    holdingBlock = false;
+    --filledBlocks;
+    sendingBlock = (sendingBlock + 1) % blocks.size();
+    sendingOffset = 0;
+    blockReleased.notify_one();
+  }
+
+  if (!holdingBlock)
+  {
+    blockFilled.wait(lock, [this]() { return filledBlocks > 0 || readError; });
+    if (filledBlocks == 0)
+    {
+      std::rethrow_exception(readError);
+    }
+    holdingBlock = true;
+  }
+
+  const auto& block = blocks[sendingBlock];
+  const auto length = std::min(frameSize, block.length - sendingOffset);
+  const auto frame = boost::asio::buffer(block.data.get() + sendingOffset, length);
+  sendingOffset += length;
+  return frame;
+}
+
+void ReadAheadReader::readBlocks(const ThreadTuning::ThreadSettings& readerThread)
+{
+  try
+  {
+    ThreadTuning::applyToCurrentThread(readerThread);
+    for (std::size_t next = 0;; next = (next + 1) % blocks.size())
+    {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        blockReleased.wait(lock, [this]() { return stopping || filledBlocks < blocks.size(); });
+        if (stopping)
+        {
+          return;
+        }
+      }
+
+      const auto last = fillBlock(blocks[next]);
+      {
+        const std::lock_guard<std::mutex> lock(mutex);
+        ++filledBlocks;
+      }
+      blockFilled.notify_one();
+      if (last)
+      {
+        return;
+      }
+    }
+  }
+  catch (...)
+  {
+    {
+      const std::lock_guard<std::mutex> lock(mutex);
+      readError = std::current_exception();
+    }
+    blockFilled.notify_one();
+  }
+}
+
+bool ReadAheadReader::fillBlock(Block& block)
+{
+  inputStream.read(block.data.get(), static_cast<std::streamsize>(blockSize));
+  block.length = static_cast<std::size_t>(inputStream.gcount());
+  block.last = block.length < blockSize;
+  return block.last;
+}
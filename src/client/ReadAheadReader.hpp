@@ -0,0 +1,78 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef READAHEADREADER_HPP
+#define READAHEADREADER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <boost/asio/buffer.hpp>
+#include "FrameSource.hpp"
+#include "ThreadTuning.hpp"
+
+constexpr std::size_t readAheadBlockSizeInBytes = 1024 * 1024;
+constexpr std::size_t readAheadBlockCount = 4;
+constexpr std::size_t readAheadBlockAlignment = 4096;
+
+// Reads the input stream on its own thread into a ring of page aligned blocks, so the sending thread only slices
+// filled blocks into frames and a slow read does not hold up the packet stream. Each block holds a whole number of
+// frames, so a frame never spans two blocks.
+class ReadAheadReader : public FrameSource
+{
+public:
+  ReadAheadReader(std::istream& inputStream,
+    std::size_t frameSize,
+    std::size_t blockSize = readAheadBlockSizeInBytes,
+    std::size_t blockCount = readAheadBlockCount,
+    ThreadTuning::ThreadSettings readerThread = {});
+  ~ReadAheadReader() override;
+
+  ReadAheadReader(const ReadAheadReader&) = delete;
+  ReadAheadReader& operator=(const ReadAheadReader&) = delete;
+
+  // The next frameSize bytes of the input, fewer for the final frame, and empty once the input is exhausted.
+  // The frame stays valid until the next call. Rethrows any exception raised while reading the input, or while
+  // applying the reader thread settings.
+  boost::asio::const_buffer nextFrame() override;
+
+private:
+  struct AlignedDelete
+  {
+    void operator()(char* data) const;
+  };
+
+  struct Block
+  {
+    std::unique_ptr<char[], AlignedDelete> data;
+    std::size_t length;
+    bool last;
+  };
+
+  void readBlocks(const ThreadTuning::ThreadSettings& readerThread);
+  bool fillBlock(Block& block);
+
+  std::istream& inputStream;
+  const std::size_t frameSize;
+  const std::size_t blockSize;
+  std::vector<Block> blocks;
+
+  std::mutex mutex;
+  std::condition_variable blockFilled;
+  std::condition_variable blockReleased;
+  std::size_t filledBlocks = 0;
+  std::size_t sendingBlock = 0;
+  std::size_t sendingOffset = 0;
+  bool holdingBlock = false;
+  bool stopping = false;
+  std::exception_ptr readError;
+
+  std::thread reader;
+};
+
+#endif //READAHEADREADER_HPP
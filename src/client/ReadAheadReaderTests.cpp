@@ -0,0 +1,104 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <sstream>
+#include <string>
+#include "test/catch.hpp"
+#include "ReadAheadReader.hpp"
+
+namespace
+{
+  std::string frameToString(const boost::asio::const_buffer& frame)
+  {
+    return {static_cast<const char*>(frame.data()), frame.size()};
+  }
+
+  std::vector<std::string> readAllFrames(ReadAheadReader& reader)
+  {
+    std::vector<std::string> frames;
+    for (auto frame = reader.nextFrame(); frame.size() > 0; frame = reader.nextFrame())
+    {
+      frames.push_back(frameToString(frame));
+    }
+    return frames;
+  }
+
+  class FailingStreamBuffer : public std::streambuf
+  {
+  protected:
+    int_type underflow() override
+    {
+      throw std::runtime_error("read failed");
+    }
+  };
+}
+
+TEST_CASE("Read ahead reader. Input is sliced into frames across blocks")
+{
+  std::stringstream input("abcdefghijklmnopq");
+  ReadAheadReader reader(input, 3, 6, 2);
+
+  REQUIRE(readAllFrames(reader) == std::vector<std::string>{"abc", "def", "ghi", "jkl", "mno", "pq"});
+  REQUIRE(reader.nextFrame().size() == 0);
+}
+
+TEST_CASE("Read ahead reader. Input ending on a block boundary")
+{
+  std::stringstream input("abcdef");
+  ReadAheadReader reader(input, 3, 6, 2);
+
+  REQUIRE(readAllFrames(reader) == std::vector<std::string>{"abc", "def"});
+  REQUIRE(reader.nextFrame().size() == 0);
+}
+
+TEST_CASE("Read ahead reader. Empty input has no frames")
+{
+  std::stringstream input("");
+  ReadAheadReader reader(input, 3);
+
+  REQUIRE(reader.nextFrame().size() == 0);
+}
+
+TEST_CASE("Read ahead reader. Block size is rounded down to a whole number of frames")
+{
+  std::stringstream input("abcdefghij");
+  ReadAheadReader reader(input, 4, 7, 2);
+
+  REQUIRE(readAllFrames(reader) == std::vector<std::string>{"abcd", "efgh", "ij"});
+}
+
+TEST_CASE("Read ahead reader. Large input through a small ring")
+{
+  std::string data(100000, '\0');
+  for (auto i = 0u; i < data.size(); ++i)
+  {
+    data[i] = static_cast<char>(i % 251);
+  }
+  std::stringstream input(data);
+  ReadAheadReader reader(input, 1000, 4000, 2);
+
+  std::string received;
+  for (const auto& frame : readAllFrames(reader))
+  {
+    received += frame;
+  }
+  REQUIRE(received == data);
+}
+
+TEST_CASE("Read ahead reader. Read errors are rethrown to the sender")
+{
+  FailingStreamBuffer buffer;
+  std::istream input(&buffer);
+  input.exceptions(std::istream::badbit);
+  ReadAheadReader reader(input, 3);
+
+  REQUIRE_THROWS(reader.nextFrame());
+}
+
+TEST_CASE("Read ahead reader. Can be destroyed before the input is consumed")
+{
+  std::stringstream input(std::string(100000, 'x'));
+  ReadAheadReader reader(input, 10, 100, 2);
+
+  REQUIRE(frameToString(reader.nextFrame()) == std::string(10, 'x'));
+}
@@ -0,0 +1,98 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "ResumableTransfer.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+  constexpr std::uint64_t hashMultiplier = 0x9E3779B97F4A7C15;
+
+  std::uint64_t mix(std::uint64_t hash, std::uint64_t word)
+  {
+    hash ^= word;
+    hash *= hashMultiplier;
+    return hash ^ (hash >> 29);
+  }
+
+  // Mixes in a block eight bytes at a time, with any tail bytes packed into a final word.
+  std::uint64_t mixBytes(std::uint64_t hash, const char* data, std::size_t length)
+  {
+    std::size_t offset = 0;
+    for (; offset + sizeof(std::uint64_t) <= length; offset += sizeof(std::uint64_t))
+    {
+      std::uint64_t word;
+      std::memcpy(&word, data + offset, sizeof(word));
+      hash = mix(hash, word);
+    }
+    if (offset < length)
+    {
+      std::uint64_t word = 0;
+      std::memcpy(&word, data + offset, length - offset);
+      hash = mix(hash, word);
+    }
+    return hash;
+  }
+
+  std::uint32_t parseFrameCount(std::string_view number, std::string_view list)
+  {
+    std::uint32_t value{};
+    const auto result = std::from_chars(number.data(), number.data() + number.size(), value);
+    if (number.empty() || result.ec != std::errc() || result.ptr != number.data() + number.size() || value == 0)
+    {
+      throw std::runtime_error("Invalid frame list: " + std::string(list));
+    }
+    return value;
+  }
+}
+
+std::vector<FrameRange> parseFrameRanges(std::string_view list)
+{
+  std::vector<FrameRange> ranges;
+  for (std::size_t begin = 0, end = 0; end < list.size(); begin = end + 1)
+  {
+    end = std::min(list.find(',', begin), list.size());
+    const auto range = list.substr(begin, end - begin);
+    const auto dash = range.find('-');
+    const auto first = parseFrameCount(range.substr(0, dash), list);
+    auto last = first;
+    if (dash != std::string_view::npos)
+    {
+      last = dash + 1 == range.size() ? std::numeric_limits<std::uint32_t>::max()
+                                      : parseFrameCount(range.substr(dash + 1), list);
+    }
+    if (last < first)
+    {
+      throw std::runtime_error("Invalid frame list: " + std::string(list));
+    }
+    ranges.push_back({first, last});
+  }
+  return ranges;
+}
+
+ContentId calculateContentId(std::istream& inputStream, const std::string& filename, std::uint32_t frameSize)
+{
+  std::uint64_t hash = mixBytes(hashMultiplier, filename.data(), filename.size());
+  hash = mix(hash, frameSize);
+
+  std::vector<char> block(1024 * 1024);
+  std::uint64_t size = 0;
+  while (inputStream)
+  {
+    inputStream.read(block.data(), static_cast<std::streamsize>(block.size()));
+    const auto length = static_cast<std::size_t>(inputStream.gcount());
+    hash = mixBytes(hash, block.data(), length);
+    size += length;
+  }
+  hash = mix(hash, size);
+  inputStream.clear();
+  inputStream.seekg(0);
+  if (!inputStream)
+  {
+    throw std::runtime_error("Resumable sends need a seekable input");
+  }
+  return {static_cast<std::uint32_t>(hash ^ (hash >> 32)), size};
+}
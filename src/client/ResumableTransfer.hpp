@@ -0,0 +1,47 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef RESUMABLETRANSFER_HPP
+#define RESUMABLETRANSFER_HPP
+
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Inclusive range of frame counts to send; frame n holds file bytes from (n - 1) * frameSize.
+struct FrameRange
+{
+  std::uint32_t first;
+  std::uint32_t last;
+
+  bool operator==(const FrameRange& rhs) const { return first == rhs.first && last == rhs.last; }
+};
+
+// A resumable send tags every frame so the server can write it straight to its place in the file and carry on
+// from where an earlier, interrupted send of the same file left off.
+struct ResumeOptions
+{
+  bool enabled;
+  // Frames to send, all of them if empty. The EOF frame is always sent last.
+  std::vector<FrameRange> frames;
+  // Number of times to send the frames, to ride out loss on a link that can never ask for a resend.
+  unsigned int passes;
+};
+
+struct ContentId
+{
+  std::uint32_t sessionId;
+  std::uint64_t size;
+};
+
+// Parses a list such as "1-100,250,4000-", where an open range runs to the end of the file.
+std::vector<FrameRange> parseFrameRanges(std::string_view list);
+
+// Session ID derived from the whole content of the stream, its filename and the frame size, so that every send of
+// the same file with the same MTU resumes the same session. Reads the stream to the end and rewinds it.
+ContentId calculateContentId(std::istream& inputStream, const std::string& filename, std::uint32_t frameSize);
+
+#endif //RESUMABLETRANSFER_HPP
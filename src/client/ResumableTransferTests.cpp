@@ -0,0 +1,117 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "test/catch.hpp"
+#include "test/EnterpriseDiodeTestHelpers.hpp"
+#include "diodeheader/EnterpriseDiodeHeader.hpp"
+#include "Client.hpp"
+#include "ResumableTransfer.hpp"
+#include "Timer.hpp"
+
+namespace
+{
+  std::uint32_t readField(const BytesBuffer& packet, std::uint32_t index)
+  {
+    std::uint32_t value;
+    std::memcpy(&value, packet.data() + index, sizeof(value));
+    return value;
+  }
+}
+
+TEST_CASE("Resumable transfer. Frame lists are parsed")
+{
+  REQUIRE(parseFrameRanges("").empty());
+  REQUIRE(parseFrameRanges("7") == std::vector<FrameRange>{{7, 7}});
+  REQUIRE(parseFrameRanges("1-100,250,4000-") ==
+          std::vector<FrameRange>{{1, 100}, {250, 250}, {4000, std::numeric_limits<std::uint32_t>::max()}});
+
+  for (const auto list : {"0", "a", "1,", "5-2", "-3", "1-2-3", "1 2", "99999999999"})
+  {
+    INFO(list);
+    REQUIRE_THROWS_AS(parseFrameRanges(list), std::runtime_error);
+  }
+}
+
+TEST_CASE("Resumable transfer. Content ID depends on the content, filename and frame size")
+{
+  std::stringstream content(std::string(3000000, 'x'));
+  const auto contentId = calculateContentId(content, "file.bin", 1360);
+  REQUIRE(contentId.size == 3000000);
+  REQUIRE(content.tellg() == 0);
+
+  std::stringstream sameContent(std::string(3000000, 'x'));
+  REQUIRE(calculateContentId(sameContent, "file.bin", 1360).sessionId == contentId.sessionId);
+  sameContent.seekg(0);
+  REQUIRE(calculateContentId(sameContent, "other.bin", 1360).sessionId != contentId.sessionId);
+  sameContent.seekg(0);
+  REQUIRE(calculateContentId(sameContent, "file.bin", 8860).sessionId != contentId.sessionId);
+
+  auto changed = std::string(3000000, 'x');
+  changed[2999999] = 'y';
+  std::stringstream changedContent(changed);
+  REQUIRE(calculateContentId(changedContent, "file.bin", 1360).sessionId != contentId.sessionId);
+}
+
+TEST_CASE("Resumable transfer. Client sends the chosen frames under the content ID")
+{
+  auto udpClientSpy = std::make_shared<UdpClientSpy>();
+  const std::string data = "AABBCCDDE";
+
+  SECTION("Every frame is sent by default, with the frame size and EOF frame in each header")
+  {
+    Client edClient(udpClientSpy, std::make_shared<Timer>(0), 2, "file.bin", false, {}, {true, {}, 1});
+    std::stringstream input(data);
+    edClient.send(input);
+
+    REQUIRE(udpClientSpy->buffersSent.size() == 6);
+    for (std::uint32_t frame = 1; frame <= 6; ++frame)
+    {
+      const auto& packet = udpClientSpy->buffersSent.at(frame - 1);
+      REQUIRE(readField(packet, EnterpriseDiode::FrameCountIndex) == frame);
+      REQUIRE(packet.at(EnterpriseDiode::ResumableFlagIndex) == 1);
+      REQUIRE(readField(packet, EnterpriseDiode::ResumeFrameSizeIndex) == 2);
+      REQUIRE(readField(packet, EnterpriseDiode::ResumeEOFFrameIndex) == 6);
+    }
+    REQUIRE(udpClientSpy->buffersSent.at(5).at(EnterpriseDiode::EOFFlagIndex));
+
+    std::stringstream sameInput(data);
+    REQUIRE(readField(udpClientSpy->buffersSent.at(0), EnterpriseDiode::SessionIDIndex) ==
+            calculateContentId(sameInput, "file.bin", 2).sessionId);
+  }
+
+  SECTION("Only the chosen frames are sent, then the EOF frame")
+  {
+    Client edClient(udpClientSpy, std::make_shared<Timer>(0), 2, "file.bin", false, {},
+      {true, {{2, 2}, {4, 100}}, 2});
+    std::stringstream input(data);
+    edClient.send(input);
+
+    std::vector<std::pair<std::uint32_t, std::string>> framesSent;
+    for (const auto& packet : udpClientSpy->buffersSent)
+    {
+      framesSent.emplace_back(
+        readField(packet, EnterpriseDiode::FrameCountIndex),
+        std::string(packet.begin() + EnterpriseDiode::HeaderSizeInBytes, packet.end()));
+    }
+    REQUIRE(framesSent.size() == 7);
+    REQUIRE(framesSent.at(0) == std::make_pair(2u, std::string("BB")));
+    REQUIRE(framesSent.at(1) == std::make_pair(4u, std::string("DD")));
+    REQUIRE(framesSent.at(2) == std::make_pair(5u, std::string("E")));
+    REQUIRE(framesSent.at(3) == std::make_pair(2u, std::string("BB")));
+    REQUIRE(framesSent.at(6).first == 6);
+    REQUIRE(udpClientSpy->buffersSent.at(6).at(EnterpriseDiode::EOFFlagIndex));
+  }
+
+  SECTION("Resumable sends cannot be compressed, and only resumable sends take frame ranges")
+  {
+    REQUIRE_THROWS_AS(
+      Client(udpClientSpy, std::make_shared<Timer>(0), 2, "file.bin", true, {}, {true, {}, 1}), std::runtime_error);
+    REQUIRE_THROWS_AS(
+      Client(udpClientSpy, std::make_shared<Timer>(0), 2, "file.bin", false, {}, {false, {{1, 1}}, 1}),
+      std::runtime_error);
+  }
+}
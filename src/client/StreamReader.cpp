@@ -0,0 +1,87 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "StreamReader.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <poll.h>
+#include <unistd.h>
+
+StreamReader::StreamReader(int fileDescriptor, std::size_t frameSize, std::chrono::milliseconds flushLatency,
+  std::chrono::milliseconds keepaliveInterval):
+    fileDescriptor(fileDescriptor),
+    flushLatency(flushLatency),
+    keepaliveInterval(keepaliveInterval),
+    frame(frameSize)
+{
+  if (frameSize == 0)
+  {
+    throw std::runtime_error("Stream frames must hold at least one byte");
+  }
+}
+
+boost::asio::const_buffer StreamReader::nextFrame()
+{
+  using Clock = std::chrono::steady_clock;
+  std::size_t length = 0;
+  Clock::time_point flushTime;
+  wasQuiet = false;
+  while (!closed && length < frame.size())
+  {
+    const auto timeout = length == 0 ? keepaliveInterval :
+      std::chrono::ceil<std::chrono::milliseconds>(flushTime - Clock::now());
+    if (length != 0 && timeout.count() <= 0)
+    {
+      break;
+    }
+    if (!waitForInput(timeout))
+    {
+      wasQuiet = length == 0;
+      break;
+    }
+
+    const auto bytesRead = read(fileDescriptor, frame.data() + length, frame.size() - length);
+    if (bytesRead < 0 && (errno == EINTR || errno == EAGAIN))
+    {
+      continue;
+    }
+    if (bytesRead < 0)
+    {
+      throw std::runtime_error(std::string("Unable to read the input stream: ") + std::strerror(errno));
+    }
+    if (bytesRead == 0)
+    {
+      closed = true;
+    }
+    else if (length == 0)
+    {
+      flushTime = Clock::now() + flushLatency;
+    }
+    length += static_cast<std::size_t>(bytesRead);
+  }
+  return boost::asio::buffer(frame.data(), length);
+}
+
+bool StreamReader::quiet() const
+{
+  return wasQuiet;
+}
+
+bool StreamReader::waitForInput(std::chrono::milliseconds timeout) const
+{
+  pollfd input{fileDescriptor, POLLIN, 0};
+  while (true)
+  {
+    const auto ready = poll(&input, 1, static_cast<int>(timeout.count()));
+    if (ready >= 0)
+    {
+      return ready > 0;
+    }
+    if (errno != EINTR)
+    {
+      throw std::runtime_error(std::string("Unable to wait for the input stream: ") + std::strerror(errno));
+    }
+  }
+}
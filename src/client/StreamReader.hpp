@@ -0,0 +1,47 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef STREAMREADER_HPP
+#define STREAMREADER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+#include <boost/asio/buffer.hpp>
+#include "FrameSource.hpp"
+
+// Reads input that is written as it goes, such as stdin or a named pipe, into frames of up to frameSize bytes. A
+// frame is sent once it is full, or once its first byte has waited flushLatency, so data that trickles in still
+// reaches the server within that time rather than waiting for a full frame. If nothing is written for
+// keepaliveInterval, an empty frame is returned anyway, with quiet() true, so the client can show the server the
+// stream is still there.
+class StreamReader : public FrameSource
+{
+public:
+  StreamReader(int fileDescriptor, std::size_t frameSize, std::chrono::milliseconds flushLatency,
+    std::chrono::milliseconds keepaliveInterval = std::chrono::milliseconds(-1));
+
+  StreamReader(const StreamReader&) = delete;
+  StreamReader& operator=(const StreamReader&) = delete;
+
+  // Waits for the next frame, which is empty once the writer has closed the input. The frame stays valid until the
+  // next call.
+  boost::asio::const_buffer nextFrame() override;
+
+  // Whether the last frame is empty because nothing was written for keepaliveInterval, rather than because the
+  // input has closed.
+  [[nodiscard]] bool quiet() const;
+
+private:
+  // Waits up to timeout for input, or for ever if timeout is negative. False if the wait timed out.
+  [[nodiscard]] bool waitForInput(std::chrono::milliseconds timeout) const;
+
+  const int fileDescriptor;
+  const std::chrono::milliseconds flushLatency;
+  const std::chrono::milliseconds keepaliveInterval;
+  std::vector<char> frame;
+  bool closed = false;
+  bool wasQuiet = false;
+};
+
+#endif //STREAMREADER_HPP
@@ -0,0 +1,101 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include "test/catch.hpp"
+#include "StreamReader.hpp"
+
+namespace
+{
+  std::string toString(boost::asio::const_buffer frame)
+  {
+    return {static_cast<const char*>(frame.data()), frame.size()};
+  }
+
+  class Pipe
+  {
+  public:
+    Pipe() { REQUIRE(pipe(ends) == 0); }
+    ~Pipe()
+    {
+      close(ends[0]);
+      closeWriter();
+    }
+
+    void write(const std::string& data) const
+    {
+      REQUIRE(::write(ends[1], data.data(), data.size()) == static_cast<ssize_t>(data.size()));
+    }
+    void closeWriter()
+    {
+      if (ends[1] >= 0)
+      {
+        close(ends[1]);
+        ends[1] = -1;
+      }
+    }
+    [[nodiscard]] int reader() const { return ends[0]; }
+    [[nodiscard]] int writer() const { return ends[1]; }
+
+  private:
+    int ends[2]{-1, -1};
+  };
+}
+
+TEST_CASE("Stream reader. Full frames are sent as soon as they are read")
+{
+  Pipe input;
+  StreamReader reader(input.reader(), 4, std::chrono::milliseconds(60000));
+  input.write("abcdefghij");
+  input.closeWriter();
+
+  REQUIRE(toString(reader.nextFrame()) == "abcd");
+  REQUIRE(toString(reader.nextFrame()) == "efgh");
+  REQUIRE(toString(reader.nextFrame()) == "ij");
+  REQUIRE(reader.nextFrame().size() == 0);
+  REQUIRE(reader.nextFrame().size() == 0);
+}
+
+TEST_CASE("Stream reader. A part frame is sent once it has waited the flush latency")
+{
+  Pipe input;
+  StreamReader reader(input.reader(), 1000, std::chrono::milliseconds(50));
+  input.write("first");
+  const auto start = std::chrono::steady_clock::now();
+
+  // No assertions on the writing thread, as Catch is not thread safe.
+  std::thread writer([writeEnd = input.writer()]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    const auto written = ::write(writeEnd, "second", 6);
+    static_cast<void>(written);
+  });
+  REQUIRE(toString(reader.nextFrame()) == "first");
+  const auto waited = std::chrono::steady_clock::now() - start;
+  REQUIRE(waited >= std::chrono::milliseconds(50));
+  REQUIRE(waited < std::chrono::milliseconds(400));
+
+  writer.join();
+  input.closeWriter();
+  REQUIRE(toString(reader.nextFrame()) == "second");
+  REQUIRE(reader.nextFrame().size() == 0);
+}
+
+TEST_CASE("Stream reader. A quiet input gives an empty frame after the keepalive interval, and is not closed")
+{
+  Pipe input;
+  StreamReader reader(input.reader(), 4, std::chrono::milliseconds(10), std::chrono::milliseconds(20));
+
+  REQUIRE(reader.nextFrame().size() == 0);
+  REQUIRE(reader.quiet());
+
+  input.write("ab");
+  REQUIRE(toString(reader.nextFrame()) == "ab");
+  REQUIRE_FALSE(reader.quiet());
+
+  input.closeWriter();
+  REQUIRE(reader.nextFrame().size() == 0);
+  REQUIRE_FALSE(reader.quiet());
+}
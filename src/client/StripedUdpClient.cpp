@@ -0,0 +1,127 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "StripedUdpClient.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace
+{
+  std::runtime_error invalidLinks(std::string_view list)
+  {
+    return std::runtime_error("Invalid link list: " + std::string(list));
+  }
+
+  StripeLink parseStripeLink(std::string_view link, std::string_view list)
+  {
+    const auto slash = link.find('/');
+    const auto endpoint = link.substr(0, slash);
+    const auto colon = endpoint.rfind(':');
+    if (colon == std::string_view::npos || colon == 0)
+    {
+      throw invalidLinks(list);
+    }
+
+    const auto portText = endpoint.substr(colon + 1);
+    std::uint16_t port{};
+    const auto result = std::from_chars(portText.data(), portText.data() + portText.size(), port);
+    if (portText.empty() || result.ec != std::errc() || result.ptr != portText.data() + portText.size() || port == 0)
+    {
+      throw invalidLinks(list);
+    }
+
+    double dataRateMbps = 0;
+    if (slash != std::string_view::npos)
+    {
+      const std::string rateText(link.substr(slash + 1));
+      char* end = nullptr;
+      dataRateMbps = std::strtod(rateText.c_str(), &end);
+      if (rateText.empty() || end != rateText.c_str() + rateText.size() || !(dataRateMbps > 0))
+      {
+        throw invalidLinks(list);
+      }
+    }
+    return {std::string(endpoint.substr(0, colon)), port, dataRateMbps};
+  }
+}
+
+std::vector<StripeLink> parseStripeLinks(std::string_view list)
+{
+  std::vector<StripeLink> links;
+  for (std::size_t begin = 0, end = 0; end < list.size(); begin = end + 1)
+  {
+    end = std::min(list.find(',', begin), list.size());
+    links.push_back(parseStripeLink(list.substr(begin, end - begin), list));
+  }
+  if (links.empty())
+  {
+    throw invalidLinks(list);
+  }
+
+  const auto withRate = std::count_if(links.begin(), links.end(), [](const auto& link) { return link.dataRateMbps > 0; });
+  if (withRate != 0 && withRate != static_cast<std::ptrdiff_t>(links.size()))
+  {
+    throw std::runtime_error("Give a data rate for every link or for none: " + std::string(list));
+  }
+  return links;
+}
+
+StripedUdpClient::StripedUdpClient(std::vector<Link> links):
+  links(std::move(links)),
+  credit(this->links.size())
+{
+  if (this->links.empty())
+  {
+    throw std::runtime_error("A striped send needs at least one link");
+  }
+  for (const auto& link : this->links)
+  {
+    if (link.weight == 0)
+    {
+      throw std::runtime_error("Every link of a striped send needs a weight");
+    }
+    totalWeight += link.weight;
+  }
+}
+
+void StripedUdpClient::send(ConstSocketBuffers inputBuffers)
+{
+  links[nextLink()].udpClient->send(inputBuffers);
+}
+
+LocalQueueState StripedUdpClient::localQueueState() const
+{
+  LocalQueueState fullest{0, 0, 0};
+  std::uint64_t sendStalls = 0;
+  for (const auto& link : links)
+  {
+    const auto state = link.udpClient->localQueueState();
+    sendStalls += state.sendStalls;
+    const auto fuller = fullest.queueCapacity == 0 ||
+                        state.queuedBytes * fullest.queueCapacity > fullest.queuedBytes * state.queueCapacity;
+    if (state.queueCapacity != 0 && fuller)
+    {
+      fullest = state;
+    }
+  }
+  fullest.sendStalls = sendStalls;
+  return fullest;
+}
+
+// Every link earns its weight in credit each frame and the one with the most sends, paying the total weight back.
+std::size_t StripedUdpClient::nextLink()
+{
+  std::size_t chosen = 0;
+  for (std::size_t link = 0; link < links.size(); ++link)
+  {
+    credit[link] += links[link].weight;
+    if (credit[link] > credit[chosen])
+    {
+      chosen = link;
+    }
+  }
+  credit[chosen] -= totalWeight;
+  return chosen;
+}
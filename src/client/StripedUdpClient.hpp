@@ -0,0 +1,53 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef STRIPEDUDPCLIENT_HPP
+#define STRIPEDUDPCLIENT_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "UdpClientInterface.hpp"
+
+// One destination of a striped send, as given to the client's --links option.
+struct StripeLink
+{
+  std::string address;
+  std::uint16_t port;
+  // Data rate of this link in megabits per second, 0 if the links share the overall data rate equally.
+  double dataRateMbps;
+};
+
+// Parses a list such as "10.0.1.1:45000/400,10.0.2.1:45000/200". Either every link has a data rate or none has.
+std::vector<StripeLink> parseStripeLinks(std::string_view list);
+
+// Spreads the frames of a session across several links, each frame going whole to one of them, so one large file
+// can use the bandwidth of every diode channel. Links are chosen by smooth weighted round robin, which sends each
+// link its share of the frames evenly spaced, so pacing the total rate paces every link at its own rate.
+class StripedUdpClient : public UdpClientInterface
+{
+public:
+  struct Link
+  {
+    std::shared_ptr<UdpClientInterface> udpClient;
+    std::uint32_t weight;
+  };
+
+  explicit StripedUdpClient(std::vector<Link> links);
+
+  void send(ConstSocketBuffers inputBuffers) override;
+
+  // The queue of the fullest link, as every link slows down with it, and the stalls of them all.
+  LocalQueueState localQueueState() const override;
+
+private:
+  std::size_t nextLink();
+
+  std::vector<Link> links;
+  std::vector<std::int64_t> credit;
+  std::int64_t totalWeight = 0;
+};
+
+#endif //STRIPEDUDPCLIENT_HPP
@@ -0,0 +1,135 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include "test/catch.hpp"
+#include "test/EnterpriseDiodeTestHelpers.hpp"
+#include "Client.hpp"
+#include "StripedUdpClient.hpp"
+#include "Timer.hpp"
+
+namespace
+{
+  std::string linksUsed(const std::vector<std::shared_ptr<UdpClientSpy>>& spies, std::size_t frames)
+  {
+    std::string order;
+    for (std::size_t frame = 0; frame < frames; ++frame)
+    {
+      for (std::size_t link = 0; link < spies.size(); ++link)
+      {
+        const auto& sent = spies[link]->buffersSent;
+        if (std::any_of(sent.begin(), sent.end(), [frame](const auto& buffer) { return buffer.at(0) == frame; }))
+        {
+          order += static_cast<char>('A' + link);
+        }
+      }
+    }
+    return order;
+  }
+}
+
+TEST_CASE("Striped UDP client. Link lists are parsed")
+{
+  const auto single = parseStripeLinks("10.0.1.1:45000");
+  REQUIRE(single.size() == 1);
+  REQUIRE(single[0].address == "10.0.1.1");
+  REQUIRE(single[0].port == 45000);
+  REQUIRE(single[0].dataRateMbps == Approx(0));
+
+  const auto weighted = parseStripeLinks("10.0.1.1:45000/400,diode2:45001/200.5");
+  REQUIRE(weighted.size() == 2);
+  REQUIRE(weighted[0].dataRateMbps == Approx(400));
+  REQUIRE(weighted[1].address == "diode2");
+  REQUIRE(weighted[1].port == 45001);
+  REQUIRE(weighted[1].dataRateMbps == Approx(200.5));
+
+  for (const auto list : {"", "10.0.1.1", ":45000", "10.0.1.1:", "10.0.1.1:0", "10.0.1.1:70000", "10.0.1.1:1/0",
+                          "10.0.1.1:1/x", "10.0.1.1:1/", "10.0.1.1:1,", "10.0.1.1:1/100,10.0.2.1:1"})
+  {
+    INFO(list);
+    REQUIRE_THROWS_AS(parseStripeLinks(list), std::runtime_error);
+  }
+}
+
+TEST_CASE("Striped UDP client. Frames are spread across the links by weight")
+{
+  std::vector<std::shared_ptr<UdpClientSpy>> spies;
+  std::vector<StripedUdpClient::Link> links;
+  const auto addLink = [&spies, &links](std::uint32_t weight) {
+    spies.push_back(std::make_shared<UdpClientSpy>());
+    links.push_back({spies.back(), weight});
+  };
+  const auto sendFrames = [](StripedUdpClient& client, std::size_t frames) {
+    for (std::size_t frame = 0; frame < frames; ++frame)
+    {
+      const auto data = static_cast<std::uint8_t>(frame);
+      client.send({boost::asio::buffer(&data, 1), boost::asio::const_buffer()});
+    }
+  };
+
+  SECTION("Equal links take turns")
+  {
+    addLink(1);
+    addLink(1);
+    addLink(1);
+    StripedUdpClient client(links);
+    sendFrames(client, 6);
+    REQUIRE(linksUsed(spies, 6) == "ABCABC");
+  }
+
+  SECTION("A link with twice the rate sends twice the frames, spread out rather than in bursts")
+  {
+    addLink(400);
+    addLink(200);
+    StripedUdpClient client(links);
+    sendFrames(client, 9);
+    REQUIRE(linksUsed(spies, 9) == "ABAABAABA");
+    REQUIRE(spies[0]->buffersSent.size() == 6);
+    REQUIRE(spies[1]->buffersSent.size() == 3);
+  }
+
+  SECTION("Every link needs a weight")
+  {
+    REQUIRE_THROWS_AS(StripedUdpClient({}), std::runtime_error);
+    addLink(0);
+    REQUIRE_THROWS_AS(StripedUdpClient(links), std::runtime_error);
+  }
+}
+
+TEST_CASE("Striped UDP client. The send queue is that of the fullest link, with the stalls of every link")
+{
+  class QueueStub : public UdpClientSpy
+  {
+  public:
+    explicit QueueStub(LocalQueueState state): state(state) {}
+    LocalQueueState localQueueState() const override { return state; }
+    const LocalQueueState state;
+  };
+
+  StripedUdpClient client({
+    {std::make_shared<QueueStub>(LocalQueueState{100, 1000, 1}), 1},
+    {std::make_shared<QueueStub>(LocalQueueState{300, 2000, 2}), 1},
+    {std::make_shared<QueueStub>(LocalQueueState{0, 0, 4}), 1}});
+  const auto state = client.localQueueState();
+  REQUIRE(state.queuedBytes == 300);
+  REQUIRE(state.queueCapacity == 2000);
+  REQUIRE(state.sendStalls == 7);
+}
+
+TEST_CASE("Striped UDP client. Every frame of a session goes out once, across all the links")
+{
+  auto first = std::make_shared<UdpClientSpy>();
+  auto second = std::make_shared<UdpClientSpy>();
+  Client edClient(
+    std::make_shared<StripedUdpClient>(std::vector<StripedUdpClient::Link>{{first, 1}, {second, 1}}),
+    std::make_shared<Timer>(0), 2, "file.bin");
+  std::stringstream input("AABBCCD");
+  edClient.send(input);
+
+  REQUIRE(first->buffersSent.size() == 3);
+  REQUIRE(second->buffersSent.size() == 2);
+  REQUIRE(first->buffersSent.back().at(EnterpriseDiode::EOFFlagIndex));
+}
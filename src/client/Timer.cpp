@@ -3,6 +3,12 @@
 
 #include "Timer.hpp"
 
+namespace
+{
+  // Longest a run can fall behind and still catch up with back to back ticks.
+  const auto maxCatchUp = boost::posix_time::milliseconds(10);
+}
+
 Timer::Timer(std::uint32_t timerPeriod) :
   primaryTimerPeriod(boost::posix_time::microseconds(timerPeriod)),
   deadlineTimer(io) {}
@@ -14,6 +20,7 @@ Timer::Timer(boost::posix_time::microseconds timerPeriod) :
 void Timer::runTimer(std::function<bool()> callback)
 {
   tickCallback = callback;
+  io.restart();
   deadlineTimer.expires_from_now(primaryTimerPeriod);
   tick();
   io.run();
@@ -24,6 +31,12 @@ void Timer::tick()
   deadlineTimer.expires_at(deadlineTimer.expires_at() + primaryTimerPeriod);
   if (tickCallback())
   {
+    // A callback that waited, as for streamed input, is not made up for with a burst of sends faster than the rate.
+    const auto now = boost::asio::deadline_timer::traits_type::now();
+    if (deadlineTimer.expires_at() < now - maxCatchUp)
+    {
+      deadlineTimer.expires_at(now);
+    }
     deadlineTimer.async_wait([&](const boost::system::error_code&) { tick(); });
   }
   else
@@ -1,7 +1,9 @@
 // Copyright PA Knowledge Ltd 2021
 // MIT License. For licence terms see LICENCE.md file.
 
+#include <chrono>
 #include <cstdint>
+#include <thread>
 #include <vector>
 #include <future>
 
@@ -34,6 +36,32 @@ TEST_CASE("Timer. For a timer with period 0, the sendFrame is called")
   REQUIRE(callbackWasCalled);
 }
 
+TEST_CASE("Timer. A timer can be run again once a run has finished")
+{
+  auto timer = std::make_shared<Timer>(0);
+  for (auto run = 0; run < 2; ++run)
+  {
+    int ticks = 0;
+    timer->runTimer([&ticks]() { return ++ticks < 3; });
+    REQUIRE(ticks == 3);
+  }
+}
+
+TEST_CASE("Timer. A callback that waits is not made up for with a burst of ticks", "[integration]")
+{
+  auto timer = std::make_shared<Timer>(20000);
+  std::vector<std::chrono::steady_clock::time_point> tickTimes;
+  timer->runTimer([&tickTimes]() {
+    tickTimes.push_back(std::chrono::steady_clock::now());
+    if (tickTimes.size() == 1)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+    return tickTimes.size() < 4;
+  });
+
+  REQUIRE(tickTimes.at(3) - tickTimes.at(1) >= std::chrono::milliseconds(30));
+}
 
 TEST_CASE("Timer. Calculate the timer period for a given data rate and size packet")
 {
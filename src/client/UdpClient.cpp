@@ -1,15 +1,35 @@
 // Copyright PA Knowledge Ltd 2021
 // MIT License. For licence terms see LICENCE.md file.
 
+#include <chrono>
+#include <thread>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/sockios.h>
 #include <boost/asio/ip/udp.hpp>
 #include "UdpClient.hpp"
 
+namespace
+{
+  constexpr int maxRefusedAttempts = 3;
+  constexpr int sendQueueWaitMilliseconds = 10;
+  constexpr auto noBufferSpaceBackoff = std::chrono::microseconds(50);
+}
+
 UdpClient::UdpClient(const std::string& address, std::uint16_t port) :
   io_context(),
   s(io_context, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0)),
-  endpoints(findEndpoints(address, port))
+  endpoints(findEndpoints(address, port)),
+  socketHandle(s.native_handle())
 {
-
+  s.non_blocking(true);
+  const int enable = 1;
+  setsockopt(socketHandle, IPPROTO_IP, IP_RECVERR, &enable, sizeof(enable));
+  boost::asio::socket_base::send_buffer_size sendBufferSize;
+  s.get_option(sendBufferSize);
+  sendQueueCapacity = static_cast<std::uint64_t>(sendBufferSize.value());
 }
 
 boost::asio::ip::udp::endpoint UdpClient::findEndpoints(const std::string& address, std::uint16_t port)
@@ -20,5 +40,66 @@ boost::asio::ip::udp::endpoint UdpClient::findEndpoints(const std::string& addre
 
 void UdpClient::send(ConstSocketBuffers inputBuffers)
 {
-  s.send_to(inputBuffers, endpoints);
+  for (int refusedAttempts = 0;;)
+  {
+    boost::system::error_code error;
+    s.send_to(inputBuffers, endpoints, 0, error);
+    if (!error)
+    {
+      return;
+    }
+    if (error == boost::asio::error::would_block)
+    {
+      ++sendStalls;
+      waitForSendQueue();
+    }
+    else if (error == boost::asio::error::no_buffer_space)
+    {
+      ++sendStalls;
+      std::this_thread::sleep_for(noBufferSpaceBackoff);
+    }
+    else if (++refusedAttempts < maxRefusedAttempts &&
+             (error == boost::asio::error::connection_refused || error == boost::asio::error::host_unreachable ||
+              error == boost::asio::error::network_unreachable))
+    {
+      // An ICMP error for an earlier datagram, reported on this send because of IP_RECVERR. Nothing ever comes
+      // back through a diode, so this only happens on a test network; this datagram has not been sent yet.
+      discardErrorQueue();
+    }
+    else
+    {
+      throw boost::system::system_error(error);
+    }
+  }
+}
+
+void UdpClient::waitForSendQueue()
+{
+  pollfd descriptor{socketHandle, POLLOUT, 0};
+  poll(&descriptor, 1, sendQueueWaitMilliseconds);
+}
+
+void UdpClient::discardErrorQueue()
+{
+  std::array<char, 512> control{};
+  msghdr message{};
+  message.msg_control = control.data();
+  while (true)
+  {
+    message.msg_controllen = control.size();
+    if (recvmsg(socketHandle, &message, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+    {
+      return;
+    }
+  }
+}
+
+LocalQueueState UdpClient::localQueueState() const
+{
+  int queuedBytes = 0;
+  if (ioctl(socketHandle, SIOCOUTQ, &queuedBytes) != 0)
+  {
+    return {0, 0, sendStalls};
+  }
+  return {static_cast<std::uint64_t>(queuedBytes), sendQueueCapacity, sendStalls};
 }
@@ -9,19 +9,26 @@
 #include <boost/asio/buffer.hpp>
 #include "UdpClientInterface.hpp"
 
-
+// Sends on a non-blocking socket with IP_RECVERR set, so that a datagram which does not fit the send queue, or
+// is dropped by the queueing discipline with ENOBUFS, is seen and sent again rather than silently lost.
 class UdpClient : public UdpClientInterface
 {
 public:
   explicit UdpClient(const std::string& address, std::uint16_t port);
   void send(ConstSocketBuffers inputBuffers) override;
+  LocalQueueState localQueueState() const override;
 
 private:
   boost::asio::io_service io_context;
   boost::asio::ip::udp::socket s;
   boost::asio::ip::udp::endpoint endpoints;
+  const int socketHandle;
+  std::uint64_t sendQueueCapacity = 0;
+  std::uint64_t sendStalls = 0;
 
   boost::asio::ip::udp::endpoint findEndpoints(const std::string& address, std::uint16_t port);
+  void waitForSendQueue();
+  void discardErrorQueue();
 };
 
-#endif //UDPCLIENT_HPP
\ No newline at end of file
+#endif //UDPCLIENT_HPP
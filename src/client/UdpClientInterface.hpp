@@ -4,10 +4,23 @@
 #ifndef UDPCLIENTINTERFACE_HPP
 #define UDPCLIENTINTERFACE_HPP
 
+#include <cstdint>
 #include <boost/asio/buffer.hpp>
 
 using ConstSocketBuffers = std::array<boost::asio::const_buffer, 2>;
 
+// What the sending host knows about the datagrams it has sent, so the send can be paced to what the local path
+// to the diode carries rather than overflowing a queue and losing frames.
+struct LocalQueueState
+{
+  // Bytes of sent datagrams still queued in this host, waiting for the NIC to take them.
+  std::uint64_t queuedBytes;
+  // Size of the socket's send queue, or 0 if the queue cannot be seen.
+  std::uint64_t queueCapacity;
+  // Number of times so far a datagram found the send queue full, or was refused by the queueing discipline,
+  // and had to wait to be sent again.
+  std::uint64_t sendStalls;
+};
 
 class UdpClientInterface
 {
@@ -15,6 +28,11 @@ public:
   virtual ~UdpClientInterface() = default;
 
   virtual void send(ConstSocketBuffers inputBuffers) = 0;
+
+  virtual LocalQueueState localQueueState() const
+  {
+    return {0, 0, 0};
+  }
 };
 
 #endif //UDPCLIENTINTERFACE_HPP
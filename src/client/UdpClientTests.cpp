@@ -17,3 +17,17 @@ TEST_CASE("UDP Client. Packets are sent to the real UDP client", "[integration]"
   ConstSocketBuffers testPacket = {boost::asio::buffer(testHeader), boost::asio::buffer(testPayload)};
   UdpClient("localhost", 2002).send(testPacket);
 }
+
+TEST_CASE("UDP Client. The send queue can be seen and refused datagrams do not end the send", "[integration]")
+{
+  std::array<char, EnterpriseDiode::HeaderSizeInBytes> testHeader{};
+  ConstSocketBuffers testPacket = {boost::asio::buffer(testHeader), boost::asio::const_buffer()};
+  UdpClient udpClient("localhost", 2006);
+  REQUIRE(udpClient.localQueueState().queueCapacity > 0);
+
+  for (auto packet = 0; packet < 100; ++packet)
+  {
+    udpClient.send(testPacket);
+  }
+  REQUIRE(udpClient.localQueueState().queuedBytes < udpClient.localQueueState().queueCapacity);
+}
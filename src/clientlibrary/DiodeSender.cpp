@@ -0,0 +1,61 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "DiodeSender.hpp"
+#include <vector>
+#include <boost/asio/buffer.hpp>
+#include "client/Client.hpp"
+#include "client/ClientWrapper.hpp"
+#include "client/UdpClient.hpp"
+
+class DiodeSender::Impl
+{
+public:
+  explicit Impl(const DiodeSenderConfig& config):
+    config(config),
+    maxPayloadSize(calculatePayloadSize(config.mtuSize)),
+    udpClient(std::make_shared<UdpClient>(config.address, config.port)),
+    timer(ClientWrapper::selectTimer(config.mtuSize, config.dataRateMbps, udpClient))
+  {
+  }
+
+  void send(const std::string& filename, std::vector<boost::asio::const_buffer> buffers)
+  {
+    // A client is only its header and settings, so one is made for each file. The socket and timer, which hold
+    // the state worth keeping, are shared by them all.
+    Client client(
+      udpClient, timer, maxPayloadSize, filename, config.compress, {}, {}, {}, false, config.timestamps);
+    client.send(std::move(buffers));
+  }
+
+private:
+  const DiodeSenderConfig config;
+  const std::uint16_t maxPayloadSize;
+  const std::shared_ptr<UdpClientInterface> udpClient;
+  const std::shared_ptr<TimerInterface> timer;
+};
+
+DiodeSender::DiodeSender(const DiodeSenderConfig& config):
+  impl(std::make_unique<Impl>(config))
+{
+}
+
+DiodeSender::~DiodeSender() = default;
+DiodeSender::DiodeSender(DiodeSender&&) noexcept = default;
+DiodeSender& DiodeSender::operator=(DiodeSender&&) noexcept = default;
+
+void DiodeSender::send(const std::string& filename, const void* data, std::size_t size)
+{
+  impl->send(filename, {boost::asio::buffer(data, size)});
+}
+
+void DiodeSender::send(const std::string& filename, const iovec* buffers, std::size_t bufferCount)
+{
+  std::vector<boost::asio::const_buffer> memoryBuffers;
+  memoryBuffers.reserve(bufferCount);
+  for (std::size_t index = 0; index < bufferCount; ++index)
+  {
+    memoryBuffers.emplace_back(buffers[index].iov_base, buffers[index].iov_len);
+  }
+  impl->send(filename, std::move(memoryBuffers));
+}
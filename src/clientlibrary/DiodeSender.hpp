@@ -0,0 +1,49 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef DIODESENDER_HPP
+#define DIODESENDER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <sys/uio.h>
+
+#ifndef ED_API
+#define ED_API __attribute__((visibility("default")))
+#endif
+
+struct DiodeSenderConfig
+{
+  std::string address;
+  std::uint16_t port = 0;
+  std::uint16_t mtuSize = 1500;
+  // Megabits per second, or 0 to send as fast as the local path to the diode carries.
+  double dataRateMbps = 0;
+  bool compress = false;
+  bool timestamps = false;
+};
+
+// Sends data held in memory across the diode, each send as its own session arriving as the named file. Made for
+// producers that would otherwise write to disk only for the client to read it back: a frame that lies within
+// one of the caller's buffers is sent from it in place, and the socket and pacing are set up once and kept for
+// every send. Sends run on the calling thread and a sender is not safe to use from several threads at once.
+class ED_API DiodeSender
+{
+public:
+  explicit DiodeSender(const DiodeSenderConfig& config);
+  ~DiodeSender();
+  DiodeSender(DiodeSender&&) noexcept;
+  DiodeSender& operator=(DiodeSender&&) noexcept;
+
+  // Each returns once the last frame is sent and throws std::runtime_error if the send fails.
+  void send(const std::string& filename, const void* data, std::size_t size);
+  void send(const std::string& filename, const iovec* buffers, std::size_t bufferCount);
+
+private:
+  class Impl;
+  std::unique_ptr<Impl> impl;
+};
+
+#endif //DIODESENDER_HPP
@@ -0,0 +1,102 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <future>
+#include <string>
+#include <thread>
+#include <test/EnterpriseDiodeTestHelpers.hpp>
+#include "test/catch.hpp"
+#include "DiodeSender.hpp"
+#include "edclient.h"
+#include "Server.hpp"
+#include "UdpServer.hpp"
+
+TEST_CASE("Client library. The C interface reports failures through ed_last_error")
+{
+  ed_sender_config config;
+  ed_sender_config_init(&config);
+  REQUIRE(config.mtu_size == 1500);
+  REQUIRE(config.compress == 0);
+
+  SECTION("A config must be filled in by ed_sender_config_init with this version's layout")
+  {
+    config.address = "localhost";
+    config.struct_size = sizeof(config) - sizeof(int);
+    REQUIRE(ed_sender_create(&config) == nullptr);
+    REQUIRE(std::string(ed_last_error()).find("ed_sender_config_init") != std::string::npos);
+  }
+
+  SECTION("A sender needs an address")
+  {
+    REQUIRE(ed_sender_create(&config) == nullptr);
+    REQUIRE(std::string(ed_last_error()) == "address must not be NULL");
+  }
+
+  SECTION("A sender needs an MTU of at least the minimum")
+  {
+    config.address = "localhost";
+    config.port = 2008;
+    config.mtu_size = 500;
+    REQUIRE(ed_sender_create(&config) == nullptr);
+    REQUIRE(std::string(ed_last_error()) == "MTU should be greater than 576");
+  }
+
+  SECTION("Sends with an invalid file name or missing arguments fail")
+  {
+    config.address = "localhost";
+    config.port = 2008;
+    auto sender = ed_sender_create(&config);
+    REQUIRE(sender != nullptr);
+    REQUIRE(ed_sender_send(sender, "bad name!", "x", 1) == -1);
+    REQUIRE(std::string(ed_last_error()).find("filename") != std::string::npos);
+    REQUIRE(ed_sender_send(sender, "name", nullptr, 1) == -1);
+    REQUIRE(std::string(ed_last_error()) == "data must not be NULL");
+    REQUIRE(ed_sender_sendv(nullptr, "name", nullptr, 0) == -1);
+    REQUIRE(std::string(ed_last_error()) == "sender must not be NULL");
+    ed_sender_destroy(sender);
+  }
+}
+
+TEST_CASE("Client library. Buffers and iovecs sent from memory are received whole", "[integration]")
+{
+  std::stringstream outputStream;
+  std::uint32_t capturedSessionId = 0;
+  boost::asio::io_service io_context;
+  Server edServer = createEdServer(
+    std::make_unique<UdpServer>(2008, io_context, EnterpriseDiode::calculateMaxBufferSize(1500), 1024 * 1024),
+    1024 * 1024, 100, capturedSessionId, outputStream, DiodeType::basic);
+  auto serverHandle = std::async(std::launch::async, [&io_context]() { io_context.run(); });
+
+  std::string content;
+  for (auto index = 0; index < 5000; ++index)
+  {
+    content += static_cast<char>('a' + index % 26);
+  }
+  // Split so that frames both lie within the pieces and span them, and one piece is empty.
+  const std::string first = content.substr(0, 1000);
+  const std::string second = content.substr(1000, 3);
+  const std::string third = content.substr(1003);
+  const iovec pieces[] = {{const_cast<char*>(first.data()), first.size()},
+                          {const_cast<char*>(second.data()), second.size()},
+                          {nullptr, 0},
+                          {const_cast<char*>(third.data()), third.size()}};
+
+  DiodeSender sender({"localhost", 2008, 1500, 10, false, false});
+  sender.send("buffer.bin", content.data(), content.size());
+
+  ed_sender_config config;
+  ed_sender_config_init(&config);
+  config.address = "localhost";
+  config.port = 2008;
+  config.data_rate_mbps = 10;
+  auto cSender = ed_sender_create(&config);
+  REQUIRE(ed_sender_sendv(cSender, "iovecs.bin", pieces, 4) == 0);
+  ed_sender_destroy(cSender);
+
+  for (auto timeout = 0; outputStream.str().size() < content.size() * 2 && timeout < 200; ++timeout)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  io_context.stop();
+  REQUIRE(outputStream.str() == content + content);
+}
@@ -0,0 +1,109 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "edclient.h"
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include "DiodeSender.hpp"
+
+struct ed_sender
+{
+  DiodeSender sender;
+};
+
+namespace
+{
+  thread_local std::string lastError;
+
+  // No exception may cross into C, so each is caught here and kept for ed_last_error.
+  template <typename Function>
+  int reportErrors(Function function)
+  {
+    try
+    {
+      function();
+      return 0;
+    }
+    catch (const std::exception& exception)
+    {
+      lastError = exception.what();
+    }
+    catch (...)
+    {
+      lastError = "Unknown error";
+    }
+    return -1;
+  }
+
+  void requireNotNull(const void* pointer, const char* name)
+  {
+    if (pointer == nullptr)
+    {
+      throw std::runtime_error(std::string(name) + " must not be NULL");
+    }
+  }
+}
+
+void ed_sender_config_init(ed_sender_config* config)
+{
+  if (config != nullptr)
+  {
+    *config = {sizeof(ed_sender_config), nullptr, 0, 1500, 0, 0, 0};
+  }
+}
+
+ed_sender* ed_sender_create(const ed_sender_config* config)
+{
+  ed_sender* sender = nullptr;
+  reportErrors([&]() {
+    requireNotNull(config, "config");
+    if (config->struct_size != sizeof(ed_sender_config))
+    {
+      throw std::runtime_error(
+        "config is " + std::to_string(config->struct_size) + " bytes, not the " +
+        std::to_string(sizeof(ed_sender_config)) + " of this library; fill it with ed_sender_config_init");
+    }
+    requireNotNull(config->address, "address");
+    sender = new ed_sender{DiodeSender(DiodeSenderConfig{
+      config->address, config->port, config->mtu_size, config->data_rate_mbps, config->compress != 0,
+      config->timestamps != 0})};
+  });
+  return sender;
+}
+
+void ed_sender_destroy(ed_sender* sender)
+{
+  delete sender;
+}
+
+int ed_sender_send(ed_sender* sender, const char* filename, const void* data, size_t size)
+{
+  return reportErrors([&]() {
+    requireNotNull(sender, "sender");
+    requireNotNull(filename, "filename");
+    if (size != 0)
+    {
+      requireNotNull(data, "data");
+    }
+    sender->sender.send(filename, data, size);
+  });
+}
+
+int ed_sender_sendv(ed_sender* sender, const char* filename, const struct iovec* buffers, size_t count)
+{
+  return reportErrors([&]() {
+    requireNotNull(sender, "sender");
+    requireNotNull(filename, "filename");
+    if (count != 0)
+    {
+      requireNotNull(buffers, "buffers");
+    }
+    sender->sender.send(filename, buffers, count);
+  });
+}
+
+const char* ed_last_error(void)
+{
+  return lastError.c_str();
+}
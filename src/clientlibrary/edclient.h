@@ -0,0 +1,61 @@
+/* Copyright PA Knowledge Ltd 2021
+ * MIT License. For licence terms see LICENCE.md file. */
+
+#ifndef EDCLIENT_H
+#define EDCLIENT_H
+
+/* C interface to the enterprise diode client, for sending data held in memory from any language that can call C.
+ * See DiodeSender.hpp for the C++ interface. Every function returning int returns 0 on success and -1 on failure,
+ * when ed_last_error describes what went wrong. */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/uio.h>
+
+#ifndef ED_API
+#define ED_API __attribute__((visibility("default")))
+#endif
+
+/* Raised when a change to this interface would break callers built against an earlier version. */
+#define ED_CLIENT_API_VERSION 2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ed_sender ed_sender;
+
+/* struct_size is set by ed_sender_config_init to the size of the structure the caller was built with, so a library
+ * built with a different layout refuses it rather than reading the wrong fields. */
+typedef struct ed_sender_config
+{
+  size_t struct_size;
+  const char* address;
+  uint16_t port;
+  uint16_t mtu_size;
+  /* Megabits per second, or 0 to send as fast as the local path to the diode carries. */
+  double data_rate_mbps;
+  int compress;
+  int timestamps;
+} ed_sender_config;
+
+/* Fills config with the defaults: a 1500 byte MTU, adaptive pacing, no compression and no timestamps. */
+ED_API void ed_sender_config_init(ed_sender_config* config);
+
+/* Returns NULL on failure, including a config not filled in by ed_sender_config_init of this version. The sender keeps its socket and pacing for every send until it is destroyed. */
+ED_API ed_sender* ed_sender_create(const ed_sender_config* config);
+ED_API void ed_sender_destroy(ed_sender* sender);
+
+/* Each send is a session of its own, received as filename, and returns once its last frame is sent. A sender must
+ * not be used from more than one thread at a time. */
+ED_API int ed_sender_send(ed_sender* sender, const char* filename, const void* data, size_t size);
+ED_API int ed_sender_sendv(ed_sender* sender, const char* filename, const struct iovec* buffers, size_t count);
+
+/* The reason the last call on this thread failed, valid until the next call that fails on it. */
+ED_API const char* ed_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EDCLIENT_H */
@@ -2,7 +2,6 @@
 // MIT License. For licence terms see LICENCE.md file.
 
 #include "EnterpriseDiodeHeader.hpp"
-#include <Parsing.hpp>
 
 EDHeader::EDHeader(const std::vector<std::uint8_t>& frame) :
   headerParams(readHeaderParams(frame))
@@ -16,23 +15,17 @@ HeaderParams EDHeader::readHeaderParams(const std::vector<std::uint8_t>& frame)
   {
     throw std::runtime_error("Header size too small");
   }
-  return {
-    Parsing::extract<std::uint32_t>(frame, 0),
-    Parsing::extract<std::uint32_t>(frame, 4),
-    Parsing::extract<bool>(frame, 8),
-    Parsing::extract_array(frame, EnterpriseDiode::HeaderSizeInBytes - CloakedDagger::headerSize())
-  };
+  return EDHeaderView(frame.data()).headerParams();
 }
 
 namespace EnterpriseDiode
 {
   std::uint16_t calculateMaxBufferSize(std::uint16_t mtuSize)
   {
-    if (mtuSize < 576)
+    if (mtuSize < MinMtuSize)
     {
       throw std::runtime_error("MTU should be greater than 576");
     }
-    // IP frame size = 20 & UDP frame size = 8
-    return std::uint16_t(((short) mtuSize - 20) - 8);
+    return static_cast<std::uint16_t>(mtuSize - IPHeaderSizeInBytes - UDPHeaderSizeInBytes);
   }
 }
\ No newline at end of file
@@ -4,24 +4,129 @@
 #ifndef EDHEADER_HPP
 #define EDHEADER_HPP
 
+#include <chrono>
 #include <fstream>
 #include <boost/asio/buffer.hpp>
 #include <Packet.hpp>
+#include "HeaderLayout.hpp"
 
 namespace EnterpriseDiode
 {
+  namespace Layout
+  {
+    using HeaderLayout::Field;
+
+    // Control header. Multi byte fields are in host order, as the client writes them.
+    using SessionId = Field<std::uint32_t, 0>;
+    using FrameCount = Field<std::uint32_t, 4>;
+    using EOFFlag = Field<std::uint8_t, 8>;
+    // First byte of the control header padding; set on every frame of a session whose payloads are compressed.
+    using CompressedFlag = Field<std::uint8_t, 9>;
+    // Set on every frame of a resumable session, whose session ID is derived from the file content and whose
+    // frames each carry the number of file bytes in a full frame, so the server can place any frame in the file.
+    using ResumableFlag = Field<std::uint8_t, 10>;
+    // Set on every frame of a session that carries many small files packed together, see PackFormat.hpp.
+    using PackedFlag = Field<std::uint8_t, 11>;
+    // Set on every frame of a session streamed from a pipe, whose frames may be short and which may last for ever.
+    using StreamingFlag = Field<std::uint8_t, 12>;
+    // Set on a datagram a quiet stream sends to show it is still there. It is not a frame of the session, and its
+    // payload is ignored.
+    using KeepaliveFlag = Field<std::uint8_t, 13>;
+    using ControlPadding = Field<std::array<std::uint8_t, 2>, 14>;
+    using ResumeFrameSize = Field<std::uint32_t, 16>;
+    // When the client sent the frame, in nanoseconds since the Unix epoch, or 0 if it was not asked to say.
+    using SendTimestamp = Field<std::uint64_t, 20>;
+    // The frame count of the EOF frame of a resumable session, sent on every frame so the server knows from the
+    // first frame it sees how many frames the file can have.
+    using ResumeEOFFrame = Field<std::uint32_t, 28>;
+    using Reserved = Field<std::array<std::uint8_t, 32>, 32>;
+    using CloakedDaggerHeader = Field<::CloakedDaggerHeader, 64>;
+  }
+
   constexpr std::uint16_t HeaderSizeInBytes = 112;
   constexpr std::uint16_t ControlHeaderSizeInBytes = 16;
   constexpr std::uint16_t ControlHeaderPaddingSizeInBytes = 7;
-  constexpr std::uint32_t SessionIDIndex = 0;
-  constexpr std::uint32_t FrameCountIndex = 4;
-  constexpr std::uint32_t EOFFlagIndex = 8;
+  constexpr std::uint32_t SessionIDIndex = Layout::SessionId::offset;
+  constexpr std::uint32_t FrameCountIndex = Layout::FrameCount::offset;
+  constexpr std::uint32_t EOFFlagIndex = Layout::EOFFlag::offset;
+  constexpr std::uint32_t CompressedFlagIndex = Layout::CompressedFlag::offset;
+  constexpr std::uint32_t ResumableFlagIndex = Layout::ResumableFlag::offset;
+  constexpr std::uint32_t ResumeFrameSizeIndex = Layout::ResumeFrameSize::offset;
+  constexpr std::uint32_t PackedFlagIndex = Layout::PackedFlag::offset;
+  constexpr std::uint32_t StreamingFlagIndex = Layout::StreamingFlag::offset;
+  constexpr std::uint32_t KeepaliveFlagIndex = Layout::KeepaliveFlag::offset;
+  constexpr std::uint32_t SendTimestampIndex = Layout::SendTimestamp::offset;
+  constexpr std::uint32_t ResumeEOFFrameIndex = Layout::ResumeEOFFrame::offset;
+
+  static_assert(HeaderLayout::tiles<HeaderSizeInBytes,
+    Layout::SessionId, Layout::FrameCount, Layout::EOFFlag, Layout::CompressedFlag, Layout::ResumableFlag,
+    Layout::PackedFlag, Layout::StreamingFlag, Layout::KeepaliveFlag, Layout::ControlPadding, Layout::ResumeFrameSize,
+    Layout::SendTimestamp, Layout::ResumeEOFFrame, Layout::Reserved, Layout::CloakedDaggerHeader>());
+  static_assert(Layout::ControlPadding::end - Layout::CompressedFlag::offset == ControlHeaderPaddingSizeInBytes);
+  static_assert(Layout::ResumeFrameSize::offset == ControlHeaderSizeInBytes);
+
+  // How long a quiet stream goes between keepalives, a tenth of the time the server gives a stream without one.
+  constexpr std::chrono::seconds StreamKeepaliveInterval{60};
 
   constexpr std::uint32_t UDPSocketSizeInBytes = 268435456;
 
+  constexpr std::uint16_t MinMtuSize = 576;
+  constexpr std::uint16_t IPHeaderSizeInBytes = 20;
+  constexpr std::uint16_t UDPHeaderSizeInBytes = 8;
+  // The largest UDP datagram payload, sent with an MTU of 65535 on loopback or where the NIC segments for us.
+  constexpr std::uint16_t MaxDatagramSizeInBytes = 65535 - IPHeaderSizeInBytes - UDPHeaderSizeInBytes;
+
+  // Size of the UDP payload, header and frame together, that fits an MTU. Up to MaxDatagramSizeInBytes.
   std::uint16_t calculateMaxBufferSize(std::uint16_t mtuSize);
 }
 
+// Reads the fields of a received header in place, without copying or validating it. The caller must ensure
+// the buffer holds at least HeaderSizeInBytes bytes.
+class EDHeaderView
+{
+public:
+  explicit EDHeaderView(const std::uint8_t* header) noexcept:
+    header(header)
+  {
+  }
+
+  [[nodiscard]] std::uint32_t sessionId() const noexcept { return EnterpriseDiode::Layout::SessionId::read(header); }
+  [[nodiscard]] std::uint32_t frameCount() const noexcept { return EnterpriseDiode::Layout::FrameCount::read(header); }
+  [[nodiscard]] bool eOFFlag() const noexcept { return EnterpriseDiode::Layout::EOFFlag::read(header) != 0; }
+  [[nodiscard]] bool compressed() const noexcept { return EnterpriseDiode::Layout::CompressedFlag::read(header) == 1; }
+  [[nodiscard]] bool resumable() const noexcept { return EnterpriseDiode::Layout::ResumableFlag::read(header) == 1; }
+  [[nodiscard]] std::uint32_t resumeFrameSize() const noexcept
+  {
+    return EnterpriseDiode::Layout::ResumeFrameSize::read(header);
+  }
+  [[nodiscard]] bool packed() const noexcept { return EnterpriseDiode::Layout::PackedFlag::read(header) == 1; }
+  [[nodiscard]] bool streaming() const noexcept { return EnterpriseDiode::Layout::StreamingFlag::read(header) == 1; }
+  [[nodiscard]] bool keepalive() const noexcept { return EnterpriseDiode::Layout::KeepaliveFlag::read(header) == 1; }
+  [[nodiscard]] std::uint64_t sendTimestamp() const noexcept
+  {
+    return EnterpriseDiode::Layout::SendTimestamp::read(header);
+  }
+  [[nodiscard]] std::uint32_t resumeEofFrame() const noexcept
+  {
+    return EnterpriseDiode::Layout::ResumeEOFFrame::read(header);
+  }
+
+  [[nodiscard]] CloakedDaggerView cloakedDagger() const noexcept
+  {
+    return CloakedDaggerView(header + EnterpriseDiode::Layout::CloakedDaggerHeader::offset);
+  }
+
+  [[nodiscard]] HeaderParams headerParams() const
+  {
+    return {sessionId(), frameCount(), eOFFlag(), EnterpriseDiode::Layout::CloakedDaggerHeader::read(header),
+            compressed(), resumable(), resumeFrameSize(), packed(), sendTimestamp(), streaming(),
+            resumeEofFrame(), keepalive()};
+  }
+
+private:
+  const std::uint8_t* header;
+};
+
 class EDHeader
 {
 public:
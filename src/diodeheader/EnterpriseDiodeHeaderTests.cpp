@@ -2,6 +2,7 @@
 // MIT License. For licence terms see LICENCE.md file.
 
 #include <array>
+#include <cstring>
 #include "test/catch.hpp"
 #include "EnterpriseDiodeHeader.hpp"
 
@@ -23,6 +24,55 @@ TEST_CASE("ED Header. Header is created from a input stream. readHeaderParams co
   REQUIRE(edHeader.headerParams.cloakedDaggerHeader == testCloakDaggerHeader);
 }
 
+TEST_CASE("ED Header. Compressed flag is read from the first padding byte")
+{
+  std::array<char, EnterpriseDiode::HeaderSizeInBytes> headerBuffer{};
+  REQUIRE_FALSE(EDHeader({headerBuffer.begin(), headerBuffer.end()}).headerParams.compressed);
+
+  headerBuffer.at(EnterpriseDiode::CompressedFlagIndex) = 1;
+  REQUIRE(EDHeader({headerBuffer.begin(), headerBuffer.end()}).headerParams.compressed);
+}
+
+TEST_CASE("ED Header. Resumable sessions carry their frame size after the control padding, and their EOF frame")
+{
+  std::array<char, EnterpriseDiode::HeaderSizeInBytes> headerBuffer{};
+  REQUIRE_FALSE(EDHeader({headerBuffer.begin(), headerBuffer.end()}).headerParams.resumable);
+
+  headerBuffer.at(EnterpriseDiode::ResumableFlagIndex) = 1;
+  const std::uint32_t frameSize = 1360;
+  std::memcpy(headerBuffer.data() + EnterpriseDiode::ResumeFrameSizeIndex, &frameSize, sizeof(frameSize));
+  const std::uint32_t eofFrame = 771;
+  std::memcpy(headerBuffer.data() + EnterpriseDiode::ResumeEOFFrameIndex, &eofFrame, sizeof(eofFrame));
+  const auto headerParams = EDHeader({headerBuffer.begin(), headerBuffer.end()}).headerParams;
+  REQUIRE(headerParams.resumable);
+  REQUIRE(headerParams.resumeFrameSize == 1360);
+  REQUIRE(headerParams.resumeEofFrame == 771);
+  REQUIRE_FALSE(headerParams.compressed);
+}
+
+TEST_CASE("ED Header. Packed flag is read from the control padding")
+{
+  std::array<char, EnterpriseDiode::HeaderSizeInBytes> headerBuffer{};
+  REQUIRE_FALSE(EDHeader({headerBuffer.begin(), headerBuffer.end()}).headerParams.packed);
+
+  headerBuffer.at(EnterpriseDiode::PackedFlagIndex) = 1;
+  const auto headerParams = EDHeader({headerBuffer.begin(), headerBuffer.end()}).headerParams;
+  REQUIRE(headerParams.packed);
+  REQUIRE_FALSE(headerParams.resumable);
+}
+
+TEST_CASE("ED Header. Send timestamp is read from the reserved bytes")
+{
+  std::array<char, EnterpriseDiode::HeaderSizeInBytes> headerBuffer{};
+  REQUIRE(EDHeader({headerBuffer.begin(), headerBuffer.end()}).headerParams.sendTimestamp == 0);
+
+  const std::uint64_t sendTimestamp = 1634567890123456789;
+  std::memcpy(headerBuffer.data() + EnterpriseDiode::SendTimestampIndex, &sendTimestamp, sizeof(sendTimestamp));
+  const auto headerParams = EDHeader({headerBuffer.begin(), headerBuffer.end()}).headerParams;
+  REQUIRE(headerParams.sendTimestamp == sendTimestamp);
+  REQUIRE(headerParams.resumeFrameSize == 0);
+}
+
 TEST_CASE("ED Header. Header fields at maximum")
 {
   std::array<char, EnterpriseDiode::HeaderSizeInBytes> headerBuffer{'\xFF', '\xFF', '\xFF', '\xFF',
@@ -53,6 +103,9 @@ TEST_CASE("ED Header. calculateMaxBufferSize returns max buffer size given speci
 {
   REQUIRE(EnterpriseDiode::calculateMaxBufferSize(1500) == 1472);
   REQUIRE(EnterpriseDiode::calculateMaxBufferSize(9000) == 8972);
+  REQUIRE(EnterpriseDiode::calculateMaxBufferSize(32768) == 32740);
+  REQUIRE(EnterpriseDiode::calculateMaxBufferSize(65535) == EnterpriseDiode::MaxDatagramSizeInBytes);
+  REQUIRE(EnterpriseDiode::MaxDatagramSizeInBytes == 65507);
 }
 
 TEST_CASE("ED Header. calculateMaxBufferSize throws error if given MTU size is less than 576.")
@@ -69,3 +122,28 @@ TEST_CASE("ED Header. Constructing EDHeader from bytesbuffer with size less than
                                                                         '\x00', '\x00', '\x00', '\x00'};
   REQUIRE_THROWS_AS(EDHeader({headerBuffer.begin(), headerBuffer.end()}), std::runtime_error);
 }
+
+TEST_CASE("ED Header. View reads the fields in place")
+{
+  std::vector<std::uint8_t> frame(EnterpriseDiode::HeaderSizeInBytes + 4);
+  frame.at(EnterpriseDiode::SessionIDIndex) = 0x07;
+  frame.at(EnterpriseDiode::FrameCountIndex + 1) = 0x01;
+  frame.at(EnterpriseDiode::EOFFlagIndex) = 1;
+  frame.at(EnterpriseDiode::CompressedFlagIndex) = 1;
+  frame.at(EnterpriseDiode::HeaderSizeInBytes - CloakedDagger::headerSize()) = CloakedDagger::cloakedDaggerIdentifierByte;
+
+  const EDHeaderView view(frame.data());
+  REQUIRE(view.sessionId() == 7);
+  REQUIRE(view.frameCount() == 256);
+  REQUIRE(view.eOFFlag());
+  REQUIRE(view.compressed());
+  REQUIRE(view.cloakedDagger().data() == frame.data() + 64);
+  REQUIRE_FALSE(view.cloakedDagger().isValid());
+
+  const auto headerParams = EDHeader(frame).headerParams;
+  REQUIRE(headerParams.sessionId == view.sessionId());
+  REQUIRE(headerParams.frameCount == view.frameCount());
+  REQUIRE(headerParams.eOFFlag);
+  REQUIRE(headerParams.compressed);
+  REQUIRE(headerParams.cloakedDaggerHeader.at(0) == static_cast<char>(CloakedDagger::cloakedDaggerIdentifierByte));
+}
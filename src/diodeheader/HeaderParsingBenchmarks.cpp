@@ -0,0 +1,68 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <chrono>
+#include <vector>
+#include "test/catch.hpp"
+#include "EnterpriseDiodeHeader.hpp"
+#include "rewrapper/UnwrapperTestHelpers.hpp"
+#include "spdlog/spdlog.h"
+
+// Hidden from the default run; use: UnitTests "[benchmark]"
+namespace
+{
+  constexpr std::size_t packetCount = 1 << 16;
+  constexpr int passes = 64;
+
+  // Headers for consecutive frames of a wrapped session, back to back as they would sit in receive buffers.
+  std::vector<std::uint8_t> makeHeaders()
+  {
+    const auto cloakedDaggerHeader = createTestWrappedString("").header;
+    std::vector<std::uint8_t> headers(packetCount * EnterpriseDiode::HeaderSizeInBytes);
+    for (std::uint32_t packet = 0; packet < packetCount; ++packet)
+    {
+      auto* header = headers.data() + packet * EnterpriseDiode::HeaderSizeInBytes;
+      const auto frameCount = packet + 1;
+      std::memcpy(header + EnterpriseDiode::FrameCountIndex, &frameCount, sizeof(frameCount));
+      std::memcpy(
+        header + EnterpriseDiode::Layout::CloakedDaggerHeader::offset, cloakedDaggerHeader.data(),
+        cloakedDaggerHeader.size());
+    }
+    return headers;
+  }
+
+  template <typename Parse>
+  void logParseRate(const char* name, const std::vector<std::uint8_t>& headers, Parse&& parse)
+  {
+    std::uint64_t checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass)
+    {
+      for (std::size_t packet = 0; packet < packetCount; ++packet)
+      {
+        checksum += parse(headers.data() + packet * EnterpriseDiode::HeaderSizeInBytes);
+      }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const auto packets = static_cast<double>(packetCount) * passes;
+    spdlog::info("{}: {:.1f} million packets/s", name, packets / elapsed.count() / 1e6);
+    REQUIRE(checksum == passes * (packetCount * (packetCount + 1) / 2));
+  }
+}
+
+TEST_CASE("ED Header benchmark. Import diode header parse rate", "[.][benchmark]")
+{
+  const auto headers = makeHeaders();
+
+  logParseRate("EDHeader and CloakedDagger", headers, [](const std::uint8_t* header) {
+    const std::vector<std::uint8_t> frame(header, header + EnterpriseDiode::HeaderSizeInBytes);
+    const auto headerParams = EDHeader(frame).headerParams;
+    const CloakedDagger cloakedDagger(headerParams.cloakedDaggerHeader);
+    return std::uint64_t{headerParams.frameCount} * (cloakedDagger.key.size() == CloakedDagger::maskLength);
+  });
+
+  logParseRate("EDHeaderView", headers, [](const std::uint8_t* header) {
+    const EDHeaderView view(header);
+    return std::uint64_t{view.frameCount()} * view.cloakedDagger().isValid();
+  });
+}
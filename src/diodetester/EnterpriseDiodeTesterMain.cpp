@@ -14,6 +14,8 @@
 #include "Server.hpp"
 #include "client/ClientWrapper.hpp"
 #include "SessionManager.hpp"
+#include "LoadGenerator.hpp"
+#include "ThreadTuning.hpp"
 
 struct Params
 {
@@ -27,6 +29,15 @@ struct Params
   bool dropPackets;
   DiodeType diodeType;
   std::string logLevel;
+  std::uint32_t sessions;
+  std::uint64_t sessionSize;
+  std::uint64_t maxSessionSize;
+  bool compress;
+  ThreadTuning::ThreadSettings serverThread;
+  ThreadTuning::ThreadSettings clientThread;
+  ThreadTuning::ThreadSettings readerThread;
+  int busyPollMicroseconds;
+  unsigned int backgroundLoadThreads;
 };
 
 inline Params parseArgs(int argc, char **argv)
@@ -42,11 +53,22 @@ inline Params parseArgs(int argc, char **argv)
   bool dropPackets = false;
   bool importDiode = false;
   std::string logLevel = "info";
+  std::uint32_t sessions = 0;
+  std::uint64_t sessionSize = 1024 * 1024;
+  std::uint64_t maxSessionSize = 0;
+  bool compress = false;
+  std::string serverCpus;
+  std::string clientCpus;
+  std::string readerCpus;
+  int numaNode = -1;
+  int realtimePriority = 0;
+  int busyPollMicroseconds = 0;
+  unsigned int backgroundLoadThreads = 0;
   const auto cli = clara::Help(showHelp) |
                    clara::Opt(clientAddress, "client address")["-a"]["--address"]("address send packets to").required() |
                    clara::Opt(clientPort, "client port")["-c"]["--clientPort"]("port to send packets to").required() |
                    clara::Opt(serverPort, "server port")["-s"]["--serverPort"]("port to listen for packets on").required() |
-                   clara::Opt(filename, "filename")["-f"]["--filename"]("name of a file you want to send").required() |
+                   clara::Opt(filename, "filename")["-f"]["--filename"]("name of a file you want to send") |
                    clara::Opt(dataRateMbps, "date rate in Megabits per second")["-r"]["--datarate"](
                      "data rate of transfer. default as fast as possible") |
                    clara::Opt(mtuSize, "MTU size")["-m"]["--mtu"]("MTU size of the network interface") |
@@ -56,7 +78,26 @@ inline Params parseArgs(int argc, char **argv)
                      "Server will drop all received packets and only show missing packets") |
                    clara::Opt(importDiode)["-i"]["--importDiode"](
                      "Set flag if using an import diode so that the server rewraps data before writing to file.") |
-                   clara::Opt(logLevel, "Log level")["-l"]["--logLevel"]("Logging level for program output - default info");
+                   clara::Opt(logLevel, "Log level")["-l"]["--logLevel"]("Logging level for program output - default info") |
+                   clara::Opt(sessions, "sessions")["-k"]["--sessions"](
+                     "Load test: send this many concurrent sessions of random data instead of a file") |
+                   clara::Opt(sessionSize, "bytes")["--sessionSize"](
+                     "Load test: size of each session in bytes - default 1048576") |
+                   clara::Opt(maxSessionSize, "bytes")["--maxSessionSize"](
+                     "Load test: if set, session sizes are uniformly distributed between sessionSize and this") |
+                   clara::Opt(compress)["-z"]["--compress"]("Compress the file with LZ4. Not supported with --importDiode") |
+                   clara::Opt(serverCpus, "cpu list")["--serverCpus"](
+                     "Cores to run the server thread on, e.g. 2-3 - default any") |
+                   clara::Opt(clientCpus, "cpu list")["--clientCpus"]("Cores to run the client sending threads on") |
+                   clara::Opt(readerCpus, "cpu list")["--readerCpus"]("Cores to run the client file reading threads on") |
+                   clara::Opt(numaNode, "NUMA node")["--numaNode"](
+                     "Run every thread on the cores of this NUMA node, unless given cores") |
+                   clara::Opt(realtimePriority, "priority")["--realtime"](
+                     "Run every thread with SCHED_FIFO at this priority (1-99) - default off") |
+                   clara::Opt(busyPollMicroseconds, "microseconds")["--busyPoll"](
+                     "Busy poll the server UDP socket for this long before sleeping - default off") |
+                   clara::Opt(backgroundLoadThreads, "threads")["--backgroundLoad"](
+                     "Keep this many threads spinning throughout, to compare tuning options under CPU contention");
 
   const auto result = cli.parse(clara::Args(argc, argv));
   if (!result)
@@ -73,6 +114,13 @@ inline Params parseArgs(int argc, char **argv)
     exit(1);
   }
 
+  if (filename.empty() == (sessions == 0))
+  {
+    spdlog::error("Specify either a filename or a number of load test sessions");
+    exit(1);
+  }
+  maxSessionSize = std::max(sessionSize, maxSessionSize);
+
   auto diodeType = DiodeType::basic;
   if (importDiode)
   {
@@ -80,8 +128,21 @@ inline Params parseArgs(int argc, char **argv)
   }
 
   spdlog::set_level(spdlog::level::from_str(logLevel));
-  return {clientAddress, clientPort, serverPort, filename, dataRateMbps, mtuSize, maxQueueLength, dropPackets,
-          diodeType, logLevel};
+  try
+  {
+    const auto node = numaNode < 0 ? std::nullopt : std::optional(static_cast<unsigned int>(numaNode));
+    return {clientAddress, clientPort, serverPort, filename, dataRateMbps, mtuSize, maxQueueLength, dropPackets,
+            diodeType, logLevel, sessions, sessionSize, maxSessionSize, compress,
+            ThreadTuning::threadSettings(serverCpus, node, realtimePriority),
+            ThreadTuning::threadSettings(clientCpus, node, realtimePriority),
+            ThreadTuning::threadSettings(readerCpus, node, realtimePriority),
+            busyPollMicroseconds, backgroundLoadThreads};
+  }
+  catch (const std::runtime_error& exception)
+  {
+    spdlog::error(exception.what());
+    exit(1);
+  }
 }
 
 namespace EDTesterApplication
@@ -103,36 +164,80 @@ int main(int argc, char **argv)
   signal(SIGINT, EDTesterApplication::signalHandler);
 
   auto maxBufferSize = EnterpriseDiode::calculateMaxBufferSize(params.mtuSize);
+  LoadTestReceiver loadTestReceiver(params.sessions);
 
   Server edServer(
     std::make_unique<UdpServer>(
       params.serverPort,
       EDTesterApplication::io_context,
       maxBufferSize,
-      EnterpriseDiode::UDPSocketSizeInBytes),
+      EnterpriseDiode::UDPSocketSizeInBytes,
+      params.busyPollMicroseconds),
     maxBufferSize,
     params.maxQueueLength,
-    [](std::uint32_t sessionId)
-    { return std::make_unique<FileStream>(sessionId); },
+    [&params, &loadTestReceiver](std::uint32_t sessionId) -> std::unique_ptr<StreamInterface>
+    {
+      if (params.sessions > 0)
+      {
+        return loadTestReceiver.createStream(sessionId);
+      }
+      return std::make_unique<FileStream>(sessionId);
+    },
     []()
     { return std::time(nullptr); }, 15, params.diodeType);
 
+  std::promise<void> serverThreadTuned;
+  auto serverThreadTuning = serverThreadTuned.get_future();
   auto handleToSendingProcess = std::async(
-    std::launch::async, []() {
+    std::launch::async, [&params, &serverThreadTuned]() {
+      try
+      {
+        ThreadTuning::applyToCurrentThread(params.serverThread);
+        serverThreadTuned.set_value();
+      }
+      catch (const std::runtime_error&)
+      {
+        serverThreadTuned.set_exception(std::current_exception());
+        return;
+      }
       EDTesterApplication::io_context.run();
     });
 
+  try
+  {
+    serverThreadTuning.get();
+  }
+  catch (const std::runtime_error& exception)
+  {
+    spdlog::error(std::string("Unable to tune the server thread: ") + exception.what());
+    return 2;
+  }
   while (EDTesterApplication::io_context.stopped()) { usleep(100); }
 
+  const BackgroundLoad backgroundLoad(params.backgroundLoadThreads);
   try
   {
+    if (params.sessions > 0)
+    {
+      const auto report = runLoadTest(
+        {params.clientAddress, params.clientPort, params.mtuSize, params.dataRateMbps, params.sessions,
+         params.sessionSize, params.maxSessionSize, params.logLevel, params.clientThread, params.readerThread},
+        EDTesterApplication::io_context,
+        loadTestReceiver);
+      EDTesterApplication::io_context.stop();
+      return logLoadTestReport(report) ? 0 : 3;
+    }
+
+    ThreadTuning::applyToCurrentThread(params.clientThread);
     ClientWrapper(
       params.clientAddress,
       params.clientPort,
       params.mtuSize,
       params.dataRateMbps,
       params.filename,
-      params.logLevel
+      params.logLevel,
+      params.compress,
+      params.readerThread
     ).sendData(params.filename);
   }
   catch (const std::exception& exception)
@@ -0,0 +1,348 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "LoadGenerator.hpp"
+#include <algorithm>
+#include <charconv>
+#include <ctime>
+#include <fstream>
+#include <future>
+#include <random>
+#include <sstream>
+#include <boost/asio/post.hpp>
+#include "spdlog/spdlog.h"
+#include "client/ClientWrapper.hpp"
+
+namespace
+{
+  // Sessions still in flight once every client has finished sending get this long to arrive.
+  constexpr auto drainTimeout = std::chrono::seconds(5);
+
+  class LoadTestStream : public StreamInterface
+  {
+  public:
+    explicit LoadTestStream(LoadTestReceiver& receiver):
+      receiver(receiver)
+    {
+    }
+
+    void deleteFile() override
+    {
+      receiver.sessionDropped();
+    }
+
+    void renameFile() override
+    {
+      receiver.sessionComplete(storedFilename, bytesReceived);
+    }
+
+    void setStoredFilename(std::string filename) override
+    {
+      storedFilename = std::move(filename);
+    }
+
+    void write(const BytesBuffer& inputData) override
+    {
+      bytesReceived += inputData.size();
+    }
+
+  private:
+    LoadTestReceiver& receiver;
+    std::string storedFilename;
+    std::uint64_t bytesReceived = 0;
+  };
+
+  std::vector<char> createSyntheticData(std::uint64_t size)
+  {
+    std::vector<char> data(size);
+    std::mt19937 random(2021);
+    std::generate(data.begin(), data.end(), [&random]() { return static_cast<char>(random()); });
+    return data;
+  }
+
+  std::chrono::duration<double> threadCpuTime()
+  {
+    timespec cpuTime{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuTime);
+    return std::chrono::seconds(cpuTime.tv_sec) + std::chrono::nanoseconds(cpuTime.tv_nsec);
+  }
+
+  // The server runs on a single thread, so its CPU time is read by a handler run on that thread.
+  std::chrono::duration<double> serverThreadCpuTime(boost::asio::io_service& serverContext)
+  {
+    const auto cpuTime = std::make_shared<std::promise<std::chrono::duration<double>>>();
+    auto result = cpuTime->get_future();
+    boost::asio::post(serverContext, [cpuTime]() { cpuTime->set_value(threadCpuTime()); });
+    if (result.wait_for(std::chrono::seconds(1)) != std::future_status::ready)
+    {
+      spdlog::error("Server thread is not running, unable to read its CPU time");
+      return {};
+    }
+    return result.get();
+  }
+
+  std::optional<UdpReceiveErrors> readUdpReceiveErrors()
+  {
+    std::ifstream snmp("/proc/net/snmp");
+    return parseUdpReceiveErrors(snmp);
+  }
+
+  double megabitsPerSecond(std::uint64_t bytes, std::chrono::duration<double> time)
+  {
+    return time.count() > 0 ? static_cast<double>(bytes) * 8 / time.count() / 1e6 : 0;
+  }
+}
+
+MemoryStreamBuffer::MemoryStreamBuffer(const char* data, std::size_t size)
+{
+  const auto begin = const_cast<char*>(data);
+  setg(begin, begin, begin + size);
+}
+
+std::string loadTestFilename(std::uint32_t sessionIndex)
+{
+  return "loadtest-" + std::to_string(sessionIndex) + ".bin";
+}
+
+std::optional<std::uint32_t> loadTestSessionIndex(const std::string& filename)
+{
+  const std::string_view prefix = "loadtest-";
+  const std::string_view suffix = ".bin";
+  if (filename.size() <= prefix.size() + suffix.size() || filename.compare(0, prefix.size(), prefix) != 0 ||
+      filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) != 0)
+  {
+    return std::nullopt;
+  }
+  std::uint32_t index{};
+  const auto first = filename.data() + prefix.size();
+  const auto last = filename.data() + filename.size() - suffix.size();
+  const auto result = std::from_chars(first, last, index);
+  if (result.ec != std::errc() || result.ptr != last)
+  {
+    return std::nullopt;
+  }
+  return index;
+}
+
+std::optional<UdpReceiveErrors> parseUdpReceiveErrors(std::istream& snmp)
+{
+  std::vector<std::string> names;
+  for (std::string line; std::getline(snmp, line);)
+  {
+    if (line.compare(0, 5, "Udp: ") != 0)
+    {
+      continue;
+    }
+    std::istringstream fields(line.substr(5));
+    if (names.empty())
+    {
+      for (std::string name; fields >> name;)
+      {
+        names.push_back(name);
+      }
+      continue;
+    }
+
+    std::optional<std::uint64_t> inErrors;
+    std::optional<std::uint64_t> receiveBufferErrors;
+    for (const auto& name : names)
+    {
+      std::uint64_t value{};
+      if (!(fields >> value))
+      {
+        return std::nullopt;
+      }
+      if (name == "InErrors")
+      {
+        inErrors = value;
+      }
+      else if (name == "RcvbufErrors")
+      {
+        receiveBufferErrors = value;
+      }
+    }
+    if (!inErrors || !receiveBufferErrors)
+    {
+      return std::nullopt;
+    }
+    return UdpReceiveErrors{*inErrors, *receiveBufferErrors};
+  }
+  return std::nullopt;
+}
+
+BackgroundLoad::BackgroundLoad(unsigned int threads)
+{
+  for (auto i = 0u; i < threads; ++i)
+  {
+    spinners.emplace_back([this]() {
+      while (!stopping.load(std::memory_order_relaxed))
+      {
+      }
+    });
+  }
+}
+
+BackgroundLoad::~BackgroundLoad()
+{
+  stopping = true;
+  for (auto& spinner : spinners)
+  {
+    spinner.join();
+  }
+}
+
+LoadTestReceiver::LoadTestReceiver(std::uint32_t sessions):
+  received(sessions)
+{
+}
+
+std::unique_ptr<StreamInterface> LoadTestReceiver::createStream(std::uint32_t)
+{
+  return std::make_unique<LoadTestStream>(*this);
+}
+
+void LoadTestReceiver::sessionComplete(const std::string& filename, std::uint64_t bytes)
+{
+  const auto now = std::chrono::steady_clock::now();
+  const std::lock_guard<std::mutex> lock(mutex);
+  ++finished;
+  const auto index = loadTestSessionIndex(filename);
+  if (index && *index < received.size())
+  {
+    received[*index] = ReceivedSession{bytes, now};
+  }
+  else
+  {
+    spdlog::error("Load test received unexpected file: " + filename);
+  }
+}
+
+void LoadTestReceiver::sessionDropped()
+{
+  const std::lock_guard<std::mutex> lock(mutex);
+  ++finished;
+}
+
+std::uint32_t LoadTestReceiver::sessionsFinished() const
+{
+  const std::lock_guard<std::mutex> lock(mutex);
+  return finished;
+}
+
+std::vector<std::optional<LoadTestReceiver::ReceivedSession>> LoadTestReceiver::receivedSessions() const
+{
+  const std::lock_guard<std::mutex> lock(mutex);
+  return received;
+}
+
+LoadTestReport runLoadTest(const LoadTestParams& params, boost::asio::io_service& serverContext,
+  LoadTestReceiver& receiver)
+{
+  std::mt19937_64 random(params.sessions);
+  std::uniform_int_distribution<std::uint64_t> sessionSize(params.minSessionSize, params.maxSessionSize);
+  LoadTestReport report{};
+  for (auto i = 0u; i < params.sessions; ++i)
+  {
+    report.sessions.push_back({sessionSize(random), {}, {}});
+  }
+  const auto syntheticData = createSyntheticData(params.maxSessionSize);
+  spdlog::info("Starting load test of " + std::to_string(params.sessions) + " sessions");
+
+  const auto cpuTimeAtStart = serverThreadCpuTime(serverContext);
+  const auto udpErrorsAtStart = readUdpReceiveErrors();
+  report.start = std::chrono::steady_clock::now();
+
+  std::vector<std::future<void>> senders;
+  for (auto i = 0u; i < params.sessions; ++i)
+  {
+    senders.push_back(std::async(std::launch::async, [&params, &syntheticData, &session = report.sessions.at(i), i]() {
+      MemoryStreamBuffer buffer(syntheticData.data(), session.bytesSent);
+      std::istream inputStream(&buffer);
+      const auto filename = loadTestFilename(i);
+      ThreadTuning::applyToCurrentThread(params.clientThread);
+      const auto sendStart = std::chrono::steady_clock::now();
+      ClientWrapper(
+        params.address, params.port, params.mtuSize, params.dataRateMbps, filename, params.logLevel, false,
+        params.readerThread).sendData(inputStream);
+      session.sendTime = std::chrono::steady_clock::now() - sendStart;
+    }));
+  }
+  for (auto& sender : senders)
+  {
+    sender.get();
+  }
+  report.sendTime = std::chrono::steady_clock::now() - report.start;
+
+  const auto drainDeadline = std::chrono::steady_clock::now() + drainTimeout;
+  while (receiver.sessionsFinished() < params.sessions && std::chrono::steady_clock::now() < drainDeadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  report.receiveCpuTime = serverThreadCpuTime(serverContext) - cpuTimeAtStart;
+  const auto udpErrorsAtEnd = readUdpReceiveErrors();
+  if (udpErrorsAtStart && udpErrorsAtEnd)
+  {
+    report.udpReceiveErrors = UdpReceiveErrors{
+      udpErrorsAtEnd->inErrors - udpErrorsAtStart->inErrors,
+      udpErrorsAtEnd->receiveBufferErrors - udpErrorsAtStart->receiveBufferErrors};
+  }
+
+  const auto received = receiver.receivedSessions();
+  for (auto i = 0u; i < params.sessions; ++i)
+  {
+    report.sessions.at(i).received = received.at(i);
+  }
+  return report;
+}
+
+bool logLoadTestReport(const LoadTestReport& report)
+{
+  std::uint64_t bytesSent = 0;
+  std::uint64_t bytesReceived = 0;
+  std::size_t sessionsReceived = 0;
+  auto lastCompletion = report.start;
+  for (auto i = 0u; i < report.sessions.size(); ++i)
+  {
+    const auto& session = report.sessions.at(i);
+    bytesSent += session.bytesSent;
+    const auto sendRate = megabitsPerSecond(session.bytesSent, session.sendTime);
+    if (session.received)
+    {
+      ++sessionsReceived;
+      bytesReceived += session.received->bytes;
+      lastCompletion = std::max(lastCompletion, session.received->completedAt);
+      const auto receiveTime = session.received->completedAt - report.start;
+      spdlog::info(
+        "Session {}: sent {} bytes in {:.3f}s ({:.1f} Mbps), received {} bytes {:.3f}s after the test started",
+        i, session.bytesSent, session.sendTime.count(), sendRate, session.received->bytes,
+        std::chrono::duration<double>(receiveTime).count());
+    }
+    else
+    {
+      spdlog::info(
+        "Session {}: sent {} bytes in {:.3f}s ({:.1f} Mbps), not received", i, session.bytesSent,
+        session.sendTime.count(), sendRate);
+    }
+  }
+
+  const std::chrono::duration<double> receiveTime = lastCompletion - report.start;
+  const auto completionRatio =
+    report.sessions.empty() ? 1.0 : static_cast<double>(sessionsReceived) / static_cast<double>(report.sessions.size());
+  spdlog::info(
+    "Load test: sent {} bytes in {:.3f}s ({:.1f} Mbps), received {} of {} sessions (completion ratio {:.3f}), "
+    "{} bytes in {:.3f}s ({:.1f} Mbps)",
+    bytesSent, report.sendTime.count(), megabitsPerSecond(bytesSent, report.sendTime), sessionsReceived,
+    report.sessions.size(), completionRatio, bytesReceived, receiveTime.count(),
+    megabitsPerSecond(bytesReceived, receiveTime));
+  spdlog::info(
+    "Load test: receive thread CPU {:.3f}s ({:.1f}% of the receive time)", report.receiveCpuTime.count(),
+    receiveTime.count() > 0 ? 100 * report.receiveCpuTime.count() / receiveTime.count() : 0);
+  if (report.udpReceiveErrors)
+  {
+    spdlog::info(
+      "Load test: {} UDP receive errors, {} for want of socket buffer space, across the host",
+      report.udpReceiveErrors->inErrors, report.udpReceiveErrors->receiveBufferErrors);
+  }
+
+  return sessionsReceived == report.sessions.size();
+}
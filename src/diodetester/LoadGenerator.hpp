@@ -0,0 +1,126 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef LOADGENERATOR_HPP
+#define LOADGENERATOR_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio/io_service.hpp>
+#include "StreamInterface.hpp"
+#include "ThreadTuning.hpp"
+
+struct LoadTestParams
+{
+  std::string address;
+  std::uint16_t port;
+  std::uint16_t mtuSize;
+  double dataRateMbps;
+  std::uint32_t sessions;
+  std::uint64_t minSessionSize;
+  std::uint64_t maxSessionSize;
+  std::string logLevel;
+  ThreadTuning::ThreadSettings clientThread;
+  ThreadTuning::ThreadSettings readerThread;
+};
+
+// Read only stream buffer over memory owned elsewhere, so each session can send from the shared synthetic data.
+class MemoryStreamBuffer : public std::streambuf
+{
+public:
+  MemoryStreamBuffer(const char* data, std::size_t size);
+};
+
+std::string loadTestFilename(std::uint32_t sessionIndex);
+std::optional<std::uint32_t> loadTestSessionIndex(const std::string& filename);
+
+// Receive side record of the synthetic sessions. Streams are created and written on the server thread while the
+// load generator polls from another, so access is locked.
+class LoadTestReceiver
+{
+public:
+  struct ReceivedSession
+  {
+    std::uint64_t bytes;
+    std::chrono::steady_clock::time_point completedAt;
+  };
+
+  explicit LoadTestReceiver(std::uint32_t sessions);
+
+  std::unique_ptr<StreamInterface> createStream(std::uint32_t sessionId);
+  void sessionComplete(const std::string& filename, std::uint64_t bytes);
+  void sessionDropped();
+
+  std::uint32_t sessionsFinished() const;
+  std::vector<std::optional<ReceivedSession>> receivedSessions() const;
+
+private:
+  mutable std::mutex mutex;
+  std::vector<std::optional<ReceivedSession>> received;
+  std::uint32_t finished = 0;
+};
+
+// Host wide UDP receive error counters. The kernel counts a datagram dropped for want of socket buffer space in
+// both; InErrors also counts checksum and other receive failures.
+struct UdpReceiveErrors
+{
+  std::uint64_t inErrors;
+  std::uint64_t receiveBufferErrors;
+};
+
+// Parses the counters from the Udp lines of /proc/net/snmp.
+std::optional<UdpReceiveErrors> parseUdpReceiveErrors(std::istream& snmp);
+
+// Keeps threads busy spinning on every core for as long as it exists, so a load test shows how the transfer copes
+// with contention for the CPU, and what pinning and real-time scheduling do about it.
+class BackgroundLoad
+{
+public:
+  explicit BackgroundLoad(unsigned int threads);
+  ~BackgroundLoad();
+
+  BackgroundLoad(const BackgroundLoad&) = delete;
+  BackgroundLoad& operator=(const BackgroundLoad&) = delete;
+
+private:
+  std::atomic<bool> stopping = false;
+  std::vector<std::thread> spinners;
+};
+
+struct LoadTestReport
+{
+  struct Session
+  {
+    std::uint64_t bytesSent;
+    std::chrono::duration<double> sendTime;
+    std::optional<LoadTestReceiver::ReceivedSession> received;
+  };
+
+  std::vector<Session> sessions;
+  std::chrono::steady_clock::time_point start;
+  std::chrono::duration<double> sendTime;
+  std::chrono::duration<double> receiveCpuTime;
+  // Change over the test, if /proc/net/snmp could be read. Counts every UDP socket on the host.
+  std::optional<UdpReceiveErrors> udpReceiveErrors;
+};
+
+// Sends params.sessions concurrent sessions of random in-memory data, with sizes drawn uniformly from
+// [minSessionSize, maxSessionSize], to a server running on serverContext whose streams come from receiver.
+LoadTestReport runLoadTest(const LoadTestParams& params, boost::asio::io_service& serverContext,
+  LoadTestReceiver& receiver);
+
+// Logs per-session and aggregate throughput, the completion ratio, the receive thread CPU use and the UDP receive
+// drops.
+// Returns true if every session was received.
+bool logLoadTestReport(const LoadTestReport& report);
+
+#endif //LOADGENERATOR_HPP
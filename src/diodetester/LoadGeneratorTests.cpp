@@ -0,0 +1,103 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <future>
+#include <istream>
+#include <sstream>
+#include "test/catch.hpp"
+#include "LoadGenerator.hpp"
+#include "Server.hpp"
+#include "UdpServer.hpp"
+
+TEST_CASE("Load generator. Memory stream buffer reads exactly the given bytes")
+{
+  const std::string data = "abcdefgh";
+  MemoryStreamBuffer buffer(data.data(), 5);
+  std::istream inputStream(&buffer);
+
+  std::vector<char> read(8);
+  REQUIRE(inputStream.read(read.data(), 3).gcount() == 3);
+  REQUIRE(inputStream.read(read.data() + 3, 5).gcount() == 2);
+  REQUIRE(std::string(read.data(), 5) == "abcde");
+  REQUIRE(inputStream.eof());
+}
+
+TEST_CASE("Load generator. Session filenames map back to the session index")
+{
+  REQUIRE(loadTestFilename(12) == "loadtest-12.bin");
+  REQUIRE(loadTestSessionIndex(loadTestFilename(0)) == 0u);
+  REQUIRE(loadTestSessionIndex(loadTestFilename(4294967295)) == 4294967295u);
+  REQUIRE(!loadTestSessionIndex("loadtest-.bin"));
+  REQUIRE(!loadTestSessionIndex("loadtest-1x.bin"));
+  REQUIRE(!loadTestSessionIndex("other-1.bin"));
+  REQUIRE(!loadTestSessionIndex("rejected."));
+}
+
+TEST_CASE("Load generator. Receiver records completed and dropped sessions")
+{
+  LoadTestReceiver receiver(3);
+
+  auto completed = receiver.createStream(100);
+  completed->write(BytesBuffer(10));
+  completed->write(BytesBuffer(5));
+  completed->setStoredFilename(loadTestFilename(1));
+  completed->renameFile();
+
+  receiver.createStream(101)->deleteFile();
+
+  REQUIRE(receiver.sessionsFinished() == 2);
+  const auto received = receiver.receivedSessions();
+  REQUIRE(received.size() == 3);
+  REQUIRE(!received.at(0));
+  REQUIRE(received.at(1)->bytes == 15);
+  REQUIRE(!received.at(2));
+}
+
+TEST_CASE("Load generator. UDP receive errors are read from the snmp counters")
+{
+  std::istringstream snmp(
+    "Ip: Forwarding DefaultTTL\n"
+    "Ip: 1 64\n"
+    "Udp: InDatagrams NoPorts InErrors OutDatagrams RcvbufErrors SndbufErrors InCsumErrors IgnoredMulti\n"
+    "Udp: 1000 3 25 900 20 0 5 0\n"
+    "UdpLite: InDatagrams NoPorts InErrors OutDatagrams RcvbufErrors SndbufErrors InCsumErrors IgnoredMulti\n"
+    "UdpLite: 0 0 7 0 7 0 0 0\n");
+  const auto errors = parseUdpReceiveErrors(snmp);
+  REQUIRE(errors);
+  REQUIRE(errors->inErrors == 25);
+  REQUIRE(errors->receiveBufferErrors == 20);
+
+  SECTION("Missing counters are not reported")
+  {
+    std::istringstream truncated("Udp: InDatagrams NoPorts InErrors\nUdp: 1000 3\n");
+    REQUIRE_FALSE(parseUdpReceiveErrors(truncated));
+    std::istringstream noUdp("Ip: Forwarding DefaultTTL\nIp: 1 64\n");
+    REQUIRE_FALSE(parseUdpReceiveErrors(noUdp));
+  }
+}
+
+TEST_CASE("Load generator. Concurrent sessions are all received", "[integration]")
+{
+  boost::asio::io_service io_context;
+  const std::uint16_t mtuSize = 1500;
+  const auto maxBufferSize = EnterpriseDiode::calculateMaxBufferSize(mtuSize);
+  LoadTestReceiver receiver(4);
+  Server edServer(
+    std::make_unique<UdpServer>(2010, io_context, maxBufferSize, EnterpriseDiode::UDPSocketSizeInBytes),
+    maxBufferSize, 1024, [&receiver](std::uint32_t sessionId) { return receiver.createStream(sessionId); },
+    []() { return std::time(nullptr); }, 15, DiodeType::basic);
+  auto serverHandle = std::async(std::launch::async, [&io_context]() { io_context.run(); });
+
+  const auto report = runLoadTest({"localhost", 2010, mtuSize, 100, 4, 64 * 1024, 128 * 1024, "info", {}, {}}, io_context,
+    receiver);
+  io_context.stop();
+
+  REQUIRE(report.sessions.size() == 4);
+  REQUIRE(logLoadTestReport(report));
+  for (const auto& session : report.sessions)
+  {
+    REQUIRE(session.bytesSent >= 64 * 1024);
+    REQUIRE(session.bytesSent <= 128 * 1024);
+    REQUIRE(session.received->bytes == session.bytesSent);
+  }
+}
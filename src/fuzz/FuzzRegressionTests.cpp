@@ -0,0 +1,141 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "FuzzTargets.hpp"
+#include <BytesBuffer.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <test/catch.hpp>
+
+namespace
+{
+  struct FuzzTarget
+  {
+    const char* corpus;
+    void (*parse)(const std::uint8_t* data, std::size_t size);
+  };
+
+  const std::array<FuzzTarget, 4> fuzzTargets{{
+    {"edheader", FuzzTargets::edHeader},
+    {"cloakeddagger", FuzzTargets::cloakedDagger},
+    {"sislfilename", FuzzTargets::sislFilename},
+    {"sisltojson", FuzzTargets::sislToJson}}};
+
+  std::vector<BytesBuffer> readCorpus(const std::string& corpus)
+  {
+    std::vector<std::filesystem::path> paths;
+    for (const auto& entry : std::filesystem::directory_iterator(std::filesystem::path(FUZZ_CORPUS_DIRECTORY) / corpus))
+    {
+      paths.push_back(entry.path());
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<BytesBuffer> inputs;
+    for (const auto& path : paths)
+    {
+      std::ifstream file(path, std::ios::binary);
+      inputs.emplace_back(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    return inputs;
+  }
+
+  // A few libFuzzer style edits, so the replay covers the neighbourhood of each seed and not just the seed itself.
+  BytesBuffer mutate(BytesBuffer input, std::mt19937& random)
+  {
+    const auto randomIndex = [&random](std::size_t size) {
+      return std::uniform_int_distribution<std::size_t>(0, size - 1)(random);
+    };
+    const auto randomByte = [&random]() {
+      return static_cast<std::uint8_t>(std::uniform_int_distribution<unsigned int>(0, 255)(random));
+    };
+
+    const auto edits = std::uniform_int_distribution<int>(1, 4)(random);
+    for (auto edit = 0; edit < edits; ++edit)
+    {
+      switch (std::uniform_int_distribution<int>(0, 4)(random))
+      {
+        case 0:
+          if (!input.empty())
+          {
+            input[randomIndex(input.size())] ^= static_cast<std::uint8_t>(1u << randomIndex(8));
+          }
+          break;
+        case 1:
+          if (!input.empty())
+          {
+            input[randomIndex(input.size())] = randomByte();
+          }
+          break;
+        case 2:
+          input.insert(input.begin() + static_cast<long>(randomIndex(input.size() + 1)), randomByte());
+          break;
+        case 3:
+          if (!input.empty())
+          {
+            input.erase(input.begin() + static_cast<long>(randomIndex(input.size())));
+          }
+          break;
+        case 4:
+        default:
+          input.resize(randomIndex(input.size() + 1));
+          break;
+      }
+    }
+    return input;
+  }
+
+  void parseMutatedCorpora(std::mt19937& random)
+  {
+    constexpr auto mutationsPerInput = 200;
+    for (const auto& target : fuzzTargets)
+    {
+      INFO("Corpus: " << target.corpus);
+      for (const auto& input : readCorpus(target.corpus))
+      {
+        for (auto i = 0; i < mutationsPerInput; ++i)
+        {
+          const auto mutated = mutate(input, random);
+          REQUIRE_NOTHROW(target.parse(mutated.data(), mutated.size()));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("Fuzz regression. Seed corpora and crash reproducers are handled")
+{
+  for (const auto& target : fuzzTargets)
+  {
+    INFO("Corpus: " << target.corpus);
+    const auto inputs = readCorpus(target.corpus);
+    REQUIRE(!inputs.empty());
+    for (const auto& input : inputs)
+    {
+      REQUIRE_NOTHROW(target.parse(input.data(), input.size()));
+    }
+  }
+}
+
+TEST_CASE("Fuzz regression. Mutated corpus inputs are handled")
+{
+  std::mt19937 random(2021);
+  parseMutatedCorpora(random);
+}
+
+// Hidden from the default run, as its time depends on the machine; use: UnitTests "[benchmark]"
+TEST_CASE("Fuzz regression. Mutated corpus inputs are handled within the time budget", "[.][benchmark]")
+{
+  // Generous enough for an unoptimised build; a parser that has become pathologically slow still trips it.
+  constexpr auto timeBudget = std::chrono::seconds(5);
+
+  std::mt19937 random(2021);
+  const auto start = std::chrono::steady_clock::now();
+  parseMutatedCorpora(random);
+  REQUIRE(std::chrono::steady_clock::now() - start < timeBudget);
+}
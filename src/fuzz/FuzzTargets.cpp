@@ -0,0 +1,65 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "FuzzTargets.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+#include "diodeheader/EnterpriseDiodeHeader.hpp"
+#include "rewrapper/CloakedDagger.hpp"
+#include "SISLFilename.hpp"
+#include "SislTools/library/BoostSpiritSislParser.hpp"
+
+namespace FuzzTargets
+{
+  void edHeader(const std::uint8_t* data, std::size_t size)
+  {
+    try
+    {
+      const EDHeader header(std::vector<std::uint8_t>(data, data + size));
+    }
+    catch (const std::runtime_error&)
+    {
+    }
+  }
+
+  void cloakedDagger(const std::uint8_t* data, std::size_t size)
+  {
+    // The server only builds a CloakedDagger from the fixed size field of a header that has passed EDHeader.
+    CloakedDaggerHeader header{};
+    std::copy_n(data, std::min(size, header.size()), reinterpret_cast<std::uint8_t*>(header.data()));
+    bool parsed = true;
+    try
+    {
+      const CloakedDagger cloakedDagger(header);
+    }
+    catch (const std::runtime_error&)
+    {
+      parsed = false;
+    }
+    // The receive path relies on the view accepting exactly the headers the full parse accepts.
+    if (CloakedDaggerView(header).isValid() != parsed)
+    {
+      std::abort();
+    }
+  }
+
+  void sislFilename(const std::uint8_t* data, std::size_t size)
+  {
+    static const SISLFilename sislFilename(1000);
+    static_cast<void>(sislFilename.extractFilename(BytesBuffer(data, data + size)));
+  }
+
+  void sislToJson(const std::uint8_t* data, std::size_t size)
+  {
+    try
+    {
+      SislToolsInternal::parseSislToJson(std::string_view(reinterpret_cast<const char*>(data), size));
+    }
+    catch (const std::runtime_error&)
+    {
+    }
+  }
+}
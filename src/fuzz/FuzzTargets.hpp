@@ -0,0 +1,21 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef ED_FUZZTARGETS_HPP
+#define ED_FUZZTARGETS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Entry points shared by the libFuzzer executables and the replay tests in UnitTests. Each feeds untrusted bytes to
+// one of the parsers the server runs on received datagrams. Rejecting the input with std::runtime_error is expected;
+// any other exception, assert or sanitizer report is a bug.
+namespace FuzzTargets
+{
+  void edHeader(const std::uint8_t* data, std::size_t size);
+  void cloakedDagger(const std::uint8_t* data, std::size_t size);
+  void sislFilename(const std::uint8_t* data, std::size_t size);
+  void sislToJson(const std::uint8_t* data, std::size_t size);
+}
+
+#endif //ED_FUZZTARGETS_HPP
@@ -0,0 +1,11 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+// libFuzzer entry point. Built once per target, FUZZ_TARGET names the FuzzTargets function to call.
+#include "FuzzTargets.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+  FuzzTargets::FUZZ_TARGET(data, size);
+  return 0;
+}
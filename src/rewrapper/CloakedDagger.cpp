@@ -3,25 +3,32 @@
 
 #include "CloakedDagger.hpp"
 #include <BytesBuffer.hpp>
-#include <Parsing.hpp>
 #include <array>
 #include <boost/endian/conversion.hpp>
 
+namespace
+{
+  const std::uint8_t* bytes(const CloakedDaggerHeader& cloakedDaggerHeader)
+  {
+    return reinterpret_cast<const std::uint8_t*>(cloakedDaggerHeader.data());
+  }
+}
+
 CloakedDagger::CloakedDagger(const CloakedDaggerHeader& cloakedDaggerHeader):
-  magic1(Parsing::extract<std::uint32_t>(cloakedDaggerHeader, 0)),
-  majorVersion(Parsing::extract<std::uint16_t>(cloakedDaggerHeader, 4)),
-  minorVersion(Parsing::extract<std::uint16_t>(cloakedDaggerHeader, 6)),
-  headerLength(Parsing::extract<std::uint32_t>(cloakedDaggerHeader, 8)),
-  encapsulationType(Parsing::extract<std::uint32_t>(cloakedDaggerHeader, 12)),
-  encapsulationConfig(Parsing::extract<std::uint16_t>(cloakedDaggerHeader, 16)),
-  encapsulationDataLength(Parsing::extract<std::uint16_t>(cloakedDaggerHeader, 18)),
-  key(Parsing::extract<std::array<char, maskLength>>(cloakedDaggerHeader, 20)),
-  headerChecksumType(Parsing::extract<std::uint32_t>(cloakedDaggerHeader, 28)),
-  headerChecksumConfig(Parsing::extract<std::uint16_t>(cloakedDaggerHeader, 32)),
-  headerChecksumDataLength(Parsing::extract<std::uint16_t>(cloakedDaggerHeader, 34)),
-  dataChecksumType(Parsing::extract<std::uint32_t>(cloakedDaggerHeader, 36)),
-  dataChecksumDataLength(Parsing::extract<std::uint32_t>(cloakedDaggerHeader, 40)),
-  magic2(Parsing::extract<std::uint32_t>(cloakedDaggerHeader, 44))
+  magic1(CloakedDaggerLayout::Magic1::read(bytes(cloakedDaggerHeader))),
+  majorVersion(CloakedDaggerLayout::MajorVersion::read(bytes(cloakedDaggerHeader))),
+  minorVersion(CloakedDaggerLayout::MinorVersion::read(bytes(cloakedDaggerHeader))),
+  headerLength(CloakedDaggerLayout::HeaderLength::read(bytes(cloakedDaggerHeader))),
+  encapsulationType(CloakedDaggerLayout::EncapsulationType::read(bytes(cloakedDaggerHeader))),
+  encapsulationConfig(CloakedDaggerLayout::EncapsulationConfig::read(bytes(cloakedDaggerHeader))),
+  encapsulationDataLength(CloakedDaggerLayout::EncapsulationDataLength::read(bytes(cloakedDaggerHeader))),
+  key(CloakedDaggerLayout::Key::read(bytes(cloakedDaggerHeader))),
+  headerChecksumType(CloakedDaggerLayout::HeaderChecksumType::read(bytes(cloakedDaggerHeader))),
+  headerChecksumConfig(CloakedDaggerLayout::HeaderChecksumConfig::read(bytes(cloakedDaggerHeader))),
+  headerChecksumDataLength(CloakedDaggerLayout::HeaderChecksumDataLength::read(bytes(cloakedDaggerHeader))),
+  dataChecksumType(CloakedDaggerLayout::DataChecksumType::read(bytes(cloakedDaggerHeader))),
+  dataChecksumDataLength(CloakedDaggerLayout::DataChecksumDataLength::read(bytes(cloakedDaggerHeader))),
+  magic2(CloakedDaggerLayout::Magic2::read(bytes(cloakedDaggerHeader)))
 {
   throwIfHeaderInvalid();
 }
@@ -10,8 +10,77 @@
 #include <cstring>
 #include "BytesBuffer.hpp"
 #include "CloakedDaggerHeader.hpp"
+#include "HeaderLayout.hpp"
 #include <array>
 
+namespace CloakedDaggerLayout
+{
+  using HeaderLayout::Field;
+
+  // Multi byte fields are big endian on the wire.
+  using Magic1 = Field<std::uint32_t, 0>;
+  using MajorVersion = Field<std::uint16_t, 4>;
+  using MinorVersion = Field<std::uint16_t, 6>;
+  using HeaderLength = Field<std::uint32_t, 8>;
+  using EncapsulationType = Field<std::uint32_t, 12>;
+  using EncapsulationConfig = Field<std::uint16_t, 16>;
+  using EncapsulationDataLength = Field<std::uint16_t, 18>;
+  using Key = Field<std::array<char, 8>, 20>;
+  using HeaderChecksumType = Field<std::uint32_t, 28>;
+  using HeaderChecksumConfig = Field<std::uint16_t, 32>;
+  using HeaderChecksumDataLength = Field<std::uint16_t, 34>;
+  using DataChecksumType = Field<std::uint32_t, 36>;
+  using DataChecksumDataLength = Field<std::uint32_t, 40>;
+  using Magic2 = Field<std::uint32_t, 44>;
+
+  static_assert(HeaderLayout::tiles<std::tuple_size_v<CloakedDaggerHeader>,
+    Magic1, MajorVersion, MinorVersion, HeaderLength, EncapsulationType, EncapsulationConfig,
+    EncapsulationDataLength, Key, HeaderChecksumType, HeaderChecksumConfig, HeaderChecksumDataLength,
+    DataChecksumType, DataChecksumDataLength, Magic2>());
+
+  using Version = HeaderLayout::Span<std::uint32_t, MajorVersion, MinorVersion>;
+  using Encapsulation = HeaderLayout::Span<std::uint64_t, EncapsulationType, EncapsulationDataLength>;
+}
+
+// Reads a Cloaked Dagger header in place. isValid checks the same fields as the CloakedDagger constructor
+// without branching, so the receive path can check every frame cheaply.
+class CloakedDaggerView
+{
+public:
+  explicit CloakedDaggerView(const std::uint8_t* header) noexcept:
+    header(header)
+  {
+  }
+
+  explicit CloakedDaggerView(const CloakedDaggerHeader& header) noexcept:
+    header(reinterpret_cast<const std::uint8_t*>(header.data()))
+  {
+  }
+
+  [[nodiscard]] bool isValid() const noexcept
+  {
+    using namespace CloakedDaggerLayout;
+    const auto magic = (std::uint64_t{Magic1::read(header)} << 32) | Magic2::read(header);
+    return ((magic ^ expectedMagic) | (Version::read(header) ^ expectedVersion) |
+            (Encapsulation::read(header) ^ expectedEncapsulation)) == 0;
+  }
+
+  [[nodiscard]] std::array<char, 8> key() const noexcept { return CloakedDaggerLayout::Key::read(header); }
+
+  [[nodiscard]] const std::uint8_t* data() const noexcept { return header; }
+
+private:
+  static constexpr std::uint64_t expectedMagic =
+    (std::uint64_t{HeaderLayout::fromWire<std::uint32_t>(0xd1df5fff)} << 32) |
+    HeaderLayout::fromWire<std::uint32_t>(0xff5fdfd1);
+  // Major version 1, minor version 0.
+  static constexpr std::uint32_t expectedVersion = HeaderLayout::fromWire<std::uint32_t>(0x00010000);
+  // Encapsulation type 1 (XOR mask), config 3, with an 8 byte mask.
+  static constexpr std::uint64_t expectedEncapsulation = HeaderLayout::fromWire<std::uint64_t>(0x0000000100030008);
+
+  const std::uint8_t* header;
+};
+
 class CloakedDagger
 {
 public:
@@ -43,5 +112,7 @@ private:
   void throwIfHeaderInvalid() const;
 };
 
+static_assert(CloakedDagger::headerSize() == std::tuple_size_v<CloakedDaggerHeader>);
+static_assert(CloakedDaggerLayout::Key::size == CloakedDagger::maskLength);
 
 #endif //REWRAPPER_CLOAKEDDAGGERHEADER_HPP
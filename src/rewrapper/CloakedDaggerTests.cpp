@@ -0,0 +1,51 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "test/catch.hpp"
+#include "CloakedDagger.hpp"
+#include "UnwrapperTestHelpers.hpp"
+
+TEST_CASE("Cloaked Dagger. View of a valid header")
+{
+  const auto header = createTestWrappedString("abc", {1, 2, 3, 4, 5, 6, 7, 8}).header;
+  const CloakedDaggerView view(header);
+
+  REQUIRE(view.isValid());
+  REQUIRE(view.key() == std::array<char, 8>{1, 2, 3, 4, 5, 6, 7, 8});
+  REQUIRE(view.key() == CloakedDagger(header).key);
+}
+
+TEST_CASE("Cloaked Dagger. View rejects the same headers as the full parse")
+{
+  auto header = createTestWrappedString("abc").header;
+  const auto index = GENERATE(
+    0, 1, 2, 3, // magic1
+    4, 5, 6, 7, // major and minor version
+    12, 13, 14, 15, // encapsulation type
+    16, 17, 18, 19, // encapsulation config and mask length
+    44, 45, 46, 47); // magic2
+  header.at(static_cast<std::size_t>(index)) ^= 0x10;
+
+  REQUIRE_FALSE(CloakedDaggerView(header).isValid());
+  REQUIRE_THROWS_AS(CloakedDagger(header), std::runtime_error);
+}
+
+TEST_CASE("Cloaked Dagger. Length, key and checksum fields are not validated")
+{
+  auto header = createTestWrappedString("abc").header;
+  const auto index = GENERATE(8, 9, 10, 11, 20, 27, 28, 35, 36, 43);
+  header.at(static_cast<std::size_t>(index)) ^= 0x10;
+
+  REQUIRE(CloakedDaggerView(header).isValid());
+  REQUIRE_NOTHROW(CloakedDagger(header));
+}
+
+TEST_CASE("Cloaked Dagger. Layout fields are read in wire order")
+{
+  const auto header = createTestWrappedString("abc").header;
+  const auto* bytes = reinterpret_cast<const std::uint8_t*>(header.data());
+
+  REQUIRE(CloakedDaggerLayout::HeaderLength::read(bytes) == HeaderLayout::fromWire<std::uint32_t>(0x30));
+  REQUIRE(CloakedDaggerLayout::EncapsulationConfig::read(bytes) == HeaderLayout::fromWire<std::uint16_t>(3));
+  REQUIRE(HeaderLayout::fromWire<std::uint8_t>(0xab) == 0xab);
+}
@@ -0,0 +1,108 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "ParallelRewrapper.hpp"
+#include <algorithm>
+#include "ThreadTuning.hpp"
+
+namespace
+{
+  // Each thread takes about a quarter of its even share of a batch at a time.
+  constexpr std::size_t chunksPerThread = 4;
+}
+
+ParallelRewrapper::ParallelRewrapper(unsigned int threadCount)
+{
+  for (unsigned int thread = 0; thread < threadCount; ++thread)
+  {
+    workers.emplace_back([this]() { work(); });
+  }
+}
+
+ParallelRewrapper::~ParallelRewrapper()
+{
+  {
+    std::lock_guard lock(mutex);
+    stopping = true;
+  }
+  batchReady.notify_all();
+  for (auto& worker : workers)
+  {
+    worker.join();
+  }
+}
+
+void ParallelRewrapper::rewrap(std::vector<RewrapJob>& jobs)
+{
+  {
+    std::lock_guard lock(mutex);
+    batch = &jobs;
+    nextJob = 0;
+    jobsDone = 0;
+    ++batchNumber;
+  }
+  batchReady.notify_all();
+  rewrapJobs();
+
+  std::unique_lock lock(mutex);
+  batchDone.wait(lock, [this, &jobs]() { return jobsDone == jobs.size(); });
+  batch = nullptr;
+}
+
+void ParallelRewrapper::work()
+{
+  // Started from the receive thread, whose cores and real-time priority it would otherwise share.
+  ThreadTuning::applyToCurrentThread({});
+  std::uint64_t lastBatch = 0;
+  while (true)
+  {
+    {
+      std::unique_lock lock(mutex);
+      batchReady.wait(lock, [this, lastBatch]() { return stopping || (batch != nullptr && batchNumber != lastBatch); });
+      if (stopping)
+      {
+        return;
+      }
+      lastBatch = batchNumber;
+    }
+    rewrapJobs();
+  }
+}
+
+// Frames are taken a few at a time, so a thread that is slow to wake only does less of the batch.
+void ParallelRewrapper::rewrapJobs()
+{
+  while (true)
+  {
+    std::vector<RewrapJob>* jobs = nullptr;
+    std::size_t first = 0;
+    std::size_t last = 0;
+    {
+      std::lock_guard lock(mutex);
+      if (batch == nullptr || nextJob == batch->size())
+      {
+        return;
+      }
+      jobs = batch;
+      const auto chunk = std::max<std::size_t>(1, jobs->size() / (chunksPerThread * (workers.size() + 1)));
+      first = nextJob;
+      last = std::min(jobs->size(), first + chunk);
+      nextJob = last;
+    }
+    for (auto index = first; index < last; ++index)
+    {
+      auto& job = (*jobs)[index];
+      if (job.plan.wrapped)
+      {
+        StreamingRewrapper::apply(job.input, job.plan, job.output);
+      }
+    }
+
+    std::lock_guard lock(mutex);
+    jobsDone += last - first;
+    if (jobsDone == jobs->size())
+    {
+      batchDone.notify_one();
+    }
+  }
+}
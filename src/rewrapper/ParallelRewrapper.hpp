@@ -0,0 +1,53 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef REWRAPPER_PARALLELREWRAPPER_HPP
+#define REWRAPPER_PARALLELREWRAPPER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "BytesBuffer.hpp"
+#include "StreamingRewrapper.hpp"
+
+// One frame of a batch: planned in order by the session's StreamingRewrapper, rewrapped into output on any thread.
+struct RewrapJob
+{
+  BytesBuffer input;
+  StreamingRewrapper::FramePlan plan;
+  BytesBuffer output;
+};
+
+// Rewraps the frames of a batch on a pool of worker threads, so one large import session is not limited to what the
+// network thread can XOR. Only a batch of frames that are already planned is spread out, so frames are still written
+// in order. Shared by every session, which the network thread handles one at a time.
+class ParallelRewrapper
+{
+public:
+  explicit ParallelRewrapper(unsigned int threadCount);
+  ~ParallelRewrapper();
+
+  ParallelRewrapper(const ParallelRewrapper&) = delete;
+  ParallelRewrapper& operator=(const ParallelRewrapper&) = delete;
+
+  // Returns once every wrapped frame of jobs has its output, having taken a share of the work itself.
+  void rewrap(std::vector<RewrapJob>& jobs);
+
+private:
+  void work();
+  void rewrapJobs();
+
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable batchReady;
+  std::condition_variable batchDone;
+  std::vector<RewrapJob>* batch = nullptr;
+  std::size_t nextJob = 0;
+  std::size_t jobsDone = 0;
+  std::uint64_t batchNumber = 0;
+  bool stopping = false;
+};
+
+#endif //REWRAPPER_PARALLELREWRAPPER_HPP
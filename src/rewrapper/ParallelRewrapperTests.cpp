@@ -0,0 +1,93 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <src/test/catch.hpp>
+#include "BytesBuffer.hpp"
+#include "ParallelRewrapper.hpp"
+#include "StreamingRewrapper.hpp"
+#include "UnwrapperTestHelpers.hpp"
+
+namespace
+{
+  // Frames of different lengths, so their offsets in the stream are not a multiple of the mask length.
+  std::string framePayload(std::size_t frame)
+  {
+    return std::string(1 + (frame * 37) % 301, static_cast<char>('a' + frame % 26));
+  }
+}
+
+TEST_CASE("ParallelRewrapper. Frames rewrapped in a batch match those rewrapped one at a time")
+{
+  const std::array<char, 8> firstKey{0x12, 0x34, 0x56, 0x78, static_cast<char>(0x9a), static_cast<char>(0xbc),
+    static_cast<char>(0xde), static_cast<char>(0xf0)};
+  const std::array<char, 8> secondKey{0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+  const auto threadCount = GENERATE(0u, 1u, 3u);
+  constexpr std::size_t frameCount = 200;
+
+  StreamingRewrapper serialRewrapper;
+  StreamingRewrapper plannedRewrapper;
+  const auto first = createTestWrappedString("first", firstKey);
+  REQUIRE(serialRewrapper.rewrap(first.message, first.header, 1) ==
+          plannedRewrapper.rewrap(first.message, first.header, 1));
+
+  std::vector<BytesBuffer> expected;
+  std::vector<RewrapJob> jobs;
+  for (std::size_t frame = 2; frame < frameCount; ++frame)
+  {
+    const auto input = createTestWrappedString(framePayload(frame), frame % 3 == 0 ? secondKey : firstKey);
+    expected.push_back(serialRewrapper.rewrap(input.message, input.header, static_cast<std::uint32_t>(frame)));
+    jobs.push_back({input.message, plannedRewrapper.plan(input.message, input.header), {}});
+  }
+
+  ParallelRewrapper parallelRewrapper(threadCount);
+  parallelRewrapper.rewrap(jobs);
+  for (std::size_t job = 0; job < jobs.size(); ++job)
+  {
+    REQUIRE(jobs[job].plan.wrapped);
+    REQUIRE(jobs[job].output == expected[job]);
+  }
+}
+
+TEST_CASE("ParallelRewrapper. Unwrapped frames are left as they are")
+{
+  StreamingRewrapper streamingRewrapper;
+  const BytesBuffer first{'{', 'a'};
+  REQUIRE(streamingRewrapper.rewrap(first, CloakedDaggerHeader(), 1) == first);
+
+  std::vector<RewrapJob> jobs;
+  const BytesBuffer next{'B', 'c'};
+  jobs.push_back({next, streamingRewrapper.plan(next, CloakedDaggerHeader()), {}});
+
+  ParallelRewrapper parallelRewrapper(2);
+  parallelRewrapper.rewrap(jobs);
+  REQUIRE_FALSE(jobs[0].plan.wrapped);
+  REQUIRE(jobs[0].output.empty());
+}
+
+TEST_CASE("ParallelRewrapper. The pool is reused for batch after batch")
+{
+  StreamingRewrapper serialRewrapper;
+  StreamingRewrapper plannedRewrapper;
+  const auto first = createTestWrappedString("first");
+  static_cast<void>(serialRewrapper.rewrap(first.message, first.header, 1));
+  static_cast<void>(plannedRewrapper.rewrap(first.message, first.header, 1));
+
+  ParallelRewrapper parallelRewrapper(4);
+  std::uint32_t frameCount = 2;
+  for (std::size_t batchSize : {1, 0, 7, 64, 3})
+  {
+    std::vector<BytesBuffer> expected;
+    std::vector<RewrapJob> jobs;
+    for (std::size_t job = 0; job < batchSize; ++job, ++frameCount)
+    {
+      const auto input = createTestWrappedString(framePayload(frameCount));
+      expected.push_back(serialRewrapper.rewrap(input.message, input.header, frameCount));
+      jobs.push_back({input.message, plannedRewrapper.plan(input.message, input.header), {}});
+    }
+    parallelRewrapper.rewrap(jobs);
+    for (std::size_t job = 0; job < batchSize; ++job)
+    {
+      REQUIRE(jobs[job].output == expected[job]);
+    }
+  }
+}
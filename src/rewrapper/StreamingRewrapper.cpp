@@ -2,68 +2,129 @@
 // MIT License. For licence terms see LICENCE.md file.
 
 #include "StreamingRewrapper.hpp"
+#include <cstring>
 #include "BytesBuffer.hpp"
 #include "CloakedDagger.hpp"
 
-BytesBuffer StreamingRewrapper::rewrap(const BytesBuffer& input, const CloakedDaggerHeader& cloakedDaggerHeader, std::uint32_t frameCount)
+namespace
 {
-  if (cloakedDaggerHeader.at(0) != static_cast<char>(CloakedDagger::cloakedDaggerIdentifierByte))
+  bool isWrapped(const BytesBuffer& input, const CloakedDaggerHeader& cloakedDaggerHeader)
   {
-    if (input.at(0) != '{' && input.at(0) != 'B')
+    if (cloakedDaggerHeader.at(0) != static_cast<char>(CloakedDagger::cloakedDaggerIdentifierByte))
     {
-      throw std::runtime_error("received data that was not wrapped, sisl nor bitmap!");
+      if (input.at(0) != '{' && input.at(0) != 'B')
+      {
+        throw std::runtime_error("received data that was not wrapped, sisl nor bitmap!");
+      }
+      return false;
     }
+    return true;
+  }
+}
+
+const BytesBuffer& StreamingRewrapper::rewrap(const BytesBuffer& input, const CloakedDaggerHeader& cloakedDaggerHeader, std::uint32_t frameCount)
+{
+  if (frameCount != 1)
+  {
+    const auto framePlan = plan(input, cloakedDaggerHeader);
+    if (!framePlan.wrapped)
+    {
+      return input;
+    }
+    apply(input, framePlan, output);
+    return output;
+  }
+
+  if (!isWrapped(input, cloakedDaggerHeader))
+  {
     return input;
   }
-  const auto inputChunkMask = getMaskFromHeader(cloakedDaggerHeader);
+  handleFirstFrame(input, getMaskFromHeader(cloakedDaggerHeader));
+  output.assign(cloakedDaggerHeader.begin(), cloakedDaggerHeader.end());
+  output.insert(output.end(), input.begin(), input.end());
+  return output;
+}
 
-  if (frameCount == 1)
+StreamingRewrapper::FramePlan StreamingRewrapper::plan(
+  const BytesBuffer& input, const CloakedDaggerHeader& cloakedDaggerHeader)
+{
+  if (!isWrapped(input, cloakedDaggerHeader))
   {
-    handleFirstFrame(input, inputChunkMask);
-    BytesBuffer firstFrame{cloakedDaggerHeader.begin(), cloakedDaggerHeader.end()};
-    firstFrame.insert(firstFrame.end(), input.begin(), input.end());
-    return firstFrame;
+    return {false, {}};
   }
-  return rewrapData(input, constructXORedMask(inputChunkMask));
+  const auto framePlan = FramePlan{true, constructXORedMask(getMaskFromHeader(cloakedDaggerHeader))};
+  mask_index += input.size();
+  return framePlan;
 }
 
-void StreamingRewrapper::handleFirstFrame(const BytesBuffer& input, const BytesBuffer& inputChunkMask)
+void StreamingRewrapper::handleFirstFrame(const BytesBuffer& input, const Mask& inputChunkMask)
 {
   mask = inputChunkMask;
+  maskSet = true;
+  cachedXORedMaskValid = false;
   mask_index = input.size();
 }
 
-BytesBuffer StreamingRewrapper::rewrapData(const BytesBuffer& input, const BytesBuffer& newMask)
+// frameMask is indexed from the start of the frame, so whole words of the input can be XORed at once.
+void StreamingRewrapper::apply(const BytesBuffer& input, const FramePlan& framePlan, BytesBuffer& output)
 {
-  BytesBuffer output;
+  const auto& frameMask = framePlan.frameMask;
+  output.resize(input.size());
+  std::uint64_t maskWord;
+  std::memcpy(&maskWord, frameMask.data(), sizeof(maskWord));
 
-  for (unsigned char c : input)
+  std::size_t index = 0;
+  for (; index + sizeof(maskWord) <= input.size(); index += sizeof(maskWord))
   {
-    output.push_back(c ^ newMask.at(mask_index % CloakedDagger::maskLength));
-    mask_index++;
+    std::uint64_t word;
+    std::memcpy(&word, input.data() + index, sizeof(word));
+    word ^= maskWord;
+    std::memcpy(output.data() + index, &word, sizeof(word));
+  }
+  for (; index < input.size(); ++index)
+  {
+    output[index] = static_cast<std::uint8_t>(input[index] ^ frameMask[index % CloakedDagger::maskLength]);
   }
-  return output;
 }
 
-BytesBuffer StreamingRewrapper::constructXORedMask(const BytesBuffer& inputChunkMask) const
+const StreamingRewrapper::Mask& StreamingRewrapper::constructXORedMask(const Mask& inputChunkMask)
 {
-  if (mask == BytesBuffer(CloakedDagger::maskLength))
+  if (!maskSet)
   {
     throw std::runtime_error("Tried to rewrap a frame before mask set.");
   }
-  BytesBuffer newMask(CloakedDagger::maskLength);
+  const auto rotation = static_cast<std::size_t>(mask_index % CloakedDagger::maskLength);
+  if (cachedXORedMaskValid && cachedMaskRotation == rotation)
+  {
+    return cachedXORedMask;
+  }
 
-  for (std::uint8_t rotatingInputIndex=0; rotatingInputIndex < CloakedDagger::maskLength; rotatingInputIndex++)
+  for (std::size_t rotatingInputIndex = 0; rotatingInputIndex < CloakedDagger::maskLength; rotatingInputIndex++)
   {
-    const auto rotatingOutputIndex = (rotatingInputIndex + mask_index) % CloakedDagger::maskLength;
-    newMask[rotatingOutputIndex] = inputChunkMask.at(rotatingInputIndex) ^ mask.at(rotatingOutputIndex);
+    const auto rotatingOutputIndex = (rotatingInputIndex + rotation) % CloakedDagger::maskLength;
+    cachedXORedMask[rotatingInputIndex] = inputChunkMask[rotatingInputIndex] ^ mask[rotatingOutputIndex];
   }
-  return newMask;
+  cachedMaskRotation = rotation;
+  cachedXORedMaskValid = true;
+  return cachedXORedMask;
 }
 
-BytesBuffer StreamingRewrapper::getMaskFromHeader(const CloakedDaggerHeader& cloakedDaggerHeader)
+const StreamingRewrapper::Mask& StreamingRewrapper::getMaskFromHeader(const CloakedDaggerHeader& cloakedDaggerHeader)
 {
-  const auto header = CloakedDagger(cloakedDaggerHeader);
+  if (cachedHeaderValid && cloakedDaggerHeader == cachedHeader)
+  {
+    return cachedKey;
+  }
 
-  return BytesBuffer(header.key.begin(), header.key.end());
+  const CloakedDaggerView header(cloakedDaggerHeader);
+  if (!header.isValid())
+  {
+    throw std::runtime_error("The header did not decode correctly");
+  }
+  const auto key = header.key();
+  std::memcpy(cachedKey.data(), key.data(), key.size());
+  cachedHeader = cloakedDaggerHeader;
+  cachedHeaderValid = true;
+  cachedXORedMaskValid = false;
+  return cachedKey;
 }
@@ -5,24 +5,53 @@
 #ifndef REWRAPPER_STREAMINGREWRAPPER_HPP
 #define REWRAPPER_STREAMINGREWRAPPER_HPP
 
-#include <boost/optional.hpp>
+#include <array>
 #include "CloakedDagger.hpp"
 #include "CloakedDaggerHeader.hpp"
 
 class StreamingRewrapper
 {
 public:
+  using Mask = std::array<std::uint8_t, CloakedDagger::maskLength>;
+
+  // How to rewrap one frame after the first. The mask of a frame follows from its offset in the stream alone, so
+  // frames can be planned in order on one thread and then applied on any.
+  struct FramePlan
+  {
+    bool wrapped;
+    // Indexed from the start of the frame.
+    Mask frameMask;
+  };
+
   StreamingRewrapper() = default;
-  BytesBuffer rewrap(const BytesBuffer& input, const CloakedDaggerHeader& cloakedDaggerHeader, std::uint32_t frameCount);
+  // Returns the input itself if it is not wrapped, otherwise a buffer owned by the rewrapper that is reused by
+  // the next call.
+  const BytesBuffer& rewrap(const BytesBuffer& input, const CloakedDaggerHeader& cloakedDaggerHeader, std::uint32_t frameCount);
+
+  // For frames after the first, in frame order. Checks the header and moves the stream position past the frame.
+  FramePlan plan(const BytesBuffer& input, const CloakedDaggerHeader& cloakedDaggerHeader);
+  // Rewraps a wrapped frame into output. Safe to call on several threads at once.
+  static void apply(const BytesBuffer& input, const FramePlan& framePlan, BytesBuffer& output);
 
 private:
-  static BytesBuffer getMaskFromHeader(const CloakedDaggerHeader& cloakedDaggerHeader);
-  BytesBuffer constructXORedMask(const BytesBuffer& inputChunkMask) const;
-  BytesBuffer rewrapData(const BytesBuffer& input, const BytesBuffer& newMask);
-  void handleFirstFrame(const BytesBuffer& input, const BytesBuffer& inputChunkMask);
 
-  size_t mask_index {0};
-  BytesBuffer mask = BytesBuffer(CloakedDagger::maskLength);
+  const Mask& getMaskFromHeader(const CloakedDaggerHeader& cloakedDaggerHeader);
+  const Mask& constructXORedMask(const Mask& inputChunkMask);
+  void handleFirstFrame(const BytesBuffer& input, const Mask& inputChunkMask);
+
+  std::uint64_t mask_index {0};
+  Mask mask {};
+  bool maskSet {false};
+  BytesBuffer output;
+
+  // Every frame of a session normally carries the same header, so the validated key and the XOR mask for the
+  // current stream position are kept until either changes.
+  CloakedDaggerHeader cachedHeader {};
+  bool cachedHeaderValid {false};
+  Mask cachedKey {};
+  std::size_t cachedMaskRotation {0};
+  bool cachedXORedMaskValid {false};
+  Mask cachedXORedMask {};
 };
 
 
@@ -67,3 +67,51 @@ TEST_CASE("StreamingRewrapper. Wrapped files should remain wrapped")
   }
 
 }
+
+TEST_CASE("StreamingRewrapper. Frames are rewrapped with the key of the first frame")
+{
+  StreamingRewrapper streamingRewrapper;
+  const std::array<char, 8> firstKey{0x12, 0x34, 0x56, 0x78, static_cast<char>(0x9a), static_cast<char>(0xbc), static_cast<char>(0xde), static_cast<char>(0xf0)};
+  const std::array<char, 8> secondKey{0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+
+  std::stringstream rewrapped;
+  const auto writeFrame = [&](const std::string& payload, const std::array<char, 8>& key, std::uint32_t frameCount) {
+    const auto input = createTestWrappedString(payload, key);
+    const auto& output = streamingRewrapper.rewrap(input.message, input.header, frameCount);
+    rewrapped.write(reinterpret_cast<const char*>(output.data()), static_cast<std::streamsize>(output.size()));
+  };
+
+  writeFrame("abc", firstKey, 1);
+  writeFrame("defghijklmnopqrstu", firstKey, 2);
+  writeFrame("vwxyz", firstKey, 3);
+  writeFrame("0123456789", secondKey, 4);
+  writeFrame("ABCDEFGHIJKLMNOPQRSTUVWXYZ", secondKey, 5);
+  writeFrame("!", firstKey, 6);
+
+  std::stringstream unwrapped;
+  unwrapFromStream(rewrapped, unwrapped);
+  REQUIRE(unwrapped.str() == "abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ!");
+}
+
+TEST_CASE("StreamingRewrapper. Steady state frames reuse the output buffer")
+{
+  StreamingRewrapper streamingRewrapper;
+  const auto first = createTestWrappedString(std::string(64, 'a'));
+  static_cast<void>(streamingRewrapper.rewrap(first.message, first.header, 1));
+
+  const auto next = createTestWrappedString(std::string(64, 'b'));
+  const auto* outputData = streamingRewrapper.rewrap(next.message, next.header, 2).data();
+  REQUIRE(streamingRewrapper.rewrap(next.message, next.header, 3).data() == outputData);
+}
+
+TEST_CASE("StreamingRewrapper. An invalid header is rejected after valid frames")
+{
+  StreamingRewrapper streamingRewrapper;
+  const auto input = createTestWrappedString("abc");
+  static_cast<void>(streamingRewrapper.rewrap(input.message, input.header, 1));
+  static_cast<void>(streamingRewrapper.rewrap(input.message, input.header, 2));
+
+  auto invalidHeader = input.header;
+  invalidHeader[47] = 0;
+  REQUIRE_THROWS_AS(streamingRewrapper.rewrap(input.message, invalidHeader, 3), std::runtime_error);
+}
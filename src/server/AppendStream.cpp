@@ -0,0 +1,81 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "AppendStream.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include "spdlog/spdlog.h"
+
+AppendStream::AppendStream(const std::string& path, std::uint32_t sessionId):
+  path(path),
+  sessionId(sessionId),
+  // Non blocking, so that a named pipe without a reader, or whose reader falls behind, fails rather than stalling
+  // the server.
+  fileDescriptor(open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_NONBLOCK | O_CLOEXEC, 0644))
+{
+  if (fileDescriptor < 0)
+  {
+    throw std::runtime_error("Unable to open " + path + " for session " + std::to_string(sessionId) + ": " +
+      std::strerror(errno));
+  }
+  spdlog::info("Stream session {} started, appending to {}", sessionId, path);
+}
+
+AppendStream::~AppendStream()
+{
+  closeOutput();
+}
+
+void AppendStream::deleteFile()
+{
+  spdlog::error("Stream session {} ended early after {} bytes", sessionId, bytesWritten);
+  closeOutput();
+}
+
+void AppendStream::renameFile()
+{
+  spdlog::info("Stream session {} {} complete, {} bytes", sessionId, streamName, bytesWritten);
+  closeOutput();
+}
+
+void AppendStream::setStoredFilename(std::string filename)
+{
+  streamName = std::move(filename);
+}
+
+void AppendStream::write(const BytesBuffer& inputData)
+{
+  std::size_t offset = 0;
+  while (offset < inputData.size())
+  {
+    const auto written = ::write(fileDescriptor, inputData.data() + offset, inputData.size() - offset);
+    if (written < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+      throw std::runtime_error("Stream session " + std::to_string(sessionId) + ": the reader of " + path +
+        " is not keeping up");
+    }
+    if (written < 0)
+    {
+      throw std::runtime_error("Unable to append stream session " + std::to_string(sessionId) + " to " + path + ": " +
+        std::strerror(errno));
+    }
+    offset += static_cast<std::size_t>(written);
+  }
+  bytesWritten += inputData.size();
+}
+
+void AppendStream::closeOutput()
+{
+  if (fileDescriptor >= 0)
+  {
+    close(fileDescriptor);
+    fileDescriptor = -1;
+  }
+}
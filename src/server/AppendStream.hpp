@@ -0,0 +1,40 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef APPENDSTREAM_HPP
+#define APPENDSTREAM_HPP
+
+#include <cstdint>
+#include <string>
+#include "StreamInterface.hpp"
+
+// Appends a streamed session to a file or named pipe as its frames come into order, without buffering, so a reader
+// sees the data as soon as the server has it rather than when the stream ends. A named pipe must already have its
+// reader, as the server does not wait for one, and a write the reader has left no room for throws rather than
+// waits.
+class AppendStream : public StreamInterface
+{
+public:
+  AppendStream(const std::string& path, std::uint32_t sessionId);
+  ~AppendStream() override;
+
+  AppendStream(const AppendStream&) = delete;
+  AppendStream& operator=(const AppendStream&) = delete;
+
+  // What has been appended cannot be taken back, so a stream that times out or fails just stops.
+  void deleteFile() override;
+  void renameFile() override;
+  void setStoredFilename(std::string filename) override;
+  void write(const BytesBuffer& inputData) override;
+
+private:
+  void closeOutput();
+
+  const std::string path;
+  const std::uint32_t sessionId;
+  int fileDescriptor;
+  std::string streamName;
+  std::uint64_t bytesWritten = 0;
+};
+
+#endif //APPENDSTREAM_HPP
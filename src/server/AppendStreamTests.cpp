@@ -0,0 +1,68 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "test/catch.hpp"
+#include "AppendStream.hpp"
+
+namespace
+{
+  std::string readFile(const std::filesystem::path& path)
+  {
+    std::ifstream input(path, std::ios::binary);
+    std::stringstream content;
+    content << input.rdbuf();
+    return content.str();
+  }
+}
+
+TEST_CASE("AppendStream. Each write reaches the file straight away, after what was there before")
+{
+  const auto path = std::filesystem::temp_directory_path() / "appendStreamTest.log";
+  std::ofstream(path) << "earlier\n";
+
+  AppendStream stream(path.string(), 1);
+  stream.write({'a', 'b', '\n'});
+  REQUIRE(readFile(path) == "earlier\nab\n");
+
+  stream.setStoredFilename("feed.log");
+  stream.renameFile();
+  REQUIRE(readFile(path) == "earlier\nab\n");
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("AppendStream. A named pipe without a reader is refused rather than waited for")
+{
+  const auto path = std::filesystem::temp_directory_path() / "appendStreamTest.fifo";
+  std::filesystem::remove(path);
+  REQUIRE(mkfifo(path.c_str(), 0600) == 0);
+
+  REQUIRE_THROWS_AS(AppendStream(path.string(), 1), std::runtime_error);
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("AppendStream. A write to a named pipe whose reader has fallen behind throws rather than waits")
+{
+  const auto path = std::filesystem::temp_directory_path() / "appendStreamTest.slow.fifo";
+  std::filesystem::remove(path);
+  REQUIRE(mkfifo(path.c_str(), 0600) == 0);
+  const auto reader = open(path.c_str(), O_RDONLY | O_NONBLOCK);
+  REQUIRE(reader >= 0);
+
+  AppendStream stream(path.string(), 1);
+  const BytesBuffer frame(4096, 'a');
+  REQUIRE_THROWS_AS([&]() {
+    for (int frames = 0; frames < 1024; ++frames)
+    {
+      stream.write(frame);
+    }
+  }(), std::runtime_error);
+
+  close(reader);
+  std::filesystem::remove(path);
+}
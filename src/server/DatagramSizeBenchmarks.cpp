@@ -0,0 +1,83 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include "test/catch.hpp"
+#include "client/Client.hpp"
+#include "client/ClientWrapper.hpp"
+#include "client/FreeRunningTimer.hpp"
+#include "diodeheader/EnterpriseDiodeHeader.hpp"
+#include "Server.hpp"
+#include "StreamInterface.hpp"
+#include "spdlog/spdlog.h"
+
+// Hidden from the default run; use: UnitTests "[benchmark]"
+namespace
+{
+  constexpr std::size_t transferSizeInBytes = 128 * 1024 * 1024;
+
+  class ByteCounter : public StreamInterface
+  {
+  public:
+    explicit ByteCounter(std::size_t& bytesWritten): bytesWritten(bytesWritten) {}
+    void deleteFile() override {}
+    void renameFile() override {}
+    void setStoredFilename(std::string) override {}
+    void write(const BytesBuffer& inputData) override { bytesWritten += inputData.size(); }
+
+  private:
+    std::size_t& bytesWritten;
+  };
+
+  // Hands each datagram the client sends straight to the server, as the sockets would with nothing lost, so only
+  // the per datagram cost of framing, reordering and writing is measured.
+  class DirectLink : public UdpClientInterface
+  {
+  public:
+    explicit DirectLink(Server& server): server(server) {}
+
+    void send(ConstSocketBuffers inputBuffers) override
+    {
+      BytesBuffer header(EnterpriseDiode::HeaderSizeInBytes);
+      BytesBuffer payload(boost::asio::buffer_size(inputBuffers) - header.size());
+      boost::asio::buffer_copy(
+        std::array<boost::asio::mutable_buffer, 2>{boost::asio::buffer(header), boost::asio::buffer(payload)},
+        inputBuffers);
+      server.receivePacket(std::move(header), std::move(payload));
+      ++datagramsSent;
+    }
+
+    std::size_t datagramsSent = 0;
+
+  private:
+    Server& server;
+  };
+}
+
+TEST_CASE("Datagram size benchmark. Client to server throughput at 1500, 9000 and 65535 byte MTUs", "[.][benchmark]")
+{
+  const std::string content(transferSizeInBytes, 'x');
+  for (const auto mtuSize : {std::uint16_t{1500}, std::uint16_t{9000}, std::uint16_t{65535}})
+  {
+    std::size_t bytesWritten = 0;
+    Server server(
+      std::make_unique<UdpServerInterface>(), EnterpriseDiode::calculateMaxBufferSize(mtuSize), 1024,
+      [&bytesWritten](std::uint32_t) { return std::make_unique<ByteCounter>(bytesWritten); },
+      []() { return std::time(nullptr); }, 15, DiodeType::basic);
+    auto link = std::make_shared<DirectLink>(server);
+    Client client(link, std::make_shared<FreeRunningTimer>(), calculatePayloadSize(mtuSize), "benchmark.bin");
+
+    std::stringstream input(content);
+    const auto start = std::chrono::steady_clock::now();
+    client.send(input);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    spdlog::info("MTU {}: {} datagrams of up to {} bytes, {:.0f} MB/s, {:.2f} million datagrams/s", mtuSize,
+      link->datagramsSent, EnterpriseDiode::calculateMaxBufferSize(mtuSize),
+      static_cast<double>(transferSizeInBytes) / elapsed.count() / (1024 * 1024),
+      static_cast<double>(link->datagramsSent) / elapsed.count() / 1e6);
+    REQUIRE(bytesWritten == transferSizeInBytes);
+  }
+}
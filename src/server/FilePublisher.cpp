@@ -0,0 +1,93 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "FilePublisher.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "spdlog/spdlog.h"
+
+FilePublisher::FilePublisher(std::string socketPath):
+  socketPath(std::move(socketPath))
+{
+  if (this->socketPath.size() >= sizeof(sockaddr_un::sun_path))
+  {
+    throw std::runtime_error("Socket path is too long: " + this->socketPath);
+  }
+}
+
+FilePublisher::~FilePublisher()
+{
+  disconnect();
+}
+
+bool FilePublisher::publish(int fileDescriptor, const std::string& filename)
+{
+  if (socketHandle < 0 && !connectToConsumer())
+  {
+    return false;
+  }
+
+  iovec name{const_cast<char*>(filename.data()), filename.size()};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+  msghdr message{};
+  message.msg_iov = &name;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+  auto* rights = CMSG_FIRSTHDR(&message);
+  rights->cmsg_level = SOL_SOCKET;
+  rights->cmsg_type = SCM_RIGHTS;
+  rights->cmsg_len = CMSG_LEN(sizeof(int));
+  std::memcpy(CMSG_DATA(rights), &fileDescriptor, sizeof(int));
+
+  auto sent = sendmsg(socketHandle, &message, MSG_DONTWAIT | MSG_NOSIGNAL);
+  while (sent < 0 && errno == EINTR)
+  {
+    sent = sendmsg(socketHandle, &message, MSG_DONTWAIT | MSG_NOSIGNAL);
+  }
+  if (sent < 0)
+  {
+    spdlog::warn("Unable to publish {} to {}: {}", filename, socketPath, std::strerror(errno));
+    // A consumer that is only behind keeps its connection; one that has gone is connected to afresh next time.
+    if (errno != EAGAIN && errno != EWOULDBLOCK)
+    {
+      disconnect();
+    }
+    return false;
+  }
+  return true;
+}
+
+bool FilePublisher::connectToConsumer()
+{
+  socketHandle = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+  if (socketHandle < 0)
+  {
+    spdlog::warn("Unable to create a socket to publish to {}: {}", socketPath, std::strerror(errno));
+    return false;
+  }
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size());
+  if (connect(socketHandle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+  {
+    spdlog::warn("No consumer listening on {}: {}", socketPath, std::strerror(errno));
+    disconnect();
+    return false;
+  }
+  spdlog::info("Publishing files to {}", socketPath);
+  return true;
+}
+
+void FilePublisher::disconnect()
+{
+  if (socketHandle >= 0)
+  {
+    close(socketHandle);
+    socketHandle = -1;
+  }
+}
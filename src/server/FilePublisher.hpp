@@ -0,0 +1,35 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef FILEPUBLISHER_HPP
+#define FILEPUBLISHER_HPP
+
+#include <string>
+
+// Hands each completed file to a consumer on the same host listening on a Unix domain SOCK_SEQPACKET socket. Each
+// file is one message: its name as the payload and an open descriptor of its content passed with SCM_RIGHTS, so
+// the consumer can map the data the server wrote without reading it back from disk, and knows it is complete
+// without polling the output folder. The server connects when it first has a file, and again after the consumer
+// goes away, so the consumer can be started and restarted at any time.
+class FilePublisher
+{
+public:
+  explicit FilePublisher(std::string socketPath);
+  ~FilePublisher();
+
+  FilePublisher(const FilePublisher&) = delete;
+  FilePublisher& operator=(const FilePublisher&) = delete;
+
+  // Returns false if there is no consumer or it is not keeping up, when the caller keeps the file itself. Never
+  // waits on the consumer, which would hold up receiving.
+  bool publish(int fileDescriptor, const std::string& filename);
+
+private:
+  bool connectToConsumer();
+  void disconnect();
+
+  const std::string socketPath;
+  int socketHandle = -1;
+};
+
+#endif //FILEPUBLISHER_HPP
@@ -1,6 +1,7 @@
 // Copyright PA Knowledge Ltd 2021
 // MIT License. For licence terms see LICENCE.md file.
 
+#include "OutputFolders.hpp"
 #include "StreamInterface.hpp"
 #include <algorithm>
 #include <filesystem>
@@ -31,6 +32,15 @@ public:
   {
     outputStream.close();
     spdlog::info("File complete. Renaming .received. file" );
+    try
+    {
+      createParentFolders(".", storedFilename);
+    }
+    catch (const std::exception& exception)
+    {
+      spdlog::error(exception.what());
+      storedFilename = "rejected." + std::to_string(tempFilename);
+    }
     spdlog::info(storedFilename);
     std::filesystem::rename(".received." + std::to_string(tempFilename), storedFilename);
   }
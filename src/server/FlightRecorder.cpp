@@ -0,0 +1,338 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "FlightRecorder.hpp"
+#include <algorithm>
+#include <array>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include "spdlog/spdlog.h"
+
+namespace
+{
+  constexpr std::array<char, 8> flightRecordMagic{'E', 'D', 'F', 'L', 'I', 'G', 'H', 'T'};
+  constexpr std::uint32_t flightRecordVersion = 1;
+  constexpr auto failureDumpInterval = std::chrono::seconds(10);
+
+  std::size_t roundUpToPowerOfTwo(std::size_t value)
+  {
+    std::size_t power = 1;
+    while (power < value)
+    {
+      power *= 2;
+    }
+    return power;
+  }
+
+  template <typename T>
+  void writeValue(std::ostream& output, T value)
+  {
+    output.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  template <typename T>
+  T readValue(std::istream& input)
+  {
+    T value{};
+    if (!input.read(reinterpret_cast<char*>(&value), sizeof(value)))
+    {
+      throw std::runtime_error("Flight record is truncated");
+    }
+    return value;
+  }
+
+  // The name of the time a frame spent getting to stage from the stage before.
+  const char* spanName(FlightStage stage)
+  {
+    switch (stage)
+    {
+      case FlightStage::parsed: return "parse";
+      case FlightStage::enqueued: return "enqueue";
+      case FlightStage::dequeued: return "reorder queue";
+      case FlightStage::rewrapped: return "rewrap";
+      case FlightStage::written: return "write";
+      case FlightStage::received:
+      case FlightStage::dropped:
+      case FlightStage::sessionFailed:
+      default: return "wait";
+    }
+  }
+
+  const char* reasonName(FlightReason reason)
+  {
+    switch (reason)
+    {
+      case FlightReason::queueFull: return "queue full";
+      case FlightReason::invalidPacket: return "invalid packet";
+      case FlightReason::rejected: return "rejected";
+      case FlightReason::timedOut: return "timed out";
+      case FlightReason::none:
+      default: return "none";
+    }
+  }
+
+  class ChromeTraceWriter
+  {
+  public:
+    ChromeTraceWriter(std::ostream& output, std::uint64_t startNs): output(output), startNs(startNs)
+    {
+      output << "{\"traceEvents\":[";
+    }
+
+    ~ChromeTraceWriter()
+    {
+      output << "\n]}\n";
+    }
+
+    ChromeTraceWriter(const ChromeTraceWriter&) = delete;
+    ChromeTraceWriter& operator=(const ChromeTraceWriter&) = delete;
+
+    void processName(std::uint32_t sessionId)
+    {
+      begin();
+      output << R"("name":"process_name","ph":"M","pid":)" << sessionId << R"(,"args":{"name":"Session )"
+             << sessionId << "\"}}";
+    }
+
+    void asyncEvent(const char* phase, const std::string& name, const FlightEvent& event)
+    {
+      begin();
+      output << R"("name":")" << name << R"(","cat":"frame","ph":")" << phase << R"(","id":")" << event.sessionId
+             << '.' << event.frameCount << R"(","pid":)" << event.sessionId << R"(,"tid":0,"ts":)"
+             << microseconds(event) << R"(,"args":{"frame":)" << event.frameCount << "}}";
+    }
+
+    void instant(const std::string& name, const FlightEvent& event)
+    {
+      begin();
+      output << R"("name":")" << name << R"(","ph":"i","s":")" << (event.sessionId == 0 ? 'g' : 'p')
+             << R"(","pid":)" << event.sessionId << R"(,"tid":0,"ts":)" << microseconds(event)
+             << R"(,"args":{"frame":)" << event.frameCount << R"(,"reason":")" << reasonName(event.reason) << "\"}}";
+    }
+
+  private:
+    void begin()
+    {
+      output << (first ? "\n{" : ",\n{");
+      first = false;
+    }
+
+    double microseconds(const FlightEvent& event) const
+    {
+      return static_cast<double>(event.timeNs - startNs) / 1000;
+    }
+
+    std::ostream& output;
+    const std::uint64_t startNs;
+    bool first = true;
+  };
+}
+
+FlightRecorder::FlightRecorder(std::size_t capacity):
+  capacity(roundUpToPowerOfTwo(std::max<std::size_t>(capacity, 1))),
+  slots(std::make_unique<Slot[]>(this->capacity))
+{
+}
+
+std::uint64_t FlightRecorder::now()
+{
+  return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void FlightRecorder::record(
+  FlightStage stage, std::uint32_t sessionId, std::uint32_t frameCount, FlightReason reason, std::uint64_t timeNs)
+{
+  const auto index = nextEvent.fetch_add(1, std::memory_order_relaxed);
+  auto& slot = slots[index & (capacity - 1)];
+  slot.sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.timeNs.store(timeNs, std::memory_order_relaxed);
+  slot.frame.store(std::uint64_t{sessionId} << 32 | frameCount, std::memory_order_relaxed);
+  slot.stage.store(static_cast<std::uint64_t>(stage) | static_cast<std::uint64_t>(reason) << 8,
+    std::memory_order_relaxed);
+  slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+std::vector<FlightEvent> FlightRecorder::events() const
+{
+  const auto end = nextEvent.load(std::memory_order_acquire);
+  const auto begin = end > capacity ? end - capacity : 0;
+  std::vector<FlightEvent> recorded;
+  recorded.reserve(static_cast<std::size_t>(end - begin));
+  for (auto index = begin; index < end; ++index)
+  {
+    const auto& slot = slots[index & (capacity - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != index + 1)
+    {
+      continue;
+    }
+    const auto timeNs = slot.timeNs.load(std::memory_order_relaxed);
+    const auto frame = slot.frame.load(std::memory_order_relaxed);
+    const auto stage = slot.stage.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != index + 1)
+    {
+      continue;
+    }
+    recorded.push_back({timeNs, static_cast<std::uint32_t>(frame >> 32), static_cast<std::uint32_t>(frame),
+      static_cast<FlightStage>(stage & 0xff), static_cast<FlightReason>(stage >> 8 & 0xff)});
+  }
+  return recorded;
+}
+
+std::filesystem::path FlightRecorder::dump(const std::filesystem::path& folder, const std::string& cause) const
+{
+  static std::atomic<std::uint32_t> dumpCount{0};
+  const auto path = folder / ("flight." + std::to_string(std::time(nullptr)) + "." + std::to_string(++dumpCount) +
+    ".bin");
+  std::ofstream output(path, std::ios::binary);
+  writeFlightRecord(events(), output);
+  if (!output)
+  {
+    throw std::runtime_error("Unable to write flight record " + path.string());
+  }
+  spdlog::info("Flight record written to {} after {}", path.string(), cause);
+  return path;
+}
+
+void FlightRecorder::dumpAfterFailure(const std::string& cause)
+{
+  std::filesystem::path folder;
+  {
+    std::lock_guard lock(dumpMutex);
+    if (dumpFolder.empty())
+    {
+      return;
+    }
+    const auto time = std::chrono::steady_clock::now();
+    if (lastFailureDump != std::chrono::steady_clock::time_point{} && time - lastFailureDump < failureDumpInterval)
+    {
+      return;
+    }
+    lastFailureDump = time;
+    folder = dumpFolder;
+  }
+  try
+  {
+    dump(folder, cause);
+  }
+  catch (const std::exception& exception)
+  {
+    spdlog::warn(exception.what());
+  }
+}
+
+void FlightRecorder::setDumpFolder(std::filesystem::path folder)
+{
+  std::lock_guard lock(dumpMutex);
+  dumpFolder = std::move(folder);
+}
+
+FlightRecorder& flightRecorder()
+{
+  static FlightRecorder recorder;
+  return recorder;
+}
+
+void writeFlightRecord(const std::vector<FlightEvent>& events, std::ostream& output)
+{
+  output.write(flightRecordMagic.data(), flightRecordMagic.size());
+  writeValue(output, flightRecordVersion);
+  writeValue(output, static_cast<std::uint64_t>(events.size()));
+  for (const auto& event : events)
+  {
+    writeValue(output, event.timeNs);
+    writeValue(output, event.sessionId);
+    writeValue(output, event.frameCount);
+    writeValue(output, event.stage);
+    writeValue(output, event.reason);
+  }
+}
+
+std::vector<FlightEvent> readFlightRecord(std::istream& input)
+{
+  std::array<char, flightRecordMagic.size()> magic{};
+  if (!input.read(magic.data(), magic.size()) || magic != flightRecordMagic)
+  {
+    throw std::runtime_error("Not a flight record");
+  }
+  if (readValue<std::uint32_t>(input) != flightRecordVersion)
+  {
+    throw std::runtime_error("Unsupported flight record version");
+  }
+  const auto count = readValue<std::uint64_t>(input);
+  std::vector<FlightEvent> events;
+  for (std::uint64_t index = 0; index < count; ++index)
+  {
+    FlightEvent event{};
+    event.timeNs = readValue<std::uint64_t>(input);
+    event.sessionId = readValue<std::uint32_t>(input);
+    event.frameCount = readValue<std::uint32_t>(input);
+    event.stage = readValue<FlightStage>(input);
+    event.reason = readValue<FlightReason>(input);
+    events.push_back(event);
+  }
+  return events;
+}
+
+// A frame's slice runs from its first event to its last, with a slice inside it for each step between them.
+// Failures of a whole session, and datagrams that could not be parsed at all, are instant events.
+void writeChromeTrace(const std::vector<FlightEvent>& events, std::ostream& output)
+{
+  auto sorted = events;
+  std::stable_sort(sorted.begin(), sorted.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.timeNs < rhs.timeNs;
+  });
+  ChromeTraceWriter trace(output, sorted.empty() ? 0 : sorted.front().timeNs);
+
+  std::set<std::uint32_t> sessions;
+  std::map<std::pair<std::uint32_t, std::uint32_t>, FlightEvent> openFrames;
+  for (const auto& event : sorted)
+  {
+    if (event.sessionId != 0 && sessions.insert(event.sessionId).second)
+    {
+      trace.processName(event.sessionId);
+    }
+    if (event.stage == FlightStage::sessionFailed || event.sessionId == 0)
+    {
+      trace.instant(event.stage == FlightStage::sessionFailed ? "session failed" : "dropped", event);
+      continue;
+    }
+
+    const auto frameName = "frame " + std::to_string(event.frameCount);
+    const auto key = std::make_pair(event.sessionId, event.frameCount);
+    const auto open = openFrames.find(key);
+    if (open == openFrames.end())
+    {
+      trace.asyncEvent("b", frameName, event);
+    }
+    else
+    {
+      const auto name = event.stage == FlightStage::dropped ? std::string("dropped: ") + reasonName(event.reason) :
+        std::string(spanName(event.stage));
+      trace.asyncEvent("b", name, open->second);
+      trace.asyncEvent("e", name, event);
+    }
+
+    if (event.stage == FlightStage::written || event.stage == FlightStage::dropped)
+    {
+      trace.asyncEvent("e", frameName, event);
+      if (open != openFrames.end())
+      {
+        openFrames.erase(open);
+      }
+    }
+    else
+    {
+      openFrames.insert_or_assign(key, event);
+    }
+  }
+  for (const auto& [key, event] : openFrames)
+  {
+    trace.asyncEvent("e", "frame " + std::to_string(key.second), event);
+  }
+}
@@ -0,0 +1,104 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef FLIGHTRECORDER_HPP
+#define FLIGHTRECORDER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Where a frame had got to when it was recorded, from the socket to the output file.
+enum class FlightStage : std::uint8_t
+{
+  received,
+  parsed,
+  enqueued,
+  dequeued,
+  rewrapped,
+  written,
+  dropped,
+  sessionFailed
+};
+
+enum class FlightReason : std::uint8_t
+{
+  none,
+  queueFull,
+  invalidPacket,
+  rejected,
+  timedOut
+};
+
+struct FlightEvent
+{
+  // Nanoseconds of the steady clock.
+  std::uint64_t timeNs;
+  std::uint32_t sessionId;
+  std::uint32_t frameCount;
+  FlightStage stage;
+  FlightReason reason;
+};
+
+// Keeps the last capacity stage timestamps of every frame the server handles, so that when a transfer fails there
+// is a record of where its time went. Recording takes no lock: each event claims the next slot of a ring, and a
+// reader skips a slot that is being overwritten while it reads.
+class FlightRecorder
+{
+public:
+  static constexpr std::size_t defaultCapacity = 65536;
+
+  // Capacity is rounded up to a power of two.
+  explicit FlightRecorder(std::size_t capacity = defaultCapacity);
+
+  static std::uint64_t now();
+
+  void record(FlightStage stage, std::uint32_t sessionId, std::uint32_t frameCount,
+    FlightReason reason = FlightReason::none, std::uint64_t timeNs = now());
+
+  // Oldest first.
+  [[nodiscard]] std::vector<FlightEvent> events() const;
+
+  // Writes the events to a file in folder, returning its path.
+  std::filesystem::path dump(const std::filesystem::path& folder, const std::string& cause) const;
+  // As dump, to the folder set, but at most once every few seconds however often sessions fail, and never throwing.
+  // Does nothing until a folder is set.
+  void dumpAfterFailure(const std::string& cause);
+  void setDumpFolder(std::filesystem::path folder);
+
+private:
+  struct Slot
+  {
+    // The index of the event in the slot plus one, 0 while it is being written.
+    std::atomic<std::uint64_t> sequence{0};
+    std::atomic<std::uint64_t> timeNs{0};
+    std::atomic<std::uint64_t> frame{0};
+    std::atomic<std::uint64_t> stage{0};
+  };
+
+  const std::size_t capacity;
+  std::unique_ptr<Slot[]> slots;
+  std::atomic<std::uint64_t> nextEvent{0};
+
+  std::mutex dumpMutex;
+  std::filesystem::path dumpFolder;
+  std::chrono::steady_clock::time_point lastFailureDump{};
+};
+
+// The recorder every part of the server records to.
+FlightRecorder& flightRecorder();
+
+void writeFlightRecord(const std::vector<FlightEvent>& events, std::ostream& output);
+std::vector<FlightEvent> readFlightRecord(std::istream& input);
+// The Chrome trace event format, which chrome://tracing and ui.perfetto.dev open. Each session is a process and
+// each frame an async slice, divided into the time it spent between one stage and the next.
+void writeChromeTrace(const std::vector<FlightEvent>& events, std::ostream& output);
+
+#endif //FLIGHTRECORDER_HPP
@@ -0,0 +1,175 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include "test/catch.hpp"
+#include "FlightRecorder.hpp"
+#include "ReorderPackets.hpp"
+#include "StreamSpy.hpp"
+
+namespace
+{
+  bool contains(const std::vector<FlightEvent>& events, FlightStage stage, std::uint32_t sessionId,
+    std::uint32_t frameCount, FlightReason reason = FlightReason::none)
+  {
+    return std::any_of(events.begin(), events.end(), [&](const auto& event) {
+      return event.stage == stage && event.sessionId == sessionId && event.frameCount == frameCount &&
+        event.reason == reason;
+    });
+  }
+}
+
+TEST_CASE("FlightRecorder. Events are returned oldest first")
+{
+  FlightRecorder recorder(8);
+  recorder.record(FlightStage::received, 1, 1, FlightReason::none, 100);
+  recorder.record(FlightStage::dropped, 1, 1, FlightReason::queueFull, 200);
+
+  const auto events = recorder.events();
+  REQUIRE(events.size() == 2);
+  REQUIRE(events[0].timeNs == 100);
+  REQUIRE(events[0].stage == FlightStage::received);
+  REQUIRE(events[1].sessionId == 1);
+  REQUIRE(events[1].frameCount == 1);
+  REQUIRE(events[1].stage == FlightStage::dropped);
+  REQUIRE(events[1].reason == FlightReason::queueFull);
+}
+
+TEST_CASE("FlightRecorder. Only the latest events are kept")
+{
+  FlightRecorder recorder(6);
+  for (std::uint32_t frame = 1; frame <= 20; ++frame)
+  {
+    recorder.record(FlightStage::written, 7, frame);
+  }
+
+  const auto events = recorder.events();
+  REQUIRE(events.size() == 8);
+  REQUIRE(events.front().frameCount == 13);
+  REQUIRE(events.back().frameCount == 20);
+}
+
+TEST_CASE("FlightRecorder. Threads can record at the same time")
+{
+  FlightRecorder recorder(1024);
+  std::vector<std::thread> threads;
+  for (std::uint32_t session = 1; session <= 4; ++session)
+  {
+    threads.emplace_back([&recorder, session]() {
+      for (std::uint32_t frame = 1; frame <= 100; ++frame)
+      {
+        recorder.record(FlightStage::enqueued, session, frame);
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  const auto events = recorder.events();
+  REQUIRE(events.size() == 400);
+  for (std::uint32_t session = 1; session <= 4; ++session)
+  {
+    REQUIRE(std::count_if(events.begin(), events.end(), [session](const auto& event) {
+      return event.sessionId == session;
+    }) == 100);
+  }
+}
+
+TEST_CASE("FlightRecorder. A flight record reads back as it was written")
+{
+  const std::vector<FlightEvent> events{
+    {100, 1, 2, FlightStage::parsed, FlightReason::none},
+    {250, 3, 4, FlightStage::sessionFailed, FlightReason::timedOut}};
+  std::stringstream record;
+  writeFlightRecord(events, record);
+
+  const auto read = readFlightRecord(record);
+  REQUIRE(read.size() == 2);
+  REQUIRE(read[1].timeNs == 250);
+  REQUIRE(read[1].sessionId == 3);
+  REQUIRE(read[1].frameCount == 4);
+  REQUIRE(read[1].stage == FlightStage::sessionFailed);
+  REQUIRE(read[1].reason == FlightReason::timedOut);
+
+  std::stringstream notARecord("not a flight record");
+  REQUIRE_THROWS_AS(readFlightRecord(notARecord), std::runtime_error);
+}
+
+TEST_CASE("FlightRecorder. Dumps are written to the folder given")
+{
+  const auto folder = std::filesystem::temp_directory_path() / "flightRecorderTest";
+  std::filesystem::remove_all(folder);
+  std::filesystem::create_directory(folder);
+  FlightRecorder recorder(8);
+  recorder.record(FlightStage::written, 1, 1);
+
+  const auto path = recorder.dump(folder, "test");
+  std::ifstream input(path, std::ios::binary);
+  REQUIRE(readFlightRecord(input).size() == 1);
+
+  SECTION("Failures dump only once a folder is set, and not again straight away")
+  {
+    FlightRecorder failing(8);
+    failing.dumpAfterFailure("test");
+    failing.setDumpFolder(folder);
+    failing.dumpAfterFailure("test");
+    failing.dumpAfterFailure("test");
+    REQUIRE(std::distance(std::filesystem::directory_iterator(folder), std::filesystem::directory_iterator()) == 2);
+  }
+  std::filesystem::remove_all(folder);
+}
+
+TEST_CASE("FlightRecorder. The Chrome trace divides each frame into its stages")
+{
+  const std::vector<FlightEvent> events{
+    {1000, 5, 1, FlightStage::received, FlightReason::none},
+    {3000, 5, 1, FlightStage::parsed, FlightReason::none},
+    {4000, 5, 1, FlightStage::enqueued, FlightReason::none},
+    {9000, 5, 1, FlightStage::dequeued, FlightReason::none},
+    {9500, 5, 1, FlightStage::written, FlightReason::none},
+    {9600, 5, 2, FlightStage::dropped, FlightReason::queueFull},
+    {9700, 5, 3, FlightStage::sessionFailed, FlightReason::timedOut}};
+  std::stringstream trace;
+  writeChromeTrace(events, trace);
+
+  const auto json = trace.str();
+  REQUIRE(json.rfind("{\"traceEvents\":[", 0) == 0);
+  REQUIRE(json.find(R"("name":"Session 5")") != std::string::npos);
+  REQUIRE(json.find(R"("name":"frame 1","cat":"frame","ph":"b","id":"5.1","pid":5,"tid":0,"ts":0,)") !=
+          std::string::npos);
+  REQUIRE(json.find(R"("name":"reorder queue","cat":"frame","ph":"b","id":"5.1","pid":5,"tid":0,"ts":3,)") !=
+          std::string::npos);
+  REQUIRE(json.find(R"("name":"reorder queue","cat":"frame","ph":"e","id":"5.1","pid":5,"tid":0,"ts":8,)") !=
+          std::string::npos);
+  REQUIRE(json.find(R"("name":"frame 1","cat":"frame","ph":"e")") != std::string::npos);
+  REQUIRE(json.find(R"("name":"session failed","ph":"i")") != std::string::npos);
+  REQUIRE(json.find(R"("reason":"timed out")") != std::string::npos);
+  REQUIRE(json.substr(json.size() - 4) == "\n]}\n");
+}
+
+TEST_CASE("FlightRecorder. Frames are recorded through the reorder queue")
+{
+  std::stringstream outputStream;
+  StreamSpy stream(outputStream, 1);
+  auto queueManager = ReorderPackets(4, 2, DiodeType::basic);
+  constexpr std::uint32_t sessionId = 0xf1f1f1f1;
+
+  queueManager.write({HeaderParams{sessionId, 2, false, {}}, {'b'}}, &stream);
+  queueManager.write({HeaderParams{sessionId, 1, false, {}}, {'a'}}, &stream);
+  queueManager.write({HeaderParams{sessionId, 4, false, {}}, {'d'}}, &stream);
+  queueManager.write({HeaderParams{sessionId, 5, false, {}}, {'e'}}, &stream);
+  queueManager.write({HeaderParams{sessionId, 6, false, {}}, {'f'}}, &stream);
+
+  const auto events = flightRecorder().events();
+  REQUIRE(contains(events, FlightStage::enqueued, sessionId, 2));
+  REQUIRE(contains(events, FlightStage::dequeued, sessionId, 1));
+  REQUIRE(contains(events, FlightStage::written, sessionId, 2));
+  REQUIRE(contains(events, FlightStage::enqueued, sessionId, 5));
+  REQUIRE(contains(events, FlightStage::dropped, sessionId, 6, FlightReason::queueFull));
+}
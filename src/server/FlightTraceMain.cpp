@@ -0,0 +1,40 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <fstream>
+#include <iostream>
+#include "FlightRecorder.hpp"
+
+// Converts a flight record the server wrote into a Chrome trace, for chrome://tracing or ui.perfetto.dev.
+int main(int argc, char **argv)
+{
+  if (argc < 2 || argc > 3)
+  {
+    std::cerr << "Usage: flighttrace FLIGHT_RECORD [TRACE_JSON]" << std::endl;
+    return 1;
+  }
+  try
+  {
+    std::ifstream input(argv[1], std::ios::binary);
+    if (!input)
+    {
+      throw std::runtime_error(std::string("Unable to open ") + argv[1]);
+    }
+    const auto events = readFlightRecord(input);
+    if (argc == 3)
+    {
+      std::ofstream output(argv[2]);
+      writeChromeTrace(events, output);
+    }
+    else
+    {
+      writeChromeTrace(events, std::cout);
+    }
+  }
+  catch (const std::runtime_error& exception)
+  {
+    std::cerr << exception.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,129 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "LatencyHistogram.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+  constexpr std::uint64_t subBuckets = std::uint64_t{1} << LatencyHistogram::precisionBits;
+
+  std::string milliseconds(double nanoseconds)
+  {
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(3) << nanoseconds / 1e6 << "ms";
+    return text.str();
+  }
+}
+
+void LatencyHistogram::record(std::int64_t latencyNanoseconds)
+{
+  if (total == 0)
+  {
+    minimum = latencyNanoseconds;
+    maximum = latencyNanoseconds;
+  }
+  else
+  {
+    // RFC 3550 section 6.4.1, with the transit time being the latency including any clock offset, which cancels out.
+    const auto change = static_cast<double>(std::llabs(latencyNanoseconds - lastLatency));
+    jitterEstimate += (change - jitterEstimate) / 16;
+  }
+  lastLatency = latencyNanoseconds;
+  minimum = std::min(minimum, latencyNanoseconds);
+  maximum = std::max(maximum, latencyNanoseconds);
+  ++total;
+
+  if (latencyNanoseconds < 0)
+  {
+    ++negatives;
+  }
+  const auto index = bucketIndex(static_cast<std::uint64_t>(std::max<std::int64_t>(latencyNanoseconds, 0)));
+  if (index >= buckets.size())
+  {
+    buckets.resize(index + 1);
+  }
+  ++buckets[index];
+}
+
+std::uint64_t LatencyHistogram::count() const
+{
+  return total;
+}
+
+std::uint64_t LatencyHistogram::negativeCount() const
+{
+  return negatives;
+}
+
+std::int64_t LatencyHistogram::min() const
+{
+  return minimum;
+}
+
+std::int64_t LatencyHistogram::max() const
+{
+  return maximum;
+}
+
+std::int64_t LatencyHistogram::percentile(double percent) const
+{
+  if (total == 0)
+  {
+    return 0;
+  }
+  const auto wanted = std::max<std::uint64_t>(
+    1, static_cast<std::uint64_t>(std::ceil(std::clamp(percent, 0.0, 100.0) / 100 * static_cast<double>(total))));
+  std::uint64_t seen = 0;
+  for (std::size_t index = 0; index < buckets.size(); ++index)
+  {
+    seen += buckets[index];
+    if (seen >= wanted)
+    {
+      return std::clamp(static_cast<std::int64_t>(bucketHighestValue(index)), minimum, maximum);
+    }
+  }
+  return maximum;
+}
+
+double LatencyHistogram::jitter() const
+{
+  return jitterEstimate;
+}
+
+std::string LatencyHistogram::summary() const
+{
+  return "min " + milliseconds(static_cast<double>(min())) +
+    " p50 " + milliseconds(static_cast<double>(percentile(50))) +
+    " p99 " + milliseconds(static_cast<double>(percentile(99))) +
+    " p99.9 " + milliseconds(static_cast<double>(percentile(99.9))) +
+    " max " + milliseconds(static_cast<double>(max())) +
+    " jitter " + milliseconds(jitter());
+}
+
+// Values below subBuckets have a bucket each. Above, each power of two is split into subBuckets equal buckets.
+std::size_t LatencyHistogram::bucketIndex(std::uint64_t value)
+{
+  if (value < subBuckets)
+  {
+    return static_cast<std::size_t>(value);
+  }
+  const auto topBit = static_cast<unsigned int>(63 - __builtin_clzll(value));
+  const auto shift = topBit - precisionBits;
+  return static_cast<std::size_t>(subBuckets + shift * subBuckets + ((value >> shift) - subBuckets));
+}
+
+std::uint64_t LatencyHistogram::bucketHighestValue(std::size_t index)
+{
+  if (index < subBuckets)
+  {
+    return index;
+  }
+  const auto shift = (index - subBuckets) / subBuckets;
+  const auto lowest = (subBuckets + (index - subBuckets) % subBuckets) << shift;
+  return lowest + (std::uint64_t{1} << shift) - 1;
+}
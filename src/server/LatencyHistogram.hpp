@@ -0,0 +1,49 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef LATENCYHISTOGRAM_HPP
+#define LATENCYHISTOGRAM_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One way latencies of the frames of a session, from the client's send timestamp to the server's receive time, in
+// nanoseconds. Values are counted in log linear buckets, as an HDR histogram does: exact below 128ns and within
+// 1/128 of the value above, so percentiles keep their precision from microseconds to minutes in a few kilobytes.
+// The latency is only as good as the agreement of the two hosts' clocks, which PTP or NTP must keep in step.
+class LatencyHistogram
+{
+public:
+  static constexpr unsigned int precisionBits = 7;
+
+  void record(std::int64_t latencyNanoseconds);
+
+  [[nodiscard]] std::uint64_t count() const;
+  // Frames received before they were sent, which only happens when the clocks are out of step. They count as 0
+  // towards the percentiles.
+  [[nodiscard]] std::uint64_t negativeCount() const;
+  [[nodiscard]] std::int64_t min() const;
+  [[nodiscard]] std::int64_t max() const;
+  // The latency that percent of the frames were within, to the precision of its bucket. 0 if nothing is recorded.
+  [[nodiscard]] std::int64_t percentile(double percent) const;
+  // Interarrival jitter as RFC 3550 estimates it, a running average of the change in latency from frame to frame.
+  [[nodiscard]] double jitter() const;
+
+  // "min 1.200ms p50 1.310ms p99 2.050ms p99.9 3.500ms max 4.100ms jitter 0.020ms", for the end of session log.
+  [[nodiscard]] std::string summary() const;
+
+private:
+  static std::size_t bucketIndex(std::uint64_t value);
+  static std::uint64_t bucketHighestValue(std::size_t index);
+
+  std::vector<std::uint64_t> buckets;
+  std::uint64_t total = 0;
+  std::uint64_t negatives = 0;
+  std::int64_t minimum = 0;
+  std::int64_t maximum = 0;
+  std::int64_t lastLatency = 0;
+  double jitterEstimate = 0;
+};
+
+#endif //LATENCYHISTOGRAM_HPP
@@ -0,0 +1,87 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "test/catch.hpp"
+#include "LatencyHistogram.hpp"
+
+TEST_CASE("Latency histogram. Percentiles are exact for small values and within 1/128 for large ones")
+{
+  LatencyHistogram histogram;
+  REQUIRE(histogram.count() == 0);
+  REQUIRE(histogram.percentile(50) == 0);
+
+  SECTION("Small values")
+  {
+    for (std::int64_t latency = 1; latency <= 100; ++latency)
+    {
+      histogram.record(latency);
+    }
+    REQUIRE(histogram.count() == 100);
+    REQUIRE(histogram.min() == 1);
+    REQUIRE(histogram.max() == 100);
+    REQUIRE(histogram.percentile(50) == 50);
+    REQUIRE(histogram.percentile(99) == 99);
+    REQUIRE(histogram.percentile(100) == 100);
+  }
+
+  SECTION("Large values")
+  {
+    for (std::int64_t microseconds = 1; microseconds <= 1000; ++microseconds)
+    {
+      histogram.record(microseconds * 1000);
+    }
+    REQUIRE(histogram.percentile(50) >= 500000);
+    REQUIRE(histogram.percentile(50) <= 500000 + 500000 / 128);
+    REQUIRE(histogram.percentile(99.9) >= 999000);
+    REQUIRE(histogram.percentile(99.9) <= 999000 + 999000 / 128);
+    REQUIRE(histogram.percentile(100) == 1000000);
+  }
+
+  SECTION("Values from seconds to minutes")
+  {
+    const std::int64_t minute = 60000000000;
+    histogram.record(minute);
+    histogram.record(10 * minute);
+    REQUIRE(histogram.percentile(50) >= minute);
+    REQUIRE(histogram.percentile(50) <= minute + minute / 128);
+    REQUIRE(histogram.percentile(100) == 10 * minute);
+  }
+}
+
+TEST_CASE("Latency histogram. Frames received before they were sent are counted apart")
+{
+  LatencyHistogram histogram;
+  histogram.record(-5000);
+  histogram.record(2000);
+  histogram.record(3000);
+
+  REQUIRE(histogram.negativeCount() == 1);
+  REQUIRE(histogram.min() == -5000);
+  REQUIRE(histogram.percentile(1) == 0);
+  REQUIRE(histogram.percentile(100) == 3000);
+}
+
+TEST_CASE("Latency histogram. Jitter follows the change in latency from frame to frame")
+{
+  LatencyHistogram histogram;
+  for (auto frame = 0; frame < 1000; ++frame)
+  {
+    histogram.record(1000000);
+  }
+  REQUIRE(histogram.jitter() == Approx(0));
+
+  for (auto frame = 0; frame < 1000; ++frame)
+  {
+    histogram.record(frame % 2 == 0 ? 1000000 : 1100000);
+  }
+  REQUIRE(histogram.jitter() == Approx(100000).epsilon(0.01));
+}
+
+TEST_CASE("Latency histogram. The summary gives the percentiles in milliseconds")
+{
+  LatencyHistogram histogram;
+  histogram.record(1200000);
+  histogram.record(1200000);
+  REQUIRE(histogram.summary() ==
+          "min 1.200ms p50 1.200ms p99 1.200ms p99.9 1.200ms max 1.200ms jitter 0.000ms");
+}
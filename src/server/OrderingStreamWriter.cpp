@@ -8,8 +8,12 @@ OrderingStreamWriter::OrderingStreamWriter(
   std::uint32_t maxQueueLength,
   std::unique_ptr<StreamInterface> streamWrapper,
   std::function<std::time_t()> getTime,
-  DiodeType diodeType) :
-    packetQueue(maxBufferSize, maxQueueLength, diodeType),
+  DiodeType diodeType,
+  std::shared_ptr<ReorderBudget> reorderBudget,
+  std::shared_ptr<ParallelRewrapper> parallelRewrapper) :
+    packetQueue(
+      maxBufferSize, maxQueueLength, diodeType, defaultMaxFilenameLength, std::move(reorderBudget),
+      std::move(parallelRewrapper)),
     streamWrapper(std::move(streamWrapper)),
     getTime(std::move(getTime)),
     timeLastUpdated(this->getTime())
@@ -31,3 +35,8 @@ void OrderingStreamWriter::renameFile()
 {
   streamWrapper->renameFile();
 }
+
+const ReorderWindow* OrderingStreamWriter::reorderWindow() const
+{
+  return packetQueue.reorderWindow();
+}
@@ -20,11 +20,15 @@ public:
     std::uint32_t maxQueueLength,
     std::unique_ptr<StreamInterface> stream,
     std::function<std::time_t()> getTime,
-    DiodeType diodeType);
+    DiodeType diodeType,
+    std::shared_ptr<ReorderBudget> reorderBudget = nullptr,
+    std::shared_ptr<ParallelRewrapper> parallelRewrapper = nullptr);
 
   bool write(Packet&& data);
   void deleteFile();
   void renameFile();
+  // Null unless the reorder window is adaptive.
+  [[nodiscard]] const ReorderWindow* reorderWindow() const;
 
 private:
   ReorderPackets packetQueue;
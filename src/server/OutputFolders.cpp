@@ -0,0 +1,31 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "OutputFolders.hpp"
+#include <stdexcept>
+
+void createParentFolders(const std::filesystem::path& base, const std::filesystem::path& relativeFilename)
+{
+  if (relativeFilename.is_absolute())
+  {
+    throw std::runtime_error("Received filename is not relative: " + relativeFilename.string());
+  }
+
+  auto folder = base;
+  for (const auto& component : relativeFilename.parent_path())
+  {
+    if (component == "." || component == "..")
+    {
+      throw std::runtime_error("Received filename leaves the output folder: " + relativeFilename.string());
+    }
+    folder /= component;
+    if (!std::filesystem::exists(std::filesystem::symlink_status(folder)))
+    {
+      std::filesystem::create_directory(folder);
+    }
+    if (!std::filesystem::is_directory(std::filesystem::symlink_status(folder)))
+    {
+      throw std::runtime_error("Received filename goes through something that is not a folder: " + folder.string());
+    }
+  }
+}
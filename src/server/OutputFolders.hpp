@@ -0,0 +1,13 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef OUTPUTFOLDERS_HPP
+#define OUTPUTFOLDERS_HPP
+
+#include <filesystem>
+
+// Creates the folders of a received relative filename, such as docs/2021/a.pdf, under base one at a time. Throws
+// rather than go through anything already there that is not a real folder, such as a symlink to somewhere else.
+void createParentFolders(const std::filesystem::path& base, const std::filesystem::path& relativeFilename);
+
+#endif //OUTPUTFOLDERS_HPP
@@ -0,0 +1,43 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include "test/catch.hpp"
+#include "OutputFolders.hpp"
+
+TEST_CASE("OutputFolders.")
+{
+  const auto base =
+    std::filesystem::temp_directory_path() / ("edfolders." + std::to_string(std::random_device()()));
+  std::filesystem::create_directories(base);
+
+  SECTION("The folders of a relative filename are created under the base folder")
+  {
+    createParentFolders(base, "docs/2021/report.pdf");
+    REQUIRE(std::filesystem::is_directory(base / "docs" / "2021"));
+    REQUIRE_FALSE(std::filesystem::exists(base / "docs" / "2021" / "report.pdf"));
+
+    createParentFolders(base, "docs/2021/other.pdf");
+    createParentFolders(base, "top.pdf");
+  }
+
+  SECTION("Filenames that leave the base folder are refused")
+  {
+    REQUIRE_THROWS_AS(createParentFolders(base, "/etc/passwd"), std::runtime_error);
+    REQUIRE_THROWS_AS(createParentFolders(base, "../outside/a.pdf"), std::runtime_error);
+    REQUIRE_THROWS_AS(createParentFolders(base, "docs/../../a.pdf"), std::runtime_error);
+  }
+
+  SECTION("Folders are not created through a symlink or a file")
+  {
+    std::filesystem::create_directory_symlink(std::filesystem::temp_directory_path(), base / "link");
+    REQUIRE_THROWS_AS(createParentFolders(base, "link/a.pdf"), std::runtime_error);
+
+    std::ofstream(base / "file").put('x');
+    REQUIRE_THROWS_AS(createParentFolders(base, "file/a.pdf"), std::runtime_error);
+  }
+
+  std::filesystem::remove_all(base);
+}
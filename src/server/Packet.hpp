@@ -13,10 +13,40 @@
 
 struct HeaderParams
 {
+  HeaderParams(std::uint32_t sessionId, std::uint32_t frameCount, bool eOFFlag,
+    const CloakedDaggerHeader& cloakedDaggerHeader, bool compressed = false, bool resumable = false,
+    std::uint32_t resumeFrameSize = 0, bool packed = false, std::uint64_t sendTimestamp = 0,
+    bool streaming = false, std::uint32_t resumeEofFrame = 0, bool keepalive = false):
+      sessionId(sessionId),
+      frameCount(frameCount),
+      eOFFlag(eOFFlag),
+      cloakedDaggerHeader(cloakedDaggerHeader),
+      compressed(compressed),
+      resumable(resumable),
+      resumeFrameSize(resumeFrameSize),
+      packed(packed),
+      sendTimestamp(sendTimestamp),
+      streaming(streaming),
+      resumeEofFrame(resumeEofFrame),
+      keepalive(keepalive)
+  {
+  }
+
   std::uint32_t sessionId;
   std::uint32_t frameCount;
   bool eOFFlag;
   CloakedDaggerHeader cloakedDaggerHeader;
+  bool compressed;
+  bool resumable;
+  std::uint32_t resumeFrameSize;
+  bool packed;
+  // Nanoseconds since the Unix epoch, 0 if the frame was not stamped.
+  std::uint64_t sendTimestamp;
+  bool streaming;
+  // The frame count of the EOF frame of a resumable session, 0 if the session is not resumable.
+  std::uint32_t resumeEofFrame;
+  // A quiet stream showing it is still there, rather than a frame.
+  bool keepalive;
 };
 
 class Packet
@@ -30,12 +60,14 @@ public:
 
   Packet(Packet&& rhs) noexcept:
       headerParams(std::move(rhs.headerParams)),
-      payload(std::move(rhs.payload)){};
+      payload(std::move(rhs.payload)),
+      receiveTimestamp(rhs.receiveTimestamp){};
 
   Packet& operator=(Packet&& rhs) noexcept
   {
     headerParams = std::move(rhs.headerParams);
     payload = std::move(rhs.payload);
+    receiveTimestamp = rhs.receiveTimestamp;
     return *this;
   }
 
@@ -50,6 +82,8 @@ public:
 
   HeaderParams headerParams;
   std::vector<std::uint8_t> payload;
+  // When the server received a stamped frame, in nanoseconds since the Unix epoch, or 0.
+  std::uint64_t receiveTimestamp = 0;
 };
 
 Packet parsePacket(std::vector<std::uint8_t>&& header, std::vector<std::uint8_t>&& payload);
@@ -0,0 +1,98 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "PacketCapture.hpp"
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+  template <typename T>
+  void writeValue(std::ostream& output, T value)
+  {
+    output.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  template <typename T>
+  T readValue(const char* data)
+  {
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+  }
+}
+
+PacketCapture::Writer::Writer(std::ostream& output):
+  output(output)
+{
+  writeValue(output, nanosecondMagic);
+  writeValue(output, std::uint16_t{2});
+  writeValue(output, std::uint16_t{4});
+  writeValue(output, std::int32_t{0});
+  writeValue(output, std::uint32_t{0});
+  writeValue(output, snapshotLength);
+  writeValue(output, linkTypeUser0);
+}
+
+void PacketCapture::Writer::write(Timestamp timestamp, const BytesBuffer& header, const BytesBuffer& payload)
+{
+  const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timestamp);
+  const auto length = static_cast<std::uint32_t>(header.size() + payload.size());
+  writeValue(output, static_cast<std::uint32_t>(seconds.count()));
+  writeValue(output, static_cast<std::uint32_t>((timestamp - seconds).count()));
+  writeValue(output, length);
+  writeValue(output, length);
+  output.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+  output.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+}
+
+PacketCapture::Reader::Reader(std::istream& input):
+  input(input)
+{
+  std::array<char, 24> fileHeader{};
+  if (!input.read(fileHeader.data(), fileHeader.size()))
+  {
+    throw std::runtime_error("Packet capture is too short");
+  }
+  const auto magic = readValue<std::uint32_t>(fileHeader.data());
+  if (magic != nanosecondMagic && magic != microsecondMagic)
+  {
+    throw std::runtime_error("Not a pcap file in this machine's byte order");
+  }
+  if (readValue<std::uint32_t>(fileHeader.data() + 20) != linkTypeUser0)
+  {
+    throw std::runtime_error("Packet capture is not of raw ED datagrams");
+  }
+  subsecondScale = magic == nanosecondMagic ? 1 : 1000;
+}
+
+std::optional<PacketCapture::Record> PacketCapture::Reader::next()
+{
+  std::array<char, 16> recordHeader{};
+  input.read(recordHeader.data(), recordHeader.size());
+  if (input.gcount() == 0 && input.eof())
+  {
+    return std::nullopt;
+  }
+  if (!input)
+  {
+    throw std::runtime_error("Truncated packet capture record header");
+  }
+
+  const auto length = readValue<std::uint32_t>(recordHeader.data() + 8);
+  if (length > snapshotLength)
+  {
+    throw std::runtime_error("Packet capture record of " + std::to_string(length) + " bytes is too long");
+  }
+  Record record{
+    std::chrono::seconds(readValue<std::uint32_t>(recordHeader.data())) +
+      Timestamp(static_cast<Timestamp::rep>(readValue<std::uint32_t>(recordHeader.data() + 4)) * subsecondScale),
+    BytesBuffer(length)};
+  if (!input.read(reinterpret_cast<char*>(record.datagram.data()), length))
+  {
+    throw std::runtime_error("Truncated packet capture record");
+  }
+  return record;
+}
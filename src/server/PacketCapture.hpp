@@ -0,0 +1,59 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef PACKETCAPTURE_HPP
+#define PACKETCAPTURE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include "BytesBuffer.hpp"
+
+// Received ED datagrams stored as a pcap file, so a capture opens in Wireshark and tcpdump. Each record holds one
+// whole datagram, header then payload, with no Ethernet, IP or UDP headers (link type USER0), timestamped to the
+// nanosecond with the time the server received it.
+namespace PacketCapture
+{
+  using Timestamp = std::chrono::nanoseconds;
+
+  constexpr std::uint32_t nanosecondMagic = 0xa1b23c4d;
+  constexpr std::uint32_t microsecondMagic = 0xa1b2c3d4;
+  constexpr std::uint32_t linkTypeUser0 = 147;
+  constexpr std::uint32_t snapshotLength = 65535;
+
+  struct Record
+  {
+    // Since the Unix epoch.
+    Timestamp timestamp;
+    BytesBuffer datagram;
+  };
+
+  class Writer
+  {
+  public:
+    explicit Writer(std::ostream& output);
+
+    void write(Timestamp timestamp, const BytesBuffer& header, const BytesBuffer& payload);
+
+  private:
+    std::ostream& output;
+  };
+
+  class Reader
+  {
+  public:
+    // Throws if the input does not start with a pcap header in this machine's byte order, of link type USER0.
+    explicit Reader(std::istream& input);
+
+    // The next record, or nothing at the end of the capture. Throws on a truncated record.
+    std::optional<Record> next();
+
+  private:
+    std::istream& input;
+    std::uint32_t subsecondScale;
+  };
+}
+
+#endif //PACKETCAPTURE_HPP
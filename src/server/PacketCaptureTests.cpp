@@ -0,0 +1,221 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <boost/asio/signal_set.hpp>
+
+#include "test/catch.hpp"
+#include "test/EnterpriseDiodeTestHelpers.hpp"
+#include "PacketCapture.hpp"
+#include "PacketRecorder.hpp"
+#include "PacketReplayer.hpp"
+#include "StreamSpy.hpp"
+
+namespace
+{
+  class UdpServerStub : public UdpServerInterface
+  {
+  public:
+    void receive(BytesBuffer header, BytesBuffer payload)
+    {
+      callback(std::move(header), std::move(payload));
+    }
+  };
+
+  // A capture of one session with its frames received out of order, spacing seconds apart from startSeconds.
+  std::string createCapture(std::uint8_t sessionId, std::uint32_t startSeconds = 1600000000, std::uint32_t spacing = 1)
+  {
+    std::ostringstream capture;
+    PacketCapture::Writer writer(capture);
+    const std::string filename = "{name: !str \"testFilename\"}";
+    auto time = std::chrono::seconds(startSeconds);
+    writer.write(time, createTestPacketStream(sessionId, 2, false), {'C', 'D'});
+    time += std::chrono::seconds(spacing);
+    writer.write(time, createTestPacketStream(sessionId, 3, true), {filename.begin(), filename.end()});
+    time += std::chrono::seconds(spacing);
+    writer.write(time, createTestPacketStream(sessionId, 1, false), {'A', 'B'});
+    return capture.str();
+  }
+}
+
+TEST_CASE("Packet capture. Records are read back as they were written")
+{
+  std::stringstream capture;
+  PacketCapture::Writer writer(capture);
+  writer.write(std::chrono::seconds(1600000000) + std::chrono::nanoseconds(123456789), {1, 2, 3}, {4, 5});
+  writer.write(std::chrono::seconds(1600000001), {6}, {});
+
+  PacketCapture::Reader reader(capture);
+  const auto first = reader.next();
+  REQUIRE(first->timestamp == std::chrono::seconds(1600000000) + std::chrono::nanoseconds(123456789));
+  REQUIRE(first->datagram == BytesBuffer{1, 2, 3, 4, 5});
+  const auto second = reader.next();
+  REQUIRE(second->timestamp == std::chrono::seconds(1600000001));
+  REQUIRE(second->datagram == BytesBuffer{6});
+  REQUIRE_FALSE(reader.next());
+
+  SECTION("Microsecond captures are read")
+  {
+    auto data = capture.str();
+    std::memcpy(data.data(), &PacketCapture::microsecondMagic, sizeof(PacketCapture::microsecondMagic));
+    std::istringstream microsecondCapture(data);
+    REQUIRE(PacketCapture::Reader(microsecondCapture).next()->timestamp ==
+            std::chrono::seconds(1600000000) + std::chrono::microseconds(123456789));
+  }
+  SECTION("Truncated records are rejected")
+  {
+    const auto data = capture.str();
+    std::istringstream truncated(data.substr(0, data.size() - 1));
+    PacketCapture::Reader truncatedReader(truncated);
+    truncatedReader.next();
+    REQUIRE_THROWS_AS(truncatedReader.next(), std::runtime_error);
+  }
+  SECTION("Other files are rejected")
+  {
+    std::istringstream empty("");
+    REQUIRE_THROWS_AS(PacketCapture::Reader(empty), std::runtime_error);
+    auto data = capture.str();
+    data[20] = 1;
+    std::istringstream ethernetCapture(data);
+    REQUIRE_THROWS_AS(PacketCapture::Reader(ethernetCapture), std::runtime_error);
+  }
+}
+
+TEST_CASE("Packet capture. The recorder writes each datagram and passes it on")
+{
+  auto receiver = std::make_unique<UdpServerStub>();
+  auto& stub = *receiver;
+  auto output = std::make_unique<std::stringstream>();
+  auto& capture = *output;
+  PacketRecorder recorder(std::move(receiver), std::move(output), []() {
+    return std::chrono::system_clock::time_point(std::chrono::seconds(1600000000));
+  });
+  std::vector<BytesBuffer> passedOn;
+  recorder.setCallback([&passedOn](BytesBuffer&& header, BytesBuffer&& payload) {
+    passedOn.push_back(header);
+    passedOn.push_back(payload);
+  });
+
+  stub.receive({1, 2}, {3});
+
+  REQUIRE(passedOn == std::vector<BytesBuffer>{{1, 2}, {3}});
+  PacketCapture::Reader reader(capture);
+  const auto record = reader.next();
+  REQUIRE(record->timestamp == std::chrono::seconds(1600000000));
+  REQUIRE(record->datagram == BytesBuffer{1, 2, 3});
+}
+
+TEST_CASE("Packet capture. A replayed capture is reordered and written by the server")
+{
+  boost::asio::io_service io_context;
+  std::stringstream outputStream;
+  std::uint32_t capturedSessionId = 0;
+  auto replayer = std::make_unique<PacketReplayer>(
+    std::make_unique<std::istringstream>(createCapture(7, 1600000000, 0)), io_context, ReplaySpeed::asFastAsPossible);
+  auto& replayed = *replayer;
+  Server edServer = createEdServer(std::move(replayer), 16, 100, capturedSessionId, outputStream, DiodeType::basic);
+
+  io_context.run();
+
+  REQUIRE(replayed.packetsReplayed() == 3);
+  REQUIRE(capturedSessionId == 7);
+  REQUIRE(outputStream.str() == "ABCD");
+}
+
+TEST_CASE("Packet capture. A replay ends other work on its io_service once the capture is exhausted")
+{
+  boost::asio::io_service io_context;
+  boost::asio::signal_set signals(io_context, SIGUSR1);
+  bool signalWaitEnded = false;
+  signals.async_wait([&signalWaitEnded](const boost::system::error_code&, int) { signalWaitEnded = true; });
+  std::stringstream outputStream;
+  std::uint32_t capturedSessionId = 0;
+  auto replayer = std::make_unique<PacketReplayer>(
+    std::make_unique<std::istringstream>(createCapture(7, 1600000000, 0)), io_context, ReplaySpeed::asFastAsPossible);
+  replayer->whenFinished([&signals]() { signals.cancel(); });
+  Server edServer = createEdServer(std::move(replayer), 16, 100, capturedSessionId, outputStream, DiodeType::basic);
+
+  io_context.run_for(std::chrono::seconds(5));
+
+  REQUIRE(io_context.stopped());
+  REQUIRE(signalWaitEnded);
+  REQUIRE(outputStream.str() == "ABCD");
+
+  SECTION("Even when the capture has no datagrams")
+  {
+    std::ostringstream emptyCapture;
+    PacketCapture::Writer writer(emptyCapture);
+    boost::asio::io_service emptyContext;
+    boost::asio::signal_set emptySignals(emptyContext, SIGUSR1);
+    emptySignals.async_wait([](const boost::system::error_code&, int) {});
+    PacketReplayer emptyReplayer(
+      std::make_unique<std::istringstream>(emptyCapture.str()), emptyContext, ReplaySpeed::asFastAsPossible);
+    emptyReplayer.whenFinished([&emptySignals]() { emptySignals.cancel(); });
+
+    emptyContext.run_for(std::chrono::seconds(5));
+
+    REQUIRE(emptyContext.stopped());
+  }
+}
+
+TEST_CASE("Packet capture. A capture cut off part way through a record is replayed up to the cut")
+{
+  auto capture = createCapture(7, 1600000000, 0);
+  capture.resize(capture.size() - 1);
+  boost::asio::io_service io_context;
+  std::stringstream outputStream;
+  std::uint32_t capturedSessionId = 0;
+  auto replayer = std::make_unique<PacketReplayer>(
+    std::make_unique<std::istringstream>(capture), io_context, ReplaySpeed::asFastAsPossible);
+  auto& replayed = *replayer;
+  Server edServer = createEdServer(std::move(replayer), 16, 100, capturedSessionId, outputStream, DiodeType::basic);
+
+  REQUIRE_NOTHROW(io_context.run());
+
+  REQUIRE(replayed.packetsReplayed() == 2);
+  REQUIRE(capturedSessionId == 7);
+}
+
+TEST_CASE("Packet capture. Replay at the original speed keeps the packet spacing")
+{
+  std::ostringstream capture;
+  PacketCapture::Writer writer(capture);
+  writer.write(std::chrono::seconds(1600000000), createTestPacketStream(1, 1, false), {'A'});
+  writer.write(std::chrono::seconds(1600000000) + std::chrono::milliseconds(50), createTestPacketStream(1, 2, false), {'B'});
+
+  boost::asio::io_service io_context;
+  PacketReplayer replayer(std::make_unique<std::istringstream>(capture.str()), io_context, ReplaySpeed::original);
+  std::vector<std::chrono::steady_clock::time_point> receivedAt;
+  replayer.setCallback([&receivedAt](BytesBuffer&&, BytesBuffer&&) {
+    receivedAt.push_back(std::chrono::steady_clock::now());
+  });
+
+  io_context.run();
+
+  REQUIRE(receivedAt.size() == 2);
+  REQUIRE(receivedAt[1] - receivedAt[0] >= std::chrono::milliseconds(45));
+}
+
+TEST_CASE("Packet capture. Session timeouts follow the recorded time, not the replay speed")
+{
+  boost::asio::io_service io_context;
+  std::stringstream outputStream;
+  bool fileDeleted = false;
+  bool fileRenamed = false;
+  auto replayer = std::make_unique<PacketReplayer>(
+    std::make_unique<std::istringstream>(createCapture(1, 1600000000, 20)), io_context, ReplaySpeed::asFastAsPossible);
+  auto& replayed = *replayer;
+  Server edServer(std::move(replayer), 16, 100,
+    [&](std::uint32_t sessionId) {
+      return std::make_unique<StreamSpy>(outputStream, sessionId, fileDeleted, fileRenamed);
+    },
+    [&replayed]() { return replayed.recordedTime(); }, 15, DiodeType::basic);
+
+  io_context.run();
+
+  REQUIRE(fileDeleted);
+  REQUIRE_FALSE(fileRenamed);
+}
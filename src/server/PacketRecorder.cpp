@@ -0,0 +1,33 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "PacketRecorder.hpp"
+#include <stdexcept>
+
+PacketRecorder::PacketRecorder(
+  std::unique_ptr<UdpServerInterface> receiver,
+  std::unique_ptr<std::ostream> output,
+  std::function<std::chrono::system_clock::time_point()> getTime):
+    output(std::move(output)),
+    writer(*this->output),
+    getTime(std::move(getTime)),
+    receiver(std::move(receiver))
+{
+  if (!*this->output)
+  {
+    throw std::runtime_error("Unable to write the packet capture");
+  }
+  this->receiver->setCallback([this](BytesBuffer&& header, BytesBuffer&& payload) {
+    writer.write(
+      std::chrono::duration_cast<PacketCapture::Timestamp>(this->getTime().time_since_epoch()), header, payload);
+    if (callback)
+    {
+      callback(std::move(header), std::move(payload));
+    }
+  });
+}
+
+std::chrono::system_clock::time_point PacketRecorder::receiveTime() const
+{
+  return receiver->receiveTime();
+}
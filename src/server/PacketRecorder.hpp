@@ -0,0 +1,33 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef PACKETRECORDER_HPP
+#define PACKETRECORDER_HPP
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include "PacketCapture.hpp"
+#include "UdpServerInterface.hpp"
+
+// Passes datagrams through from another receiver, writing each to a packet capture on the way, so a receive
+// problem seen on the real diode can be replayed later with PacketReplayer.
+class PacketRecorder : public UdpServerInterface
+{
+public:
+  PacketRecorder(
+    std::unique_ptr<UdpServerInterface> receiver,
+    std::unique_ptr<std::ostream> output,
+    std::function<std::chrono::system_clock::time_point()> getTime = std::chrono::system_clock::now);
+
+  std::chrono::system_clock::time_point receiveTime() const override;
+
+private:
+  std::unique_ptr<std::ostream> output;
+  PacketCapture::Writer writer;
+  std::function<std::chrono::system_clock::time_point()> getTime;
+  std::unique_ptr<UdpServerInterface> receiver;
+};
+
+#endif //PACKETRECORDER_HPP
@@ -0,0 +1,111 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "PacketReplayer.hpp"
+#include <iostream>
+#include <stdexcept>
+#include <boost/asio/post.hpp>
+#include "diodeheader/EnterpriseDiodeHeader.hpp"
+#include "spdlog/spdlog.h"
+
+PacketReplayer::PacketReplayer(
+  std::unique_ptr<std::istream> input,
+  boost::asio::io_service& io_service,
+  ReplaySpeed speed):
+    input(std::move(input)),
+    reader(*this->input),
+    io_context(io_service),
+    speed(speed),
+    timer(io_service),
+    nextPacket(readNextPacket()),
+    replayStart(std::chrono::steady_clock::now())
+{
+  if (nextPacket)
+  {
+    firstTimestamp = nextPacket->timestamp;
+    currentTimestamp = firstTimestamp;
+  }
+  scheduleNextPacket();
+}
+
+std::time_t PacketReplayer::recordedTime() const
+{
+  return static_cast<std::time_t>(std::chrono::duration_cast<std::chrono::seconds>(currentTimestamp).count());
+}
+
+std::chrono::system_clock::time_point PacketReplayer::receiveTime() const
+{
+  return std::chrono::system_clock::time_point(
+    std::chrono::duration_cast<std::chrono::system_clock::duration>(currentTimestamp));
+}
+
+std::size_t PacketReplayer::packetsReplayed() const
+{
+  return packetCount;
+}
+
+void PacketReplayer::whenFinished(std::function<void()> finished)
+{
+  this->finished = std::move(finished);
+  if (!nextPacket)
+  {
+    boost::asio::post(io_context, this->finished);
+  }
+}
+
+void PacketReplayer::scheduleNextPacket()
+{
+  if (!nextPacket)
+  {
+    if (finished)
+    {
+      finished();
+    }
+    return;
+  }
+  if (speed == ReplaySpeed::asFastAsPossible)
+  {
+    boost::asio::post(io_context, [this]() { deliverPacket(); });
+    return;
+  }
+  timer.expires_at(replayStart + (nextPacket->timestamp - firstTimestamp));
+  timer.async_wait([this](const boost::system::error_code& errorCode) {
+    if (!errorCode)
+    {
+      deliverPacket();
+    }
+  });
+}
+
+void PacketReplayer::deliverPacket()
+{
+  auto& datagram = nextPacket->datagram;
+  currentTimestamp = nextPacket->timestamp;
+  ++packetCount;
+  if (callback && datagram.size() > EnterpriseDiode::HeaderSizeInBytes)
+  {
+    BytesBuffer payload(datagram.begin() + EnterpriseDiode::HeaderSizeInBytes, datagram.end());
+    datagram.resize(EnterpriseDiode::HeaderSizeInBytes);
+    callback(std::move(datagram), std::move(payload));
+  }
+  else
+  {
+    std::cerr << "insufficient data in payload" << "\n";
+  }
+  nextPacket = readNextPacket();
+  scheduleNextPacket();
+}
+
+// A capture from a server that was killed mid write ends part way through a record, which ends the replay there.
+std::optional<PacketCapture::Record> PacketReplayer::readNextPacket()
+{
+  try
+  {
+    return reader.next();
+  }
+  catch (const std::runtime_error& exception)
+  {
+    spdlog::warn("Ending the replay after {} datagrams: {}", packetCount, exception.what());
+    return std::nullopt;
+  }
+}
@@ -0,0 +1,63 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef PACKETREPLAYER_HPP
+#define PACKETREPLAYER_HPP
+
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include "PacketCapture.hpp"
+#include "UdpServerInterface.hpp"
+
+enum class ReplaySpeed
+{
+  original,
+  asFastAsPossible
+};
+
+// Feeds the datagrams of a packet capture to the server on io_service, in place of a network receiver, either
+// with their original spacing or back to back. Once the capture is exhausted the replayer has no more work, so
+// io_service.run() returns unless something else, such as a signal set, is still waiting on it.
+class PacketReplayer : public UdpServerInterface
+{
+public:
+  PacketReplayer(std::unique_ptr<std::istream> input, boost::asio::io_service& io_service, ReplaySpeed speed);
+
+  // The receive time of the datagram being delivered, to drive the server's session timeouts from the capture
+  // rather than the clock, so a replay times out the same sessions however fast it runs.
+  std::time_t recordedTime() const;
+
+  // The recorded receive time of the datagram being delivered, so a replay reports the latencies seen live.
+  std::chrono::system_clock::time_point receiveTime() const override;
+
+  std::size_t packetsReplayed() const;
+
+  // Called on io_service once the last datagram has been delivered, to end other work waiting on it, so that
+  // io_service.run() returns.
+  void whenFinished(std::function<void()> finished);
+
+private:
+  std::optional<PacketCapture::Record> readNextPacket();
+  void scheduleNextPacket();
+  void deliverPacket();
+
+  std::unique_ptr<std::istream> input;
+  PacketCapture::Reader reader;
+  boost::asio::io_service& io_context;
+  const ReplaySpeed speed;
+  boost::asio::steady_timer timer;
+  std::optional<PacketCapture::Record> nextPacket;
+  PacketCapture::Timestamp firstTimestamp{};
+  PacketCapture::Timestamp currentTimestamp{};
+  std::chrono::steady_clock::time_point replayStart;
+  std::size_t packetCount = 0;
+  std::function<void()> finished;
+};
+
+#endif //PACKETREPLAYER_HPP
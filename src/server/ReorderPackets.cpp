@@ -2,8 +2,10 @@
 // MIT License. For licence terms see LICENCE.md file.
 
 #include "ReorderPackets.hpp"
+#include "FlightRecorder.hpp"
 #include "Packet.hpp"
 #include "StreamInterface.hpp"
+#include <FrameCompression.hpp>
 #include <chrono>
 #include <iostream>
 #include "spdlog/spdlog.h"
@@ -12,12 +14,24 @@ ReorderPackets::ReorderPackets(
   std::uint32_t maxBufferSize,
   std::uint32_t maxQueueLength,
   DiodeType diodeType,
-  std::uint32_t maxFilenameLength):
-    sislFilename(maxFilenameLength),
+  std::uint32_t maxFilenameLength,
+  std::shared_ptr<ReorderBudget> reorderBudget,
+  std::shared_ptr<ParallelRewrapper> parallelRewrapper):
+    sislFilename(maxEofSislLength(maxFilenameLength), maxFilenameLength),
     maxBufferSize(maxBufferSize),
     maxQueueLength(maxQueueLength),
-    diodeType(diodeType)
+    diodeType(diodeType),
+    parallelRewrapper(std::move(parallelRewrapper))
 {
+  if (reorderBudget)
+  {
+    window.emplace(std::move(reorderBudget), maxBufferSize);
+  }
+}
+
+const ReorderWindow* ReorderPackets::reorderWindow() const
+{
+  return window ? &*window : nullptr;
 }
 
 bool ReorderPackets::write(Packet&& packet, StreamInterface* streamWrapper)
@@ -38,47 +52,135 @@ void ReorderPackets::logOutOfOrderPackets(uint32_t frameCount)
 
 void ReorderPackets::addFrameToQueue(Packet&& packet)
 {
-  if (queue.size() >= maxQueueLength)
+  if (window)
+  {
+    const auto frameCount = packet.headerParams.frameCount;
+    window->recordDistance(frameCount > nextFrameCount ? frameCount - nextFrameCount : 0);
+  }
+  if (!hasRoomInQueue())
   {
     if (!queueAlreadyExceeded)
     {
-      spdlog::error("ReorderPackets: maxQueueLength exceeded.");
+      spdlog::error(
+        window ? "ReorderPackets: reorder memory budget exhausted." : "ReorderPackets: maxQueueLength exceeded.");
       queueAlreadyExceeded = true;
     }
+    flightRecorder().record(FlightStage::dropped, packet.headerParams.sessionId, packet.headerParams.frameCount,
+      FlightReason::queueFull);
     return;
   }
+  flightRecorder().record(FlightStage::enqueued, packet.headerParams.sessionId, packet.headerParams.frameCount);
   queue.emplace(std::move(packet));
 }
 
+bool ReorderPackets::hasRoomInQueue()
+{
+  if (!window)
+  {
+    return queue.size() < maxQueueLength;
+  }
+  return queue.size() < window->length() || window->grow();
+}
+
 bool ReorderPackets::checkQueueAndWrite(StreamInterface* streamWrapper)
 {
   while (!queue.empty() && (queue.top().headerParams.frameCount == nextFrameCount))
   {
+    flightRecorder().record(FlightStage::dequeued, queue.top().headerParams.sessionId, nextFrameCount);
     if (queue.top().headerParams.eOFFlag)
     {
+      writeRewrapBatch(streamWrapper);
       streamWrapper->setStoredFilename(
         sislFilename.extractFilename(queue.top().getFrame()).value_or("rejected."));
+      flightRecorder().record(FlightStage::written, queue.top().headerParams.sessionId, nextFrameCount);
       queue.pop();
       return true;
     }
-    writeFrame(streamWrapper);
+    if (rewrapInBatch())
+    {
+      addFrameToRewrapBatch(streamWrapper);
+    }
+    else
+    {
+      writeFrame(streamWrapper);
+    }
     queue.pop();
     ++nextFrameCount;
+    if (window)
+    {
+      window->frameWritten(queue.size());
+    }
   }
   return false;
 }
 
 void ReorderPackets::writeFrame(StreamInterface* streamWrapper)
 {
-  if (diodeType == DiodeType::import)
+  const auto sessionId = queue.top().headerParams.sessionId;
+  if (queue.top().headerParams.compressed)
+  {
+    if (diodeType == DiodeType::import)
+    {
+      throw std::runtime_error("Compressed sessions are not supported through the import diode");
+    }
+    FrameCompression::decompressFrame(queue.top().payload, decompressedFrame);
+    streamWrapper->write(decompressedFrame);
+  }
+  else if (diodeType == DiodeType::import)
   {
-    streamWrapper->write(
-      streamingRewrapper.rewrap(
-        queue.top().getFrame(), queue.top().headerParams.cloakedDaggerHeader,
-        nextFrameCount));
+    const auto& rewrapped = streamingRewrapper.rewrap(
+      queue.top().payload, queue.top().headerParams.cloakedDaggerHeader, nextFrameCount);
+    flightRecorder().record(FlightStage::rewrapped, sessionId, nextFrameCount);
+    streamWrapper->write(rewrapped);
   }
   else
   {
-    streamWrapper->write(queue.top().getFrame());
+    streamWrapper->write(queue.top().payload);
+  }
+  flightRecorder().record(FlightStage::written, sessionId, nextFrameCount);
+}
+
+// The first frame sets the mask the rest are rewrapped with, so it is always rewrapped on its own.
+bool ReorderPackets::rewrapInBatch() const
+{
+  return parallelRewrapper && diodeType == DiodeType::import && nextFrameCount != 1 &&
+    !queue.top().headerParams.compressed;
+}
+
+void ReorderPackets::addFrameToRewrapBatch(StreamInterface* streamWrapper)
+{
+  // The payload is moved out of the frame at the top of the queue just before it is popped, as the queue is
+  // only ordered by the header.
+  auto& packet = const_cast<Packet&>(queue.top());
+  const auto plan = streamingRewrapper.plan(packet.payload, packet.headerParams.cloakedDaggerHeader);
+  if (rewrapBatch.empty())
+  {
+    rewrapBatchFirstFrame = nextFrameCount;
+  }
+  rewrapBatchSessionId = packet.headerParams.sessionId;
+  rewrapBatchBytes += packet.payload.size();
+  rewrapBatch.push_back({std::move(packet.payload), plan, {}});
+  if (rewrapBatchBytes >= rewrapBatchSizeInBytes)
+  {
+    writeRewrapBatch(streamWrapper);
+  }
+}
+
+void ReorderPackets::writeRewrapBatch(StreamInterface* streamWrapper)
+{
+  if (rewrapBatch.empty())
+  {
+    return;
+  }
+  parallelRewrapper->rewrap(rewrapBatch);
+  const auto rewrappedNs = FlightRecorder::now();
+  auto frameCount = rewrapBatchFirstFrame;
+  for (const auto& job : rewrapBatch)
+  {
+    flightRecorder().record(FlightStage::rewrapped, rewrapBatchSessionId, frameCount, FlightReason::none, rewrappedNs);
+    streamWrapper->write(job.plan.wrapped ? job.output : job.input);
+    flightRecorder().record(FlightStage::written, rewrapBatchSessionId, frameCount++);
   }
+  rewrapBatch.clear();
+  rewrapBatchBytes = 0;
 }
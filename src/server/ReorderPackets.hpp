@@ -6,8 +6,11 @@
 #include <BytesBuffer.hpp>
 #include <algorithm>
 #include <optional>
+#include <memory>
 #include <queue>
+#include <rewrapper/ParallelRewrapper.hpp>
 #include <rewrapper/StreamingRewrapper.hpp>
+#include "ReorderWindow.hpp"
 
 class StreamInterface;
 
@@ -18,6 +21,19 @@ enum class DiodeType
   basic
 };
 
+// Most memory the reorder queue of one session can hold: every queued packet keeps a receive buffer of
+// maxBufferSize, so with 64KB datagrams the same queue length takes over forty times what it does at 1500.
+constexpr std::uint64_t reorderQueueSizeInBytes(std::uint32_t maxBufferSize, std::uint32_t maxQueueLength)
+{
+  return std::uint64_t{maxBufferSize} * maxQueueLength;
+}
+
+// Frames of an import session held back to be rewrapped together by the ParallelRewrapper.
+constexpr std::size_t rewrapBatchSizeInBytes = 2 * 1024 * 1024;
+
+// Puts the frames of a session back in order. The queue holds up to maxQueueLength frames, or, given a budget, as
+// many as the session's adaptive ReorderWindow allows. Given a parallelRewrapper, frames of an import session are
+// rewrapped in batches across its threads, and written in order when the batch is done or the session complete.
 class ReorderPackets
 {
 public:
@@ -25,13 +41,22 @@ public:
     std::uint32_t maxBufferSize,
     std::uint32_t maxQueueLength,
     DiodeType diodeType,
-    std::uint32_t maxFilenameLength = 65);
+    std::uint32_t maxFilenameLength = defaultMaxFilenameLength,
+    std::shared_ptr<ReorderBudget> reorderBudget = nullptr,
+    std::shared_ptr<ParallelRewrapper> parallelRewrapper = nullptr);
   bool write(Packet&& packet, StreamInterface* streamWrapper);
 
+  // Null unless the window is adaptive.
+  [[nodiscard]] const ReorderWindow* reorderWindow() const;
+
 private:
   bool checkQueueAndWrite(StreamInterface* streamWrapper);
   void addFrameToQueue(Packet&& packet);
+  bool hasRoomInQueue();
   void writeFrame(StreamInterface *streamWrapper);
+  [[nodiscard]] bool rewrapInBatch() const;
+  void addFrameToRewrapBatch(StreamInterface* streamWrapper);
+  void writeRewrapBatch(StreamInterface* streamWrapper);
   void logOutOfOrderPackets(uint32_t frameCount);
 
   SISLFilename sislFilename;
@@ -40,7 +65,14 @@ private:
   std::uint32_t lastFrameReceived = 0;
   const std::uint32_t maxBufferSize;
   const std::uint32_t maxQueueLength;
+  std::optional<ReorderWindow> window;
   std::priority_queue<Packet, std::vector<Packet>, std::greater<>> queue;
   const DiodeType diodeType;
   StreamingRewrapper streamingRewrapper;
+  std::shared_ptr<ParallelRewrapper> parallelRewrapper;
+  std::vector<RewrapJob> rewrapBatch;
+  std::size_t rewrapBatchBytes = 0;
+  std::uint32_t rewrapBatchSessionId = 0;
+  std::uint32_t rewrapBatchFirstFrame = 0;
+  BytesBuffer decompressedFrame;
 };
@@ -5,6 +5,7 @@
 #include "ReorderPackets.hpp"
 #include "StreamSpy.hpp"
 #include "test/catch.hpp"
+#include <FrameCompression.hpp>
 #include <rewrapper/UnwrapperTestHelpers.hpp>
 
 TEST_CASE("ReorderPackets. Packets received in order are written to the output")
@@ -262,3 +263,93 @@ TEST_CASE("ReorderPackets. Import diode.")
     REQUIRE(stream.storedFilename == "testFilename");
   }
 }
+
+TEST_CASE("ReorderPackets. Import diode frames rewrapped in parallel are written in order")
+{
+  std::stringstream outputStream;
+  StreamSpy stream(outputStream, 1);
+  auto queueManager = ReorderPackets(
+    70000, 1024, DiodeType::import, defaultMaxFilenameLength, nullptr, std::make_shared<ParallelRewrapper>(3));
+  const auto writeFrame = [&](const std::string& payload, std::uint32_t frameCount) {
+    const auto input = createTestWrappedString(payload);
+    return queueManager.write(
+      {HeaderParams{0, frameCount, false, input.header}, BytesBuffer(input.message)}, &stream);
+  };
+
+  SECTION("Frames after the first are held until the end of the file")
+  {
+    REQUIRE_FALSE(writeFrame("abc", 1));
+    const auto firstFrameLength = outputStream.str().size();
+    REQUIRE_FALSE(writeFrame("ghi", 3));
+    REQUIRE_FALSE(writeFrame("def", 2));
+    REQUIRE_FALSE(writeFrame("jkl", 4));
+    REQUIRE(outputStream.str().size() == firstFrameLength);
+
+    const auto eof = std::string("{name: !str \"testFilename\"}");
+    REQUIRE(queueManager.write({HeaderParams{0, 5, true, {}}, {eof.begin(), eof.end()}}, &stream));
+    std::stringstream unwrappedStream;
+    unwrapFromStream(outputStream, unwrappedStream);
+    REQUIRE(unwrappedStream.str() == "abcdefghijkl");
+    REQUIRE(stream.storedFilename == "testFilename");
+  }
+
+  SECTION("A full batch is written without waiting for the end of the file")
+  {
+    std::string expected;
+    std::uint32_t frameCount = 1;
+    for (; expected.size() <= rewrapBatchSizeInBytes; ++frameCount)
+    {
+      const auto payload = std::string(65536, static_cast<char>('a' + frameCount % 26));
+      expected += payload;
+      REQUIRE_FALSE(writeFrame(payload, frameCount));
+    }
+    std::stringstream unwrappedStream;
+    unwrapFromStream(outputStream, unwrappedStream);
+    REQUIRE(unwrappedStream.str() == expected);
+  }
+}
+
+namespace
+{
+  BytesBuffer compressTestFrame(const std::string& input)
+  {
+    BytesBuffer frame(1024);
+    const auto compressed = FrameCompression::compressFrame(
+      input.data(), input.size(), reinterpret_cast<char*>(frame.data()), frame.size());
+    frame.resize(compressed.frameLength);
+    return frame;
+  }
+}
+
+TEST_CASE("ReorderPackets. Compressed frames are written decompressed")
+{
+  std::stringstream outputStream;
+  StreamSpy stream(outputStream, 1);
+  auto queueManager = ReorderPackets(4, 1024, DiodeType::basic);
+
+  REQUIRE_FALSE(queueManager.write({HeaderParams{0, 2, false, {}, true}, compressTestFrame("def")}, &stream));
+  REQUIRE_FALSE(queueManager.write({HeaderParams{0, 1, false, {}, true}, compressTestFrame("abc")}, &stream));
+  REQUIRE(outputStream.str() == "abcdef");
+
+  auto inputStream = std::string("{name: !str \"testFilename\"}");
+  REQUIRE(queueManager.write({HeaderParams{0, 3, true, {}, true}, {inputStream.begin(), inputStream.end()}}, &stream));
+  REQUIRE(stream.storedFilename == "testFilename");
+}
+
+TEST_CASE("ReorderPackets. Corrupt compressed frames throw")
+{
+  std::stringstream outputStream;
+  StreamSpy stream(outputStream, 1);
+  auto queueManager = ReorderPackets(4, 1024, DiodeType::basic);
+
+  REQUIRE_THROWS_AS(queueManager.write({HeaderParams{0, 1, false, {}, true}, {'a', 'b', 'c'}}, &stream), std::runtime_error);
+}
+
+TEST_CASE("ReorderPackets. Compressed frames are rejected through the import diode")
+{
+  std::stringstream outputStream;
+  StreamSpy stream(outputStream, 1);
+  auto queueManager = ReorderPackets(4, 1024, DiodeType::import, 65);
+
+  REQUIRE_THROWS_AS(queueManager.write({HeaderParams{0, 1, false, {}, true}, compressTestFrame("abc")}, &stream), std::runtime_error);
+}
@@ -0,0 +1,157 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "ReorderWindow.hpp"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+  std::size_t bitWidth(std::uint32_t value)
+  {
+    return value == 0 ? 0 : static_cast<std::size_t>(32 - __builtin_clz(value));
+  }
+
+  // Only called with values up to 2^31.
+  std::uint32_t roundUpToPowerOfTwo(std::uint32_t value)
+  {
+    return value <= 1 ? 1 : std::uint32_t{1} << bitWidth(value - 1);
+  }
+
+  // Twice the distance seen, so a session that comes close to its worst again still fits.
+  std::uint32_t lengthToCover(std::uint32_t distance)
+  {
+    return roundUpToPowerOfTwo(static_cast<std::uint32_t>(
+      std::min<std::uint64_t>((std::uint64_t{distance} + 1) * 2, std::uint64_t{1} << 31)));
+  }
+}
+
+ReorderBudget::ReorderBudget(std::uint64_t budgetInBytes):
+  budgetInBytes(budgetInBytes)
+{
+}
+
+bool ReorderBudget::reserve(std::uint64_t bytes)
+{
+  if (reserved + bytes > budgetInBytes)
+  {
+    return false;
+  }
+  reserved += bytes;
+  return true;
+}
+
+void ReorderBudget::reserveAnyway(std::uint64_t bytes)
+{
+  reserved += bytes;
+}
+
+void ReorderBudget::release(std::uint64_t bytes)
+{
+  reserved -= std::min(bytes, reserved);
+}
+
+std::uint64_t ReorderBudget::reservedBytes() const
+{
+  return reserved;
+}
+
+std::uint64_t ReorderBudget::budgetBytes() const
+{
+  return budgetInBytes;
+}
+
+ReorderWindow::ReorderWindow(std::shared_ptr<ReorderBudget> budget, std::uint32_t maxBufferSize):
+  budget(std::move(budget)),
+  maxBufferSize(maxBufferSize)
+{
+  this->budget->reserveAnyway(std::uint64_t{window} * maxBufferSize);
+}
+
+ReorderWindow::~ReorderWindow()
+{
+  if (budget)
+  {
+    budget->release(std::uint64_t{window} * maxBufferSize);
+  }
+}
+
+ReorderWindow::ReorderWindow(ReorderWindow&& other) noexcept:
+  budget(std::move(other.budget)),
+  maxBufferSize(other.maxBufferSize),
+  window(other.window),
+  maximumDistance(other.maximumDistance),
+  intervalMaxDistance(other.intervalMaxDistance),
+  framesSinceShrinkCheck(other.framesSinceShrinkCheck),
+  distanceCounts(other.distanceCounts)
+{
+}
+
+void ReorderWindow::recordDistance(std::uint32_t distance)
+{
+  ++distanceCounts[bitWidth(distance)];
+  maximumDistance = std::max(maximumDistance, distance);
+  intervalMaxDistance = std::max(intervalMaxDistance, distance);
+}
+
+bool ReorderWindow::grow()
+{
+  if (window > std::numeric_limits<std::uint32_t>::max() / 2 ||
+      !budget->reserve(std::uint64_t{window} * maxBufferSize))
+  {
+    return false;
+  }
+  window *= 2;
+  return true;
+}
+
+void ReorderWindow::frameWritten(std::size_t queued)
+{
+  if (++framesSinceShrinkCheck < shrinkInterval)
+  {
+    return;
+  }
+  const auto needed = std::max(initialLength, lengthToCover(intervalMaxDistance));
+  while (window / 2 >= needed && queued <= window / 2)
+  {
+    window /= 2;
+    budget->release(std::uint64_t{window} * maxBufferSize);
+  }
+  framesSinceShrinkCheck = 0;
+  intervalMaxDistance = 0;
+}
+
+std::uint32_t ReorderWindow::length() const
+{
+  return window;
+}
+
+std::uint32_t ReorderWindow::maxDistance() const
+{
+  return maximumDistance;
+}
+
+std::uint32_t ReorderWindow::p99DistanceBound() const
+{
+  const auto total = std::accumulate(distanceCounts.begin(), distanceCounts.end(), std::uint64_t{0});
+  if (total == 0)
+  {
+    return 0;
+  }
+  std::uint64_t counted = 0;
+  for (std::size_t width = 0; width < distanceCounts.size(); ++width)
+  {
+    counted += distanceCounts[width];
+    if (counted * 100 >= total * 99)
+    {
+      return width >= 32 ? std::numeric_limits<std::uint32_t>::max() : (std::uint32_t{1} << width);
+    }
+  }
+  return 0;
+}
+
+std::uint32_t ReorderWindow::recommendedQueueLength() const
+{
+  return lengthToCover(maximumDistance);
+}
@@ -0,0 +1,75 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef REORDERWINDOW_HPP
+#define REORDERWINDOW_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+// The memory all sessions' reorder queues may take between them, when their windows are sized adaptively. Each
+// session reserves a receive buffer for every frame its window holds, whether or not the frame has arrived.
+class ReorderBudget
+{
+public:
+  explicit ReorderBudget(std::uint64_t budgetInBytes);
+
+  // False, reserving nothing, if that many more bytes would take the sessions over the budget.
+  bool reserve(std::uint64_t bytes);
+  // For a session's first window, which it gets even when the budget is used up so it can still receive in order.
+  void reserveAnyway(std::uint64_t bytes);
+  void release(std::uint64_t bytes);
+
+  [[nodiscard]] std::uint64_t reservedBytes() const;
+  [[nodiscard]] std::uint64_t budgetBytes() const;
+
+private:
+  const std::uint64_t budgetInBytes;
+  std::uint64_t reserved = 0;
+};
+
+// How many frames the reorder queue of one session may hold, sized from how far ahead of the next frame due its
+// frames actually arrive rather than fixed by -q. The window starts small, doubles whenever a frame would not fit
+// and the budget has room, and is halved again when the frames of the last few thousand arrived in a quarter of it.
+// Only the last reservation of a moved from window is given back.
+class ReorderWindow
+{
+public:
+  static constexpr std::uint32_t initialLength = 64;
+  static constexpr std::uint32_t shrinkInterval = 4096;
+
+  ReorderWindow(std::shared_ptr<ReorderBudget> budget, std::uint32_t maxBufferSize);
+  ~ReorderWindow();
+
+  ReorderWindow(ReorderWindow&& other) noexcept;
+  ReorderWindow& operator=(ReorderWindow&&) = delete;
+  ReorderWindow(const ReorderWindow&) = delete;
+  ReorderWindow& operator=(const ReorderWindow&) = delete;
+
+  // Every frame that reaches the queue, with how many frames it is ahead of the one due next.
+  void recordDistance(std::uint32_t distance);
+  // Doubles the window if the budget allows. False if not, when the frame that did not fit is dropped.
+  bool grow();
+  // Every frame written in order, with how many are still queued behind it.
+  void frameWritten(std::size_t queued);
+
+  [[nodiscard]] std::uint32_t length() const;
+  [[nodiscard]] std::uint32_t maxDistance() const;
+  // To the power of two above: the distance 99% of frames arrived within is less than this. 0 before any frame.
+  [[nodiscard]] std::uint32_t p99DistanceBound() const;
+  // The -q that would have held every frame of the session, with room to spare.
+  [[nodiscard]] std::uint32_t recommendedQueueLength() const;
+
+private:
+  std::shared_ptr<ReorderBudget> budget;
+  const std::uint32_t maxBufferSize;
+  std::uint32_t window = initialLength;
+  std::uint32_t maximumDistance = 0;
+  std::uint32_t intervalMaxDistance = 0;
+  std::uint32_t framesSinceShrinkCheck = 0;
+  // Distances counted by bit width: 0, 1, 2-3, 4-7 and so on.
+  std::array<std::uint64_t, 33> distanceCounts{};
+};
+
+#endif //REORDERWINDOW_HPP
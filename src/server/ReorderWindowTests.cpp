@@ -0,0 +1,108 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <sstream>
+#include "test/catch.hpp"
+#include "ReorderPackets.hpp"
+#include "ReorderWindow.hpp"
+#include "StreamSpy.hpp"
+
+TEST_CASE("ReorderWindow. The budget refuses what would take it over")
+{
+  ReorderBudget budget(100);
+  REQUIRE(budget.reserve(60));
+  REQUIRE_FALSE(budget.reserve(41));
+  REQUIRE(budget.reservedBytes() == 60);
+  budget.reserveAnyway(50);
+  REQUIRE(budget.reservedBytes() == 110);
+  budget.release(110);
+  REQUIRE(budget.reservedBytes() == 0);
+}
+
+TEST_CASE("ReorderWindow. The window doubles within the budget and gives it all back when the session ends")
+{
+  const std::uint32_t bufferSize = 10;
+  auto budget = std::make_shared<ReorderBudget>(ReorderWindow::initialLength * bufferSize * 4);
+  {
+    ReorderWindow window(budget, bufferSize);
+    REQUIRE(window.length() == ReorderWindow::initialLength);
+    REQUIRE(window.grow());
+    REQUIRE(window.length() == ReorderWindow::initialLength * 2);
+    REQUIRE(window.grow());
+    REQUIRE(window.length() == ReorderWindow::initialLength * 4);
+    REQUIRE_FALSE(window.grow());
+    REQUIRE(window.length() == ReorderWindow::initialLength * 4);
+
+    ReorderWindow moved(std::move(window));
+    REQUIRE(budget->reservedBytes() == ReorderWindow::initialLength * bufferSize * 4);
+  }
+  REQUIRE(budget->reservedBytes() == 0);
+}
+
+TEST_CASE("ReorderWindow. A window larger than recent reordering needs is shrunk")
+{
+  auto budget = std::make_shared<ReorderBudget>(1024 * 1024);
+  ReorderWindow window(budget, 1);
+  for (auto growth = 0; growth < 4; ++growth)
+  {
+    REQUIRE(window.grow());
+  }
+  REQUIRE(window.length() == ReorderWindow::initialLength * 16);
+
+  window.recordDistance(200);
+  for (std::uint32_t frame = 0; frame < ReorderWindow::shrinkInterval; ++frame)
+  {
+    window.recordDistance(frame % 3);
+    window.frameWritten(0);
+  }
+  // Twice the largest distance of the interval, to a power of two.
+  REQUIRE(window.length() == 512);
+  REQUIRE(budget->reservedBytes() == 512);
+
+  for (std::uint32_t frame = 0; frame < ReorderWindow::shrinkInterval; ++frame)
+  {
+    window.recordDistance(1);
+    window.frameWritten(0);
+  }
+  REQUIRE(window.length() == ReorderWindow::initialLength);
+  REQUIRE(window.maxDistance() == 200);
+  REQUIRE(window.p99DistanceBound() == 4);
+  REQUIRE(window.recommendedQueueLength() == 512);
+}
+
+TEST_CASE("ReorderWindow. Frames further out of order than the first window are reassembled within the budget")
+{
+  std::stringstream outputStream;
+  bool notused1;
+  bool notused2;
+  StreamSpy stream(outputStream, 1, notused1, notused2);
+  const std::uint32_t framesAhead = 200;
+
+  SECTION("The window grows to hold them")
+  {
+    auto budget = std::make_shared<ReorderBudget>(1024 * 16);
+    ReorderPackets reorder(16, 1024, DiodeType::basic, defaultMaxFilenameLength, budget);
+    for (std::uint32_t frame = 2; frame <= framesAhead + 1; ++frame)
+    {
+      REQUIRE_FALSE(reorder.write({HeaderParams{0, frame, false, {}}, {'b'}}, &stream));
+    }
+    REQUIRE(outputStream.str().empty());
+    REQUIRE_FALSE(reorder.write({HeaderParams{0, 1, false, {}}, {'a'}}, &stream));
+    REQUIRE(outputStream.str() == "a" + std::string(framesAhead, 'b'));
+    REQUIRE(reorder.reorderWindow()->length() == 256);
+    REQUIRE(reorder.reorderWindow()->maxDistance() == framesAhead);
+  }
+
+  SECTION("Without room in the budget the window stays as it started and the session is lost, as with too short a -q")
+  {
+    auto budget = std::make_shared<ReorderBudget>(0);
+    ReorderPackets reorder(16, 1024, DiodeType::basic, defaultMaxFilenameLength, budget);
+    for (std::uint32_t frame = 2; frame <= framesAhead + 1; ++frame)
+    {
+      reorder.write({HeaderParams{0, frame, false, {}}, {'b'}}, &stream);
+    }
+    reorder.write({HeaderParams{0, 1, false, {}}, {'a'}}, &stream);
+    REQUIRE(reorder.reorderWindow()->length() == ReorderWindow::initialLength);
+    REQUIRE(outputStream.str().empty());
+  }
+}
@@ -0,0 +1,343 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "ResumableSessions.hpp"
+#include "OutputFolders.hpp"
+#include "spdlog/spdlog.h"
+
+namespace
+{
+  struct ProgressHeader
+  {
+    std::uint32_t frameSize;
+    std::uint32_t eofFrame;
+    std::uint32_t frameCount;
+  };
+}
+
+ResumableSession::ResumableSession(
+  std::uint32_t sessionId, std::uint32_t frameSize, std::uint32_t lastFrame, std::filesystem::path directory):
+    sessionId(sessionId),
+    sessionFrameSize(frameSize),
+    announcedEofFrame(lastFrame),
+    directory(std::move(directory)),
+    sislFilename(maxEofSislLength(defaultMaxFilenameLength), defaultMaxFilenameLength)
+{
+  if (loadProgress())
+  {
+    file.open(partialPath(), std::ios::binary | std::ios::in | std::ios::out);
+  }
+  if (!file.is_open())
+  {
+    received.clear();
+    framesReceived = 0;
+    eofFrame = 0;
+    file.open(partialPath(), std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+  }
+  file.exceptions(std::fstream::failbit | std::fstream::badbit);
+}
+
+bool ResumableSession::loadProgress()
+{
+  std::ifstream progress(progressPath(), std::ios::binary);
+  ProgressHeader header{};
+  if (!progress.read(reinterpret_cast<char*>(&header), sizeof(header)))
+  {
+    return false;
+  }
+  if (header.frameSize != sessionFrameSize)
+  {
+    spdlog::warn("Resumable session {}: saved with frames of {} bytes, not {}, starting again", sessionId,
+      header.frameSize, sessionFrameSize);
+    return false;
+  }
+  if (header.frameCount >= announcedEofFrame || (header.eofFrame != 0 && header.eofFrame != announcedEofFrame))
+  {
+    spdlog::warn("Resumable session {}: saved with more frames than the {} announced, starting again", sessionId,
+      announcedEofFrame - 1);
+    return false;
+  }
+
+  std::vector<char> bitmap((header.frameCount + 7) / 8);
+  if (!progress.read(bitmap.data(), static_cast<std::streamsize>(bitmap.size())))
+  {
+    return false;
+  }
+  received.assign(header.frameCount, false);
+  framesReceived = 0;
+  for (std::uint32_t frame = 0; frame < header.frameCount; ++frame)
+  {
+    if ((bitmap[frame / 8] >> (frame % 8)) & 1)
+    {
+      received[frame] = true;
+      ++framesReceived;
+    }
+  }
+  eofFrame = header.eofFrame;
+  spdlog::info("Resumable session {}: resuming with {} frames already received", sessionId, framesReceived);
+  return true;
+}
+
+bool ResumableSession::write(const Packet& packet)
+{
+  const auto frameCount = packet.headerParams.frameCount;
+  if (frameCount == 0 || frameCount > announcedEofFrame)
+  {
+    return false;
+  }
+
+  if (packet.headerParams.eOFFlag)
+  {
+    if (frameCount != announcedEofFrame)
+    {
+      return false;
+    }
+    eofFrame = frameCount;
+    storedFilename = sislFilename.extractFilename(packet.payload).value_or("rejected." + std::to_string(sessionId));
+    progressSaved = false;
+  }
+  else if (frameCount == announcedEofFrame || packet.payload.size() > sessionFrameSize)
+  {
+    return false;
+  }
+  else
+  {
+    if (received.size() < frameCount)
+    {
+      received.resize(frameCount);
+    }
+    if (received[frameCount - 1])
+    {
+      return false;
+    }
+
+    const auto offset = std::uint64_t{frameCount - 1} * sessionFrameSize;
+    if (offset != writeOffset)
+    {
+      file.seekp(static_cast<std::streamoff>(offset));
+    }
+    file.write(reinterpret_cast<const char*>(packet.payload.data()), static_cast<std::streamsize>(packet.payload.size()));
+    writeOffset = offset + packet.payload.size();
+    received[frameCount - 1] = true;
+    ++framesReceived;
+    progressSaved = false;
+  }
+
+  if (eofFrame != 0 && !storedFilename.empty() && framesReceived == eofFrame - 1)
+  {
+    finish();
+    return true;
+  }
+  return false;
+}
+
+void ResumableSession::finish()
+{
+  file.close();
+  try
+  {
+    createParentFolders(directory, storedFilename);
+  }
+  catch (const std::exception& exception)
+  {
+    spdlog::error(exception.what());
+    storedFilename = "rejected." + std::to_string(sessionId);
+  }
+  std::filesystem::rename(partialPath(), directory / storedFilename);
+  std::filesystem::remove(progressPath());
+  spdlog::info("Resumable session {} complete: {}", sessionId, storedFilename);
+}
+
+void ResumableSession::saveProgress()
+{
+  if (progressSaved)
+  {
+    return;
+  }
+  file.flush();
+
+  const auto frameCount = static_cast<std::uint32_t>(received.size());
+  std::vector<char> bitmap((frameCount + 7) / 8);
+  for (std::uint32_t frame = 0; frame < frameCount; ++frame)
+  {
+    if (received[frame])
+    {
+      bitmap[frame / 8] = static_cast<char>(bitmap[frame / 8] | (1 << (frame % 8)));
+    }
+  }
+  const ProgressHeader header{sessionFrameSize, eofFrame, frameCount};
+
+  auto temporaryPath = progressPath();
+  temporaryPath += ".tmp";
+  {
+    std::ofstream progress(temporaryPath, std::ios::binary | std::ios::trunc);
+    progress.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+    progress.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    progress.write(bitmap.data(), static_cast<std::streamsize>(bitmap.size()));
+  }
+  std::filesystem::rename(temporaryPath, progressPath());
+  progressSaved = true;
+}
+
+std::string ResumableSession::missingFrames() const
+{
+  const auto lastFrame = eofFrame != 0 ? eofFrame - 1 : static_cast<std::uint32_t>(received.size());
+  std::string missing;
+  const auto addRange = [&missing](std::uint32_t first, std::uint32_t last) {
+    missing += (missing.empty() ? "" : ",") + std::to_string(first);
+    if (last != first)
+    {
+      missing += "-" + std::to_string(last);
+    }
+  };
+
+  std::uint32_t rangeStart = 0;
+  for (std::uint32_t frame = 1; frame <= lastFrame; ++frame)
+  {
+    const auto have = frame <= received.size() && received[frame - 1];
+    if (!have && rangeStart == 0)
+    {
+      rangeStart = frame;
+    }
+    if (have && rangeStart != 0)
+    {
+      addRange(rangeStart, frame - 1);
+      rangeStart = 0;
+    }
+  }
+  if (rangeStart != 0)
+  {
+    addRange(rangeStart, lastFrame);
+  }
+  if (eofFrame == 0)
+  {
+    missing += (missing.empty() ? "" : ",") + std::to_string(lastFrame + 1) + "-";
+  }
+  return missing;
+}
+
+std::uint32_t ResumableSession::frameSize() const
+{
+  return sessionFrameSize;
+}
+
+std::uint32_t ResumableSession::lastFrame() const
+{
+  return announcedEofFrame;
+}
+
+std::filesystem::path ResumableSession::partialPath() const
+{
+  return directory / (".partial." + std::to_string(sessionId));
+}
+
+std::filesystem::path ResumableSession::progressPath() const
+{
+  return directory / (".partial." + std::to_string(sessionId) + ".frames");
+}
+
+ResumableSessions::ResumableSessions(
+  std::function<std::time_t()> getTime,
+  std::uint32_t timeoutPeriod,
+  std::filesystem::path directory,
+  std::uint64_t maxSessionSize):
+    getTime(std::move(getTime)),
+    timeoutPeriod(timeoutPeriod),
+    directory(std::move(directory)),
+    maxSessionSize(maxSessionSize)
+{
+}
+
+ResumableSessions::~ResumableSessions()
+{
+  for (auto& [sessionId, session] : sessions)
+  {
+    try
+    {
+      session.saveProgress();
+      spdlog::info("Resumable session {} incomplete, missing frames {}", sessionId, session.missingFrames());
+    }
+    catch (const std::exception& exception)
+    {
+      spdlog::error("Resumable session {}: unable to save progress: {}", sessionId, exception.what());
+    }
+  }
+}
+
+void ResumableSessions::write(Packet&& packet)
+{
+  const auto now = getTime();
+  if (now != lastSaved)
+  {
+    saveProgress(now);
+  }
+
+  const auto sessionId = packet.headerParams.sessionId;
+  const auto frameSize = packet.headerParams.resumeFrameSize;
+  const auto lastFrame = packet.headerParams.resumeEofFrame;
+  const auto completed = completedSessions.find(sessionId);
+  if (completed != completedSessions.end())
+  {
+    completed->second = now;
+    return;
+  }
+
+  auto session = sessions.find(sessionId);
+  if (session == sessions.end())
+  {
+    if (frameSize == 0)
+    {
+      throw std::runtime_error("Resumable frame without a frame size");
+    }
+    if (lastFrame == 0)
+    {
+      throw std::runtime_error("Resumable frame without an EOF frame");
+    }
+    if (std::uint64_t{lastFrame - 1} * frameSize > maxSessionSize)
+    {
+      throw std::runtime_error(
+        "Resumable session " + std::to_string(sessionId) + " is larger than the " + std::to_string(maxSessionSize) +
+        " bytes allowed");
+    }
+    session = sessions.emplace(
+      std::piecewise_construct, std::forward_as_tuple(sessionId),
+      std::forward_as_tuple(sessionId, frameSize, lastFrame, directory)).first;
+  }
+  else if (session->second.frameSize() != frameSize)
+  {
+    throw std::runtime_error("Resumable session " + std::to_string(sessionId) + " changed frame size");
+  }
+  else if (session->second.lastFrame() != lastFrame)
+  {
+    throw std::runtime_error("Resumable session " + std::to_string(sessionId) + " changed EOF frame");
+  }
+
+  session->second.timeLastUpdated = now;
+  if (session->second.write(packet))
+  {
+    sessions.erase(session);
+    completedSessions[sessionId] = now;
+  }
+}
+
+void ResumableSessions::saveProgress(std::time_t now)
+{
+  lastSaved = now;
+  for (auto session = sessions.begin(); session != sessions.end();)
+  {
+    session->second.saveProgress();
+    if (session->second.timeLastUpdated + timeoutPeriod < now)
+    {
+      spdlog::info("Resumable session {} timed out, missing frames {}", session->first, session->second.missingFrames());
+      session = sessions.erase(session);
+    }
+    else
+    {
+      ++session;
+    }
+  }
+  for (auto completed = completedSessions.begin(); completed != completedSessions.end();)
+  {
+    completed = completed->second + timeoutPeriod < now ? completedSessions.erase(completed) : std::next(completed);
+  }
+}
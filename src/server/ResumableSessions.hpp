@@ -0,0 +1,99 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef RESUMABLESESSIONS_HPP
+#define RESUMABLESESSIONS_HPP
+
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include "Packet.hpp"
+#include "SISLFilename.hpp"
+
+// A session sent with the client's --resumable option. Each frame is written straight to its place in
+// .partial.<sessionId>, so no reordering is needed, and the frames received so far are saved alongside in
+// .partial.<sessionId>.frames. A later send of the same file picks up from there.
+class ResumableSession
+{
+public:
+  // Carries on from the saved progress of sessionId in directory if there is any for the same frame size and EOF
+  // frame. Frames past lastFrame, the EOF frame the client announces, are dropped.
+  ResumableSession(
+    std::uint32_t sessionId, std::uint32_t frameSize, std::uint32_t lastFrame, std::filesystem::path directory);
+
+  // Returns true once every frame up to the EOF frame is in, when the file has been given the name sent in the
+  // EOF frame.
+  bool write(const Packet& packet);
+
+  // Flushes the file, then saves which frames are in it, so the saved progress never claims a frame that is not.
+  void saveProgress();
+
+  // The frames still to be sent, in the client's --frames format. Open ended if the EOF frame has not arrived.
+  [[nodiscard]] std::string missingFrames() const;
+
+  [[nodiscard]] std::uint32_t frameSize() const;
+  [[nodiscard]] std::uint32_t lastFrame() const;
+
+  std::time_t timeLastUpdated = 0;
+
+private:
+  bool loadProgress();
+  void finish();
+  [[nodiscard]] std::filesystem::path partialPath() const;
+  [[nodiscard]] std::filesystem::path progressPath() const;
+
+  const std::uint32_t sessionId;
+  const std::uint32_t sessionFrameSize;
+  const std::uint32_t announcedEofFrame;
+  const std::filesystem::path directory;
+  const SISLFilename sislFilename;
+  std::fstream file;
+  std::uint64_t writeOffset = 0;
+  std::vector<bool> received;
+  std::uint32_t framesReceived = 0;
+  std::uint32_t eofFrame = 0;
+  std::string storedFilename;
+  bool progressSaved = true;
+};
+
+// The largest file a resumable session may announce, so one bad first frame cannot size the file and its record of
+// frames received from a 32 bit EOF frame and frame size.
+constexpr std::uint64_t defaultMaxResumableSessionSize = std::uint64_t{1} << 40;
+
+// The resumable sessions in progress. Progress is saved at most once a second while frames arrive, when a session
+// times out and when the server stops; a timed out session is closed but kept, unlike an ordinary session. A
+// completed session is remembered until its frames stop arriving for the timeout, so the further passes of a
+// --passes send are dropped rather than starting the file again.
+class ResumableSessions
+{
+public:
+  ResumableSessions(
+    std::function<std::time_t()> getTime,
+    std::uint32_t timeoutPeriod,
+    std::filesystem::path directory = ".",
+    std::uint64_t maxSessionSize = defaultMaxResumableSessionSize);
+  ~ResumableSessions();
+
+  ResumableSessions(const ResumableSessions&) = delete;
+  ResumableSessions& operator=(const ResumableSessions&) = delete;
+
+  void write(Packet&& packet);
+
+private:
+  void saveProgress(std::time_t now);
+
+  std::function<std::time_t()> getTime;
+  const std::uint32_t timeoutPeriod;
+  const std::filesystem::path directory;
+  const std::uint64_t maxSessionSize;
+  std::map<std::uint32_t, ResumableSession> sessions;
+  std::map<std::uint32_t, std::time_t> completedSessions;
+  std::time_t lastSaved = 0;
+};
+
+#endif //RESUMABLESESSIONS_HPP
@@ -0,0 +1,217 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <test/EnterpriseDiodeTestHelpers.hpp>
+#include "test/catch.hpp"
+#include "diodeheader/EnterpriseDiodeHeader.hpp"
+#include "ResumableSessions.hpp"
+
+namespace
+{
+  constexpr std::uint32_t sessionId = 0x1234;
+  constexpr std::uint32_t frameSize = 2;
+
+  Packet resumablePacket(std::uint32_t frameCount, const std::string& payload, std::uint32_t eofFrame, bool eof = false)
+  {
+    BytesBuffer header(EnterpriseDiode::HeaderSizeInBytes);
+    header[EnterpriseDiode::EOFFlagIndex] = eof;
+    header[EnterpriseDiode::ResumableFlagIndex] = 1;
+    std::memcpy(&header[EnterpriseDiode::SessionIDIndex], &sessionId, sizeof(sessionId));
+    std::memcpy(&header[EnterpriseDiode::FrameCountIndex], &frameCount, sizeof(frameCount));
+    std::memcpy(&header[EnterpriseDiode::ResumeFrameSizeIndex], &frameSize, sizeof(frameSize));
+    std::memcpy(&header[EnterpriseDiode::ResumeEOFFrameIndex], &eofFrame, sizeof(eofFrame));
+    return parsePacket(std::move(header), {payload.begin(), payload.end()});
+  }
+
+  Packet eofPacket(std::uint32_t frameCount)
+  {
+    return resumablePacket(frameCount, "{name: !str \"resumed.bin\"}", frameCount, true);
+  }
+
+  std::string readFile(const std::filesystem::path& path)
+  {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+  }
+
+  class TemporaryDirectory
+  {
+  public:
+    TemporaryDirectory():
+      path(std::filesystem::temp_directory_path() / ("edresume." + std::to_string(std::random_device()())))
+    {
+      std::filesystem::create_directories(path);
+    }
+
+    ~TemporaryDirectory()
+    {
+      std::filesystem::remove_all(path);
+    }
+
+    const std::filesystem::path path;
+  };
+}
+
+TEST_CASE("ResumableSessions.")
+{
+  TemporaryDirectory directory;
+  std::time_t now = 10000;
+  const auto getTime = [&now]() { return now; };
+  const auto partialPath = directory.path / ".partial.4660";
+  const auto progressPath = directory.path / ".partial.4660.frames";
+
+  SECTION("Frames are written to their place in the file in any order, and the file is named once all are in")
+  {
+    ResumableSessions sessions(getTime, 5, directory.path);
+    sessions.write(resumablePacket(3, "CC", 5));
+    sessions.write(resumablePacket(1, "AA", 5));
+    sessions.write(eofPacket(5));
+    sessions.write(resumablePacket(4, "D", 5));
+    REQUIRE_FALSE(std::filesystem::exists(directory.path / "resumed.bin"));
+
+    sessions.write(resumablePacket(2, "BB", 5));
+    REQUIRE(readFile(directory.path / "resumed.bin") == "AABBCCD");
+    REQUIRE_FALSE(std::filesystem::exists(partialPath));
+    REQUIRE_FALSE(std::filesystem::exists(progressPath));
+  }
+
+  SECTION("Further passes of a completed session are dropped until its frames stop for the timeout")
+  {
+    ResumableSessions sessions(getTime, 5, directory.path);
+    sessions.write(resumablePacket(1, "AA", 3));
+    sessions.write(resumablePacket(2, "B", 3));
+    sessions.write(eofPacket(3));
+    REQUIRE(readFile(directory.path / "resumed.bin") == "AAB");
+
+    now += 4;
+    sessions.write(resumablePacket(1, "AA", 3));
+    now += 4;
+    sessions.write(resumablePacket(2, "B", 3));
+    REQUIRE_FALSE(std::filesystem::exists(partialPath));
+    REQUIRE_FALSE(std::filesystem::exists(progressPath));
+
+    now += 10;
+    sessions.write(resumablePacket(1, "XX", 3));
+    REQUIRE(std::filesystem::exists(partialPath));
+  }
+
+  SECTION("Repeated frames are only written once")
+  {
+    ResumableSessions sessions(getTime, 5, directory.path);
+    sessions.write(resumablePacket(1, "AA", 3));
+    sessions.write(resumablePacket(1, "AA", 3));
+    sessions.write(resumablePacket(2, "B", 3));
+    sessions.write(eofPacket(3));
+    REQUIRE(readFile(directory.path / "resumed.bin") == "AAB");
+  }
+
+  SECTION("An interrupted session is saved and carries on when the server starts again")
+  {
+    {
+      ResumableSessions sessions(getTime, 5, directory.path);
+      sessions.write(resumablePacket(1, "AA", 6));
+      sessions.write(resumablePacket(4, "DD", 6));
+    }
+    REQUIRE(std::filesystem::exists(partialPath));
+    REQUIRE(std::filesystem::exists(progressPath));
+
+    ResumableSession saved(sessionId, frameSize, 6, directory.path);
+    REQUIRE(saved.missingFrames() == "2-3,5-");
+
+    ResumableSessions sessions(getTime, 5, directory.path);
+    sessions.write(resumablePacket(2, "BB", 6));
+    sessions.write(resumablePacket(3, "CC", 6));
+    sessions.write(resumablePacket(5, "E", 6));
+    sessions.write(eofPacket(6));
+    REQUIRE(readFile(directory.path / "resumed.bin") == "AABBCCDDE");
+  }
+
+  SECTION("Saved progress for a different frame size is discarded")
+  {
+    {
+      ResumableSessions sessions(getTime, 5, directory.path);
+      sessions.write(resumablePacket(1, "AA", 6));
+    }
+    ResumableSession session(sessionId, frameSize * 2, 6, directory.path);
+    REQUIRE(session.missingFrames() == "1-");
+    REQUIRE(std::filesystem::file_size(partialPath) == 0);
+  }
+
+  SECTION("Timed out sessions are saved and kept rather than deleted")
+  {
+    ResumableSessions sessions(getTime, 5, directory.path);
+    sessions.write(resumablePacket(2, "BB", 4));
+    sessions.write(eofPacket(4));
+    now += 10;
+    sessions.write(resumablePacket(1, "AA", 4));
+    REQUIRE(std::filesystem::exists(progressPath));
+
+    ResumableSession saved(sessionId, frameSize, 4, directory.path);
+    REQUIRE(saved.missingFrames() == "1,3");
+  }
+
+  SECTION("Missing frames are listed as ranges, ending at the EOF frame once it has arrived")
+  {
+    ResumableSession session(sessionId, frameSize, 10, directory.path);
+    REQUIRE(session.missingFrames() == "1-");
+    session.write(resumablePacket(2, "BB", 10));
+    session.write(resumablePacket(3, "CC", 10));
+    session.write(resumablePacket(6, "FF", 10));
+    REQUIRE(session.missingFrames() == "1,4-5,7-");
+    session.write(eofPacket(10));
+    REQUIRE(session.missingFrames() == "1,4-5,7-9");
+  }
+
+  SECTION("Frames larger than the session frame size are ignored")
+  {
+    ResumableSession session(sessionId, frameSize, 10, directory.path);
+    session.write(resumablePacket(1, "AAA", 10));
+    REQUIRE(session.missingFrames() == "1-");
+  }
+
+  SECTION("Frames past the EOF frame the client announced are ignored, however large their frame count")
+  {
+    ResumableSessions sessions(getTime, 5, directory.path);
+    sessions.write(resumablePacket(1, "AA", 3));
+    sessions.write(resumablePacket(0xfffffff0, "ZZ", 3));
+    sessions.write(resumablePacket(3, "CC", 3));
+    sessions.write(resumablePacket(7, "{name: !str \"resumed.bin\"}", 3, true));
+    sessions.write(resumablePacket(2, "B", 3));
+    REQUIRE_FALSE(std::filesystem::exists(directory.path / "resumed.bin"));
+    sessions.write(eofPacket(3));
+    REQUIRE(readFile(directory.path / "resumed.bin") == "AAB");
+  }
+
+  SECTION("A resumable frame must carry its EOF frame, and the same one throughout the session")
+  {
+    ResumableSessions sessions(getTime, 5, directory.path);
+    REQUIRE_THROWS_AS(sessions.write(resumablePacket(1, "AA", 0)), std::runtime_error);
+    sessions.write(resumablePacket(1, "AA", 3));
+    REQUIRE_THROWS_AS(sessions.write(resumablePacket(2, "BB", 4)), std::runtime_error);
+  }
+
+  SECTION("A session announcing a file larger than the limit is refused before anything is written")
+  {
+    ResumableSessions sessions(getTime, 5, directory.path, 8);
+    REQUIRE_THROWS_AS(sessions.write(resumablePacket(1, "AA", 6)), std::runtime_error);
+    REQUIRE_FALSE(std::filesystem::exists(partialPath));
+
+    sessions.write(resumablePacket(1, "AA", 5));
+    REQUIRE(std::filesystem::exists(partialPath));
+  }
+
+  SECTION("Saved progress for a different EOF frame is discarded")
+  {
+    {
+      ResumableSessions sessions(getTime, 5, directory.path);
+      sessions.write(resumablePacket(4, "DD", 6));
+    }
+    ResumableSession session(sessionId, frameSize, 3, directory.path);
+    REQUIRE(session.missingFrames() == "1-");
+  }
+}
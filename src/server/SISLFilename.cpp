@@ -1,6 +1,7 @@
 // Copyright PA Knowledge 2021
 
 #include "SISLFilename.hpp"
+#include <FilenameValidator.hpp>
 #include <SislTools/SislTools.hpp>
 #include <iostream>
 #include <rapidjson/document.h>
@@ -29,31 +30,50 @@ std::optional<std::string> SISLFilename::extractFilename(const BytesBuffer& eofF
 
   try
   {
-    const auto filename = convertFromSisl(sislHeader);
+    const auto doc = parseSisl(sislHeader);
+    const auto filename = convertFromSisl(doc);
     if (filename.size() > maxFilenameLength)
     {
       spdlog::error("Filename too long");
       return std::optional<std::string>();
     }
-    return std::regex_match(filename, filter) ? filename : std::optional<std::string>();
+    if (!FilenameValidator::isValid(filename))
+    {
+      return std::optional<std::string>();
+    }
+    if (!doc.HasMember("path"))
+    {
+      return filename;
+    }
+    const auto path = pathFromSisl(doc);
+    if (!path)
+    {
+      spdlog::error("Invalid path in SISL");
+      return std::optional<std::string>();
+    }
+    return *path + "/" + filename;
   }
   catch (UnableToParseSislException& ex)
   {
     spdlog::error(std::string("Unable to parse SISL filename as SISL: ") + ex.what());
     return std::optional<std::string>();
   }
-  catch (std::regex_error& ex)
-  {
-    spdlog::error(std::string("Failed filename sanity checks: ") + ex.what());
-    return std::optional<std::string>();
-  }
 
 }
 
-std::string SISLFilename::convertFromSisl(const std::string& sislFrame)
+std::string SISLFilename::convertFromSisl(const rapidjson::Document& doc)
+{
+  return doc.IsObject() && doc.HasMember("name") && doc["name"].IsString() ? doc["name"].GetString() : "";
+}
+
+std::optional<std::string> SISLFilename::pathFromSisl(const rapidjson::Document& doc)
 {
-  const auto doc = parseSisl(sislFrame);
-  return doc.HasMember("name") ? doc["name"].GetString() : "";
+  if (!doc["path"].IsString())
+  {
+    return std::optional<std::string>();
+  }
+  const auto path = std::string(doc["path"].GetString(), doc["path"].GetStringLength());
+  return FilenameValidator::isValidRelativePath(path) ? path : std::optional<std::string>();
 }
 
 rapidjson::Document SISLFilename::parseSisl(const std::string& sislFrame)
@@ -4,26 +4,35 @@
 #define ENTERPRISEDIODETESTER_SISLFILENAME_H
 
 #include <BytesBuffer.hpp>
+#include <FilenameValidator.hpp>
 #include <optional>
 #include <rapidjson/document.h>
-#include <regex>
 #include <string>
 
+constexpr auto defaultMaxFilenameLength = static_cast<std::uint32_t>(FilenameValidator::maxFilenameLength);
+
+// Longest EOF frame SISL holding a name of up to maxFilenameLength characters and the longest relative path.
+constexpr std::uint32_t maxEofSislLength(std::uint32_t maxFilenameLength)
+{
+  return maxFilenameLength + static_cast<std::uint32_t>(FilenameValidator::maxRelativePathLength) + 32;
+}
+
 class SISLFilename
 {
 public:
   explicit SISLFilename(std::uint32_t maxSislLength, std::uint32_t maxFilenameLength=1000);
 
 public:
+  // The name in an EOF frame, after the folder it was sent from if the frame has a path, as in docs/2021/a.pdf.
   [[nodiscard]] std::optional<std::string> extractFilename(const BytesBuffer& eofFrame) const;
 
 private:
-  static std::string convertFromSisl(const std::string& sislFilename);
+  static std::string convertFromSisl(const rapidjson::Document& doc);
+  static std::optional<std::string> pathFromSisl(const rapidjson::Document& doc);
   static rapidjson::Document parseSisl(const std::string& sislFilename);
 
   const std::uint32_t maxSislLength;
   const std::uint32_t maxFilenameLength;
-  const std::regex filter{"[a-zA-Z0-9\\.\\-_]+"};
 };
 
 #endif // ENTERPRISEDIODETESTER_SISLFILENAME_H
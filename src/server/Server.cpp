@@ -1,7 +1,9 @@
 // Copyright PA Knowledge Ltd 2021
 // MIT License. For licence terms see LICENCE.md file.
 
+#include <chrono>
 #include <iostream>
+#include "FlightRecorder.hpp"
 #include "Server.hpp"
 #include "StreamInterface.hpp"
 
@@ -12,9 +14,13 @@ Server::Server(
   std::function<std::unique_ptr<StreamInterface>(std::uint32_t)> streamCreator,
   std::function<std::time_t()> getTime,
   std::uint32_t timeoutPeriod,
-  DiodeType diodeType) :
+  DiodeType diodeType,
+  std::function<std::unique_ptr<StreamInterface>(std::uint32_t)> liveStreamCreator,
+  std::uint64_t reorderBudgetInBytes,
+  unsigned int rewrapThreads) :
   udpServerInterface(std::move(udpServerInterface)),
-  sessionManager(maxBufferSize, maxQueueLength, std::move(streamCreator), std::move(getTime), timeoutPeriod, diodeType)
+  sessionManager(maxBufferSize, maxQueueLength, std::move(streamCreator), std::move(getTime), timeoutPeriod, diodeType,
+    std::move(liveStreamCreator), reorderBudgetInBytes, rewrapThreads)
 {
   this->udpServerInterface->setCallback(
     [this](std::vector<std::uint8_t>&& header, std::vector<std::uint8_t>&& payload) {
@@ -24,12 +30,29 @@ Server::Server(
 
 void Server::receivePacket(std::vector<std::uint8_t>&& header, std::vector<std::uint8_t>&& payload)
 {
+  const auto receivedNs = FlightRecorder::now();
+  std::uint32_t sessionId = 0;
+  std::uint32_t frameCount = 0;
   try
   {
-    sessionManager.writeToStream(parsePacket(std::move(header), std::move(payload)));
+    auto packet = parsePacket(std::move(header), std::move(payload));
+    sessionId = packet.headerParams.sessionId;
+    frameCount = packet.headerParams.frameCount;
+    flightRecorder().record(FlightStage::received, sessionId, frameCount, FlightReason::none, receivedNs);
+    flightRecorder().record(FlightStage::parsed, sessionId, frameCount);
+    if (packet.headerParams.sendTimestamp != 0)
+    {
+      packet.receiveTimestamp = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        udpServerInterface->receiveTime().time_since_epoch()).count());
+    }
+    sessionManager.writeToStream(std::move(packet));
   }
   catch (const std::runtime_error& exception)
   {
     std::cerr << std::string("Caught exception: ") + exception.what() << std::endl;
+    // A packet that could not be parsed has no session to go with.
+    const auto reason = sessionId == 0 ? FlightReason::invalidPacket : FlightReason::rejected;
+    flightRecorder().record(FlightStage::dropped, sessionId, frameCount, reason);
+    flightRecorder().dumpAfterFailure(exception.what());
   }
 }
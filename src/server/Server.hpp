@@ -22,7 +22,10 @@ public:
     std::function<std::unique_ptr<StreamInterface>(std::uint32_t)> streamCreator,
     std::function<std::time_t()> getTime,
     std::uint32_t timeoutPeriod,
-   DiodeType diodeType);
+   DiodeType diodeType,
+    std::function<std::unique_ptr<StreamInterface>(std::uint32_t)> liveStreamCreator = {},
+    std::uint64_t reorderBudgetInBytes = 0,
+    unsigned int rewrapThreads = 0);
 
   void receivePacket(std::vector<std::uint8_t>&& header, std::vector<std::uint8_t>&& payload);
 
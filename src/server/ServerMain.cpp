@@ -3,43 +3,112 @@
 
 #include <chrono>
 #include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <boost/asio/signal_set.hpp>
 
 #include "clara/clara.hpp"
 #include "spdlog/spdlog.h"
 
 #include "Server.hpp"
 #include "UdpServer.hpp"
+#include "UdpServerGroup.hpp"
+#ifdef ED_AF_XDP
+#include "XdpServer.hpp"
+#endif
+#include "AppendStream.hpp"
 #include "FileStream.hpp"
 #include "DropStream.hpp"
+#include "FlightRecorder.hpp"
+#include "PacketRecorder.hpp"
+#include "PacketReplayer.hpp"
+#include "SharedMemoryStream.hpp"
+#include "ThreadTuning.hpp"
 
 struct Params
 {
-  std::uint16_t serverPort;
+  std::vector<std::uint16_t> serverPorts;
   std::uint16_t mtuSize;
   std::uint16_t maxQueueLength;
   bool dropPackets;
   DiodeType diodeType;
+  std::string xdpInterface;
+  std::uint32_t xdpQueue;
+  std::string networkCpus;
+  int numaNode;
+  int realtimePriority;
+  int busyPollMicroseconds;
+  std::string recordFilename;
+  std::string replayFilename;
+  ReplaySpeed replaySpeed;
+  std::string streamOutput;
+  std::string publishSocket;
+  std::uint32_t reorderMemoryMB;
+  unsigned int rewrapThreads;
+  std::string flightRecordFolder;
 };
 
 inline Params parseArgs(int argc, char **argv)
 {
   bool showHelp = false;
-  std::uint16_t serverPort = 45000;
+  std::string serverPorts = "45000";
   std::uint16_t mtuSize = 1500;
   std::uint16_t maxQueueLength = 1024;
   bool dropPackets = false;
   bool importDiode = false;
   std::string logLevel = "info";
+  std::string xdpInterface;
+  std::uint32_t xdpQueue = 0;
+  std::string networkCpus;
+  int numaNode = -1;
+  int realtimePriority = 0;
+  int busyPollMicroseconds = 0;
+  std::string recordFilename;
+  std::string replayFilename;
+  bool replayAsFastAsPossible = false;
+  std::string streamOutput;
+  std::string publishSocket;
+  std::uint32_t reorderMemoryMB = 0;
+  unsigned int rewrapThreads = 0;
+  std::string flightRecordFolder;
   const auto cli = clara::Help(showHelp) |
-                   clara::Opt(serverPort, "server port")["-s"]["--serverPort"]("port to listen for packets on - default 45000") |
+                   clara::Opt(serverPorts, "server ports")["-s"]["--serverPort"](
+                     "port to listen for packets on, or a list such as 45000-45003 for the links of a striped send - default 45000") |
                    clara::Opt(mtuSize, "MTU size")["-m"]["--mtu"]("MTU size of the network interface - default 1500") |
                    clara::Opt(maxQueueLength, "Queue Length")["-q"]["--queueLength"](
                      "Max length of queue for reordering packets - default 1024 packets") |
+                   clara::Opt(reorderMemoryMB, "MB")["--reorderMemory"](
+                     "Size each session's reordering queue from the reordering it sees, within this much memory for all sessions, instead of -q") |
                    clara::Opt(dropPackets)["-d"]["--dropPackets"](
                      "Diagnostic tool: Server will not write packets to disk if this flag set (will only count missing frames), else will write them to a file as normal") |
                    clara::Opt(importDiode)["-i"]["--importDiode"](
                      "Set flag if using an import diode so that the server rewraps data before writing to file.") |
-                   clara::Opt(logLevel, "Log level")["-l"]["--logLevel"]("Logging level for program output - default info");
+                   clara::Opt(rewrapThreads, "threads")["--rewrapThreads"](
+                     "With -i, rewrap large files on this many more threads as well as the receiving one - default 0") |
+                   clara::Opt(logLevel, "Log level")["-l"]["--logLevel"]("Logging level for program output - default info") |
+                   clara::Opt(xdpInterface, "interface")["-x"]["--xdp"](
+                     "Receive with AF_XDP on this network interface instead of a UDP socket") |
+                   clara::Opt(xdpQueue, "queue")["--xdpQueue"]("Interface receive queue for AF_XDP - default 0") |
+                   clara::Opt(networkCpus, "cpu list")["--networkCpus"](
+                     "Cores to run the receiving and writing thread on, e.g. 2-3 - default any") |
+                   clara::Opt(numaNode, "NUMA node")["--numaNode"](
+                     "Run on the cores of this NUMA node, normally the one the network card is attached to, unless given cores") |
+                   clara::Opt(realtimePriority, "priority")["--realtime"](
+                     "Run with SCHED_FIFO at this priority (1-99) - default off") |
+                   clara::Opt(busyPollMicroseconds, "microseconds")["--busyPoll"](
+                     "Busy poll the UDP socket for this long before sleeping - default off. Needs net.core.busy_poll set too") |
+                   clara::Opt(recordFilename, "pcap file")["--record"](
+                     "Write every datagram received to this packet capture, for replaying later") |
+                   clara::Opt(replayFilename, "pcap file")["--replay"](
+                     "Receive the datagrams of this packet capture instead of listening on the network, then exit") |
+                   clara::Opt(replayAsFastAsPossible)["--replayFast"](
+                     "Replay as fast as possible rather than with the original timing") |
+                   clara::Opt(streamOutput, "file or pipe")["--stream"](
+                     "Append streamed sessions to this file or named pipe as they arrive, rather than when they end") |
+                   clara::Opt(publishSocket, "socket")["--publish"](
+                     "Keep received files in shared memory and pass them to the consumer listening on this Unix socket, saving them only if it does not take them") |
+                   clara::Opt(flightRecordFolder, "folder")["--flightRecords"](
+                     "Write the flight record of recent frames here when a session fails, and on SIGUSR1 - default only on SIGUSR1, to the temporary folder");
 
   const auto result = cli.parse(clara::Args(argc, argv));
   if (!result)
@@ -62,8 +131,22 @@ inline Params parseArgs(int argc, char **argv)
     diodeType = DiodeType::import;
   }
 
+  std::vector<std::uint16_t> ports;
+  try
+  {
+    ports = parsePortList(serverPorts);
+  }
+  catch (const std::runtime_error& exception)
+  {
+    spdlog::error(exception.what());
+    exit(1);
+  }
+
   spdlog::set_level(spdlog::level::from_str(logLevel));
-  return {serverPort, mtuSize, maxQueueLength, dropPackets, diodeType};
+  return {ports, mtuSize, maxQueueLength, dropPackets, diodeType, xdpInterface, xdpQueue,
+    networkCpus, numaNode, realtimePriority, busyPollMicroseconds, recordFilename, replayFilename,
+    replayAsFastAsPossible ? ReplaySpeed::asFastAsPossible : ReplaySpeed::original, streamOutput, publishSocket,
+    reorderMemoryMB, rewrapThreads, flightRecordFolder};
 }
 
 namespace ServerApplication
@@ -78,36 +161,167 @@ namespace ServerApplication
   }
 }
 
-inline std::function<std::unique_ptr<StreamInterface>(uint32_t)> selectWriteStreamFunction(bool dropPackets)
+// Re-arms itself, so every SIGUSR1 writes the flight record, without stopping the server.
+inline void dumpFlightRecordOnSignal(boost::asio::signal_set& signals, const std::filesystem::path& folder)
+{
+  signals.async_wait([&signals, folder](const boost::system::error_code& error, int) {
+    if (error)
+    {
+      return;
+    }
+    try
+    {
+      flightRecorder().dump(folder, "SIGUSR1");
+    }
+    catch (const std::runtime_error& exception)
+    {
+      spdlog::warn(exception.what());
+    }
+    dumpFlightRecordOnSignal(signals, folder);
+  });
+}
+
+// The kernel UDP socket is the fallback if AF_XDP is not built in or cannot be set up on the interface.
+// Several ports get a socket each, feeding the one server.
+inline std::unique_ptr<UdpServerInterface> createUdpServer(const Params& params, std::uint32_t maxBufferSize)
+{
+  if (!params.xdpInterface.empty() && params.serverPorts.size() > 1)
+  {
+    spdlog::warn("AF_XDP listens on a single port, falling back to UDP sockets");
+  }
+  else if (!params.xdpInterface.empty())
+  {
+#ifdef ED_AF_XDP
+    if (params.busyPollMicroseconds > 0)
+    {
+      spdlog::warn("Busy polling only applies to the UDP socket, not AF_XDP");
+    }
+    try
+    {
+      return std::make_unique<XdpServer>(
+        params.xdpInterface, params.xdpQueue, params.serverPorts.front(), ServerApplication::io_context, maxBufferSize);
+    }
+    catch (const std::runtime_error& exception)
+    {
+      spdlog::warn(std::string(exception.what()) + ", falling back to a UDP socket");
+    }
+#else
+    spdlog::warn("Built without AF_XDP support, falling back to a UDP socket");
+#endif
+  }
+  std::vector<std::unique_ptr<UdpServerInterface>> receivers;
+  for (const auto port : params.serverPorts)
+  {
+    receivers.push_back(std::make_unique<UdpServer>(
+      port,
+      ServerApplication::io_context,
+      maxBufferSize,
+      EnterpriseDiode::UDPSocketSizeInBytes,
+      params.busyPollMicroseconds));
+  }
+  if (receivers.size() == 1)
+  {
+    return std::move(receivers.front());
+  }
+  return std::make_unique<UdpServerGroup>(std::move(receivers));
+}
+
+inline std::unique_ptr<std::istream> openPacketCapture(const std::string& filename)
+{
+  auto input = std::make_unique<std::ifstream>(filename, std::ios::binary);
+  if (!*input)
+  {
+    throw std::runtime_error("Unable to open packet capture " + filename);
+  }
+  return input;
+}
+
+inline std::function<std::unique_ptr<StreamInterface>(uint32_t)> selectWriteStreamFunction(const Params& params)
 {
-  if (dropPackets)
+  if (params.dropPackets)
   {
     return [](uint32_t sessionId) { return std::make_unique<DropStream>(sessionId); };
   }
+  if (!params.publishSocket.empty())
+  {
+    return [publisher = std::make_shared<FilePublisher>(params.publishSocket)](uint32_t sessionId) {
+      return std::make_unique<SharedMemoryStream>(publisher, sessionId);
+    };
+  }
   return [](uint32_t sessionId) { return std::make_unique<FileStream>(sessionId); };
 }
 
+inline std::function<std::unique_ptr<StreamInterface>(uint32_t)> selectLiveStreamFunction(const Params& params)
+{
+  if (params.streamOutput.empty() || params.dropPackets)
+  {
+    return {};
+  }
+  return [path = params.streamOutput](uint32_t sessionId) { return std::make_unique<AppendStream>(path, sessionId); };
+}
 
 int main(int argc, char **argv)
 {
   const auto params = parseArgs(argc, argv);
   spdlog::info("Starting Enterprise Diode Server application.");
   signal(SIGINT, ServerApplication::signalHandler);
+  // A stream's named pipe losing its reader fails the write rather than ending the server.
+  signal(SIGPIPE, SIG_IGN);
+  // Failures only write flight records when asked to, so that they cannot fill a folder nobody is watching.
+  flightRecorder().setDumpFolder(params.flightRecordFolder);
+  const auto signalDumpFolder =
+    params.flightRecordFolder.empty() ? std::filesystem::temp_directory_path().string() : params.flightRecordFolder;
+  boost::asio::signal_set flightRecordSignals(ServerApplication::io_context, SIGUSR1);
+  dumpFlightRecordOnSignal(flightRecordSignals, signalDumpFolder);
 
   const auto maxBufferSize = EnterpriseDiode::calculateMaxBufferSize(params.mtuSize);
+  if (params.reorderMemoryMB == 0)
+  {
+    spdlog::info("Datagrams up to {} bytes, reordering up to {} per session in at most {} MB", maxBufferSize,
+      params.maxQueueLength, reorderQueueSizeInBytes(maxBufferSize, params.maxQueueLength) / (1024 * 1024));
+  }
+  else
+  {
+    spdlog::info("Datagrams up to {} bytes, reordering as far as each session needs in at most {} MB between them",
+      maxBufferSize, params.reorderMemoryMB);
+  }
 
   try
   {
+    const auto numaNode = params.numaNode < 0 ? std::nullopt : std::optional(static_cast<unsigned int>(params.numaNode));
+    ThreadTuning::applyToCurrentThread(
+      ThreadTuning::threadSettings(params.networkCpus, numaNode, params.realtimePriority));
+
+    std::unique_ptr<UdpServerInterface> udpServer;
+    std::function<std::time_t()> getTime = []() { return std::time(nullptr); };
+    if (!params.replayFilename.empty())
+    {
+      auto replayer = std::make_unique<PacketReplayer>(
+        openPacketCapture(params.replayFilename), ServerApplication::io_context, params.replaySpeed);
+      getTime = [replayer = replayer.get()]() { return replayer->recordedTime(); };
+      // Otherwise the SIGUSR1 handler would keep io_context.run() from returning once the capture is replayed.
+      replayer->whenFinished([&flightRecordSignals]() { flightRecordSignals.cancel(); });
+      udpServer = std::move(replayer);
+    }
+    else
+    {
+      udpServer = createUdpServer(params, maxBufferSize);
+    }
+    if (!params.recordFilename.empty())
+    {
+      udpServer = std::make_unique<PacketRecorder>(
+        std::move(udpServer), std::make_unique<std::ofstream>(params.recordFilename, std::ios::binary));
+    }
+
     Server edServer(
-      std::make_unique<UdpServer>(
-        params.serverPort,
-        ServerApplication::io_context,
-        maxBufferSize,
-        EnterpriseDiode::UDPSocketSizeInBytes),
+      std::move(udpServer),
       maxBufferSize,
       params.maxQueueLength,
-      selectWriteStreamFunction(params.dropPackets),
-      []() { return std::time(nullptr); }, 15, params.diodeType);
+      selectWriteStreamFunction(params),
+      getTime, 15, params.diodeType,
+      selectLiveStreamFunction(params),
+      std::uint64_t{params.reorderMemoryMB} * 1024 * 1024,
+      params.rewrapThreads);
 
     ServerApplication::io_context.run();
   }
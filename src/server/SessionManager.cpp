@@ -1,11 +1,17 @@
 // Copyright PA Knowledge Ltd 2021
 // MIT License. For licence terms see LICENCE.md file.
 
+#include <algorithm>
 #include <filesystem>
 #include <iostream>
+#include <iterator>
+#include <vector>
 #include "diodeheader/EnterpriseDiodeHeader.hpp"
 #include "FileStream.hpp"
+#include "FlightRecorder.hpp"
 #include "SessionManager.hpp"
+#include "UnpackStream.hpp"
+#include "spdlog/spdlog.h"
 
 SessionManager::SessionManager(
   std::uint32_t maxBufferSize,
@@ -13,44 +19,135 @@ SessionManager::SessionManager(
   std::function<std::unique_ptr<StreamInterface>(std::uint32_t)> streamCreator,
   std::function<time_t()> getTime,
   std::uint32_t timeoutPeriod,
-  DiodeType diodeType) :
+  DiodeType diodeType,
+  std::function<std::unique_ptr<StreamInterface>(std::uint32_t)> liveStreamCreator,
+  std::uint64_t reorderBudgetInBytes,
+  unsigned int rewrapThreads) :
     maxBufferSize(maxBufferSize),
     maxQueueLength(maxQueueLength),
+    reorderBudget(reorderBudgetInBytes == 0 ? nullptr : std::make_shared<ReorderBudget>(reorderBudgetInBytes)),
+    parallelRewrapper(
+      rewrapThreads == 0 || diodeType != DiodeType::import ?
+        nullptr : std::make_shared<ParallelRewrapper>(rewrapThreads)),
     streamCreator(std::move(streamCreator)),
+    liveStreamCreator(std::move(liveStreamCreator)),
     getTime(std::move(getTime)),
     timeoutPeriod(timeoutPeriod),
-    diodeType(diodeType)
+    diodeType(diodeType),
+    resumableSessions(this->getTime, timeoutPeriod)
 {
 }
 
 void SessionManager::writeToStream(Packet&& packet)
 {
-  createSessionIfNewId(packet.headerParams.sessionId);
+  if (packet.headerParams.resumable)
+  {
+    if (diodeType == DiodeType::import)
+    {
+      throw std::runtime_error("Resumable sessions are not supported through the import diode");
+    }
+    resumableSessions.write(std::move(packet));
+    return;
+  }
+
+  if (packet.headerParams.packed && diodeType == DiodeType::import)
+  {
+    throw std::runtime_error("Packed sessions are not supported through the import diode");
+  }
+  if (packet.headerParams.streaming && diodeType == DiodeType::import)
+  {
+    throw std::runtime_error("Streamed sessions are not supported through the import diode");
+  }
+  closeIdleStreamedSessions();
+  if (packet.headerParams.keepalive)
+  {
+    const auto stream = streams.find(packet.headerParams.sessionId);
+    if (stream != streams.end())
+    {
+      stream->second.timeLastUpdated = getTime();
+    }
+    return;
+  }
+  createSessionIfNewId(packet.headerParams);
 
-  if (isStreamExpired(packet.headerParams.sessionId))
+  // Streamed sessions are timed out by closeIdleStreamedSessions instead.
+  if (!packet.headerParams.streaming && isStreamExpired(packet.headerParams.sessionId))
   {
     std::cerr << "Stream has timed-out. Closing stream" << "\n";
+    flightRecorder().record(FlightStage::sessionFailed, packet.headerParams.sessionId,
+      packet.headerParams.frameCount, FlightReason::timedOut);
+    flightRecorder().dumpAfterFailure("session " + std::to_string(packet.headerParams.sessionId) + " timed out");
     streams.at(packet.headerParams.sessionId).deleteFile();
     closeSession(packet.headerParams.sessionId);
     return;
   }
 
+  recordLatency(packet);
   writeFileAndSaveIfComplete(std::move(packet));
 }
 
-void SessionManager::createSessionIfNewId(const std::uint32_t sessionId)
+// Checked at most once a second, whichever session the frame is for, as a stream that has stopped sends nothing
+// more of its own to be timed out by.
+void SessionManager::closeIdleStreamedSessions()
 {
-  if (streams.find(sessionId) == streams.end())
+  const auto now = getTime();
+  if (now == lastIdleCheck)
   {
-    createNewSession(sessionId);
+    return;
   }
+  lastIdleCheck = now;
+
+  const auto streamTimeoutPeriod = std::time_t{timeoutPeriod} * streamTimeoutMultiple;
+  std::vector<std::uint32_t> idleSessions;
+  std::copy_if(streamedSessions.begin(), streamedSessions.end(), std::back_inserter(idleSessions),
+    [&](std::uint32_t sessionId) { return streams.at(sessionId).timeLastUpdated + streamTimeoutPeriod < now; });
+  for (const auto sessionId : idleSessions)
+  {
+    spdlog::warn("Stream session {} has had no frames for {} seconds, closing it", sessionId, streamTimeoutPeriod);
+    closeFailedSession(sessionId, FlightReason::timedOut, "stream session " + std::to_string(sessionId) + " timed out");
+  }
+}
+
+void SessionManager::closeFailedSession(std::uint32_t sessionId, FlightReason reason, const std::string& cause)
+{
+  flightRecorder().record(FlightStage::sessionFailed, sessionId, 0, reason);
+  flightRecorder().dumpAfterFailure(cause);
+  streams.at(sessionId).deleteFile();
+  closeSession(sessionId);
 }
 
-void SessionManager::createNewSession(std::uint32_t sessionId)
+void SessionManager::createSessionIfNewId(const HeaderParams& headerParams)
 {
+  if (streams.find(headerParams.sessionId) == streams.end())
+  {
+    createNewSession(headerParams);
+  }
+}
+
+void SessionManager::createNewSession(const HeaderParams& headerParams)
+{
+  const auto sessionId = headerParams.sessionId;
+  std::unique_ptr<StreamInterface> stream;
+  if (headerParams.packed)
+  {
+    stream = std::make_unique<UnpackStream>(streamCreator, sessionId);
+  }
+  else if (headerParams.streaming && liveStreamCreator)
+  {
+    stream = liveStreamCreator(sessionId);
+  }
+  else
+  {
+    stream = streamCreator(sessionId);
+  }
   streams.emplace(std::make_pair(
     sessionId,
-    OrderingStreamWriter(maxBufferSize, maxQueueLength, streamCreator(sessionId), getTime, diodeType)));
+    OrderingStreamWriter(
+      maxBufferSize, maxQueueLength, std::move(stream), getTime, diodeType, reorderBudget, parallelRewrapper)));
+  if (headerParams.streaming)
+  {
+    streamedSessions.insert(sessionId);
+  }
 }
 
 bool SessionManager::isStreamExpired(std::uint32_t sessionId)
@@ -61,7 +158,21 @@ bool SessionManager::isStreamExpired(std::uint32_t sessionId)
 void SessionManager::writeFileAndSaveIfComplete(Packet&& packet)
 {
   const auto sessionId = packet.headerParams.sessionId;
-  const bool fileComplete = streams.at(sessionId).write(std::move(packet));
+  bool fileComplete = false;
+  try
+  {
+    fileComplete = streams.at(sessionId).write(std::move(packet));
+  }
+  catch (const std::runtime_error& exception)
+  {
+    // Once a frame of a stream is lost to its output, what follows it is no use to the reader.
+    if (streamedSessions.count(sessionId) != 0)
+    {
+      spdlog::warn("Stream session {} failed, closing it: {}", sessionId, exception.what());
+      closeFailedSession(sessionId, FlightReason::rejected, "stream session " + std::to_string(sessionId) + " failed");
+    }
+    throw;
+  }
   if (fileComplete)
   {
     streams.at(sessionId).renameFile();
@@ -71,5 +182,46 @@ void SessionManager::writeFileAndSaveIfComplete(Packet&& packet)
 
 void SessionManager::closeSession(std::uint32_t sessionId)
 {
+  reportLatency(sessionId);
+  reportReorderDistance(sessionId);
   streams.erase(sessionId);
+  streamedSessions.erase(sessionId);
+}
+
+void SessionManager::recordLatency(const Packet& packet)
+{
+  if (packet.headerParams.sendTimestamp != 0 && packet.receiveTimestamp != 0)
+  {
+    latencies[packet.headerParams.sessionId].record(
+      static_cast<std::int64_t>(packet.receiveTimestamp - packet.headerParams.sendTimestamp));
+  }
+}
+
+void SessionManager::reportLatency(std::uint32_t sessionId)
+{
+  const auto latency = latencies.find(sessionId);
+  if (latency == latencies.end())
+  {
+    return;
+  }
+  spdlog::info("Session {} latency over {} frames: {}", sessionId, latency->second.count(), latency->second.summary());
+  if (latency->second.negativeCount() != 0)
+  {
+    spdlog::warn("Session {}: {} frames arrived before they were sent, the client and server clocks are out of step",
+      sessionId, latency->second.negativeCount());
+  }
+  latencies.erase(latency);
+}
+
+void SessionManager::reportReorderDistance(std::uint32_t sessionId)
+{
+  const auto* window = streams.at(sessionId).reorderWindow();
+  if (window == nullptr)
+  {
+    return;
+  }
+  recommendedQueueLength = std::max(recommendedQueueLength, window->recommendedQueueLength());
+  spdlog::info("Session {} reorder distance: p99 under {}, max {}, window {} frames. A fixed -q of {} covers every "
+    "session so far", sessionId, window->p99DistanceBound(), window->maxDistance(), window->length(),
+    recommendedQueueLength);
 }
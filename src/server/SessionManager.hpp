@@ -6,9 +6,17 @@
 
 #include <map>
 #include <set>
+#include "FlightRecorder.hpp"
+#include "LatencyHistogram.hpp"
 #include "OrderingStreamWriter.hpp"
+#include "ResumableSessions.hpp"
 #include "StreamInterface.hpp"
 
+// A streamed session may go quiet for a while when its source has nothing to send, so it is given this many timeout
+// periods without a frame or keepalive before it is closed. The client sends a keepalive every
+// EnterpriseDiode::StreamKeepaliveInterval while its source is quiet.
+constexpr std::uint32_t streamTimeoutMultiple = 40;
+
 class SessionManager
 {
 public:
@@ -18,24 +26,46 @@ public:
     std::function<std::unique_ptr<StreamInterface>(std::uint32_t)> streamCreator,
     std::function<time_t()> getTime,
     std::uint32_t timeoutPeriod,
-    DiodeType diodeType);
+    DiodeType diodeType,
+    std::function<std::unique_ptr<StreamInterface>(std::uint32_t)> liveStreamCreator = {},
+    std::uint64_t reorderBudgetInBytes = 0,
+    unsigned int rewrapThreads = 0);
 
   void writeToStream(Packet&& packet);
 
 private:
   void closeSession(std::uint32_t sessionId);
-  void createNewSession(uint32_t sessionId);
+  void createNewSession(const HeaderParams& headerParams);
 
   std::uint32_t maxBufferSize;
   std::uint32_t maxQueueLength;
+  // Shared by every session's adaptive reorder window. Null when sessions have a fixed maxQueueLength instead.
+  std::shared_ptr<ReorderBudget> reorderBudget;
+  // Rewraps import sessions on other threads as well as the network thread. Null to rewrap on it alone.
+  std::shared_ptr<ParallelRewrapper> parallelRewrapper;
+  // The largest -q any session so far has needed, for operators who would rather set it.
+  std::uint32_t recommendedQueueLength = 0;
   std::map<std::uint32_t, OrderingStreamWriter> streams;
+  // The sessions in streams that are streamed, which time out after streamTimeoutMultiple timeout periods.
+  std::set<std::uint32_t> streamedSessions;
+  std::time_t lastIdleCheck = 0;
+  // Sessions whose frames carry send timestamps, logged when the session closes.
+  std::map<std::uint32_t, LatencyHistogram> latencies;
   std::function<std::unique_ptr<StreamInterface>(std::uint32_t)> streamCreator;
+  // Writes streamed sessions as they arrive. Without it they are written like any other file.
+  std::function<std::unique_ptr<StreamInterface>(std::uint32_t)> liveStreamCreator;
   std::function<time_t()> getTime;
   std::uint32_t timeoutPeriod;
   DiodeType diodeType;
-  void createSessionIfNewId(std::uint32_t sessionId);
+  ResumableSessions resumableSessions;
+  void createSessionIfNewId(const HeaderParams& headerParams);
   bool isStreamExpired(std::uint32_t sessionId);
+  void closeIdleStreamedSessions();
+  void closeFailedSession(std::uint32_t sessionId, FlightReason reason, const std::string& cause);
   void writeFileAndSaveIfComplete(Packet&& packet);
+  void recordLatency(const Packet& packet);
+  void reportLatency(std::uint32_t sessionId);
+  void reportReorderDistance(std::uint32_t sessionId);
 };
 
 #endif //SESSIONMANAGER_HPP
@@ -4,9 +4,31 @@
 #include <sstream>
 #include <test/EnterpriseDiodeTestHelpers.hpp>
 #include "test/catch.hpp"
+#include "diodeheader/EnterpriseDiodeHeader.hpp"
+#include "PackFormat.hpp"
 #include "SessionManager.hpp"
 #include "StreamSpy.hpp"
 
+namespace
+{
+  // A stream whose output has gone, as when the reader of a named pipe falls behind.
+  class ThrowingStream: public StreamInterface
+  {
+  public:
+    explicit ThrowingStream(bool& fileDeletedWasCalled): fileDeletedWasCalled(fileDeletedWasCalled)
+    {
+    }
+
+    void deleteFile() override { fileDeletedWasCalled = true; }
+    void renameFile() override {}
+    void setStoredFilename(std::string) override {}
+    void write(const BytesBuffer&) override { throw std::runtime_error("Output has gone"); }
+
+  private:
+    bool& fileDeletedWasCalled;
+  };
+}
+
 TEST_CASE("SessionManager.")
 {
   std::vector<std::stringstream> outputStreams;
@@ -131,4 +153,119 @@ TEST_CASE("SessionManager.")
 
     REQUIRE_FALSE(fileRenameWasCalled);
   }
+
+  SECTION("SessionManager splits a packed session into a stream per file.")
+  {
+    auto fakeGetTime = []() { return 10000; };
+    auto sessionManager = SessionManager(10, 10, streamSpyCreator, fakeGetTime, 5, DiodeType::basic);
+
+    std::string payload;
+    for (const auto& [name, content] : {std::pair<std::string, std::string>{"a.txt", "AB"}, {"b.txt", "C"}})
+    {
+      const auto header = PackFormat::writeEntryHeader({static_cast<std::uint16_t>(name.size()), content.size()});
+      payload += std::string(header.begin(), header.end()) + name + content;
+    }
+    auto packetHeader = createTestPacketStream(1, 1, false);
+    packetHeader.at(EnterpriseDiode::PackedFlagIndex) = 1;
+    sessionManager.writeToStream(parsePacket(std::move(packetHeader), {payload.begin(), payload.end()}));
+
+    REQUIRE(outputStreams.size() == 2);
+    REQUIRE(outputStreams.at(0).str() == "AB");
+    REQUIRE(outputStreams.at(1).str() == "C");
+    REQUIRE(fileRenameWasCalled);
+
+    auto importManager = SessionManager(10, 10, streamSpyCreator, fakeGetTime, 5, DiodeType::import);
+    auto importHeader = createTestPacketStream(2, 1, false, true);
+    importHeader.at(EnterpriseDiode::PackedFlagIndex) = 1;
+    REQUIRE_THROWS_AS(importManager.writeToStream(parsePacket(std::move(importHeader), {'A'})), std::runtime_error);
+  }
+
+  SECTION("SessionManager writes streamed sessions to the live stream, and gives them longer to time out.")
+  {
+    std::uint32_t time = 500;
+    std::vector<std::uint32_t> liveSessions;
+    auto liveStreamCreator = [&](std::uint32_t sessionId) {
+      liveSessions.push_back(sessionId);
+      return streamSpyCreator(sessionId);
+    };
+    auto sessionManager = SessionManager(
+      10, 10, streamSpyCreator, [&time]() { return time; }, 15, DiodeType::basic, liveStreamCreator);
+    const auto streamedPacket = [](std::uint8_t frameCount, bool eOF) {
+      auto header = createTestPacketStream(1, frameCount, eOF);
+      header.at(EnterpriseDiode::StreamingFlagIndex) = 1;
+      return header;
+    };
+
+    sessionManager.writeToStream(parsePacket(streamedPacket(1, false), {'B', 'C'}));
+    time += 15 * streamTimeoutMultiple;
+    sessionManager.writeToStream(parsePacket(streamedPacket(2, false), {'D'}));
+    REQUIRE(liveSessions == std::vector<std::uint32_t>{1});
+    REQUIRE(outputStreams.at(0).str() == "BCD");
+    REQUIRE_FALSE(fileDeletedWasCalled);
+
+    sessionManager.writeToStream(parsePacket(createTestPacketStream(2, 1, false), {'E'}));
+    REQUIRE(liveSessions.size() == 1);
+
+    const std::string filename = "{name: !str \"feed.log\"}";
+    sessionManager.writeToStream(parsePacket(streamedPacket(3, true), {filename.begin(), filename.end()}));
+    REQUIRE(fileRenameWasCalled);
+
+    auto importManager = SessionManager(10, 10, streamSpyCreator, []() { return 0; }, 5, DiodeType::import);
+    REQUIRE_THROWS_AS(importManager.writeToStream(parsePacket(streamedPacket(1, false), {'A'})), std::runtime_error);
+  }
+
+  SECTION("SessionManager closes a streamed session that has been quiet too long when any other frame arrives.")
+  {
+    std::uint32_t time = 500;
+    auto sessionManager = SessionManager(
+      10, 10, streamSpyCreator, [&time]() { return time; }, 15, DiodeType::basic, streamSpyCreator);
+    auto streamedHeader = createTestPacketStream(1, 1, false);
+    streamedHeader.at(EnterpriseDiode::StreamingFlagIndex) = 1;
+
+    sessionManager.writeToStream(parsePacket(std::move(streamedHeader), {'B', 'C'}));
+    time += 15 * streamTimeoutMultiple + 1;
+    sessionManager.writeToStream(parsePacket(createTestPacketStream(2, 1, false), {'D'}));
+    REQUIRE(fileDeletedWasCalled);
+    REQUIRE(outputStreams.at(0).str() == "BC");
+  }
+
+  SECTION("SessionManager keeps a quiet stream that sends keepalives, and writes its later frames.")
+  {
+    std::uint32_t time = 500;
+    auto sessionManager = SessionManager(
+      10, 10, streamSpyCreator, [&time]() { return time; }, 15, DiodeType::basic, streamSpyCreator);
+    const auto streamedPacket = [](std::uint8_t frameCount, bool keepalive) {
+      auto header = createTestPacketStream(1, frameCount, false);
+      header.at(EnterpriseDiode::StreamingFlagIndex) = 1;
+      header.at(EnterpriseDiode::KeepaliveFlagIndex) = keepalive;
+      return header;
+    };
+
+    sessionManager.writeToStream(parsePacket(streamedPacket(1, false), {'B', 'C'}));
+    for (std::uint32_t keepalive = 0; keepalive < 2 * streamTimeoutMultiple; ++keepalive)
+    {
+      time += 10;
+      sessionManager.writeToStream(parsePacket(streamedPacket(1, true), {0}));
+    }
+    sessionManager.writeToStream(parsePacket(streamedPacket(2, false), {'D'}));
+
+    REQUIRE_FALSE(fileDeletedWasCalled);
+    REQUIRE(outputStreams.at(0).str() == "BCD");
+  }
+
+  SECTION("SessionManager closes a streamed session whose output fails.")
+  {
+    auto failingStreamCreator = [&](std::uint32_t sessionId) {
+      capturedSessionId = sessionId;
+      return std::make_unique<ThrowingStream>(fileDeletedWasCalled);
+    };
+    auto sessionManager = SessionManager(
+      10, 10, streamSpyCreator, []() { return 500; }, 15, DiodeType::basic, failingStreamCreator);
+    auto streamedHeader = createTestPacketStream(1, 1, false);
+    streamedHeader.at(EnterpriseDiode::StreamingFlagIndex) = 1;
+
+    REQUIRE_THROWS_AS(
+      sessionManager.writeToStream(parsePacket(std::move(streamedHeader), {'B', 'C'})), std::runtime_error);
+    REQUIRE(fileDeletedWasCalled);
+  }
 }
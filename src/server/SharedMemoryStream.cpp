@@ -0,0 +1,145 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "SharedMemoryStream.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
+#include "OutputFolders.hpp"
+#include "spdlog/spdlog.h"
+
+namespace
+{
+  // Opened by name and unlinked straight away, which works where memfd_create is not available, as on Centos 7.
+  int openSharedMemoryFile(std::uint32_t sessionId)
+  {
+    thread_local std::mt19937 generator(std::random_device{}());
+    const auto path = "/dev/shm/.received." + std::to_string(sessionId) + "." + std::to_string(generator());
+    const auto fileDescriptor = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fileDescriptor < 0)
+    {
+      throw std::runtime_error("Unable to create shared memory for session " + std::to_string(sessionId) + ": " +
+        std::strerror(errno));
+    }
+    unlink(path.c_str());
+    return fileDescriptor;
+  }
+
+  void throwIfFailed(bool failed, const std::string& action)
+  {
+    if (failed)
+    {
+      throw std::runtime_error("Unable to " + action + ": " + std::strerror(errno));
+    }
+  }
+}
+
+SharedMemoryStream::SharedMemoryStream(std::shared_ptr<FilePublisher> publisher, std::uint32_t sessionId):
+  publisher(std::move(publisher)),
+  sessionId(sessionId),
+  fileDescriptor(openSharedMemoryFile(sessionId))
+{
+}
+
+SharedMemoryStream::~SharedMemoryStream()
+{
+  closeFile();
+}
+
+void SharedMemoryStream::deleteFile()
+{
+  spdlog::error("Discarding session {} after {} bytes", sessionId, bytesWritten);
+  closeFile();
+}
+
+void SharedMemoryStream::renameFile()
+{
+  if (publisher->publish(fileDescriptor, storedFilename))
+  {
+    spdlog::info("File complete. Published {}, {} bytes", storedFilename, bytesWritten);
+  }
+  else
+  {
+    spdlog::info("File complete. Saving {}", storedFilename);
+    saveToOutputFolder();
+  }
+  closeFile();
+}
+
+void SharedMemoryStream::setStoredFilename(std::string filename)
+{
+  storedFilename = (filename == "rejected.") ? filename + std::to_string(sessionId) : std::move(filename);
+}
+
+void SharedMemoryStream::write(const BytesBuffer& inputData)
+{
+  std::size_t offset = 0;
+  while (offset < inputData.size())
+  {
+    const auto written = ::write(fileDescriptor, inputData.data() + offset, inputData.size() - offset);
+    if (written < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    throwIfFailed(written < 0, "write session " + std::to_string(sessionId) + " to shared memory");
+    offset += static_cast<std::size_t>(written);
+  }
+  bytesWritten += inputData.size();
+}
+
+void SharedMemoryStream::saveToOutputFolder()
+{
+  try
+  {
+    createParentFolders(".", storedFilename);
+  }
+  catch (const std::exception& exception)
+  {
+    spdlog::error(exception.what());
+    storedFilename = "rejected." + std::to_string(sessionId);
+  }
+
+  // Copied to a temporary file first, like every other stream, so the file only appears under its name whole. The
+  // temporary file is created afresh, never through a link left in its place.
+  const auto tempFilename = ".received." + std::to_string(sessionId);
+  unlink(tempFilename.c_str());
+  const auto output = open(tempFilename.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0644);
+  throwIfFailed(output < 0, "save " + storedFilename);
+  off_t offset = 0;
+  while (static_cast<std::uint64_t>(offset) < bytesWritten)
+  {
+    const auto copied = sendfile(output, fileDescriptor, &offset, bytesWritten - static_cast<std::uint64_t>(offset));
+    if (copied < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (copied <= 0)
+    {
+      close(output);
+      unlink(tempFilename.c_str());
+      throw std::runtime_error("Unable to save " + storedFilename + " from shared memory");
+    }
+  }
+  close(output);
+  if (std::rename(tempFilename.c_str(), storedFilename.c_str()) != 0)
+  {
+    const auto error = errno;
+    unlink(tempFilename.c_str());
+    errno = error;
+    throwIfFailed(true, "save " + storedFilename);
+  }
+}
+
+void SharedMemoryStream::closeFile()
+{
+  if (fileDescriptor >= 0)
+  {
+    close(fileDescriptor);
+    fileDescriptor = -1;
+  }
+}
@@ -0,0 +1,42 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef SHAREDMEMORYSTREAM_HPP
+#define SHAREDMEMORYSTREAM_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "FilePublisher.hpp"
+#include "StreamInterface.hpp"
+
+// Writes a session to an unnamed file in shared memory rather than to disk, and once it is complete publishes it
+// to a local consumer through publisher. If no consumer takes it the file is saved to the output folder as
+// FileStream would, so nothing received is lost. The memory is freed when both the server and the consumer have
+// closed the file.
+class SharedMemoryStream : public StreamInterface
+{
+public:
+  SharedMemoryStream(std::shared_ptr<FilePublisher> publisher, std::uint32_t sessionId);
+  ~SharedMemoryStream() override;
+
+  SharedMemoryStream(const SharedMemoryStream&) = delete;
+  SharedMemoryStream& operator=(const SharedMemoryStream&) = delete;
+
+  void deleteFile() override;
+  void renameFile() override;
+  void setStoredFilename(std::string filename) override;
+  void write(const BytesBuffer& inputData) override;
+
+private:
+  void saveToOutputFolder();
+  void closeFile();
+
+  const std::shared_ptr<FilePublisher> publisher;
+  const std::uint32_t sessionId;
+  int fileDescriptor;
+  std::string storedFilename;
+  std::uint64_t bytesWritten = 0;
+};
+
+#endif //SHAREDMEMORYSTREAM_HPP
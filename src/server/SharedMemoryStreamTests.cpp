@@ -0,0 +1,160 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "test/catch.hpp"
+#include "SharedMemoryStream.hpp"
+
+namespace
+{
+  // A consumer as a downstream process would be, listening for published files.
+  class Consumer
+  {
+  public:
+    explicit Consumer(const std::filesystem::path& path):
+      path(path),
+      listener(socket(AF_UNIX, SOCK_SEQPACKET, 0))
+    {
+      std::filesystem::remove(path);
+      sockaddr_un address{};
+      address.sun_family = AF_UNIX;
+      std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+      REQUIRE(bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0);
+      REQUIRE(listen(listener, 1) == 0);
+    }
+
+    ~Consumer()
+    {
+      close(connection);
+      close(listener);
+      std::filesystem::remove(path);
+    }
+
+    // The name and content of the next file published.
+    std::pair<std::string, std::string> receive()
+    {
+      if (connection < 0)
+      {
+        connection = accept(listener, nullptr, nullptr);
+      }
+      char name[256];
+      iovec nameBuffer{name, sizeof(name)};
+      alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+      msghdr message{};
+      message.msg_iov = &nameBuffer;
+      message.msg_iovlen = 1;
+      message.msg_control = control;
+      message.msg_controllen = sizeof(control);
+      const auto nameLength = recvmsg(connection, &message, 0);
+      REQUIRE(nameLength > 0);
+      const auto* rights = CMSG_FIRSTHDR(&message);
+      REQUIRE(rights != nullptr);
+      REQUIRE(rights->cmsg_type == SCM_RIGHTS);
+      int fileDescriptor = -1;
+      std::memcpy(&fileDescriptor, CMSG_DATA(rights), sizeof(int));
+
+      std::string content(static_cast<std::size_t>(lseek(fileDescriptor, 0, SEEK_END)), '\0');
+      REQUIRE(pread(fileDescriptor, content.data(), content.size(), 0) == static_cast<ssize_t>(content.size()));
+      close(fileDescriptor);
+      return {std::string(name, static_cast<std::size_t>(nameLength)), content};
+    }
+
+  private:
+    const std::filesystem::path path;
+    const int listener;
+    int connection = -1;
+  };
+
+  std::string readFile(const std::filesystem::path& path)
+  {
+    std::ifstream input(path, std::ios::binary);
+    std::stringstream content;
+    content << input.rdbuf();
+    return content.str();
+  }
+}
+
+TEST_CASE("SharedMemoryStream. A completed file is published with its name and content, and not saved")
+{
+  const auto socketPath = std::filesystem::temp_directory_path() / "sharedMemoryStreamTest.sock";
+  Consumer consumer(socketPath);
+  auto publisher = std::make_shared<FilePublisher>(socketPath.string());
+
+  for (const std::string name : {"first.txt", "second.txt"})
+  {
+    SharedMemoryStream stream(publisher, 1);
+    stream.write({'a', 'b'});
+    stream.write({'c'});
+    stream.setStoredFilename(name);
+    stream.renameFile();
+
+    REQUIRE(consumer.receive() == std::make_pair(name, std::string("abc")));
+    REQUIRE_FALSE(std::filesystem::exists(name));
+  }
+}
+
+TEST_CASE("SharedMemoryStream. Without a consumer the file is saved to the output folder")
+{
+  auto publisher = std::make_shared<FilePublisher>(
+    (std::filesystem::temp_directory_path() / "sharedMemoryStreamTest.none").string());
+  SharedMemoryStream stream(publisher, 1);
+  stream.write({'x', 'y', 'z'});
+  stream.setStoredFilename("sharedMemoryStreamTest.txt");
+  stream.renameFile();
+
+  REQUIRE(readFile("sharedMemoryStreamTest.txt") == "xyz");
+  std::filesystem::remove("sharedMemoryStreamTest.txt");
+}
+
+TEST_CASE("SharedMemoryStream. A saved file replaces a link at its name rather than writing through it")
+{
+  const auto target = std::filesystem::temp_directory_path() / "sharedMemoryStreamTest.target";
+  std::ofstream(target) << "untouched";
+  std::filesystem::remove("sharedMemoryStreamTest.txt");
+  std::filesystem::create_symlink(target, "sharedMemoryStreamTest.txt");
+
+  auto publisher = std::make_shared<FilePublisher>(
+    (std::filesystem::temp_directory_path() / "sharedMemoryStreamTest.none").string());
+  SharedMemoryStream stream(publisher, 7);
+  stream.write({'x', 'y', 'z'});
+  stream.setStoredFilename("sharedMemoryStreamTest.txt");
+  stream.renameFile();
+
+  REQUIRE_FALSE(std::filesystem::is_symlink("sharedMemoryStreamTest.txt"));
+  REQUIRE(readFile("sharedMemoryStreamTest.txt") == "xyz");
+  REQUIRE(readFile(target) == "untouched");
+  REQUIRE_FALSE(std::filesystem::exists(".received.7"));
+  std::filesystem::remove("sharedMemoryStreamTest.txt");
+  std::filesystem::remove(target);
+}
+
+TEST_CASE("SharedMemoryStream. A consumer that restarts is connected to again")
+{
+  const auto socketPath = std::filesystem::temp_directory_path() / "sharedMemoryStreamTest.sock";
+  auto publisher = std::make_shared<FilePublisher>(socketPath.string());
+  {
+    Consumer consumer(socketPath);
+    SharedMemoryStream stream(publisher, 1);
+    stream.setStoredFilename("before.txt");
+    stream.renameFile();
+    REQUIRE(consumer.receive().first == "before.txt");
+  }
+
+  Consumer consumer(socketPath);
+  for (const std::string name : {"lost.txt", "after.txt"})
+  {
+    SharedMemoryStream stream(publisher, 1);
+    stream.write({'d'});
+    stream.setStoredFilename(name);
+    stream.renameFile();
+  }
+  REQUIRE(consumer.receive() == std::make_pair(std::string("after.txt"), std::string("d")));
+  REQUIRE(readFile("lost.txt") == "d");
+  std::filesystem::remove("lost.txt");
+}
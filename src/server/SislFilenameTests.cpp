@@ -26,6 +26,11 @@ TEST_CASE("SislFilenameParsing.")
       REQUIRE(!sislFilename.extractFilename(stringToBuffer("{nae: !str \"abcd\"}")));
       REQUIRE(!sislFilename.extractFilename(stringToBuffer("{}")));
     }
+    SECTION("name field must be a string")
+    {
+      REQUIRE(!sislFilename.extractFilename(stringToBuffer("{name: !uint \"1\"}")));
+      REQUIRE(!sislFilename.extractFilename(stringToBuffer("{name: !obj {name: !str \"a\"}}")));
+    }
   }
   SECTION("sisl size is limited")
   {
@@ -54,3 +59,31 @@ TEST_CASE("SislFilenameParsing.")
 }
 
 
+
+TEST_CASE("SislFilenameParsing. Paths")
+{
+  const SISLFilename sislFilename(maxEofSislLength(65), 65);
+
+  SECTION("The folder a file was sent from goes before its name")
+  {
+    REQUIRE(sislFilename.extractFilename(stringToBuffer("{name: !str \"a.pdf\", path: !str \"docs/2021\"}")) ==
+            "docs/2021/a.pdf");
+  }
+  SECTION("Paths that could leave the output folder are rejected")
+  {
+    for (const auto path : {"", "/etc", "..", "docs/../..", "docs//2021", "docs/"})
+    {
+      INFO(path);
+      REQUIRE(!sislFilename.extractFilename(
+        stringToBuffer(std::string("{name: !str \"a.pdf\", path: !str \"") + path + "\"}")));
+    }
+  }
+  SECTION("path field must be a string")
+  {
+    REQUIRE(!sislFilename.extractFilename(stringToBuffer("{name: !str \"a.pdf\", path: !uint \"1\"}")));
+  }
+  SECTION("The name is still checked when there is a path")
+  {
+    REQUIRE(!sislFilename.extractFilename(stringToBuffer("{name: !str \"a/b.pdf\", path: !str \"docs\"}")));
+  }
+}
@@ -4,21 +4,32 @@
 #include "UdpServer.hpp"
 #include <diodeheader/EnterpriseDiodeHeader.hpp>
 #include <iostream>
+#include <linux/sockios.h>
+#include <sys/ioctl.h>
+#include "ThreadTuning.hpp"
 
 UdpServer::UdpServer(
   std::uint16_t port,
   boost::asio::io_service& io_service,
   std::uint32_t udpFrameSize,
-  std::uint32_t udpSocketBufferSizeInBytes) :
+  std::uint32_t udpSocketBufferSizeInBytes,
+  int busyPollMicroseconds) :
   udpFrameSize(udpFrameSize),
   io_context(io_service),
-  udpSocket(io_service, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), port))
+  udpSocket(io_service, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), port)),
+  socketHandle(udpSocket.native_handle())
 {
   if (udpFrameSize < EnterpriseDiode::HeaderSizeInBytes)
   {
     throw std::runtime_error("UDP Frame size MUST be greater than 112 bytes (was: " + std::to_string(udpFrameSize) + ")");
   }
   udpSocket.set_option(boost::asio::socket_base::receive_buffer_size(static_cast<int>(udpSocketBufferSizeInBytes)));
+  ThreadTuning::enableBusyPoll(udpSocket.native_handle(), busyPollMicroseconds);
+  // Asking for the stamp turns stamping on, so the kernel stamps each datagram as it arrives for receiveTime() to
+  // read back. This first ask has nothing to return. SO_TIMESTAMPNS is not used, as the kernel then only passes
+  // stamps as control messages and SIOCGSTAMPNS fails.
+  timespec stamp{};
+  ioctl(socketHandle, SIOCGSTAMPNS, &stamp);
   triggerWaitAndReadNextUdpPacket();
 }
 
@@ -27,9 +38,22 @@ UdpServer::~UdpServer()
   io_context.stop();
 }
 
+std::chrono::system_clock::time_point UdpServer::receiveTime() const
+{
+  timespec stamp{};
+  // asio reads without control messages, so the stamp is asked for afterwards rather than read with the datagram.
+  if (ioctl(socketHandle, SIOCGSTAMPNS, &stamp) != 0)
+  {
+    return UdpServerInterface::receiveTime();
+  }
+  return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+    std::chrono::seconds(stamp.tv_sec) + std::chrono::nanoseconds(stamp.tv_nsec)));
+}
+
 void UdpServer::triggerWaitAndReadNextUdpPacket()
 {
-  frame = std::vector<std::uint8_t>(udpFrameSize - EnterpriseDiode::HeaderSizeInBytes);
+  // One byte spare, as a datagram larger than the buffer would be cut short without any error.
+  frame = std::vector<std::uint8_t>(udpFrameSize - EnterpriseDiode::HeaderSizeInBytes + 1);
   header = std::vector<std::uint8_t>(EnterpriseDiode::HeaderSizeInBytes);
   std::array<boost::asio::mutable_buffer, 2> bufs = { boost::asio::buffer(header), boost::asio::buffer(frame) };
 
@@ -48,7 +72,11 @@ void UdpServer::triggerWaitAndReadNextUdpPacket()
 
 void UdpServer::checkPacketLengthAndExecuteCallback(size_t udpPacketLength)
 {
-  if (callback && ((std::int32_t)udpPacketLength - (std::int32_t)EnterpriseDiode::HeaderSizeInBytes > 0))
+  if (udpPacketLength > udpFrameSize)
+  {
+    std::cerr << "datagram larger than the MTU allows, check the client --mtu is not larger than the server's" << "\n";
+  }
+  else if (callback && udpPacketLength > EnterpriseDiode::HeaderSizeInBytes)
   {
     frame.resize(udpPacketLength - EnterpriseDiode::HeaderSizeInBytes);
     callback(std::move(header), std::move(frame));
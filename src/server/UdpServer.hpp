@@ -16,16 +16,21 @@ public:
     std::uint16_t port,
     boost::asio::io_service& io_service,
     std::uint32_t udpFrameSize,
-    std::uint32_t udpSocketBufferSizeInBytes = 268435456);
+    std::uint32_t udpSocketBufferSizeInBytes = 268435456,
+    int busyPollMicroseconds = 0);
 
   ~UdpServer() override;
 
+  // The kernel's receive time of the last datagram read from the socket.
+  std::chrono::system_clock::time_point receiveTime() const override;
+
 private:
   void triggerWaitAndReadNextUdpPacket();
   void checkPacketLengthAndExecuteCallback(size_t udpPacketLength);
   const std::uint32_t udpFrameSize;
   boost::asio::io_service& io_context;
   boost::asio::ip::udp::socket udpSocket;
+  const int socketHandle;
   boost::asio::ip::udp::endpoint senderEndpoint;
   std::vector<std::uint8_t> frame;
   std::vector<std::uint8_t> header;
@@ -0,0 +1,75 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "UdpServerGroup.hpp"
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include "BytesBuffer.hpp"
+
+namespace
+{
+  std::uint16_t parsePort(std::string_view number, std::string_view list)
+  {
+    std::uint16_t value{};
+    const auto result = std::from_chars(number.data(), number.data() + number.size(), value);
+    if (number.empty() || result.ec != std::errc() || result.ptr != number.data() + number.size() || value == 0)
+    {
+      throw std::runtime_error("Invalid port list: " + std::string(list));
+    }
+    return value;
+  }
+}
+
+std::vector<std::uint16_t> parsePortList(std::string_view list)
+{
+  std::vector<std::uint16_t> ports;
+  for (std::size_t begin = 0, end = 0; end < list.size(); begin = end + 1)
+  {
+    end = std::min(list.find(',', begin), list.size());
+    const auto range = list.substr(begin, end - begin);
+    const auto dash = range.find('-');
+    const auto first = parsePort(range.substr(0, dash), list);
+    const auto last = dash == std::string_view::npos ? first : parsePort(range.substr(dash + 1), list);
+    if (last < first)
+    {
+      throw std::runtime_error("Invalid port list: " + std::string(list));
+    }
+    for (unsigned int next = first; next <= last; ++next)
+    {
+      const auto port = static_cast<std::uint16_t>(next);
+      if (std::find(ports.begin(), ports.end(), port) != ports.end())
+      {
+        throw std::runtime_error("Port " + std::to_string(port) + " is listed twice");
+      }
+      ports.push_back(port);
+    }
+  }
+  if (ports.empty())
+  {
+    throw std::runtime_error("Invalid port list: " + std::string(list));
+  }
+  return ports;
+}
+
+UdpServerGroup::UdpServerGroup(std::vector<std::unique_ptr<UdpServerInterface>> receivers):
+  receivers(std::move(receivers))
+{
+  for (auto& receiver : this->receivers)
+  {
+    receiver->setCallback([this, &receiver](BytesBuffer&& header, BytesBuffer&& payload) {
+      if (callback)
+      {
+        delivering = receiver.get();
+        callback(std::move(header), std::move(payload));
+        delivering = nullptr;
+      }
+    });
+  }
+}
+
+std::chrono::system_clock::time_point UdpServerGroup::receiveTime() const
+{
+  return delivering ? delivering->receiveTime() : UdpServerInterface::receiveTime();
+}
@@ -0,0 +1,32 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef UDPSERVERGROUP_HPP
+#define UDPSERVERGROUP_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "UdpServerInterface.hpp"
+
+// Parses a list of ports to listen on such as "45000,45002-45003".
+std::vector<std::uint16_t> parsePortList(std::string_view list);
+
+// Passes on the datagrams of several receivers, one per link of a striped send, as if from one. The receivers
+// share the io_service, so their datagrams reach the one session manager in turn and frames of a session that
+// arrive on different links are reordered as usual.
+class UdpServerGroup : public UdpServerInterface
+{
+public:
+  explicit UdpServerGroup(std::vector<std::unique_ptr<UdpServerInterface>> receivers);
+
+  // The receive time from the receiver whose datagram is being passed on.
+  std::chrono::system_clock::time_point receiveTime() const override;
+
+private:
+  std::vector<std::unique_ptr<UdpServerInterface>> receivers;
+  const UdpServerInterface* delivering = nullptr;
+};
+
+#endif //UDPSERVERGROUP_HPP
@@ -4,6 +4,7 @@
 #ifndef UDPSERVERINTERFACE_HPP
 #define UDPSERVERINTERFACE_HPP
 
+#include <chrono>
 #include <functional>
 #include <boost/asio/buffer.hpp>
 
@@ -19,6 +20,13 @@ public:
     callback = requestedCallback;
   }
 
+  // When the datagram being passed to the callback arrived. Receivers that can ask the kernel give the time the
+  // datagram reached the socket, rather than when it was read.
+  virtual std::chrono::system_clock::time_point receiveTime() const
+  {
+    return std::chrono::system_clock::now();
+  }
+
 protected:
   std::function<void(std::vector<std::uint8_t>&&, std::vector<std::uint8_t>&&)> callback;
 };
@@ -1,15 +1,18 @@
 // Copyright PA Knowledge Ltd 2021
 // MIT License. For licence terms see LICENCE.md file.
 
+#include <chrono>
 #include <cstdint>
 #include <vector>
 #include <future>
+#include <thread>
 
 #include "test/catch.hpp"
 #include "diodeheader/EnterpriseDiodeHeader.hpp"
 #include "Server.hpp"
 #include "client/UdpClient.hpp"
 #include "UdpServer.hpp"
+#include "UdpServerGroup.hpp"
 
 
 TEST_CASE("UDP Server. Packets are received", "[integration]")
@@ -37,3 +40,116 @@ TEST_CASE("UDP Server. Packets are received", "[integration]")
   io_context.run();
   REQUIRE(dataReceived == std::vector<char>({'A', 'B', 'C'}));
 }
+
+TEST_CASE("UDP Server. Datagrams up to the MTU are received whole and larger ones are dropped", "[integration]")
+{
+  const auto mtuSize = GENERATE(std::uint16_t{1500}, std::uint16_t{9000}, std::uint16_t{65535});
+  const auto maxBufferSize = EnterpriseDiode::calculateMaxBufferSize(mtuSize);
+  std::vector<std::size_t> payloadSizesReceived;
+
+  boost::asio::io_service io_context;
+  UdpServer udpServer(2005, io_context, maxBufferSize);
+  udpServer.setCallback([&io_context, &payloadSizesReceived](BytesBuffer&&, BytesBuffer&& data) {
+    payloadSizesReceived.push_back(data.size());
+    io_context.stop();
+  });
+
+  auto handle = std::async(
+    std::launch::async,
+    [&io_context, maxBufferSize]() {
+      while (io_context.stopped()) { usleep(100); }
+      UdpClient client("localhost", 2005);
+      if (maxBufferSize < EnterpriseDiode::MaxDatagramSizeInBytes)
+      {
+        const std::vector<char> tooLarge(maxBufferSize + 1u);
+        client.send({boost::asio::buffer(tooLarge)});
+      }
+      const std::vector<char> largest(maxBufferSize);
+      client.send({boost::asio::buffer(largest)});
+    });
+
+  io_context.run();
+  REQUIRE(payloadSizesReceived == std::vector<std::size_t>{std::size_t{maxBufferSize} - EnterpriseDiode::HeaderSizeInBytes});
+}
+
+TEST_CASE("UDP Server. The kernel receive time of each datagram is available to the callback", "[integration]")
+{
+  constexpr auto readDelay = std::chrono::milliseconds(200);
+  std::vector<std::chrono::system_clock::time_point> receiveTimes;
+  std::vector<std::chrono::system_clock::time_point> callbackTimes;
+
+  boost::asio::io_service io_context;
+  UdpServer udpServer(2007, io_context, 150);
+  udpServer.setCallback([&](BytesBuffer&&, BytesBuffer&&) {
+    receiveTimes.push_back(udpServer.receiveTime());
+    callbackTimes.push_back(std::chrono::system_clock::now());
+    if (receiveTimes.size() == 2)
+    {
+      io_context.stop();
+    }
+  });
+
+  // The datagrams arrive while the server is not reading, so they are read well after the kernel stamps them.
+  const auto sendStart = std::chrono::system_clock::now();
+  const std::vector<char> datagram(113);
+  UdpClient client("localhost", 2007);
+  client.send({boost::asio::buffer(datagram)});
+  client.send({boost::asio::buffer(datagram)});
+  std::this_thread::sleep_for(readDelay);
+
+  io_context.run();
+  REQUIRE(receiveTimes.at(0) >= sendStart);
+  REQUIRE(receiveTimes.at(1) >= receiveTimes.at(0));
+  for (std::size_t datagramIndex = 0; datagramIndex < 2; ++datagramIndex)
+  {
+    REQUIRE(callbackTimes.at(datagramIndex) - receiveTimes.at(datagramIndex) >= readDelay);
+    REQUIRE(callbackTimes.at(datagramIndex) - receiveTimes.at(datagramIndex) < readDelay * 5);
+  }
+}
+
+TEST_CASE("UDP Server group. Port lists are parsed")
+{
+  REQUIRE(parsePortList("45000") == std::vector<std::uint16_t>{45000});
+  REQUIRE(parsePortList("45000,45002-45004") == std::vector<std::uint16_t>{45000, 45002, 45003, 45004});
+  REQUIRE(parsePortList("65534-65535") == std::vector<std::uint16_t>{65534, 65535});
+
+  for (const auto list : {"", "0", "a", "45000,", "45001-45000", "45000-", "45000,45000", "45000-45002,45001", "70000"})
+  {
+    INFO(list);
+    REQUIRE_THROWS_AS(parsePortList(list), std::runtime_error);
+  }
+}
+
+TEST_CASE("UDP Server group. Datagrams from every port reach the one callback", "[integration]")
+{
+  std::vector<char> dataReceived;
+
+  boost::asio::io_service io_context;
+  std::vector<std::unique_ptr<UdpServerInterface>> receivers;
+  receivers.push_back(std::make_unique<UdpServer>(2003, io_context, 150));
+  receivers.push_back(std::make_unique<UdpServer>(2004, io_context, 150));
+  UdpServerGroup group(std::move(receivers));
+  group.setCallback([&io_context, &dataReceived](BytesBuffer&&, BytesBuffer&& data) {
+    std::copy(data.begin(), data.end(), std::back_inserter(dataReceived));
+    if (dataReceived.size() == 2)
+    {
+      io_context.stop();
+    }
+  });
+
+  auto handle = std::async(
+    std::launch::async,
+    [&io_context]() {
+      while (io_context.stopped()) { usleep(100); }
+      std::vector<char> first(EnterpriseDiode::HeaderSizeInBytes, 0);
+      first.push_back('A');
+      std::vector<char> second(EnterpriseDiode::HeaderSizeInBytes, 0);
+      second.push_back('B');
+      UdpClient("localhost", 2003).send({boost::asio::buffer(first)});
+      UdpClient("localhost", 2004).send({boost::asio::buffer(second)});
+    });
+
+  io_context.run();
+  std::sort(dataReceived.begin(), dataReceived.end());
+  REQUIRE(dataReceived == std::vector<char>({'A', 'B'}));
+}
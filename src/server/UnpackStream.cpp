@@ -0,0 +1,141 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "UnpackStream.hpp"
+#include <algorithm>
+#include "spdlog/spdlog.h"
+
+UnpackStream::UnpackStream(
+  std::function<std::unique_ptr<StreamInterface>(std::uint32_t)> streamCreator,
+  std::uint32_t sessionId):
+    streamCreator(std::move(streamCreator)),
+    sessionId(sessionId)
+{
+}
+
+void UnpackStream::deleteFile()
+{
+  if (file)
+  {
+    file->deleteFile();
+    file.reset();
+  }
+  spdlog::error("Packed session {} incomplete, {} files unpacked", sessionId, unpacked);
+}
+
+void UnpackStream::renameFile()
+{
+  if (state == State::corrupt)
+  {
+    deleteFile();
+    return;
+  }
+  if (file || state == State::name || (state == State::header && !collected.empty()))
+  {
+    spdlog::error("Packed session {} ended part way through a file", sessionId);
+    deleteFile();
+    return;
+  }
+  spdlog::info("Packed session {} complete, {} files unpacked", sessionId, unpacked);
+}
+
+void UnpackStream::setStoredFilename(std::string filename)
+{
+  spdlog::debug("Packed session {} sent as {}", sessionId, filename);
+}
+
+void UnpackStream::write(const BytesBuffer& inputData)
+{
+  for (std::size_t offset = 0; offset < inputData.size() && state != State::corrupt;)
+  {
+    if (state == State::header)
+    {
+      offset += collect(inputData, offset, PackFormat::entryHeaderSizeInBytes);
+      if (collected.size() == PackFormat::entryHeaderSizeInBytes)
+      {
+        readEntryHeader();
+      }
+    }
+    else if (state == State::name)
+    {
+      offset += collect(inputData, offset, entry.nameLength);
+      if (collected.size() == entry.nameLength)
+      {
+        startEntry();
+      }
+    }
+    else
+    {
+      const auto length = static_cast<std::size_t>(std::min<std::uint64_t>(contentLeft, inputData.size() - offset));
+      writeContent(inputData, offset, length);
+      offset += length;
+    }
+  }
+}
+
+std::size_t UnpackStream::filesUnpacked() const
+{
+  return unpacked;
+}
+
+std::size_t UnpackStream::collect(const BytesBuffer& inputData, std::size_t offset, std::size_t length)
+{
+  const auto count = std::min(length - collected.size(), inputData.size() - offset);
+  collected.append(inputData.begin() + static_cast<std::ptrdiff_t>(offset),
+    inputData.begin() + static_cast<std::ptrdiff_t>(offset + count));
+  return count;
+}
+
+void UnpackStream::readEntryHeader()
+{
+  const auto header = PackFormat::readEntryHeader(collected.data());
+  collected.clear();
+  if (!header || header->nameLength == 0 || header->nameLength > PackFormat::maxNameLength)
+  {
+    spdlog::error("Packed session {} is corrupt after {} files, dropping the rest", sessionId, unpacked);
+    state = State::corrupt;
+    return;
+  }
+  entry = *header;
+  state = State::name;
+}
+
+void UnpackStream::startEntry()
+{
+  file = streamCreator(sessionId);
+  file->setStoredFilename(PackFormat::isValidName(collected) ? collected : "rejected.");
+  collected.clear();
+  contentLeft = entry.contentSize;
+  state = State::content;
+  if (contentLeft == 0)
+  {
+    finishEntry();
+  }
+}
+
+void UnpackStream::writeContent(const BytesBuffer& inputData, std::size_t offset, std::size_t length)
+{
+  if (offset == 0 && length == inputData.size())
+  {
+    file->write(inputData);
+  }
+  else
+  {
+    slice.assign(inputData.begin() + static_cast<std::ptrdiff_t>(offset),
+      inputData.begin() + static_cast<std::ptrdiff_t>(offset + length));
+    file->write(slice);
+  }
+  contentLeft -= length;
+  if (contentLeft == 0)
+  {
+    finishEntry();
+  }
+}
+
+void UnpackStream::finishEntry()
+{
+  file->renameFile();
+  file.reset();
+  ++unpacked;
+  state = State::header;
+}
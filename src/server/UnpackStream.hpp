@@ -0,0 +1,56 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef UNPACKSTREAM_HPP
+#define UNPACKSTREAM_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include "PackFormat.hpp"
+#include "StreamInterface.hpp"
+
+// Splits a packed session back into its files as the stream arrives. Each file is written through a stream of its
+// own from streamCreator, so packed files are stored, named and dropped just as files sent on their own are.
+class UnpackStream : public StreamInterface
+{
+public:
+  UnpackStream(std::function<std::unique_ptr<StreamInterface>(std::uint32_t)> streamCreator, std::uint32_t sessionId);
+
+  // The session timed out. Files already split out are kept, and only the one part written is deleted.
+  void deleteFile() override;
+  void renameFile() override;
+  // The name of the pack itself, which is only logged.
+  void setStoredFilename(std::string filename) override;
+  void write(const BytesBuffer& inputData) override;
+
+  [[nodiscard]] std::size_t filesUnpacked() const;
+
+private:
+  enum class State
+  {
+    header,
+    name,
+    content,
+    corrupt
+  };
+
+  std::size_t collect(const BytesBuffer& inputData, std::size_t offset, std::size_t length);
+  void readEntryHeader();
+  void startEntry();
+  void writeContent(const BytesBuffer& inputData, std::size_t offset, std::size_t length);
+  void finishEntry();
+
+  const std::function<std::unique_ptr<StreamInterface>(std::uint32_t)> streamCreator;
+  const std::uint32_t sessionId;
+  State state = State::header;
+  std::string collected;
+  PackFormat::EntryHeader entry{};
+  std::uint64_t contentLeft = 0;
+  std::unique_ptr<StreamInterface> file;
+  BytesBuffer slice;
+  std::size_t unpacked = 0;
+};
+
+#endif //UNPACKSTREAM_HPP
@@ -0,0 +1,98 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <map>
+#include <string>
+#include "test/catch.hpp"
+#include "PackFormat.hpp"
+#include "UnpackStream.hpp"
+
+namespace
+{
+  struct ReceivedFiles
+  {
+    std::map<std::string, std::string> renamed;
+    std::size_t deleted = 0;
+  };
+
+  class RecordingStream : public StreamInterface
+  {
+  public:
+    explicit RecordingStream(ReceivedFiles& received):
+      received(received)
+    {
+    }
+
+    void deleteFile() override { ++received.deleted; }
+    void renameFile() override { received.renamed[storedFilename] = content; }
+    void setStoredFilename(std::string filename) override { storedFilename = std::move(filename); }
+    void write(const BytesBuffer& inputData) override { content.append(inputData.begin(), inputData.end()); }
+
+  private:
+    ReceivedFiles& received;
+    std::string storedFilename;
+    std::string content;
+  };
+
+  std::string packEntry(const std::string& name, const std::string& content)
+  {
+    const auto header = PackFormat::writeEntryHeader({static_cast<std::uint16_t>(name.size()), content.size()});
+    return std::string(header.begin(), header.end()) + name + content;
+  }
+
+  // Writes the stream to the unpacker in pieces of chunkSize bytes, as the frames of a session would arrive.
+  void writeInChunks(UnpackStream& unpacker, const std::string& stream, std::size_t chunkSize)
+  {
+    for (std::size_t offset = 0; offset < stream.size(); offset += chunkSize)
+    {
+      const auto chunk = stream.substr(offset, chunkSize);
+      unpacker.write({chunk.begin(), chunk.end()});
+    }
+  }
+}
+
+TEST_CASE("UnpackStream.")
+{
+  ReceivedFiles received;
+  UnpackStream unpacker([&received](std::uint32_t) { return std::make_unique<RecordingStream>(received); }, 7);
+  const auto stream =
+    packEntry("photos/a.jpg", "AAAA") + packEntry("photos/2021/empty.txt", "") + packEntry("b.txt", "BBBBBBBBB");
+
+  SECTION("Each file is written to a stream of its own and named, however the frames split the entries")
+  {
+    for (const std::size_t chunkSize : {1, 3, 13, 1000})
+    {
+      ReceivedFiles chunkReceived;
+      UnpackStream chunkUnpacker(
+        [&chunkReceived](std::uint32_t) { return std::make_unique<RecordingStream>(chunkReceived); }, 7);
+      writeInChunks(chunkUnpacker, stream, chunkSize);
+      chunkUnpacker.renameFile();
+
+      INFO(chunkSize);
+      REQUIRE(chunkUnpacker.filesUnpacked() == 3);
+      REQUIRE(chunkReceived.renamed == std::map<std::string, std::string>{
+        {"photos/a.jpg", "AAAA"}, {"photos/2021/empty.txt", ""}, {"b.txt", "BBBBBBBBB"}});
+    }
+  }
+
+  SECTION("Names the server must not create are rejected, but the rest of the pack is still unpacked")
+  {
+    writeInChunks(unpacker, packEntry("../../etc/passwd", "X") + packEntry("c.txt", "C"), 5);
+    REQUIRE(received.renamed == std::map<std::string, std::string>{{"rejected.", "X"}, {"c.txt", "C"}});
+  }
+
+  SECTION("A session that times out keeps the files already unpacked and deletes the one part written")
+  {
+    writeInChunks(unpacker, stream.substr(0, stream.size() - 2), 4);
+    unpacker.deleteFile();
+    REQUIRE(received.renamed.size() == 2);
+    REQUIRE(received.deleted == 1);
+  }
+
+  SECTION("A corrupt entry header stops the unpacking")
+  {
+    writeInChunks(unpacker, packEntry("a.txt", "A") + "NOTAHEADER0000" + packEntry("b.txt", "B"), 100);
+    unpacker.renameFile();
+    REQUIRE(received.renamed == std::map<std::string, std::string>{{"a.txt", "A"}});
+  }
+}
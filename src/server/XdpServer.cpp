@@ -0,0 +1,435 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include "XdpServer.hpp"
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <linux/bpf.h>
+#include <linux/if_link.h>
+#include <net/if.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "spdlog/spdlog.h"
+#include "HeaderLayout.hpp"
+#include "diodeheader/EnterpriseDiodeHeader.hpp"
+
+#ifndef AF_XDP
+#define AF_XDP 44
+#endif
+#ifndef SOL_XDP
+#define SOL_XDP 283
+#endif
+
+namespace
+{
+  constexpr std::size_t ethernetHeaderSize = 14;
+  constexpr std::size_t ipv4HeaderSize = 20;
+  constexpr std::size_t udpHeaderSize = 8;
+  constexpr std::size_t udpHeaderOffset = ethernetHeaderSize + ipv4HeaderSize;
+  constexpr std::size_t udpPayloadOffset = udpHeaderOffset + udpHeaderSize;
+  // Only IPv4 without options, as the client sends.
+  constexpr std::uint8_t ipv4VersionAndHeaderLength = 0x45;
+  constexpr std::uint8_t udpProtocol = 17;
+  constexpr std::uint16_t ipv4EtherType = 0x0800;
+  // The more fragments flag and the fragment offset.
+  constexpr std::uint16_t ipv4FragmentMask = 0x3FFF;
+  constexpr std::uint32_t maxQueueCount = 64;
+
+  std::runtime_error systemError(const std::string& what)
+  {
+    return std::runtime_error("AF_XDP: " + what + ": " + std::strerror(errno));
+  }
+
+  int bpf(int command, bpf_attr& attributes)
+  {
+    return static_cast<int>(syscall(__NR_bpf, command, &attributes, sizeof(attributes)));
+  }
+
+  std::uint16_t readWireUint16(const std::uint8_t* data)
+  {
+    return static_cast<std::uint16_t>((data[0] << 8) | data[1]);
+  }
+
+  constexpr bpf_insn instruction(int code, int destination, int source, std::size_t offset, std::int32_t immediate)
+  {
+    return {static_cast<std::uint8_t>(code), static_cast<std::uint8_t>(destination & 0x0F),
+            static_cast<std::uint8_t>(source & 0x0F), static_cast<std::int16_t>(offset), immediate};
+  }
+
+  // The program checks the headers the same way as findUdpPayload, so only datagrams the server can use are taken
+  // away from the kernel.
+  std::vector<bpf_insn> redirectProgram(int mapFd, std::uint16_t port)
+  {
+    constexpr int context = BPF_REG_1;
+    constexpr int data = BPF_REG_2;
+    constexpr int dataEnd = BPF_REG_3;
+    constexpr int queue = BPF_REG_4;
+    constexpr int scratch = BPF_REG_5;
+    const auto wire16 = [](std::uint16_t value) { return static_cast<std::int32_t>(HeaderLayout::fromWire(value)); };
+
+    std::vector<bpf_insn> program{
+      instruction(BPF_LDX | BPF_W | BPF_MEM, data, context, offsetof(xdp_md, data), 0),
+      instruction(BPF_LDX | BPF_W | BPF_MEM, dataEnd, context, offsetof(xdp_md, data_end), 0),
+      instruction(BPF_LDX | BPF_W | BPF_MEM, queue, context, offsetof(xdp_md, rx_queue_index), 0),
+      instruction(BPF_ALU64 | BPF_MOV | BPF_X, scratch, data, 0, 0),
+      instruction(BPF_ALU64 | BPF_ADD | BPF_K, scratch, 0, 0, static_cast<std::int32_t>(udpPayloadOffset)),
+      instruction(BPF_JMP | BPF_JGT | BPF_X, scratch, dataEnd, 0, 0),
+      instruction(BPF_LDX | BPF_H | BPF_MEM, scratch, data, 12, 0),
+      instruction(BPF_JMP | BPF_JNE | BPF_K, scratch, 0, 0, wire16(ipv4EtherType)),
+      instruction(BPF_LDX | BPF_B | BPF_MEM, scratch, data, ethernetHeaderSize, 0),
+      instruction(BPF_JMP | BPF_JNE | BPF_K, scratch, 0, 0, ipv4VersionAndHeaderLength),
+      instruction(BPF_LDX | BPF_H | BPF_MEM, scratch, data, ethernetHeaderSize + 6, 0),
+      instruction(BPF_ALU64 | BPF_AND | BPF_K, scratch, 0, 0, wire16(ipv4FragmentMask)),
+      instruction(BPF_JMP | BPF_JNE | BPF_K, scratch, 0, 0, 0),
+      instruction(BPF_LDX | BPF_B | BPF_MEM, scratch, data, ethernetHeaderSize + 9, 0),
+      instruction(BPF_JMP | BPF_JNE | BPF_K, scratch, 0, 0, udpProtocol),
+      instruction(BPF_LDX | BPF_H | BPF_MEM, scratch, data, udpHeaderOffset + 2, 0),
+      instruction(BPF_JMP | BPF_JNE | BPF_K, scratch, 0, 0, wire16(port)),
+      instruction(BPF_LD | BPF_DW | BPF_IMM, BPF_REG_1, BPF_PSEUDO_MAP_FD, 0, mapFd),
+      instruction(0, 0, 0, 0, 0),
+      instruction(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_2, queue, 0, 0),
+      // Pass the frame to the kernel if no socket is bound to this queue.
+      instruction(BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_3, 0, 0, XDP_PASS),
+      instruction(BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map),
+      instruction(BPF_JMP | BPF_EXIT, 0, 0, 0, 0)};
+
+    const auto passLabel = static_cast<std::int16_t>(program.size());
+    program.push_back(instruction(BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_0, 0, 0, XDP_PASS));
+    program.push_back(instruction(BPF_JMP | BPF_EXIT, 0, 0, 0, 0));
+
+    for (std::size_t index = 0; index < program.size(); ++index)
+    {
+      const auto code = program[index].code;
+      if (BPF_CLASS(code) == BPF_JMP && BPF_OP(code) != BPF_CALL && BPF_OP(code) != BPF_EXIT)
+      {
+        program[index].off = static_cast<std::int16_t>(passLabel - static_cast<std::int16_t>(index) - 1);
+      }
+    }
+    return program;
+  }
+
+  template <typename T>
+  std::uint32_t loadAcquire(const T* value)
+  {
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+  }
+
+  template <typename T>
+  void storeRelease(T* target, std::uint32_t value)
+  {
+    __atomic_store_n(target, value, __ATOMIC_RELEASE);
+  }
+}
+
+XdpServer::XdpServer(
+  const std::string& interfaceName,
+  std::uint32_t queueId,
+  std::uint16_t port,
+  boost::asio::io_service& io_service,
+  std::uint32_t udpFrameSize):
+    port(port),
+    udpFrameSize(udpFrameSize),
+    io_context(io_service),
+    socketDescriptor(io_service)
+{
+  if (udpFrameSize < EnterpriseDiode::HeaderSizeInBytes)
+  {
+    throw std::runtime_error("UDP Frame size MUST be greater than 112 bytes (was: " + std::to_string(udpFrameSize) + ")");
+  }
+  if (udpFrameSize + udpPayloadOffset > umemFrameSizeInBytes)
+  {
+    throw std::runtime_error("AF_XDP: UDP frame size too large for a UMEM frame");
+  }
+  if (queueId >= maxQueueCount)
+  {
+    throw std::runtime_error("AF_XDP: queue id too large");
+  }
+  const auto interfaceIndex = if_nametoindex(interfaceName.c_str());
+  if (interfaceIndex == 0)
+  {
+    throw systemError("unknown interface " + interfaceName);
+  }
+
+  try
+  {
+    createUmem();
+    createSocket(interfaceIndex, queueId);
+    attachProgram(interfaceIndex, queueId);
+  }
+  catch (...)
+  {
+    closeAll();
+    throw;
+  }
+  spdlog::info("AF_XDP: receiving on {} queue {}", interfaceName, queueId);
+  triggerWaitAndReadNextUdpPackets();
+}
+
+XdpServer::~XdpServer()
+{
+  closeAll();
+  io_context.stop();
+}
+
+void XdpServer::createUmem()
+{
+  umem = mmap(
+    nullptr, std::size_t{umemFrameCount} * umemFrameSizeInBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+    -1, 0);
+  if (umem == MAP_FAILED)
+  {
+    umem = nullptr;
+    throw systemError("unable to allocate UMEM");
+  }
+}
+
+void XdpServer::createSocket(std::uint32_t interfaceIndex, std::uint32_t queueId)
+{
+  socketFd = socket(AF_XDP, SOCK_RAW, 0);
+  if (socketFd < 0)
+  {
+    throw systemError("unable to create socket");
+  }
+
+  xdp_umem_reg umemRegistration{};
+  umemRegistration.addr = reinterpret_cast<std::uint64_t>(umem);
+  umemRegistration.len = std::uint64_t{umemFrameCount} * umemFrameSizeInBytes;
+  umemRegistration.chunk_size = umemFrameSizeInBytes;
+  if (setsockopt(socketFd, SOL_XDP, XDP_UMEM_REG, &umemRegistration, sizeof(umemRegistration)) != 0)
+  {
+    throw systemError("unable to register UMEM");
+  }
+
+  // Every UMEM frame is either on the fill ring or waiting to be processed on the receive ring.
+  const std::uint32_t ringSize = umemFrameCount;
+  const std::uint32_t completionRingSize = 64;
+  if (setsockopt(socketFd, SOL_XDP, XDP_UMEM_FILL_RING, &ringSize, sizeof(ringSize)) != 0 ||
+      setsockopt(socketFd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &completionRingSize, sizeof(completionRingSize)) != 0 ||
+      setsockopt(socketFd, SOL_XDP, XDP_RX_RING, &ringSize, sizeof(ringSize)) != 0)
+  {
+    throw systemError("unable to size rings");
+  }
+
+  xdp_mmap_offsets offsets{};
+  socklen_t offsetsLength = sizeof(offsets);
+  if (getsockopt(socketFd, SOL_XDP, XDP_MMAP_OFFSETS, &offsets, &offsetsLength) != 0)
+  {
+    throw systemError("unable to read ring offsets");
+  }
+
+  const auto mapRing = [this](auto& ring, const xdp_ring_offset& offset, std::uint32_t size, off_t pageOffset) {
+    ring.mappingLength = offset.desc + size * sizeof(*ring.entries);
+    ring.mapping = mmap(nullptr, ring.mappingLength, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, socketFd, pageOffset);
+    if (ring.mapping == MAP_FAILED)
+    {
+      ring.mapping = nullptr;
+      throw systemError("unable to map ring");
+    }
+    auto* base = static_cast<std::uint8_t*>(ring.mapping);
+    ring.producer = reinterpret_cast<std::uint32_t*>(base + offset.producer);
+    ring.consumer = reinterpret_cast<std::uint32_t*>(base + offset.consumer);
+    ring.entries = reinterpret_cast<decltype(ring.entries)>(base + offset.desc);
+    ring.mask = size - 1;
+  };
+  mapRing(fillRing, offsets.fr, ringSize, static_cast<off_t>(XDP_UMEM_PGOFF_FILL_RING));
+  mapRing(completionRing, offsets.cr, completionRingSize, static_cast<off_t>(XDP_UMEM_PGOFF_COMPLETION_RING));
+  mapRing(receiveRing, offsets.rx, ringSize, static_cast<off_t>(XDP_PGOFF_RX_RING));
+
+  for (std::uint32_t frame = 0; frame < umemFrameCount; ++frame)
+  {
+    fillRing.entries[frame & fillRing.mask] = std::uint64_t{frame} * umemFrameSizeInBytes;
+  }
+  storeRelease(fillRing.producer, umemFrameCount);
+
+  sockaddr_xdp address{};
+  address.sxdp_family = AF_XDP;
+  address.sxdp_ifindex = interfaceIndex;
+  address.sxdp_queue_id = queueId;
+  if (bind(socketFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+  {
+    throw systemError("unable to bind to queue " + std::to_string(queueId));
+  }
+  socketDescriptor.assign(socketFd);
+}
+
+void XdpServer::attachProgram(std::uint32_t interfaceIndex, std::uint32_t queueId)
+{
+  bpf_attr mapAttributes{};
+  mapAttributes.map_type = BPF_MAP_TYPE_XSKMAP;
+  mapAttributes.key_size = sizeof(std::uint32_t);
+  mapAttributes.value_size = sizeof(std::uint32_t);
+  mapAttributes.max_entries = maxQueueCount;
+  mapFd = bpf(BPF_MAP_CREATE, mapAttributes);
+  if (mapFd < 0)
+  {
+    throw systemError("unable to create socket map");
+  }
+
+  const std::uint32_t value = static_cast<std::uint32_t>(socketFd);
+  bpf_attr updateAttributes{};
+  updateAttributes.map_fd = static_cast<std::uint32_t>(mapFd);
+  updateAttributes.key = reinterpret_cast<std::uint64_t>(&queueId);
+  updateAttributes.value = reinterpret_cast<std::uint64_t>(&value);
+  if (bpf(BPF_MAP_UPDATE_ELEM, updateAttributes) != 0)
+  {
+    throw systemError("unable to add socket to map");
+  }
+
+  const auto program = redirectProgram(mapFd, port);
+  static const char licence[] = "Dual MIT/GPL";
+  std::array<char, 4096> log{};
+  bpf_attr programAttributes{};
+  programAttributes.prog_type = BPF_PROG_TYPE_XDP;
+  programAttributes.insns = reinterpret_cast<std::uint64_t>(program.data());
+  programAttributes.insn_cnt = static_cast<std::uint32_t>(program.size());
+  programAttributes.license = reinterpret_cast<std::uint64_t>(licence);
+  programAttributes.log_buf = reinterpret_cast<std::uint64_t>(log.data());
+  programAttributes.log_size = static_cast<std::uint32_t>(log.size());
+  programAttributes.log_level = 1;
+  programFd = bpf(BPF_PROG_LOAD, programAttributes);
+  if (programFd < 0)
+  {
+    const auto error = systemError("unable to load XDP program");
+    spdlog::error("AF_XDP: verifier log: {}", log.data());
+    throw error;
+  }
+
+  // Native mode if the driver supports it, otherwise the generic path. The link detaches when it is closed.
+  for (const auto mode : {XDP_FLAGS_DRV_MODE, XDP_FLAGS_SKB_MODE})
+  {
+    bpf_attr linkAttributes{};
+    linkAttributes.link_create.prog_fd = static_cast<std::uint32_t>(programFd);
+    linkAttributes.link_create.target_ifindex = interfaceIndex;
+    linkAttributes.link_create.attach_type = BPF_XDP;
+    linkAttributes.link_create.flags = mode;
+    linkFd = bpf(BPF_LINK_CREATE, linkAttributes);
+    if (linkFd >= 0)
+    {
+      return;
+    }
+  }
+  throw systemError("unable to attach XDP program");
+}
+
+void XdpServer::closeAll() noexcept
+{
+  for (auto* fd : {&linkFd, &programFd, &mapFd})
+  {
+    if (*fd >= 0)
+    {
+      close(*fd);
+      *fd = -1;
+    }
+  }
+  if (socketDescriptor.is_open())
+  {
+    boost::system::error_code ignored;
+    socketDescriptor.close(ignored);
+  }
+  else if (socketFd >= 0)
+  {
+    close(socketFd);
+  }
+  socketFd = -1;
+  for (auto* ring : {&fillRing, &completionRing})
+  {
+    if (ring->mapping != nullptr)
+    {
+      munmap(ring->mapping, ring->mappingLength);
+      ring->mapping = nullptr;
+    }
+  }
+  if (receiveRing.mapping != nullptr)
+  {
+    munmap(receiveRing.mapping, receiveRing.mappingLength);
+    receiveRing.mapping = nullptr;
+  }
+  if (umem != nullptr)
+  {
+    munmap(umem, std::size_t{umemFrameCount} * umemFrameSizeInBytes);
+    umem = nullptr;
+  }
+}
+
+void XdpServer::triggerWaitAndReadNextUdpPackets()
+{
+  socketDescriptor.async_wait(
+    boost::asio::posix::stream_descriptor::wait_read,
+    [this](boost::system::error_code errorCode) {
+      if (!errorCode)
+      {
+        receiveBatch();
+        triggerWaitAndReadNextUdpPackets();
+      }
+    });
+}
+
+// Frames are handed back to the fill ring as soon as they have been copied into the packet buffers that the
+// reorder queue keeps, so UMEM is never held by a session.
+void XdpServer::receiveBatch()
+{
+  const auto consumer = *receiveRing.consumer;
+  const auto available = loadAcquire(receiveRing.producer) - consumer;
+  const auto count = std::min(available, receiveBatchSize);
+  auto fillProducer = *fillRing.producer;
+
+  for (std::uint32_t index = 0; index < count; ++index)
+  {
+    const auto& descriptor = receiveRing.entries[(consumer + index) & receiveRing.mask];
+    const auto* frame = static_cast<const std::uint8_t*>(umem) + descriptor.addr;
+    const auto payload = findUdpPayload(frame, descriptor.len, port);
+    if (callback && payload && payload->second > EnterpriseDiode::HeaderSizeInBytes)
+    {
+      const auto* header = frame + payload->first;
+      const auto payloadLength = std::min<std::size_t>(payload->second, udpFrameSize);
+      callback(
+        std::vector<std::uint8_t>(header, header + EnterpriseDiode::HeaderSizeInBytes),
+        std::vector<std::uint8_t>(header + EnterpriseDiode::HeaderSizeInBytes, header + payloadLength));
+    }
+    else
+    {
+      spdlog::debug("insufficient data in payload");
+    }
+    fillRing.entries[fillProducer++ & fillRing.mask] = descriptor.addr - descriptor.addr % umemFrameSizeInBytes;
+  }
+
+  storeRelease(receiveRing.consumer, consumer + count);
+  storeRelease(fillRing.producer, fillProducer);
+  if (available > count)
+  {
+    io_context.post([this]() {
+      if (socketDescriptor.is_open())
+      {
+        receiveBatch();
+      }
+    });
+  }
+}
+
+std::optional<std::pair<std::size_t, std::size_t>> XdpServer::findUdpPayload(
+  const std::uint8_t* frame, std::size_t frameLength, std::uint16_t port)
+{
+  if (frameLength < udpPayloadOffset ||
+      readWireUint16(frame + 12) != ipv4EtherType ||
+      frame[ethernetHeaderSize] != ipv4VersionAndHeaderLength ||
+      (readWireUint16(frame + ethernetHeaderSize + 6) & ipv4FragmentMask) != 0 ||
+      frame[ethernetHeaderSize + 9] != udpProtocol ||
+      readWireUint16(frame + udpHeaderOffset + 2) != port)
+  {
+    return std::nullopt;
+  }
+  // Ethernet pads short frames, so the lengths come from the IP and UDP headers.
+  const std::size_t ipLength = readWireUint16(frame + ethernetHeaderSize + 2);
+  const std::size_t udpLength = readWireUint16(frame + udpHeaderOffset + 4);
+  if (udpLength < udpHeaderSize || ipLength != ipv4HeaderSize + udpLength ||
+      ethernetHeaderSize + ipLength > frameLength)
+  {
+    return std::nullopt;
+  }
+  return std::make_pair(udpPayloadOffset, udpLength - udpHeaderSize);
+}
@@ -0,0 +1,77 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#ifndef XDPSERVER_HPP
+#define XDPSERVER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <linux/if_xdp.h>
+#include "UdpServerInterface.hpp"
+
+// Receives ED frames with an AF_XDP socket instead of the kernel UDP stack. A small XDP program on the interface
+// redirects IPv4 UDP datagrams for the server port into a UMEM region shared with this process; everything else
+// carries on to the kernel as normal. Requires Linux 5.9 or later and CAP_NET_ADMIN and CAP_BPF (or root).
+class XdpServer : public UdpServerInterface
+{
+public:
+  XdpServer(
+    const std::string& interfaceName,
+    std::uint32_t queueId,
+    std::uint16_t port,
+    boost::asio::io_service& io_service,
+    std::uint32_t udpFrameSize);
+
+  ~XdpServer() override;
+
+  XdpServer(const XdpServer&) = delete;
+  XdpServer& operator=(const XdpServer&) = delete;
+
+  // Offset and length of the UDP payload of an Ethernet frame, if it is an unfragmented IPv4 UDP datagram
+  // for port.
+  static std::optional<std::pair<std::size_t, std::size_t>> findUdpPayload(
+    const std::uint8_t* frame, std::size_t frameLength, std::uint16_t port);
+
+  static constexpr std::uint32_t umemFrameSizeInBytes = 4096;
+  static constexpr std::uint32_t umemFrameCount = 4096;
+  static constexpr std::uint32_t receiveBatchSize = 64;
+
+private:
+  template <typename T>
+  struct Ring
+  {
+    std::uint32_t* producer = nullptr;
+    std::uint32_t* consumer = nullptr;
+    T* entries = nullptr;
+    std::uint32_t mask = 0;
+    void* mapping = nullptr;
+    std::size_t mappingLength = 0;
+  };
+
+  void createUmem();
+  void createSocket(std::uint32_t interfaceIndex, std::uint32_t queueId);
+  void attachProgram(std::uint32_t interfaceIndex, std::uint32_t queueId);
+  void closeAll() noexcept;
+  void triggerWaitAndReadNextUdpPackets();
+  void receiveBatch();
+
+  const std::uint16_t port;
+  const std::uint32_t udpFrameSize;
+  boost::asio::io_service& io_context;
+  void* umem = nullptr;
+  int socketFd = -1;
+  int mapFd = -1;
+  int programFd = -1;
+  int linkFd = -1;
+  Ring<std::uint64_t> fillRing;
+  Ring<std::uint64_t> completionRing;
+  Ring<xdp_desc> receiveRing;
+  boost::asio::posix::stream_descriptor socketDescriptor;
+};
+
+#endif //XDPSERVER_HPP
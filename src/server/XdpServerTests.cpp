@@ -0,0 +1,131 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <cstdint>
+#include <cstdlib>
+#include <future>
+#include <thread>
+#include <vector>
+#include <sched.h>
+
+#include "test/catch.hpp"
+#include "diodeheader/EnterpriseDiodeHeader.hpp"
+#include "client/UdpClient.hpp"
+#include "XdpServer.hpp"
+
+namespace
+{
+  // An Ethernet frame holding an IPv4 UDP datagram, padded to the Ethernet minimum.
+  std::vector<std::uint8_t> makeUdpFrame(std::uint16_t port, std::size_t payloadLength)
+  {
+    const auto udpLength = 8 + payloadLength;
+    const auto ipLength = 20 + udpLength;
+    std::vector<std::uint8_t> frame(std::max<std::size_t>(14 + ipLength, 60));
+    frame[12] = 0x08;
+    frame[14] = 0x45;
+    frame[16] = static_cast<std::uint8_t>(ipLength >> 8);
+    frame[17] = static_cast<std::uint8_t>(ipLength);
+    frame[23] = 17;
+    frame[36] = static_cast<std::uint8_t>(port >> 8);
+    frame[37] = static_cast<std::uint8_t>(port);
+    frame[38] = static_cast<std::uint8_t>(udpLength >> 8);
+    frame[39] = static_cast<std::uint8_t>(udpLength);
+    return frame;
+  }
+}
+
+TEST_CASE("XDP Server. UDP payload is found in an Ethernet frame")
+{
+  auto frame = makeUdpFrame(45000, 200);
+  REQUIRE(XdpServer::findUdpPayload(frame.data(), frame.size(), 45000) == std::make_pair<std::size_t, std::size_t>(42, 200));
+
+  SECTION("Ethernet padding is not part of the payload")
+  {
+    frame = makeUdpFrame(45000, 2);
+    REQUIRE(frame.size() == 60);
+    REQUIRE(XdpServer::findUdpPayload(frame.data(), frame.size(), 45000)->second == 2);
+  }
+  SECTION("Other ports are ignored")
+  {
+    REQUIRE_FALSE(XdpServer::findUdpPayload(frame.data(), frame.size(), 45001));
+  }
+  SECTION("Other protocols are ignored")
+  {
+    frame[23] = 6;
+    REQUIRE_FALSE(XdpServer::findUdpPayload(frame.data(), frame.size(), 45000));
+    frame[23] = 17;
+    frame[12] = 0x86;
+    frame[13] = 0xDD;
+    REQUIRE_FALSE(XdpServer::findUdpPayload(frame.data(), frame.size(), 45000));
+  }
+  SECTION("IP options and fragments are ignored")
+  {
+    frame[14] = 0x46;
+    REQUIRE_FALSE(XdpServer::findUdpPayload(frame.data(), frame.size(), 45000));
+    frame[14] = 0x45;
+    frame[20] = 0x20;
+    REQUIRE_FALSE(XdpServer::findUdpPayload(frame.data(), frame.size(), 45000));
+  }
+  SECTION("Lengths beyond the frame are rejected")
+  {
+    REQUIRE_FALSE(XdpServer::findUdpPayload(frame.data(), frame.size() - 1, 45000));
+    REQUIRE_FALSE(XdpServer::findUdpPayload(frame.data(), 41, 45000));
+    frame[39] = static_cast<std::uint8_t>(frame[39] + 1);
+    REQUIRE_FALSE(XdpServer::findUdpPayload(frame.data(), frame.size(), 45000));
+  }
+}
+
+// Needs root. Runs in its own network namespace on a veth pair: datagrams sent out of one end to an address
+// with a static neighbour entry arrive on the other end, where the XDP program redirects them to the server.
+// Hidden from the default run; use: sudo UnitTests "[xdp]"
+TEST_CASE("XDP Server. Packets are received on a veth pair", "[.][xdp]")
+{
+  std::vector<std::vector<std::uint8_t>> payloadsReceived;
+  std::vector<std::uint32_t> frameCountsReceived;
+
+  std::thread namespaceThread([&]() {
+    REQUIRE(unshare(CLONE_NEWNET) == 0);
+    REQUIRE(std::system(
+      "ip link set lo up && "
+      "ip link add edxdp0 type veth peer name edxdp1 address 02:00:00:00:ed:01 && "
+      "ip link set edxdp0 up && ip link set edxdp1 up && "
+      "ip addr add 10.237.0.1/24 dev edxdp0 && "
+      "ip neigh add 10.237.0.2 lladdr 02:00:00:00:ed:01 dev edxdp0") == 0);
+
+    boost::asio::io_service io_context;
+    XdpServer xdpServer("edxdp1", 0, 2020, io_context, 1472);
+    xdpServer.setCallback([&](BytesBuffer&& header, BytesBuffer&& payload) {
+      frameCountsReceived.push_back(EDHeaderView(header.data()).frameCount());
+      payloadsReceived.push_back(std::move(payload));
+      if (payloadsReceived.size() == 100)
+      {
+        io_context.stop();
+      }
+    });
+
+    auto sender = std::async(std::launch::async, [&]() {
+      UdpClient udpClient("10.237.0.2", 2020);
+      UdpClient otherPort("10.237.0.2", 2021);
+      std::array<char, EnterpriseDiode::HeaderSizeInBytes> header{};
+      for (std::uint32_t frameCount = 1; frameCount <= 100; ++frameCount)
+      {
+        std::memcpy(header.data() + EnterpriseDiode::FrameCountIndex, &frameCount, sizeof(frameCount));
+        const std::vector<char> payload(frameCount, static_cast<char>(frameCount));
+        otherPort.send({boost::asio::buffer(header), boost::asio::buffer(payload)});
+        udpClient.send({boost::asio::buffer(header), boost::asio::buffer(payload)});
+        usleep(1000);
+      }
+    });
+
+    io_context.run_for(std::chrono::seconds(5));
+    sender.get();
+  });
+  namespaceThread.join();
+
+  REQUIRE(payloadsReceived.size() == 100);
+  for (std::uint32_t frameCount = 1; frameCount <= 100; ++frameCount)
+  {
+    REQUIRE(frameCountsReceived.at(frameCount - 1) == frameCount);
+    REQUIRE(payloadsReceived.at(frameCount - 1) == BytesBuffer(frameCount, static_cast<std::uint8_t>(frameCount)));
+  }
+}
@@ -0,0 +1,97 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <random>
+#include <regex>
+#include <string>
+
+#include "test/catch.hpp"
+#include "FilenameValidator.hpp"
+
+namespace
+{
+  bool regexIsValid(const std::string& filename)
+  {
+    static const std::regex filter("[a-zA-Z0-9\\.\\-_]+");
+    return std::regex_match(filename, filter);
+  }
+}
+
+TEST_CASE("FilenameValidator. Allowed characters are accepted")
+{
+  REQUIRE(FilenameValidator::isValid("abcXYZ019"));
+  REQUIRE(FilenameValidator::isValid("a.b-c_"));
+  REQUIRE(FilenameValidator::isValid("."));
+}
+
+TEST_CASE("FilenameValidator. Empty filenames and disallowed characters are rejected")
+{
+  REQUIRE_FALSE(FilenameValidator::isValid(""));
+  REQUIRE_FALSE(FilenameValidator::isValid("abc/def"));
+  REQUIRE_FALSE(FilenameValidator::isValid("testFilename!"));
+  REQUIRE_FALSE(FilenameValidator::isValid(std::string("cz\0d", 4)));
+  REQUIRE_FALSE(FilenameValidator::isValid("caf\xc3\xa9"));
+}
+
+TEST_CASE("FilenameValidator. Matches the regex for every single and double byte filename")
+{
+  for (int first = 0; first < 256; ++first)
+  {
+    const std::string single(1, static_cast<char>(first));
+    REQUIRE(FilenameValidator::isValid(single) == regexIsValid(single));
+    for (int second = 0; second < 256; ++second)
+    {
+      const std::string pair{static_cast<char>(first), static_cast<char>(second)};
+      if (FilenameValidator::isValid(pair) != regexIsValid(pair))
+      {
+        FAIL("Mismatch for bytes " << first << ", " << second);
+      }
+    }
+  }
+}
+
+TEST_CASE("FilenameValidator. Matches the regex for randomly generated filenames")
+{
+  std::mt19937 generator(2021);
+  std::uniform_int_distribution<int> lengthDistribution(0, 80);
+  std::uniform_int_distribution<int> byteDistribution(0, 255);
+  std::uniform_int_distribution<int> percentDistribution(0, 99);
+  const std::string allowed = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789.-_";
+  std::uniform_int_distribution<std::size_t> allowedDistribution(0, allowed.size() - 1);
+
+  for (int iteration = 0; iteration < 20000; ++iteration)
+  {
+    std::string filename(static_cast<std::size_t>(lengthDistribution(generator)), '\0');
+    for (auto& c : filename)
+    {
+      c = percentDistribution(generator) < 97 ? allowed.at(allowedDistribution(generator))
+                                             : static_cast<char>(byteDistribution(generator));
+    }
+    if (FilenameValidator::isValid(filename) != regexIsValid(filename))
+    {
+      FAIL("Mismatch for filename " << filename);
+    }
+  }
+}
+
+TEST_CASE("FilenameValidator. Relative paths stay inside the output folder")
+{
+  REQUIRE(FilenameValidator::isValidRelativePath("docs"));
+  REQUIRE(FilenameValidator::isValidRelativePath("docs/2021/q1"));
+  REQUIRE(FilenameValidator::isValidRelativePath("a..b/.config"));
+
+  for (const auto path : {"", "/", "/etc", "docs/", "docs//2021", "..", "docs/../..", "./docs", "docs/.", "a\\b",
+         "docs/caf\xc3\xa9"})
+  {
+    INFO(path);
+    REQUIRE_FALSE(FilenameValidator::isValidRelativePath(path));
+  }
+
+  std::string deepest = "d";
+  for (std::size_t depth = 1; depth < FilenameValidator::maxPathDepth; ++depth)
+  {
+    deepest += "/d";
+  }
+  REQUIRE(FilenameValidator::isValidRelativePath(deepest));
+  REQUIRE_FALSE(FilenameValidator::isValidRelativePath(deepest + "/d"));
+}
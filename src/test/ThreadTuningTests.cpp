@@ -0,0 +1,67 @@
+// Copyright PA Knowledge Ltd 2021
+// MIT License. For licence terms see LICENCE.md file.
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "test/catch.hpp"
+#include "ThreadTuning.hpp"
+
+TEST_CASE("ThreadTuning. CPU lists are parsed in the kernel cpulist format")
+{
+  REQUIRE(ThreadTuning::parseCpuList("").empty());
+  REQUIRE(ThreadTuning::parseCpuList("3") == std::vector<unsigned int>{3});
+  REQUIRE(ThreadTuning::parseCpuList("0-3,8") == std::vector<unsigned int>{0, 1, 2, 3, 8});
+  REQUIRE(ThreadTuning::parseCpuList("2-2,5-6\n") == std::vector<unsigned int>{2, 5, 6});
+}
+
+TEST_CASE("ThreadTuning. Invalid CPU lists are rejected")
+{
+  for (const auto list : {"a", "1,", ",1", "3-1", "1-", "-1", "1-2-3", "1 2", "99999"})
+  {
+    INFO(list);
+    REQUIRE_THROWS_AS(ThreadTuning::parseCpuList(list), std::runtime_error);
+  }
+}
+
+TEST_CASE("ThreadTuning. Thread settings take given cores over the NUMA node")
+{
+  REQUIRE(ThreadTuning::threadSettings("1,3", 0, 5).cpus == std::vector<unsigned int>{1, 3});
+  REQUIRE(ThreadTuning::threadSettings("1,3", 0, 5).realtimePriority == 5);
+  REQUIRE(ThreadTuning::threadSettings("", std::nullopt, 0).cpus.empty());
+  REQUIRE_THROWS_AS(ThreadTuning::threadSettings("", 100000, 0), std::runtime_error);
+  REQUIRE_THROWS_AS(ThreadTuning::threadSettings("", std::nullopt, 100), std::runtime_error);
+  REQUIRE_THROWS_AS(ThreadTuning::threadSettings("", std::nullopt, -1), std::runtime_error);
+}
+
+TEST_CASE("ThreadTuning. A thread is pinned to the given cores")
+{
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  std::thread([&cpuSet]() {
+    ThreadTuning::applyToCurrentThread({{0}, 0});
+    pthread_getaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+  }).join();
+
+  REQUIRE(CPU_COUNT(&cpuSet) == 1);
+  REQUIRE(CPU_ISSET(0, &cpuSet));
+}
+
+TEST_CASE("ThreadTuning. A thread with no settings of its own is put back to the process's original cores")
+{
+  cpu_set_t original;
+  CPU_ZERO(&original);
+  pthread_getaffinity_np(pthread_self(), sizeof(original), &original);
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  std::thread([&cpuSet]() {
+    ThreadTuning::applyToCurrentThread({{0}, 0});
+    std::thread([&cpuSet]() {
+      ThreadTuning::applyToCurrentThread({});
+      pthread_getaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+    }).join();
+  }).join();
+
+  REQUIRE(CPU_EQUAL(&cpuSet, &original));
+}